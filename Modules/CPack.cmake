@@ -193,6 +193,17 @@
 #  * Mandatory : NO
 #  * Default   : FALSE
 #
+# .. variable:: CPACK_ARCHIVE_THREADS
+#
+#  The number of threads used by the archive generators (TGZ, TBZ2, TXZ,
+#  and the like) to compress the package.  With more than one thread the
+#  archive is compressed in independent blocks, which standard tools
+#  decompress as one stream.  A value of 0 uses one thread per processor.
+#  Other compression methods always use one thread.
+#
+#  * Mandatory : NO
+#  * Default   : 1
+#
 # The following CPack variables are specific to source packages, and
 # will not affect binary packages:
 #
@@ -79,33 +79,38 @@ macro(CHECK_C_SOURCE_COMPILES SOURCE VAR)
       ${CHECK_C_SOURCE_COMPILES_ADD_LIBRARIES}
       CMAKE_FLAGS -DCOMPILE_DEFINITIONS:STRING=${MACRO_CHECK_FUNCTION_DEFINITIONS}
       "${CHECK_C_SOURCE_COMPILES_ADD_INCLUDES}"
-      OUTPUT_VARIABLE OUTPUT)
+      OUTPUT_VARIABLE OUTPUT
+      BATCH)
+    try_compile_batch(CALL __check_c_source_compiles_result
+      "${SOURCE}" "${VAR}" "${CMAKE_REQUIRED_QUIET}" ${_FAIL_REGEX})
 
-    foreach(_regex ${_FAIL_REGEX})
-      if("${OUTPUT}" MATCHES "${_regex}")
-        set(${VAR} 0)
-      endif()
-    endforeach()
-
-    if(${VAR})
-      set(${VAR} 1 CACHE INTERNAL "Test ${VAR}")
-      if(NOT CMAKE_REQUIRED_QUIET)
-        message(STATUS "Performing Test ${VAR} - Success")
-      endif()
-      file(APPEND ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeOutput.log
-        "Performing C SOURCE FILE Test ${VAR} succeeded with the following output:\n"
-        "${OUTPUT}\n"
-        "Source file was:\n${SOURCE}\n")
-    else()
-      if(NOT CMAKE_REQUIRED_QUIET)
-        message(STATUS "Performing Test ${VAR} - Failed")
-      endif()
-      set(${VAR} "" CACHE INTERNAL "Test ${VAR}")
-      file(APPEND ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeError.log
-        "Performing C SOURCE FILE Test ${VAR} failed with the following output:\n"
-        "${OUTPUT}\n"
-        "Source file was:\n${SOURCE}\n")
-    endif()
   endif()
 endmacro()
 
+function(__check_c_source_compiles_result SOURCE VAR QUIET)
+  foreach(_regex ${ARGN})
+    if("${OUTPUT}" MATCHES "${_regex}")
+      set(${VAR} 0)
+    endif()
+  endforeach()
+
+  if(${VAR})
+    set(${VAR} 1 CACHE INTERNAL "Test ${VAR}")
+    if(NOT QUIET)
+      message(STATUS "Performing Test ${VAR} - Success")
+    endif()
+    file(APPEND ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeOutput.log
+      "Performing C SOURCE FILE Test ${VAR} succeeded with the following output:\n"
+      "${OUTPUT}\n"
+      "Source file was:\n${SOURCE}\n")
+  else()
+    if(NOT QUIET)
+      message(STATUS "Performing Test ${VAR} - Failed")
+    endif()
+    set(${VAR} "" CACHE INTERNAL "Test ${VAR}")
+    file(APPEND ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeError.log
+      "Performing C SOURCE FILE Test ${VAR} failed with the following output:\n"
+      "${OUTPUT}\n"
+      "Source file was:\n${SOURCE}\n")
+  endif()
+endfunction()
@@ -44,7 +44,12 @@
 #  License text for the above reference.)
 
 macro(CHECK_INCLUDE_FILE_CXX INCLUDE VARIABLE)
-  if(NOT DEFINED "${VARIABLE}" OR "x${${VARIABLE}}" STREQUAL "x${VARIABLE}")
+  # A check queued in a batch of checks is not defined until it ends.
+  get_property(_CHECK_INCLUDE_QUEUED GLOBAL PROPERTY
+    __CHECK_INCLUDE_QUEUED_${VARIABLE})
+  if((NOT DEFINED "${VARIABLE}" OR "x${${VARIABLE}}" STREQUAL "x${VARIABLE}")
+      AND NOT _CHECK_INCLUDE_QUEUED)
+    set_property(GLOBAL PROPERTY __CHECK_INCLUDE_QUEUED_${VARIABLE} 1)
     if(CMAKE_REQUIRED_INCLUDES)
       set(CHECK_INCLUDE_FILE_CXX_INCLUDE_DIRS "-DINCLUDE_DIRECTORIES=${CMAKE_REQUIRED_INCLUDES}")
     else()
@@ -69,30 +74,37 @@ macro(CHECK_INCLUDE_FILE_CXX INCLUDE VARIABLE)
       CMAKE_FLAGS
       -DCOMPILE_DEFINITIONS:STRING=${MACRO_CHECK_INCLUDE_FILE_FLAGS}
       "${CHECK_INCLUDE_FILE_CXX_INCLUDE_DIRS}"
-      OUTPUT_VARIABLE OUTPUT)
+      OUTPUT_VARIABLE OUTPUT
+      BATCH)
 
     if(${ARGC} EQUAL 3)
       set(CMAKE_CXX_FLAGS ${CMAKE_CXX_FLAGS_SAVE})
     endif()
 
-    if(${VARIABLE})
-      if(NOT CMAKE_REQUIRED_QUIET)
-        message(STATUS "Looking for C++ include ${INCLUDE} - found")
-      endif()
-      set(${VARIABLE} 1 CACHE INTERNAL "Have include ${INCLUDE}")
-      file(APPEND ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeOutput.log
-        "Determining if the include file ${INCLUDE} "
-        "exists passed with the following output:\n"
-        "${OUTPUT}\n\n")
-    else()
-      if(NOT CMAKE_REQUIRED_QUIET)
-        message(STATUS "Looking for C++ include ${INCLUDE} - not found")
-      endif()
-      set(${VARIABLE} "" CACHE INTERNAL "Have include ${INCLUDE}")
-      file(APPEND ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeError.log
-        "Determining if the include file ${INCLUDE} "
-        "exists failed with the following output:\n"
-        "${OUTPUT}\n\n")
-    endif()
+    try_compile_batch(CALL __check_include_file_cxx_result
+      "${INCLUDE}" "${VARIABLE}" "${CMAKE_REQUIRED_QUIET}")
   endif()
 endmacro()
+
+function(__check_include_file_cxx_result INCLUDE VARIABLE QUIET)
+  set_property(GLOBAL PROPERTY __CHECK_INCLUDE_QUEUED_${VARIABLE})
+  if(${VARIABLE})
+    if(NOT QUIET)
+      message(STATUS "Looking for C++ include ${INCLUDE} - found")
+    endif()
+    set(${VARIABLE} 1 CACHE INTERNAL "Have include ${INCLUDE}")
+    file(APPEND ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeOutput.log
+      "Determining if the include file ${INCLUDE} "
+      "exists passed with the following output:\n"
+      "${OUTPUT}\n\n")
+  else()
+    if(NOT QUIET)
+      message(STATUS "Looking for C++ include ${INCLUDE} - not found")
+    endif()
+    set(${VARIABLE} "" CACHE INTERNAL "Have include ${INCLUDE}")
+    file(APPEND ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeError.log
+      "Determining if the include file ${INCLUDE} "
+      "exists failed with the following output:\n"
+      "${OUTPUT}\n\n")
+  endif()
+endfunction()
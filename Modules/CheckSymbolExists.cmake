@@ -91,27 +91,34 @@ macro(_CHECK_SYMBOL_EXISTS SOURCEFILE SYMBOL FILES VARIABLE)
       CMAKE_FLAGS
       -DCOMPILE_DEFINITIONS:STRING=${MACRO_CHECK_SYMBOL_EXISTS_FLAGS}
       "${CMAKE_SYMBOL_EXISTS_INCLUDES}"
-      OUTPUT_VARIABLE OUTPUT)
-    if(${VARIABLE})
-      if(NOT CMAKE_REQUIRED_QUIET)
-        message(STATUS "Looking for ${SYMBOL} - found")
-      endif()
-      set(${VARIABLE} 1 CACHE INTERNAL "Have symbol ${SYMBOL}")
-      file(APPEND ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeOutput.log
-        "Determining if the ${SYMBOL} "
-        "exist passed with the following output:\n"
-        "${OUTPUT}\nFile ${SOURCEFILE}:\n"
-        "${CMAKE_CONFIGURABLE_FILE_CONTENT}\n")
-    else()
-      if(NOT CMAKE_REQUIRED_QUIET)
-        message(STATUS "Looking for ${SYMBOL} - not found")
-      endif()
-      set(${VARIABLE} "" CACHE INTERNAL "Have symbol ${SYMBOL}")
-      file(APPEND ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeError.log
-        "Determining if the ${SYMBOL} "
-        "exist failed with the following output:\n"
-        "${OUTPUT}\nFile ${SOURCEFILE}:\n"
-        "${CMAKE_CONFIGURABLE_FILE_CONTENT}\n")
-    endif()
+      OUTPUT_VARIABLE OUTPUT
+      BATCH)
+    try_compile_batch(CALL __check_symbol_exists_result
+      "${SYMBOL}" "${SOURCEFILE}" "${VARIABLE}" "${CMAKE_REQUIRED_QUIET}"
+      "${CMAKE_CONFIGURABLE_FILE_CONTENT}")
   endif()
 endmacro()
+
+function(__check_symbol_exists_result SYMBOL SOURCEFILE VARIABLE QUIET CONTENT)
+  if(${VARIABLE})
+    if(NOT QUIET)
+      message(STATUS "Looking for ${SYMBOL} - found")
+    endif()
+    set(${VARIABLE} 1 CACHE INTERNAL "Have symbol ${SYMBOL}")
+    file(APPEND ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeOutput.log
+      "Determining if the ${SYMBOL} "
+      "exist passed with the following output:\n"
+      "${OUTPUT}\nFile ${SOURCEFILE}:\n"
+      "${CONTENT}\n")
+  else()
+    if(NOT QUIET)
+      message(STATUS "Looking for ${SYMBOL} - not found")
+    endif()
+    set(${VARIABLE} "" CACHE INTERNAL "Have symbol ${SYMBOL}")
+    file(APPEND ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeError.log
+      "Determining if the ${SYMBOL} "
+      "exist failed with the following output:\n"
+      "${OUTPUT}\nFile ${SOURCEFILE}:\n"
+      "${CONTENT}\n")
+  endif()
+endfunction()
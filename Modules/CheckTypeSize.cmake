@@ -88,8 +88,9 @@ get_filename_component(__check_type_size_dir "${CMAKE_CURRENT_LIST_FILE}" PATH)
 
 #-----------------------------------------------------------------------------
 # Helper function.  DO NOT CALL DIRECTLY.
-function(__check_type_size_impl type var map builtin language)
-  if(NOT CMAKE_REQUIRED_QUIET)
+function(__check_type_size_impl type var map builtin language quiet
+    flags definitions includes libraries extra_includes)
+  if(NOT quiet)
     message(STATUS "Check size of ${type}")
   endif()
 
@@ -106,7 +107,7 @@ function(__check_type_size_impl type var map builtin language)
       set(headers "${headers}#include <stddef.h>\n")
     endif()
   endif()
-  foreach(h ${CMAKE_EXTRA_INCLUDE_FILES})
+  foreach(h ${extra_includes})
     set(headers "${headers}#include \"${h}\"\n")
   endforeach()
 
@@ -122,15 +123,22 @@ function(__check_type_size_impl type var map builtin language)
   set(bin ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CheckTypeSize/${var}.bin)
   configure_file(${__check_type_size_dir}/CheckTypeSize.c.in ${src} @ONLY)
   try_compile(HAVE_${var} ${CMAKE_BINARY_DIR} ${src}
-    COMPILE_DEFINITIONS ${CMAKE_REQUIRED_DEFINITIONS}
-    LINK_LIBRARIES ${CMAKE_REQUIRED_LIBRARIES}
+    COMPILE_DEFINITIONS ${definitions}
+    LINK_LIBRARIES ${libraries}
     CMAKE_FLAGS
-      "-DCOMPILE_DEFINITIONS:STRING=${CMAKE_REQUIRED_FLAGS}"
-      "-DINCLUDE_DIRECTORIES:STRING=${CMAKE_REQUIRED_INCLUDES}"
-    OUTPUT_VARIABLE output
+      "-DCOMPILE_DEFINITIONS:STRING=${flags}"
+      "-DINCLUDE_DIRECTORIES:STRING=${includes}"
+    OUTPUT_VARIABLE __CHECK_TYPE_SIZE_OUTPUT_${var}
     COPY_FILE ${bin}
+    BATCH
     )
+  try_compile_batch(CALL __check_type_size_result
+    "${type}" "${var}" "${map}" "${src}" "${bin}" "${quiet}")
+endfunction()
 
+#-----------------------------------------------------------------------------
+# Helper function.  DO NOT CALL DIRECTLY.
+function(__check_type_size_result type var map src bin quiet)
   if(HAVE_${var})
     # The check compiled.  Load information from the binary.
     file(STRINGS ${bin} strings LIMIT_COUNT 10 REGEX "INFO:size")
@@ -175,25 +183,64 @@ function(__check_type_size_impl type var map builtin language)
       message(SEND_ERROR "CHECK_TYPE_SIZE found different results, consider setting CMAKE_OSX_ARCHITECTURES or CMAKE_TRY_COMPILE_OSX_ARCHITECTURES to one or no architecture !")
     endif()
 
-    if(NOT CMAKE_REQUIRED_QUIET)
+    if(NOT quiet)
       message(STATUS "Check size of ${type} - done")
     endif()
     file(APPEND ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeOutput.log
-      "Determining size of ${type} passed with the following output:\n${output}\n\n")
+      "Determining size of ${type} passed with the following output:\n${__CHECK_TYPE_SIZE_OUTPUT_${var}}\n\n")
     set(${var} "${${var}}" CACHE INTERNAL "CHECK_TYPE_SIZE: sizeof(${type})")
   else()
     # The check failed to compile.
-    if(NOT CMAKE_REQUIRED_QUIET)
+    if(NOT quiet)
       message(STATUS "Check size of ${type} - failed")
     endif()
     file(READ ${src} content)
     file(APPEND ${CMAKE_BINARY_DIR}${CMAKE_FILES_DIRECTORY}/CMakeError.log
-      "Determining size of ${type} failed with the following output:\n${output}\n${src}:\n${content}\n\n")
+      "Determining size of ${type} failed with the following output:\n${__CHECK_TYPE_SIZE_OUTPUT_${var}}\n${src}:\n${content}\n\n")
     set(${var} "" CACHE INTERNAL "CHECK_TYPE_SIZE: ${type} unknown")
     file(REMOVE ${map})
   endif()
+
+  # Inside a batch the output was stored in the scope that ended it.
+  unset(__CHECK_TYPE_SIZE_OUTPUT_${var} PARENT_SCOPE)
 endfunction()
 
+#-----------------------------------------------------------------------------
+# Helper macro.  DO NOT CALL DIRECTLY.
+macro(__check_type_size_check TYPE VARIABLE _builtin _language _quiet
+    _flags _definitions _includes _libraries _extra_includes)
+  set(${VARIABLE}_KEYS)
+  if(NOT DEFINED HAVE_${VARIABLE})
+    __check_type_size_impl(${TYPE} ${VARIABLE}
+      ${CMAKE_BINARY_DIR}/${CMAKE_FILES_DIRECTORY}/CheckTypeSize/${VARIABLE}.cmake
+      ${_builtin} ${_language} "${_quiet}" "${_flags}" "${_definitions}"
+      "${_includes}" "${_libraries}" "${_extra_includes}")
+  endif()
+  try_compile_batch(CALL __check_type_size_code "${VARIABLE}")
+endmacro()
+
+#-----------------------------------------------------------------------------
+# Helper macro.  DO NOT CALL DIRECTLY.
+macro(__check_type_size_code VARIABLE)
+  include(${CMAKE_BINARY_DIR}/${CMAKE_FILES_DIRECTORY}/CheckTypeSize/${VARIABLE}.cmake OPTIONAL)
+
+  # Create preprocessor code.
+  if(${VARIABLE}_KEYS)
+    set(${VARIABLE}_CODE)
+    set(_if if)
+    foreach(key ${${VARIABLE}_KEYS})
+      set(${VARIABLE}_CODE "${${VARIABLE}_CODE}#${_if} defined(${key})\n# define ${VARIABLE} ${${VARIABLE}-${key}}\n")
+      set(_if elif)
+    endforeach()
+    set(${VARIABLE}_CODE "${${VARIABLE}_CODE}#else\n# error ${VARIABLE} unknown\n#endif")
+    set(_if)
+  elseif(${VARIABLE})
+    set(${VARIABLE}_CODE "#define ${VARIABLE} ${${VARIABLE}}")
+  else()
+    set(${VARIABLE}_CODE "/* #undef ${VARIABLE} */")
+  endif()
+endmacro()
+
 #-----------------------------------------------------------------------------
 macro(CHECK_TYPE_SIZE TYPE VARIABLE)
   # parse arguments
@@ -242,31 +289,14 @@ macro(CHECK_TYPE_SIZE TYPE VARIABLE)
   unset(_CHECK_TYPE_SIZE_BUILTIN_TYPES_ONLY)
   unset(_CHECK_TYPE_SIZE_LANGUAGE)
 
-  # Compute or load the size or size map.
-  set(${VARIABLE}_KEYS)
-  set(_map_file ${CMAKE_BINARY_DIR}/${CMAKE_FILES_DIRECTORY}/CheckTypeSize/${VARIABLE}.cmake)
-  if(NOT DEFINED HAVE_${VARIABLE})
-    __check_type_size_impl(${TYPE} ${VARIABLE} ${_map_file} ${_builtin} ${_language})
-  endif()
-  include(${_map_file} OPTIONAL)
-  set(_map_file)
+  # Compute or load the size or size map.  In a batch of checks the
+  # header checks above are done when the batch ends, so check then.
+  try_compile_batch(CALL __check_type_size_check
+    "${TYPE}" "${VARIABLE}" "${_builtin}" "${_language}"
+    "${CMAKE_REQUIRED_QUIET}" "${CMAKE_REQUIRED_FLAGS}"
+    "${CMAKE_REQUIRED_DEFINITIONS}" "${CMAKE_REQUIRED_INCLUDES}"
+    "${CMAKE_REQUIRED_LIBRARIES}" "${CMAKE_EXTRA_INCLUDE_FILES}")
   set(_builtin)
-
-  # Create preprocessor code.
-  if(${VARIABLE}_KEYS)
-    set(${VARIABLE}_CODE)
-    set(_if if)
-    foreach(key ${${VARIABLE}_KEYS})
-      set(${VARIABLE}_CODE "${${VARIABLE}_CODE}#${_if} defined(${key})\n# define ${VARIABLE} ${${VARIABLE}-${key}}\n")
-      set(_if elif)
-    endforeach()
-    set(${VARIABLE}_CODE "${${VARIABLE}_CODE}#else\n# error ${VARIABLE} unknown\n#endif")
-    set(_if)
-  elseif(${VARIABLE})
-    set(${VARIABLE}_CODE "#define ${VARIABLE} ${${VARIABLE}}")
-  else()
-    set(${VARIABLE}_CODE "/* #undef ${VARIABLE} */")
-  endif()
 endmacro()
 
 #-----------------------------------------------------------------------------
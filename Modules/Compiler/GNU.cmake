@@ -42,6 +42,9 @@ macro(__compiler_gnu lang)
     # internally, as it ought to.  Work around this bug by setting -MT here
     # even though it isn't strictly necessary.
     set(CMAKE_DEPFILE_FLAGS_${lang} "-MD -MT <OBJECT> -MF <DEPFILE>")
+    # Makefile generators also need phony rules for the headers so
+    # that removing one does not break the build.
+    set(CMAKE_MAKE_DEPFILE_FLAGS_${lang} "-MD -MP -MT <OBJECT> -MF <DEPFILE>")
   endif()
 
   # Initial configuration flags.
@@ -40,6 +40,21 @@ int cmCPackArchiveGenerator::InitializeInternal()
   this->SetOptionIfNotSet("CPACK_INCLUDE_TOPLEVEL_DIRECTORY", "1");
   return this->Superclass::InitializeInternal();
 }
+
+int cmCPackArchiveGenerator::GetThreadCount()
+{
+  long threads = 1;
+  if (const char* value = this->GetOption("CPACK_ARCHIVE_THREADS")) {
+    if (!cmSystemTools::StringToLong(value, &threads) || threads < 0) {
+      cmCPackLogger(cmCPackLog::LOG_WARNING,
+                    "Ignoring invalid CPACK_ARCHIVE_THREADS value: "
+                      << value << std::endl);
+      threads = 1;
+    }
+  }
+  return static_cast<int>(threads);
+}
+
 int cmCPackArchiveGenerator::addOneComponentToArchive(
   cmArchiveWrite& archive, cmCPackComponent* component)
 {
@@ -94,7 +109,8 @@ int cmCPackArchiveGenerator::addOneComponentToArchive(
                     << filename << ">." << std::endl);                        \
     return 0;                                                                 \
   }                                                                           \
-  cmArchiveWrite archive(gf, this->Compress, this->ArchiveFormat);            \
+  cmArchiveWrite archive(gf, this->Compress, this->ArchiveFormat,             \
+                         this->GetThreadCount());                             \
   if (!archive) {                                                             \
     cmCPackLogger(cmCPackLog::LOG_ERROR, "Problem to create archive < "       \
                     << filename << ">. ERROR =" << archive.GetError()         \
@@ -102,6 +118,18 @@ int cmCPackArchiveGenerator::addOneComponentToArchive(
     return 0;                                                                 \
   }
 
+/*
+ * The macro will finish writing the 'archive' object
+ * declared by DECLARE_AND_OPEN_ARCHIVE for the file 'filename'.
+ */
+#define FINISH_ARCHIVE(filename, archive)                                     \
+  if (!archive.Finish()) {                                                    \
+    cmCPackLogger(cmCPackLog::LOG_ERROR, "Problem to finish archive < "       \
+                    << filename << ">. ERROR =" << archive.GetError()         \
+                    << std::endl);                                            \
+    return 0;                                                                 \
+  }
+
 int cmCPackArchiveGenerator::PackageComponents(bool ignoreGroup)
 {
   packageFileNames.clear();
@@ -130,6 +158,7 @@ int cmCPackArchiveGenerator::PackageComponents(bool ignoreGroup)
           // Add the files of this component to the archive
           addOneComponentToArchive(archive, *compIt);
         }
+        FINISH_ARCHIVE(packageFileName, archive);
       }
       // add the generated package to package file names list
       packageFileNames.push_back(packageFileName);
@@ -158,6 +187,7 @@ int cmCPackArchiveGenerator::PackageComponents(bool ignoreGroup)
           DECLARE_AND_OPEN_ARCHIVE(packageFileName, archive);
           // Add the files of this component to the archive
           addOneComponentToArchive(archive, &(compIt->second));
+          FINISH_ARCHIVE(packageFileName, archive);
         }
         // add the generated package to package file names list
         packageFileNames.push_back(packageFileName);
@@ -182,6 +212,7 @@ int cmCPackArchiveGenerator::PackageComponents(bool ignoreGroup)
         DECLARE_AND_OPEN_ARCHIVE(packageFileName, archive);
         // Add the files of this component to the archive
         addOneComponentToArchive(archive, &(compIt->second));
+        FINISH_ARCHIVE(packageFileName, archive);
       }
       // add the generated package to package file names list
       packageFileNames.push_back(packageFileName);
@@ -212,7 +243,7 @@ int cmCPackArchiveGenerator::PackageComponentsAllInOne()
     addOneComponentToArchive(archive, &(compIt->second));
   }
 
-  // archive goes out of scope so it will finalized and closed.
+  FINISH_ARCHIVE(packageFileNames[0], archive);
   return 1;
 }
 
@@ -255,7 +286,7 @@ int cmCPackArchiveGenerator::PackageFiles()
     }
   }
   cmSystemTools::ChangeDirectory(dir);
-  // The destructor of cmArchiveWrite will close and finish the write
+  FINISH_ARCHIVE(packageFileNames[0], archive);
   return 1;
 }
 
@@ -67,6 +67,11 @@ protected:
    * components will be put in a single installer.
    */
   int PackageComponentsAllInOne();
+  /**
+   * The number of threads used to compress the archive,
+   * from CPACK_ARCHIVE_THREADS.
+   */
+  int GetThreadCount();
   virtual const char* GetOutputExtension() = 0;
   cmArchiveWrite::Compress Compress;
   std::string ArchiveFormat;
@@ -487,6 +487,13 @@ int cmCPackDebGenerator::createDeb()
         return 0;
       }
     }
+    if (!data_tar.Finish()) {
+      cmCPackLogger(cmCPackLog::LOG_ERROR, "Error writing the tar:"
+                      << std::endl
+                      << "#file: " << filename_data_tar << std::endl
+                      << "#error:" << data_tar.GetError() << std::endl);
+      return 0;
+    }
   } // scope for file generation
 
   std::string md5filename = strGenWDIR + "/md5sums";
@@ -648,6 +655,14 @@ int cmCPackDebGenerator::createDeb()
         }
       }
     }
+
+    if (!control_tar.Finish()) {
+      cmCPackLogger(cmCPackLog::LOG_ERROR, "Error writing the tar:"
+                      << std::endl
+                      << "#file: " << filename_control_tar << std::endl
+                      << "#error:" << control_tar.GetError() << std::endl);
+      return 0;
+    }
   }
 
   // ar -r your-package-name.deb debian-binary control.tar.* data.tar.*
@@ -198,11 +198,7 @@ void cmCTestBuildHandler::Initialize()
   this->ReallyCustomWarningMatches.clear();
   this->ReallyCustomWarningExceptions.clear();
   this->ErrorWarningFileLineRegex.clear();
-
-  this->ErrorMatchRegex.clear();
-  this->ErrorExceptionRegex.clear();
-  this->WarningMatchRegex.clear();
-  this->WarningExceptionRegex.clear();
+  this->LineMatchers.Clear();
   this->BuildProcessingQueue.clear();
   this->BuildProcessingErrorQueue.clear();
   this->BuildOutputLogSize = 0;
@@ -307,13 +303,14 @@ int cmCTestBuildHandler::ProcessHandler()
   int entry;
   for (entry = 0; cmCTestWarningErrorFileLine[entry].RegularExpressionString;
        ++entry) {
+    // Keep one entry per expression so indexes match those in LineMatchers.
     cmCTestBuildHandler::cmCTestCompileErrorWarningRex r;
-    if (r.RegularExpression.compile(
+    r.FileIndex = cmCTestWarningErrorFileLine[entry].FileIndex;
+    r.LineIndex = cmCTestWarningErrorFileLine[entry].LineIndex;
+    this->ErrorWarningFileLineRegex.push_back(r);
+    if (!this->LineMatchers.Add(
+          FileLineList,
           cmCTestWarningErrorFileLine[entry].RegularExpressionString)) {
-      r.FileIndex = cmCTestWarningErrorFileLine[entry].FileIndex;
-      r.LineIndex = cmCTestWarningErrorFileLine[entry].LineIndex;
-      this->ErrorWarningFileLineRegex.push_back(r);
-    } else {
       cmCTestLog(
         this->CTest, ERROR_MESSAGE, "Problem Compiling regular expression: "
           << cmCTestWarningErrorFileLine[entry].RegularExpressionString
@@ -371,24 +368,23 @@ int cmCTestBuildHandler::ProcessHandler()
   // Pre-compile regular expressions objects for all regular expressions
   std::vector<std::string>::iterator it;
 
-#define cmCTestBuildHandlerPopulateRegexVector(strings, regexes)              \
-  regexes.clear();                                                            \
+#define cmCTestBuildHandlerPopulateRegexVector(strings, list)                 \
   cmCTestOptionalLog(this->CTest, DEBUG,                                      \
-                     this << "Add " #regexes << std::endl, this->Quiet);      \
+                     this << "Add " #list << std::endl, this->Quiet);         \
   for (it = strings.begin(); it != strings.end(); ++it) {                     \
     cmCTestOptionalLog(this->CTest, DEBUG,                                    \
                        "Add " #strings ": " << *it << std::endl,              \
                        this->Quiet);                                          \
-    regexes.push_back(it->c_str());                                           \
+    this->LineMatchers.Add(list, *it);                                        \
   }
   cmCTestBuildHandlerPopulateRegexVector(this->CustomErrorMatches,
-                                         this->ErrorMatchRegex);
+                                         ErrorMatchList);
   cmCTestBuildHandlerPopulateRegexVector(this->CustomErrorExceptions,
-                                         this->ErrorExceptionRegex);
+                                         ErrorExceptionList);
   cmCTestBuildHandlerPopulateRegexVector(this->CustomWarningMatches,
-                                         this->WarningMatchRegex);
+                                         WarningMatchList);
   cmCTestBuildHandlerPopulateRegexVector(this->CustomWarningExceptions,
-                                         this->WarningExceptionRegex);
+                                         WarningExceptionList);
 
   // Determine source and binary tree substitutions to simplify the output.
   this->SimplifySourceDir = "";
@@ -606,30 +602,30 @@ void cmCTestBuildHandler::GenerateXMLLogScraped(cmXMLWriter& xml)
       xml.StartElement(cm->Error ? "Error" : "Warning");
       xml.Element("BuildLogLine", cm->LogLine);
       xml.Element("Text", cm->Text);
-      std::vector<cmCTestCompileErrorWarningRex>::iterator rit;
-      for (rit = this->ErrorWarningFileLineRegex.begin();
-           rit != this->ErrorWarningFileLineRegex.end(); ++rit) {
-        cmsys::RegularExpression* re = &rit->RegularExpression;
-        if (re->find(cm->Text.c_str())) {
-          cm->SourceFile = re->match(rit->FileIndex);
-          // At this point we need to make this->SourceFile relative to
-          // the source root of the project, so cvs links will work
-          cmSystemTools::ConvertToUnixSlashes(cm->SourceFile);
-          if (cm->SourceFile.find("/.../") != cm->SourceFile.npos) {
-            cmSystemTools::ReplaceString(cm->SourceFile, "/.../", "");
-            std::string::size_type p = cm->SourceFile.find('/');
-            if (p != cm->SourceFile.npos) {
-              cm->SourceFile =
-                cm->SourceFile.substr(p + 1, cm->SourceFile.size() - p);
-            }
-          } else {
-            // make sure it is a full path with the correct case
-            cm->SourceFile = cmSystemTools::CollapseFullPath(cm->SourceFile);
-            cmSystemTools::ReplaceString(cm->SourceFile, srcdir.c_str(), "");
+      this->LineMatchers.SetLine(cm->Text.c_str());
+      int index = this->LineMatchers.Find(FileLineList);
+      if (index >= 0) {
+        cmCTestCompileErrorWarningRex* rit =
+          &this->ErrorWarningFileLineRegex[static_cast<size_t>(index)];
+        cmsys::RegularExpression* re = &this->LineMatchers.GetRegex(
+          FileLineList, static_cast<size_t>(index));
+        cm->SourceFile = re->match(rit->FileIndex);
+        // At this point we need to make this->SourceFile relative to
+        // the source root of the project, so cvs links will work
+        cmSystemTools::ConvertToUnixSlashes(cm->SourceFile);
+        if (cm->SourceFile.find("/.../") != cm->SourceFile.npos) {
+          cmSystemTools::ReplaceString(cm->SourceFile, "/.../", "");
+          std::string::size_type p = cm->SourceFile.find('/');
+          if (p != cm->SourceFile.npos) {
+            cm->SourceFile =
+              cm->SourceFile.substr(p + 1, cm->SourceFile.size() - p);
           }
-          cm->LineNumber = atoi(re->match(rit->LineIndex).c_str());
-          break;
+        } else {
+          // make sure it is a full path with the correct case
+          cm->SourceFile = cmSystemTools::CollapseFullPath(cm->SourceFile);
+          cmSystemTools::ReplaceString(cm->SourceFile, srcdir.c_str(), "");
         }
+        cm->LineNumber = atoi(re->match(rit->LineIndex).c_str());
       }
       if (!cm->SourceFile.empty() && cm->LineNumber >= 0) {
         if (!cm->SourceFile.empty()) {
@@ -1085,76 +1081,56 @@ int cmCTestBuildHandler::ProcessSingleLine(const char* data)
   cmCTestOptionalLog(this->CTest, DEBUG, "Line: [" << data << "]" << std::endl,
                      this->Quiet);
 
-  std::vector<cmsys::RegularExpression>::iterator it;
-
   int warningLine = 0;
   int errorLine = 0;
 
-  // Check for regular expressions
+  // Check for regular expressions.  A single pass over the line finds the
+  // literal strings the expressions require, so only candidates are run.
+  this->LineMatchers.SetLine(data);
 
   if (!this->ErrorQuotaReached) {
     // Errors
-    int wrxCnt = 0;
-    for (it = this->ErrorMatchRegex.begin(); it != this->ErrorMatchRegex.end();
-         ++it) {
-      if (it->find(data)) {
-        errorLine = 1;
-        cmCTestOptionalLog(this->CTest, DEBUG,
-                           "  Error Line: " << data << " (matches: "
-                                            << this->CustomErrorMatches[wrxCnt]
-                                            << ")" << std::endl,
-                           this->Quiet);
-        break;
-      }
-      wrxCnt++;
+    int wrxCnt = this->LineMatchers.Find(ErrorMatchList);
+    if (wrxCnt >= 0) {
+      errorLine = 1;
+      cmCTestOptionalLog(this->CTest, DEBUG,
+                         "  Error Line: " << data << " (matches: "
+                                          << this->CustomErrorMatches[wrxCnt]
+                                          << ")" << std::endl,
+                         this->Quiet);
     }
     // Error exceptions
-    wrxCnt = 0;
-    for (it = this->ErrorExceptionRegex.begin();
-         it != this->ErrorExceptionRegex.end(); ++it) {
-      if (it->find(data)) {
-        errorLine = 0;
-        cmCTestOptionalLog(this->CTest, DEBUG, "  Not an error Line: "
-                             << data << " (matches: "
-                             << this->CustomErrorExceptions[wrxCnt] << ")"
-                             << std::endl,
-                           this->Quiet);
-        break;
-      }
-      wrxCnt++;
+    wrxCnt = this->LineMatchers.Find(ErrorExceptionList);
+    if (wrxCnt >= 0) {
+      errorLine = 0;
+      cmCTestOptionalLog(this->CTest, DEBUG, "  Not an error Line: "
+                           << data << " (matches: "
+                           << this->CustomErrorExceptions[wrxCnt] << ")"
+                           << std::endl,
+                         this->Quiet);
     }
   }
   if (!this->WarningQuotaReached) {
     // Warnings
-    int wrxCnt = 0;
-    for (it = this->WarningMatchRegex.begin();
-         it != this->WarningMatchRegex.end(); ++it) {
-      if (it->find(data)) {
-        warningLine = 1;
-        cmCTestOptionalLog(this->CTest, DEBUG, "  Warning Line: "
-                             << data << " (matches: "
-                             << this->CustomWarningMatches[wrxCnt] << ")"
-                             << std::endl,
-                           this->Quiet);
-        break;
-      }
-      wrxCnt++;
+    int wrxCnt = this->LineMatchers.Find(WarningMatchList);
+    if (wrxCnt >= 0) {
+      warningLine = 1;
+      cmCTestOptionalLog(this->CTest, DEBUG, "  Warning Line: "
+                           << data << " (matches: "
+                           << this->CustomWarningMatches[wrxCnt] << ")"
+                           << std::endl,
+                         this->Quiet);
     }
 
-    wrxCnt = 0;
     // Warning exceptions
-    for (it = this->WarningExceptionRegex.begin();
-         it != this->WarningExceptionRegex.end(); ++it) {
-      if (it->find(data)) {
-        warningLine = 0;
-        cmCTestOptionalLog(this->CTest, DEBUG, "  Not a warning Line: "
-                             << data << " (matches: "
-                             << this->CustomWarningExceptions[wrxCnt] << ")"
-                             << std::endl,
-                           this->Quiet);
-        break;
-      }
-      wrxCnt++;
+    wrxCnt = this->LineMatchers.Find(WarningExceptionList);
+    if (wrxCnt >= 0) {
+      warningLine = 0;
+      cmCTestOptionalLog(this->CTest, DEBUG, "  Not a warning Line: "
+                           << data << " (matches: "
+                           << this->CustomWarningExceptions[wrxCnt] << ")"
+                           << std::endl,
+                         this->Quiet);
     }
   }
   if (errorLine) {
@@ -15,6 +15,7 @@
 
 #include "cmCTestGenericHandler.h"
 
+#include "cmCTestRegexSet.h"
 #include "cmListFileCache.h"
 
 #include <cmsys/RegularExpression.hxx>
@@ -71,7 +72,16 @@ private:
     cmCTestCompileErrorWarningRex() {}
     int FileIndex;
     int LineIndex;
-    cmsys::RegularExpression RegularExpression;
+  };
+
+  // Lists of expressions in LineMatchers.
+  enum
+  {
+    ErrorMatchList,
+    ErrorExceptionList,
+    WarningMatchList,
+    WarningExceptionList,
+    FileLineList
   };
 
   struct cmCTestBuildErrorWarning
@@ -107,10 +117,7 @@ private:
   std::vector<std::string> ReallyCustomWarningExceptions;
   std::vector<cmCTestCompileErrorWarningRex> ErrorWarningFileLineRegex;
 
-  std::vector<cmsys::RegularExpression> ErrorMatchRegex;
-  std::vector<cmsys::RegularExpression> ErrorExceptionRegex;
-  std::vector<cmsys::RegularExpression> WarningMatchRegex;
-  std::vector<cmsys::RegularExpression> WarningExceptionRegex;
+  cmCTestRegexSet LineMatchers;
 
   typedef std::deque<char> t_BuildProcessingQueueType;
 
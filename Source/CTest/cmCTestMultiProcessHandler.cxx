@@ -19,7 +19,6 @@
 #include <cmsys/FStream.hxx>
 #include <cmsys/SystemInformation.hxx>
 #include <float.h>
-#include <list>
 #include <math.h>
 #include <stack>
 #include <stdlib.h>
@@ -44,6 +43,25 @@ private:
   cmCTestMultiProcessHandler* Handler;
 };
 
+class CriticalPathComparator
+{
+public:
+  CriticalPathComparator(std::map<int, double> const& lengths)
+    : Lengths(lengths)
+  {
+  }
+
+  // Sorts tests in descending order of critical path length
+  bool operator()(int index1, int index2) const
+  {
+    return this->Lengths.find(index1)->second >
+      this->Lengths.find(index2)->second;
+  }
+
+private:
+  std::map<int, double> const& Lengths;
+};
+
 cmCTestMultiProcessHandler::cmCTestMultiProcessHandler()
 {
   this->ParallelLevel = 1;
@@ -53,6 +71,7 @@ cmCTestMultiProcessHandler::cmCTestMultiProcessHandler()
   this->StopTimePassed = false;
   this->HasCycles = false;
   this->SerialTestRunning = false;
+  this->CriticalPathTime = 0;
 }
 
 cmCTestMultiProcessHandler::~cmCTestMultiProcessHandler()
@@ -71,6 +90,14 @@ void cmCTestMultiProcessHandler::SetTests(TestMap& tests,
        ++i) {
     this->TestRunningMap[i->first] = false;
     this->TestFinishMap[i->first] = false;
+    for (TestSet::const_iterator d = i->second.begin(); d != i->second.end();
+         ++d) {
+      this->Dependents[*d].insert(i->first);
+    }
+  }
+  for (PropertiesMap::iterator i = this->Properties.begin();
+       i != this->Properties.end(); ++i) {
+    this->TestsByName[i->second->Name] = i->first;
   }
   if (!this->CTest->GetShowOnly()) {
     this->ReadCostData();
@@ -93,6 +120,12 @@ void cmCTestMultiProcessHandler::SetTestLoad(unsigned long load)
   this->TestLoad = load;
 }
 
+void cmCTestMultiProcessHandler::SetResourceCapacities(
+  std::map<std::string, unsigned long> const& capacities)
+{
+  this->ResourceCapacities = capacities;
+}
+
 void cmCTestMultiProcessHandler::RunTests()
 {
   this->CheckResume();
@@ -100,6 +133,9 @@ void cmCTestMultiProcessHandler::RunTests()
     return;
   }
   this->TestHandler->SetMaxIndex(this->FindMaxIndex());
+  bool criticalPath = this->CTest->GetScheduleType() == "CriticalPath";
+  double predictedTime = criticalPath ? this->PredictTestTime() : 0;
+  double startTime = cmSystemTools::GetTime();
   this->StartNextTests();
   while (!this->Tests.empty()) {
     if (this->StopTimePassed) {
@@ -113,6 +149,16 @@ void cmCTestMultiProcessHandler::RunTests()
   }
   this->MarkFinished();
   this->UpdateCostData();
+
+  if (criticalPath) {
+    char buf[1024];
+    sprintf(buf, "\nCritical path test time = %6.2f sec\n"
+                 "Predicted test time (real) = %6.2f sec\n"
+                 "Actual test time (real) = %6.2f sec\n",
+            this->CriticalPathTime, predictedTime,
+            cmSystemTools::GetTime() - startTime);
+    cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT, buf, this->Quiet);
+  }
 }
 
 void cmCTestMultiProcessHandler::StartTestProcess(int test)
@@ -145,17 +191,8 @@ void cmCTestMultiProcessHandler::StartTestProcess(int test)
     delete testRun;
     return;
   } else {
-
-    for (TestMap::iterator j = this->Tests.begin(); j != this->Tests.end();
-         ++j) {
-      j->second.erase(test);
-    }
-
-    this->UnlockResources(test);
+    this->FinishTestProcess(test);
     this->Completed++;
-    this->TestFinishMap[test] = true;
-    this->TestRunningMap[test] = false;
-    this->RunningCount -= GetProcessorsUsed(test);
     testRun->EndTest(this->Completed, this->Total, false);
     this->Failed->push_back(this->Properties[test]->Name);
     delete testRun;
@@ -163,11 +200,62 @@ void cmCTestMultiProcessHandler::StartTestProcess(int test)
   cmSystemTools::ChangeDirectory(current_dir);
 }
 
+void cmCTestMultiProcessHandler::FinishTestProcess(int test)
+{
+  this->ReleaseDependents(test);
+  this->UnlockResources(test);
+  this->TestFinishMap[test] = true;
+  this->TestRunningMap[test] = false;
+  this->RunningCount -= GetProcessorsUsed(test);
+}
+
+void cmCTestMultiProcessHandler::ReleaseDependents(int test)
+{
+  TestMap::const_iterator dependents = this->Dependents.find(test);
+  if (dependents != this->Dependents.end()) {
+    for (TestSet::const_iterator i = dependents->second.begin();
+         i != dependents->second.end(); ++i) {
+      TestMap::iterator t = this->Tests.find(*i);
+      if (t != this->Tests.end() && t->second.erase(test) &&
+          t->second.empty()) {
+        this->ReadyTests.push(this->SortedTestPositions[*i]);
+      }
+    }
+  }
+}
+
+bool cmCTestMultiProcessHandler::ResourceAmountsFit(
+  int index, ResourceAmountMap const& used)
+{
+  ResourceAmountMap const& amounts = this->Properties[index]->ResourceAmounts;
+  for (ResourceAmountMap::const_iterator i = amounts.begin();
+       i != amounts.end(); ++i) {
+    ResourceAmountMap::const_iterator capacity =
+      this->ResourceCapacities.find(i->first);
+    ResourceAmountMap::const_iterator inUse = used.find(i->first);
+    if (capacity == this->ResourceCapacities.end() || inUse == used.end() ||
+        inUse->second == 0) {
+      // Pools without a capacity are unlimited, and a test that needs
+      // more than the whole pool may still run while the pool is unused.
+      continue;
+    }
+    if (inUse->second + i->second > capacity->second) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void cmCTestMultiProcessHandler::LockResources(int index)
 {
   this->LockedResources.insert(
     this->Properties[index]->LockedResources.begin(),
     this->Properties[index]->LockedResources.end());
+  ResourceAmountMap const& amounts = this->Properties[index]->ResourceAmounts;
+  for (ResourceAmountMap::const_iterator i = amounts.begin();
+       i != amounts.end(); ++i) {
+    this->ResourcesUsed[i->first] += i->second;
+  }
 
   if (this->Properties[index]->RunSerial) {
     this->SerialTestRunning = true;
@@ -181,6 +269,11 @@ void cmCTestMultiProcessHandler::UnlockResources(int index)
        i != this->Properties[index]->LockedResources.end(); ++i) {
     this->LockedResources.erase(*i);
   }
+  ResourceAmountMap const& amounts = this->Properties[index]->ResourceAmounts;
+  for (ResourceAmountMap::const_iterator i = amounts.begin();
+       i != amounts.end(); ++i) {
+    this->ResourcesUsed[i->first] -= i->second;
+  }
   if (this->Properties[index]->RunSerial) {
     this->SerialTestRunning = false;
   }
@@ -189,11 +282,9 @@ void cmCTestMultiProcessHandler::UnlockResources(int index)
 void cmCTestMultiProcessHandler::EraseTest(int test)
 {
   this->Tests.erase(test);
-  this->SortedTests.erase(
-    std::find(this->SortedTests.begin(), this->SortedTests.end(), test));
 }
 
-inline size_t cmCTestMultiProcessHandler::GetProcessorsUsed(int test)
+size_t cmCTestMultiProcessHandler::GetProcessorsUsed(int test)
 {
   size_t processors = static_cast<int>(this->Properties[test]->Processors);
   // If processors setting is set higher than the -j
@@ -220,6 +311,11 @@ bool cmCTestMultiProcessHandler::StartTest(int test)
     }
   }
 
+  // Check for enough of each counted resource
+  if (!this->ResourceAmountsFit(test, this->ResourcesUsed)) {
+    return false;
+  }
+
   // if there are no depends left then run this test
   if (this->Tests[test].empty()) {
     this->StartTestProcess(test);
@@ -252,8 +348,6 @@ void cmCTestMultiProcessHandler::StartNextTests()
   size_t minProcessorsRequired = this->ParallelLevel;
   std::string testWithMinProcessors = "";
 
-  cmsys::SystemInformation info;
-
   unsigned long systemLoad = 0;
   size_t spareLoad = 0;
   if (this->TestLoad > 0) {
@@ -271,6 +365,7 @@ void cmCTestMultiProcessHandler::StartNextTests()
     }
     // If it's not set, look up the true load average.
     else {
+      cmsys::SystemInformation info;
       systemLoad = static_cast<unsigned long>(ceil(info.GetLoadAverage()));
     }
     spareLoad =
@@ -282,23 +377,33 @@ void cmCTestMultiProcessHandler::StartNextTests()
     }
   }
 
-  TestList copy = this->SortedTests;
-  for (TestList::iterator test = copy.begin(); test != copy.end(); ++test) {
+  // Try the tests whose dependencies have finished in order.  Tests that
+  // cannot start now are queued again for the next round.
+  std::vector<size_t> deferred;
+  while (!this->ReadyTests.empty()) {
     // Take a nap if we're currently performing a RUN_SERIAL test.
     if (this->SerialTestRunning) {
       break;
     }
+    size_t position = this->ReadyTests.top();
+    this->ReadyTests.pop();
+    int test = this->SortedTests[position];
+    if (this->Tests.find(test) == this->Tests.end()) {
+      // The test was started or removed already.
+      continue;
+    }
     // We can only start a RUN_SERIAL test if no other tests are also running.
-    if (this->Properties[*test]->RunSerial && this->RunningCount > 0) {
+    if (this->Properties[test]->RunSerial && this->RunningCount > 0) {
+      deferred.push_back(position);
       continue;
     }
 
-    size_t processors = GetProcessorsUsed(*test);
+    size_t processors = GetProcessorsUsed(test);
     bool testLoadOk = true;
     if (this->TestLoad > 0) {
       if (processors <= spareLoad) {
         cmCTestLog(this->CTest, DEBUG, "OK to run "
-                     << GetName(*test) << ", it requires " << processors
+                     << GetName(test) << ", it requires " << processors
                      << " procs & system load is: " << systemLoad
                      << std::endl);
         allTestsFailedTestLoadCheck = false;
@@ -309,19 +414,29 @@ void cmCTestMultiProcessHandler::StartNextTests()
 
     if (processors <= minProcessorsRequired) {
       minProcessorsRequired = processors;
-      testWithMinProcessors = GetName(*test);
+      testWithMinProcessors = GetName(test);
     }
 
-    if (testLoadOk && processors <= numToStart && this->StartTest(*test)) {
+    if (testLoadOk && processors <= numToStart && this->StartTest(test)) {
       if (this->StopTimePassed) {
-        return;
+        break;
       }
 
       numToStart -= processors;
-    } else if (numToStart == 0) {
-      break;
+    } else {
+      deferred.push_back(position);
+      if (numToStart == 0) {
+        break;
+      }
     }
   }
+  for (std::vector<size_t>::const_iterator i = deferred.begin();
+       i != deferred.end(); ++i) {
+    this->ReadyTests.push(*i);
+  }
+  if (this->StopTimePassed) {
+    return;
+  }
 
   if (allTestsFailedTestLoadCheck) {
     cmCTestLog(this->CTest, HANDLER_OUTPUT, "***** WAITING, ");
@@ -383,16 +498,9 @@ bool cmCTestMultiProcessHandler::CheckOutput()
     } else {
       this->Failed->push_back(p->GetTestProperties()->Name);
     }
-    for (TestMap::iterator j = this->Tests.begin(); j != this->Tests.end();
-         ++j) {
-      j->second.erase(test);
-    }
-    this->TestFinishMap[test] = true;
-    this->TestRunningMap[test] = false;
+    this->FinishTestProcess(test);
     this->RunningTests.erase(p);
     this->WriteCheckpoint(test);
-    this->UnlockResources(test);
-    this->RunningCount -= GetProcessorsUsed(test);
     delete p;
   }
   return true;
@@ -429,11 +537,16 @@ void cmCTestMultiProcessHandler::UpdateCostData()
       int index = this->SearchByName(name);
       if (index == -1) {
         // This test is not in memory. We just rewrite the entry
-        fout << name << " " << prev << " " << cost << "\n";
+        fout << name << " " << prev << " " << cost;
+        if (parts.size() > 3) {
+          fout << " " << parts[3];
+        }
+        fout << "\n";
       } else {
         // Update with our new average cost
         fout << name << " " << this->Properties[index]->PreviousRuns << " "
-             << this->Properties[index]->Cost << "\n";
+             << this->Properties[index]->Cost << " "
+             << this->Properties[index]->RecentCost << "\n";
         temp.erase(index);
       }
     }
@@ -444,7 +557,7 @@ void cmCTestMultiProcessHandler::UpdateCostData()
   // Add all tests not previously listed in the file
   for (PropertiesMap::iterator i = temp.begin(); i != temp.end(); ++i) {
     fout << i->second->Name << " " << i->second->PreviousRuns << " "
-         << i->second->Cost << "\n";
+         << i->second->Cost << " " << i->second->RecentCost << "\n";
   }
 
   // Write list of failed tests
@@ -481,6 +594,11 @@ void cmCTestMultiProcessHandler::ReadCostData()
       std::string name = parts[0];
       int prev = atoi(parts[1].c_str());
       float cost = static_cast<float>(atof(parts[2].c_str()));
+      // Files written before the weighted recent cost was recorded
+      // only have the average.
+      float recent = parts.size() > 3
+        ? static_cast<float>(atof(parts[3].c_str()))
+        : cost;
 
       int index = this->SearchByName(name);
       if (index == -1) {
@@ -488,6 +606,7 @@ void cmCTestMultiProcessHandler::ReadCostData()
       }
 
       this->Properties[index]->PreviousRuns = prev;
+      this->Properties[index]->RecentCost = recent;
       // When not running in parallel mode, don't use cost data
       if (this->ParallelLevel > 1 && this->Properties[index] &&
           this->Properties[index]->Cost == 0) {
@@ -497,7 +616,7 @@ void cmCTestMultiProcessHandler::ReadCostData()
     // Next part of the file is the failed tests
     while (std::getline(fin, line)) {
       if (line != "") {
-        this->LastTestsFailed.push_back(line);
+        this->LastTestsFailed.insert(line);
       }
     }
     fin.close();
@@ -506,83 +625,94 @@ void cmCTestMultiProcessHandler::ReadCostData()
 
 int cmCTestMultiProcessHandler::SearchByName(std::string const& name)
 {
-  int index = -1;
-
-  for (PropertiesMap::iterator i = this->Properties.begin();
-       i != this->Properties.end(); ++i) {
-    if (i->second->Name == name) {
-      index = i->first;
-    }
-  }
-  return index;
+  TestNameMap::const_iterator i = this->TestsByName.find(name);
+  return i == this->TestsByName.end() ? -1 : i->second;
 }
 
 void cmCTestMultiProcessHandler::CreateTestCostList()
 {
-  if (this->ParallelLevel > 1) {
+  if (this->CTest->GetScheduleType() == "CriticalPath") {
+    CreateCriticalPathTestCostList();
+  } else if (this->ParallelLevel > 1) {
     CreateParallelTestCostList();
   } else {
     CreateSerialTestCostList();
   }
+  for (size_t i = 0; i < this->SortedTests.size(); ++i) {
+    this->SortedTestPositions[this->SortedTests[i]] = i;
+    if (this->Tests[this->SortedTests[i]].empty()) {
+      this->ReadyTests.push(i);
+    }
+  }
 }
 
 void cmCTestMultiProcessHandler::CreateParallelTestCostList()
 {
   TestSet alreadySortedTests;
 
-  std::list<TestSet> priorityStack;
-  priorityStack.push_back(TestSet());
-  TestSet& topLevel = priorityStack.back();
-
   // In parallel test runs add previously failed tests to the front
   // of the cost list and queue other tests for further sorting
   for (TestMap::const_iterator i = this->Tests.begin(); i != this->Tests.end();
        ++i) {
-    if (std::find(this->LastTestsFailed.begin(), this->LastTestsFailed.end(),
-                  this->Properties[i->first]->Name) !=
-        this->LastTestsFailed.end()) {
+    if (this->LastTestsFailed.count(this->Properties[i->first]->Name)) {
       // If the test failed last time, it should be run first.
       this->SortedTests.push_back(i->first);
       alreadySortedTests.insert(i->first);
-    } else {
-      topLevel.insert(i->first);
     }
   }
 
-  // In parallel test runs repeatedly move dependencies of the tests on
-  // the current dependency level to the next level until no
-  // further dependencies exist.
-  while (priorityStack.back().size()) {
-    TestSet& previousSet = priorityStack.back();
-    priorityStack.push_back(TestSet());
-    TestSet& currentSet = priorityStack.back();
-
-    for (TestSet::const_iterator i = previousSet.begin();
-         i != previousSet.end(); ++i) {
-      TestSet const& dependencies = this->Tests[*i];
-      currentSet.insert(dependencies.begin(), dependencies.end());
+  // In parallel test runs place each test one dependency level deeper
+  // than the deepest test depending on it.  Previously failed tests are
+  // only on a level if another test depending on them is.  Tests are
+  // visited after all tests depending on them.
+  std::map<int, int> levels;
+  std::map<int, size_t> waiting;
+  std::vector<int> visit;
+  for (TestMap::const_iterator i = this->Tests.begin(); i != this->Tests.end();
+       ++i) {
+    levels[i->first] = alreadySortedTests.count(i->first) ? -1 : 0;
+    TestMap::const_iterator dependents = this->Dependents.find(i->first);
+    waiting[i->first] =
+      dependents == this->Dependents.end() ? 0 : dependents->second.size();
+    if (waiting[i->first] == 0) {
+      visit.push_back(i->first);
     }
-
-    for (TestSet::const_iterator i = currentSet.begin(); i != currentSet.end();
-         ++i) {
-      previousSet.erase(*i);
+  }
+  int maxLevel = 0;
+  while (!visit.empty()) {
+    int test = visit.back();
+    visit.pop_back();
+    int level = levels[test];
+    if (level > maxLevel) {
+      maxLevel = level;
+    }
+    TestSet const& dependencies = this->Tests[test];
+    for (TestSet::const_iterator i = dependencies.begin();
+         i != dependencies.end(); ++i) {
+      if (level >= 0 && levels[*i] <= level) {
+        levels[*i] = level + 1;
+      }
+      if (--waiting[*i] == 0) {
+        visit.push_back(*i);
+      }
     }
   }
 
-  // Remove the empty dependency level
-  priorityStack.pop_back();
+  std::vector<TestList> priorityStack(maxLevel + 1);
+  for (std::map<int, int>::const_iterator i = levels.begin();
+       i != levels.end(); ++i) {
+    if (i->second >= 0) {
+      priorityStack[i->second].push_back(i->first);
+    }
+  }
 
   // Reverse iterate over the different dependency levels (deepest first).
   // Sort tests within each level by COST and append them to the cost list.
-  for (std::list<TestSet>::reverse_iterator i = priorityStack.rbegin();
+  for (std::vector<TestList>::reverse_iterator i = priorityStack.rbegin();
        i != priorityStack.rend(); ++i) {
-    TestSet const& currentSet = *i;
+    TestList& sortedCopy = *i;
     TestComparator comp(this);
 
-    TestList sortedCopy;
-
-    sortedCopy.insert(sortedCopy.end(), currentSet.begin(), currentSet.end());
-
     std::stable_sort(sortedCopy.begin(), sortedCopy.end(), comp);
 
     for (TestList::const_iterator j = sortedCopy.begin();
@@ -595,14 +725,157 @@ void cmCTestMultiProcessHandler::CreateParallelTestCostList()
   }
 }
 
+void cmCTestMultiProcessHandler::CreateCriticalPathTestCostList()
+{
+  // Expect tests to take as long as they did recently, or their COST.
+  std::map<int, double> lengths;
+  std::map<int, size_t> waiting;
+  std::vector<int> visit;
+  for (TestMap::const_iterator i = this->Tests.begin(); i != this->Tests.end();
+       ++i) {
+    cmCTestTestHandler::cmCTestTestProperties* p = this->Properties[i->first];
+    double expected = p->RecentCost > 0 ? p->RecentCost : p->Cost;
+    this->ExpectedTimes[i->first] = expected > 0 ? expected : 0;
+    lengths[i->first] = 0;
+    TestMap::const_iterator dependents = this->Dependents.find(i->first);
+    waiting[i->first] =
+      dependents == this->Dependents.end() ? 0 : dependents->second.size();
+    if (waiting[i->first] == 0) {
+      visit.push_back(i->first);
+    }
+  }
+
+  // The critical path of a test is its own time plus the longest critical
+  // path of the tests depending on it.  Tests are visited after all tests
+  // depending on them.
+  while (!visit.empty()) {
+    int test = visit.back();
+    visit.pop_back();
+    double length = lengths[test] + this->ExpectedTimes[test];
+    lengths[test] = length;
+    if (length > this->CriticalPathTime) {
+      this->CriticalPathTime = length;
+    }
+    TestSet const& dependencies = this->Tests[test];
+    for (TestSet::const_iterator i = dependencies.begin();
+         i != dependencies.end(); ++i) {
+      if (lengths[*i] < length) {
+        lengths[*i] = length;
+      }
+      if (--waiting[*i] == 0) {
+        visit.push_back(*i);
+      }
+    }
+  }
+
+  for (TestMap::const_iterator i = this->Tests.begin(); i != this->Tests.end();
+       ++i) {
+    this->SortedTests.push_back(i->first);
+  }
+  CriticalPathComparator comp(lengths);
+  std::stable_sort(this->SortedTests.begin(), this->SortedTests.end(), comp);
+}
+
+double cmCTestMultiProcessHandler::PredictTestTime()
+{
+  // Replay the schedule of the remaining tests with their expected times.
+  typedef std::pair<double, int> TestEnd;
+  std::priority_queue<TestEnd, std::vector<TestEnd>, std::greater<TestEnd> >
+    running;
+  std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t> >
+    ready = this->ReadyTests;
+  TestMap waiting = this->Tests;
+  std::set<std::string> locked;
+  ResourceAmountMap used;
+  size_t freeProcessors = this->ParallelLevel;
+  bool serial = false;
+  double now = 0;
+  for (;;) {
+    std::vector<size_t> deferred;
+    while (!serial && !ready.empty()) {
+      size_t position = ready.top();
+      ready.pop();
+      int test = this->SortedTests[position];
+      TestMap::iterator w = waiting.find(test);
+      if (w == waiting.end()) {
+        continue;
+      }
+      cmCTestTestHandler::cmCTestTestProperties* p = this->Properties[test];
+      size_t processors = this->GetProcessorsUsed(test);
+      bool canStart = processors <= freeProcessors &&
+        (!p->RunSerial || freeProcessors == this->ParallelLevel);
+      for (std::set<std::string>::const_iterator i =
+             p->LockedResources.begin();
+           canStart && i != p->LockedResources.end(); ++i) {
+        canStart = locked.find(*i) == locked.end();
+      }
+      if (canStart && !this->ResourceAmountsFit(test, used)) {
+        canStart = false;
+      }
+      if (!canStart) {
+        deferred.push_back(position);
+        continue;
+      }
+      waiting.erase(w);
+      freeProcessors -= processors;
+      locked.insert(p->LockedResources.begin(), p->LockedResources.end());
+      for (ResourceAmountMap::const_iterator i = p->ResourceAmounts.begin();
+           i != p->ResourceAmounts.end(); ++i) {
+        used[i->first] += i->second;
+      }
+      serial = p->RunSerial;
+      running.push(TestEnd(now + this->ExpectedTimes[test], test));
+    }
+    for (std::vector<size_t>::const_iterator i = deferred.begin();
+         i != deferred.end(); ++i) {
+      ready.push(*i);
+    }
+    if (running.empty()) {
+      break;
+    }
+
+    now = running.top().first;
+    int test = running.top().second;
+    running.pop();
+    cmCTestTestHandler::cmCTestTestProperties* p = this->Properties[test];
+    freeProcessors += this->GetProcessorsUsed(test);
+    for (std::set<std::string>::const_iterator i = p->LockedResources.begin();
+         i != p->LockedResources.end(); ++i) {
+      locked.erase(*i);
+    }
+    for (ResourceAmountMap::const_iterator i = p->ResourceAmounts.begin();
+         i != p->ResourceAmounts.end(); ++i) {
+      used[i->first] -= i->second;
+    }
+    if (p->RunSerial) {
+      serial = false;
+    }
+    TestMap::const_iterator dependents = this->Dependents.find(test);
+    if (dependents == this->Dependents.end()) {
+      continue;
+    }
+    for (TestSet::const_iterator i = dependents->second.begin();
+         i != dependents->second.end(); ++i) {
+      TestMap::iterator t = waiting.find(*i);
+      if (t != waiting.end() && t->second.erase(test) && t->second.empty()) {
+        ready.push(this->SortedTestPositions[*i]);
+      }
+    }
+  }
+  return now;
+}
+
 void cmCTestMultiProcessHandler::GetAllTestDependencies(int test,
-                                                        TestList& dependencies)
+                                                        TestList& dependencies,
+                                                        TestSet& visited)
 {
   TestSet const& dependencySet = this->Tests[test];
   for (TestSet::const_iterator i = dependencySet.begin();
        i != dependencySet.end(); ++i) {
-    GetAllTestDependencies(*i, dependencies);
-    dependencies.push_back(*i);
+    if (visited.insert(*i).second) {
+      GetAllTestDependencies(*i, dependencies, visited);
+      dependencies.push_back(*i);
+    }
   }
 }
 
@@ -628,19 +901,11 @@ void cmCTestMultiProcessHandler::CreateSerialTestCostList()
       continue;
     }
 
+    // The dependencies of sorted tests are sorted already.
     TestList dependencies;
-    GetAllTestDependencies(test, dependencies);
-
-    for (TestList::const_iterator j = dependencies.begin();
-         j != dependencies.end(); ++j) {
-      int testDependency = *j;
-
-      if (alreadySortedTests.find(testDependency) ==
-          alreadySortedTests.end()) {
-        alreadySortedTests.insert(testDependency);
-        this->SortedTests.push_back(testDependency);
-      }
-    }
+    GetAllTestDependencies(test, dependencies, alreadySortedTests);
+    this->SortedTests.insert(this->SortedTests.end(), dependencies.begin(),
+                             dependencies.end());
 
     alreadySortedTests.insert(test);
     this->SortedTests.push_back(test);
@@ -775,7 +1040,16 @@ void cmCTestMultiProcessHandler::CheckResume()
 
 void cmCTestMultiProcessHandler::RemoveTest(int index)
 {
+  if (this->Tests.find(index) == this->Tests.end()) {
+    return;
+  }
   this->EraseTest(index);
+  this->ReleaseDependents(index);
+  TestNameMap::iterator n =
+    this->TestsByName.find(this->Properties[index]->Name);
+  if (n != this->TestsByName.end() && n->second == index) {
+    this->TestsByName.erase(n);
+  }
   this->Properties.erase(index);
   this->TestRunningMap[index] = false;
   this->TestFinishMap[index] = true;
@@ -800,6 +1074,42 @@ bool cmCTestMultiProcessHandler::CheckCycles()
   cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                      "Checking test dependency graph..." << std::endl,
                      this->Quiet);
+
+  // Repeatedly take away tests whose dependencies have all been taken
+  // away.  Only if this does not reach every test is there a cycle to
+  // look for.
+  std::map<int, size_t> waiting;
+  std::vector<int> free;
+  for (TestMap::iterator it = this->Tests.begin(); it != this->Tests.end();
+       ++it) {
+    waiting[it->first] = it->second.size();
+    if (it->second.empty()) {
+      free.push_back(it->first);
+    }
+  }
+  size_t freed = 0;
+  while (!free.empty()) {
+    int test = free.back();
+    free.pop_back();
+    ++freed;
+    TestMap::const_iterator dependents = this->Dependents.find(test);
+    if (dependents == this->Dependents.end()) {
+      continue;
+    }
+    for (TestSet::const_iterator d = dependents->second.begin();
+         d != dependents->second.end(); ++d) {
+      if (--waiting[*d] == 0) {
+        free.push_back(*d);
+      }
+    }
+  }
+  if (freed == this->Tests.size()) {
+    cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                       "Checking test dependency graph end" << std::endl,
+                       this->Quiet);
+    return true;
+  }
+
   for (TestMap::iterator it = this->Tests.begin(); it != this->Tests.end();
        ++it) {
     // DFS from each element to itself
@@ -16,6 +16,15 @@
 
 #include <cmCTestRunTest.h>
 
+#ifdef CMake_HAVE_CXX11_UNORDERED_MAP
+#include <unordered_map>
+#else
+#include <cmsys/hash_map.hxx>
+#endif
+
+#include <functional>
+#include <queue>
+
 /** \class cmCTestMultiProcessHandler
  * \brief run parallel ctest
  *
@@ -39,6 +48,7 @@ public:
     : public std::map<int, cmCTestTestHandler::cmCTestTestProperties*>
   {
   };
+  typedef std::map<std::string, unsigned long> ResourceAmountMap;
 
   cmCTestMultiProcessHandler();
   virtual ~cmCTestMultiProcessHandler();
@@ -47,6 +57,9 @@ public:
   // Set the max number of tests that can be run at the same time.
   void SetParallelLevel(size_t);
   void SetTestLoad(unsigned long load);
+  // Set the capacity of each named pool of resources.  Tests are started
+  // only while the amounts they need from all pools fit.
+  void SetResourceCapacities(ResourceAmountMap const& capacities);
   virtual void RunTests();
   void PrintTestList();
   void PrintLabels();
@@ -76,8 +89,11 @@ protected:
   // Start the next test or tests as many as are allowed by
   // ParallelLevel
   void StartNextTests();
-  void StartTestProcess(int test);
+  virtual void StartTestProcess(int test);
   bool StartTest(int test);
+  // Account for a test that is done and queue the tests waiting for it
+  void FinishTestProcess(int test);
+  void ReleaseDependents(int test);
   // Mark the checkpoint for the given test
   void WriteCheckpoint(int index);
 
@@ -88,11 +104,18 @@ protected:
 
   void CreateTestCostList();
 
-  void GetAllTestDependencies(int test, TestList& dependencies);
+  void GetAllTestDependencies(int test, TestList& dependencies,
+                              TestSet& visited);
   void CreateSerialTestCostList();
 
   void CreateParallelTestCostList();
 
+  // Order tests by the expected time of the longest chain of tests
+  // depending on them
+  void CreateCriticalPathTestCostList();
+  // Return the expected time to run the remaining tests
+  double PredictTestTime();
+
   // Removes the checkpoint file
   void MarkFinished();
   void EraseTest(int index);
@@ -105,14 +128,35 @@ protected:
   // Check if there are any circular dependencies
   bool CheckCycles();
   int FindMaxIndex();
-  inline size_t GetProcessorsUsed(int index);
+  size_t GetProcessorsUsed(int index);
   std::string GetName(int index);
 
+  // Return true if the amounts of counted resources needed by a test fit
+  // next to the amounts already in use
+  bool ResourceAmountsFit(int index, ResourceAmountMap const& used);
   void LockResources(int index);
   void UnlockResources(int index);
-  // map from test number to set of depend tests
+  // map from test number to set of depend tests, for tests not started yet
   TestMap Tests;
+  // map from test number to set of tests depending on it
+  TestMap Dependents;
+  // all tests in the order in which they should be started
   TestList SortedTests;
+  // map from test number to its position in SortedTests
+  std::map<int, size_t> SortedTestPositions;
+  // positions in SortedTests of tests whose dependencies have finished
+  std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t> >
+    ReadyTests;
+#ifdef CMake_HAVE_CXX11_UNORDERED_MAP
+  typedef std::unordered_map<std::string, int> TestNameMap;
+#else
+  typedef cmsys::hash_map<std::string, int> TestNameMap;
+#endif
+  // map from test name to test number
+  TestNameMap TestsByName;
+  // expected run time of each test when ordering by critical path
+  std::map<int, double> ExpectedTimes;
+  double CriticalPathTime;
   // Total number of tests we'll be running
   size_t Total;
   // Number of tests that are complete
@@ -126,8 +170,10 @@ protected:
   std::map<int, std::string> TestOutput;
   std::vector<std::string>* Passed;
   std::vector<std::string>* Failed;
-  std::vector<std::string> LastTestsFailed;
+  std::set<std::string> LastTestsFailed;
   std::set<std::string> LockedResources;
+  ResourceAmountMap ResourceCapacities;
+  ResourceAmountMap ResourcesUsed;
   std::vector<cmCTestTestHandler::cmCTestTestResult>* TestResults;
   size_t ParallelLevel; // max number of process that can be run at once
   unsigned long TestLoad;
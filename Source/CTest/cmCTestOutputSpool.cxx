@@ -0,0 +1,207 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmCTestOutputSpool.h"
+
+#include "cmSystemTools.h"
+
+#include <cmsys/Encoding.hxx>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+cmCTestOutputSpool::cmCTestOutputSpool()
+{
+  this->Limit = 0;
+  this->Size = 0;
+  this->Spooled = false;
+  this->Truncated = false;
+  this->Text = 0;
+  this->Mapping = 0;
+}
+
+cmCTestOutputSpool::~cmCTestOutputSpool()
+{
+  this->Release();
+}
+
+void cmCTestOutputSpool::Reset(std::string const& file, size_t limit)
+{
+  this->Release();
+  this->File = file;
+  this->Limit = limit;
+}
+
+void cmCTestOutputSpool::Release()
+{
+  if (this->Mapping) {
+#if defined(_WIN32)
+    UnmapViewOfFile(this->Mapping);
+#else
+    munmap(this->Mapping, this->Size + 1);
+#endif
+    this->Mapping = 0;
+  }
+  this->Text = 0;
+  std::string().swap(this->Contents);
+  if (this->Stream.is_open()) {
+    this->Stream.close();
+  }
+  if (this->Spooled) {
+    cmSystemTools::RemoveFile(this->File);
+    this->Spooled = false;
+  }
+  std::string().swap(this->Head);
+  this->Size = 0;
+  this->Truncated = false;
+}
+
+void cmCTestOutputSpool::Truncate()
+{
+  // Keep what is in memory, which is the first limit bytes, rather than
+  // refer to a file that may be shorter than the output.
+  if (this->Stream.is_open()) {
+    this->Stream.close();
+  }
+  this->Stream.clear();
+  cmSystemTools::RemoveFile(this->File);
+  this->Spooled = false;
+  this->Truncated = true;
+  this->Head += "\n[The rest of the test output was lost because the "
+                "spool file could not be written.]\n";
+  this->Size = this->Head.size();
+}
+
+void cmCTestOutputSpool::Append(const char* text, size_t length)
+{
+  if (this->Truncated) {
+    return;
+  }
+  if (this->Spooled) {
+    this->Stream.write(text, length);
+    this->Size += length;
+    if (!this->Stream) {
+      this->Truncate();
+    }
+    return;
+  }
+  if (this->Limit == 0 || this->Size + length <= this->Limit) {
+    this->Head.append(text, length);
+    this->Size += length;
+    return;
+  }
+
+  // Move the output to the file and keep only its beginning in memory.
+  this->Stream.open(this->File.c_str(), std::ios::out | std::ios::binary);
+  if (!this->Stream) {
+    // Without a file all output stays in memory.
+    this->Stream.clear();
+    this->Limit = 0;
+    this->Head.append(text, length);
+    this->Size += length;
+    return;
+  }
+  this->Spooled = true;
+  this->Stream.write(this->Head.data(), this->Head.size());
+  this->Stream.write(text, length);
+  this->Head.append(text, this->Limit - this->Size);
+  this->Size += length;
+  if (!this->Stream) {
+    this->Truncate();
+  }
+}
+
+const char* cmCTestOutputSpool::GetText()
+{
+  if (!this->Spooled) {
+    return this->Head.c_str();
+  }
+  if (this->Text) {
+    return this->Text;
+  }
+
+  // Terminate the output in the file so it can be used as a string.
+  this->Stream.put('\0');
+  this->Stream.close();
+  if (!this->Stream) {
+    this->Truncate();
+    return this->Head.c_str();
+  }
+  if (this->Map()) {
+    return this->Text;
+  }
+
+  // Fall back to reading the file if it cannot be mapped.
+  this->Contents.reserve(this->Size);
+  cmsys::ifstream fin(this->File.c_str(), std::ios::in | std::ios::binary);
+  char buffer[4096];
+  while (fin && this->Contents.size() < this->Size) {
+    fin.read(buffer, sizeof(buffer));
+    this->Contents.append(buffer, static_cast<size_t>(fin.gcount()));
+  }
+  if (this->Contents.size() < this->Size) {
+    std::string().swap(this->Contents);
+    this->Truncate();
+    return this->Head.c_str();
+  }
+  this->Contents.resize(this->Size);
+  this->Text = this->Contents.c_str();
+  return this->Text;
+}
+
+bool cmCTestOutputSpool::Map()
+{
+#if defined(_WIN32)
+  HANDLE file = CreateFileW(cmsys::Encoding::ToWide(this->File).c_str(),
+                            GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, 0);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  // Mapping pages past the end of the file would fault on access.
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) ||
+      static_cast<ULONGLONG>(size.QuadPart) < this->Size + 1) {
+    CloseHandle(file);
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingW(file, 0, PAGE_READONLY, 0, 0, 0);
+  CloseHandle(file);
+  if (!mapping) {
+    return false;
+  }
+  this->Mapping = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+#else
+  int fd = open(this->File.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  // Mapping pages past the end of the file would fault on access.
+  struct stat st;
+  if (fstat(fd, &st) < 0 ||
+      static_cast<unsigned long long>(st.st_size) < this->Size + 1) {
+    close(fd);
+    return false;
+  }
+  void* mapping = mmap(0, this->Size + 1, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  this->Mapping = mapping == MAP_FAILED ? 0 : mapping;
+#endif
+  this->Text = static_cast<const char*>(this->Mapping);
+  return this->Mapping != 0;
+}
@@ -0,0 +1,82 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#ifndef cmCTestOutputSpool_h
+#define cmCTestOutputSpool_h
+
+#include "cmStandardIncludes.h"
+
+#include <cmsys/FStream.hxx>
+
+/** \class cmCTestOutputSpool
+ * \brief Collect the output of a test with a bounded amount of memory.
+ *
+ * Output is kept in memory up to a limit.  Once it grows beyond that,
+ * all of it is written to a spool file and only the first bytes up to
+ * the limit stay in memory.  The complete output can be mapped back
+ * into memory when the test has finished, and the file is removed when
+ * the spool is reset or destroyed.
+ */
+class cmCTestOutputSpool
+{
+public:
+  cmCTestOutputSpool();
+  ~cmCTestOutputSpool();
+
+  /** Discard all output and start collecting again.  Output beyond the
+      first limit bytes goes to the given file.  A limit of zero keeps
+      all output in memory.  */
+  void Reset(std::string const& file, size_t limit);
+
+  /** Append text to the output.  */
+  void Append(const char* text, size_t length);
+
+  /** Size of the complete output.  */
+  size_t GetSize() const { return this->Size; }
+
+  /** Whether the output has grown beyond the limit and is in the file.  */
+  bool IsSpooled() const { return this->Spooled; }
+
+  /** Whether the spool file could not be written or read back.  The
+      output is then the first limit bytes, followed by a note that the
+      rest was lost, and further output is dropped.  */
+  bool IsTruncated() const { return this->Truncated; }
+
+  /** The output kept in memory.  This is all of it unless it has been
+      spooled, in which case it is the first limit bytes.  */
+  std::string const& GetHead() const { return this->Head; }
+
+  /** Get the complete output as a null-terminated string.  If it has
+      been spooled the file is closed and mapped into memory, and no
+      more output may be appended until the spool is reset.  */
+  const char* GetText();
+
+  /** Discard all output and remove the spool file.  */
+  void Release();
+
+private:
+  bool Map();
+  void Truncate();
+
+  std::string Head;
+  size_t Limit;
+  size_t Size;
+  bool Spooled;
+  bool Truncated;
+  std::string File;
+  cmsys::ofstream Stream;
+  // The complete output after GetText, either mapped or read back.
+  const char* Text;
+  void* Mapping;
+  std::string Contents;
+};
+
+#endif
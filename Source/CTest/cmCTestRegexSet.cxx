@@ -0,0 +1,292 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmCTestRegexSet.h"
+
+#include <deque>
+
+cmCTestRegexSet::cmCTestRegexSet()
+{
+  this->AutomatonValid = false;
+  this->NumClasses = 1;
+  this->Stamp = 0;
+  this->Line = "";
+}
+
+void cmCTestRegexSet::Clear()
+{
+  this->Lists.clear();
+  this->Literals.clear();
+  this->LiteralIndex.clear();
+  this->AutomatonValid = false;
+}
+
+bool cmCTestRegexSet::Add(size_t list, std::string const& regex)
+{
+  if (this->Lists.size() <= list) {
+    this->Lists.resize(list + 1);
+  }
+  this->Lists[list].push_back(Entry());
+  Entry& e = this->Lists[list].back();
+  // User-provided expressions are run on every line of output, so use the
+  // engine that cannot backtrack exponentially.
+  e.Regex.set_engine(cmsys::RegularExpression::NFA);
+  e.Literal = -1;
+  if (!e.Regex.compile(regex)) {
+    return false;
+  }
+
+  std::string literal = RequiredLiteral(regex);
+  if (!literal.empty()) {
+    std::map<std::string, int>::iterator i =
+      this->LiteralIndex.find(literal);
+    if (i == this->LiteralIndex.end()) {
+      i = this->LiteralIndex
+            .insert(std::make_pair(literal, int(this->Literals.size())))
+            .first;
+      this->Literals.push_back(literal);
+      this->AutomatonValid = false;
+    }
+    e.Literal = i->second;
+  }
+  return true;
+}
+
+void cmCTestRegexSet::BuildAutomaton()
+{
+  // Bytes that do not occur in any literal share class 0.
+  memset(this->ClassOf, 0, sizeof(this->ClassOf));
+  this->NumClasses = 1;
+  for (std::vector<std::string>::const_iterator li = this->Literals.begin();
+       li != this->Literals.end(); ++li) {
+    for (std::string::const_iterator ci = li->begin(); ci != li->end();
+         ++ci) {
+      unsigned char c = static_cast<unsigned char>(*ci);
+      if (!this->ClassOf[c]) {
+        this->ClassOf[c] = static_cast<unsigned char>(this->NumClasses++);
+      }
+    }
+  }
+
+  // Build the trie.  Node 0 is the root.
+  size_t const k = this->NumClasses;
+  this->Goto.assign(k, -1);
+  this->Output.assign(1, std::vector<int>());
+  for (size_t l = 0; l < this->Literals.size(); ++l) {
+    std::string const& lit = this->Literals[l];
+    size_t node = 0;
+    for (std::string::const_iterator ci = lit.begin(); ci != lit.end();
+         ++ci) {
+      size_t c = this->ClassOf[static_cast<unsigned char>(*ci)];
+      if (this->Goto[node * k + c] < 0) {
+        this->Goto[node * k + c] = int(this->Output.size());
+        this->Goto.resize(this->Goto.size() + k, -1);
+        this->Output.push_back(std::vector<int>());
+      }
+      node = static_cast<size_t>(this->Goto[node * k + c]);
+    }
+    this->Output[node].push_back(int(l));
+  }
+
+  // Compute failure links breadth-first and complete the transitions.
+  std::vector<size_t> fail(this->Output.size(), 0);
+  std::deque<size_t> queue;
+  for (size_t c = 0; c < k; ++c) {
+    if (this->Goto[c] < 0) {
+      this->Goto[c] = 0;
+    } else {
+      queue.push_back(static_cast<size_t>(this->Goto[c]));
+    }
+  }
+  while (!queue.empty()) {
+    size_t node = queue.front();
+    queue.pop_front();
+    std::vector<int> const& inherited = this->Output[fail[node]];
+    this->Output[node].insert(this->Output[node].end(), inherited.begin(),
+                              inherited.end());
+    for (size_t c = 0; c < k; ++c) {
+      int next = this->Goto[node * k + c];
+      int viaFail = this->Goto[fail[node] * k + c];
+      if (next < 0) {
+        this->Goto[node * k + c] = viaFail;
+      } else {
+        fail[static_cast<size_t>(next)] = static_cast<size_t>(viaFail);
+        queue.push_back(static_cast<size_t>(next));
+      }
+    }
+  }
+
+  this->Seen.assign(this->Literals.size(), 0);
+  this->Stamp = 0;
+  this->AutomatonValid = true;
+}
+
+void cmCTestRegexSet::SetLine(const char* line)
+{
+  this->Line = line;
+  if (this->Literals.empty()) {
+    return;
+  }
+  if (!this->AutomatonValid) {
+    this->BuildAutomaton();
+  }
+  if (++this->Stamp == 0) {
+    std::fill(this->Seen.begin(), this->Seen.end(), 0);
+    this->Stamp = 1;
+  }
+
+  size_t const k = this->NumClasses;
+  int const* table = &this->Goto[0];
+  size_t node = 0;
+  for (const unsigned char* c = reinterpret_cast<const unsigned char*>(line);
+       *c; ++c) {
+    node = static_cast<size_t>(table[node * k + this->ClassOf[*c]]);
+    std::vector<int> const& out = this->Output[node];
+    for (std::vector<int>::const_iterator oi = out.begin(); oi != out.end();
+         ++oi) {
+      this->Seen[static_cast<size_t>(*oi)] = this->Stamp;
+    }
+  }
+}
+
+int cmCTestRegexSet::Find(size_t list)
+{
+  if (list >= this->Lists.size()) {
+    return -1;
+  }
+  std::vector<Entry>& entries = this->Lists[list];
+  for (size_t i = 0; i < entries.size(); ++i) {
+    Entry& e = entries[i];
+    if (e.Literal >= 0 &&
+        static_cast<size_t>(e.Literal) < this->Seen.size() &&
+        this->Seen[static_cast<size_t>(e.Literal)] != this->Stamp) {
+      continue;
+    }
+    if (e.Regex.find(this->Line)) {
+      return int(i);
+    }
+  }
+  return -1;
+}
+
+static std::string::size_type cmCTestRegexSetSkipBracket(
+  std::string const& regex, std::string::size_type i)
+{
+  // A ']' or '-' right after '[' or '[^' is part of the set.
+  ++i;
+  if (i < regex.size() && regex[i] == '^') {
+    ++i;
+  }
+  if (i < regex.size() && (regex[i] == ']' || regex[i] == '-')) {
+    ++i;
+  }
+  while (i < regex.size() && regex[i] != ']') {
+    ++i;
+  }
+  return i < regex.size() ? i + 1 : std::string::npos;
+}
+
+static std::string::size_type cmCTestRegexSetSkipGroup(
+  std::string const& regex, std::string::size_type i)
+{
+  int depth = 0;
+  while (i < regex.size()) {
+    switch (regex[i]) {
+      case '\\':
+        i += 2;
+        break;
+      case '[':
+        i = cmCTestRegexSetSkipBracket(regex, i);
+        if (i == std::string::npos) {
+          return i;
+        }
+        break;
+      case '(':
+        ++depth;
+        ++i;
+        break;
+      case ')':
+        ++i;
+        if (--depth == 0) {
+          return i;
+        }
+        break;
+      default:
+        ++i;
+        break;
+    }
+  }
+  return std::string::npos;
+}
+
+std::string cmCTestRegexSet::RequiredLiteral(std::string const& regex)
+{
+  // Collect runs of consecutive literal characters that each must match
+  // exactly once, and pick the longest.  Anything not understood here just
+  // ends the current run, which is always safe.  An alternation at the top
+  // level means nothing is required.
+  std::string best;
+  std::string run;
+  std::string::size_type i = 0;
+  while (i < regex.size()) {
+    char c = regex[i];
+    bool literal = false;
+    std::string::size_type next = i + 1;
+    switch (c) {
+      case '|':
+        return std::string();
+      case '\\':
+        if (next >= regex.size()) {
+          return std::string();
+        }
+        literal = true;
+        c = regex[next++];
+        break;
+      case '[':
+        next = cmCTestRegexSetSkipBracket(regex, i);
+        break;
+      case '(':
+        next = cmCTestRegexSetSkipGroup(regex, i);
+        break;
+      case '.':
+      case '^':
+      case '$':
+      case ')':
+      case '*':
+      case '+':
+      case '?':
+        break;
+      default:
+        literal = true;
+        break;
+    }
+    if (next == std::string::npos) {
+      return std::string();
+    }
+
+    char q = next < regex.size() ? regex[next] : '\0';
+    bool quantified = (q == '*' || q == '+' || q == '?');
+    if (literal && q != '*' && q != '?') {
+      run += c;
+    }
+    if (!literal || quantified) {
+      if (run.size() > best.size()) {
+        best = run;
+      }
+      run.clear();
+    }
+    i = quantified ? next + 1 : next;
+  }
+  if (run.size() > best.size()) {
+    best = run;
+  }
+  return best;
+}
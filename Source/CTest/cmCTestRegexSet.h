@@ -0,0 +1,83 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#ifndef cmCTestRegexSet_h
+#define cmCTestRegexSet_h
+
+#include "cmStandardIncludes.h"
+
+#include <cmsys/RegularExpression.hxx>
+
+/** \class cmCTestRegexSet
+ * \brief Match lines against several ordered lists of regular expressions.
+ *
+ * Every expression is reduced to a literal string that any match of it
+ * must contain.  One Aho-Corasick pass over a line finds which of those
+ * literals occur, and only the expressions whose literal is present are
+ * run.  Most lines of build output contain none of them and are
+ * classified without running any regular expression at all.
+ */
+class cmCTestRegexSet
+{
+public:
+  cmCTestRegexSet();
+
+  /** Remove all expressions from all lists.  */
+  void Clear();
+
+  /** Append an expression to the given list.  Returns false if it does
+      not compile, in which case it never matches.  */
+  bool Add(size_t list, std::string const& regex);
+
+  /** Scan a line for the literals of all lists.  The line must stay
+      valid while Find is called for it.  */
+  void SetLine(const char* line);
+
+  /** Return the index within the list of the first expression matching
+      the line given to SetLine, or -1 if none does.  */
+  int Find(size_t list);
+
+  /** Get an expression, e.g. to query the submatches of the last Find.  */
+  cmsys::RegularExpression& GetRegex(size_t list, size_t index)
+  {
+    return this->Lists[list][index].Regex;
+  }
+
+  /** Return a string that every match of the expression contains, or an
+      empty string if no such string is known.  */
+  static std::string RequiredLiteral(std::string const& regex);
+
+private:
+  struct Entry
+  {
+    cmsys::RegularExpression Regex;
+    int Literal;
+  };
+  std::vector<std::vector<Entry> > Lists;
+
+  std::vector<std::string> Literals;
+  std::map<std::string, int> LiteralIndex;
+
+  // Aho-Corasick automaton over byte classes of the literals.
+  void BuildAutomaton();
+  bool AutomatonValid;
+  unsigned char ClassOf[256];
+  size_t NumClasses;
+  std::vector<int> Goto;
+  std::vector<std::vector<int> > Output;
+
+  // Literals found on the current line are marked with the current stamp.
+  std::vector<unsigned int> Seen;
+  unsigned int Stamp;
+  const char* Line;
+};
+
+#endif
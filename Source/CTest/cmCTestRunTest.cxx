@@ -58,17 +58,21 @@ bool cmCTestRunTest::CheckOutput()
       // Store this line of output.
       cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT, this->GetIndex()
                    << ": " << line << std::endl);
-      this->ProcessOutput += line;
-      this->ProcessOutput += "\n";
+      this->Output.Append(line.c_str(), line.size());
+      this->Output.Append("\n", 1);
 
-      // Check for TIMEOUT_AFTER_MATCH property.
+      // Check for TIMEOUT_AFTER_MATCH property.  Once the output is
+      // spooled to disk match only the new line.
       if (!this->TestProperties->TimeoutRegularExpressions.empty()) {
+        const char* text = this->Output.IsSpooled()
+          ? line.c_str()
+          : this->Output.GetHead().c_str();
         std::vector<
           std::pair<cmsys::RegularExpression, std::string> >::iterator regIt;
         for (regIt = this->TestProperties->TimeoutRegularExpressions.begin();
              regIt != this->TestProperties->TimeoutRegularExpressions.end();
              ++regIt) {
-          if (regIt->first.find(this->ProcessOutput.c_str())) {
+          if (regIt->first.find(text)) {
             cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT, this->GetIndex()
                          << ": "
                          << "Test timeout changed to "
@@ -92,16 +96,15 @@ bool cmCTestRunTest::CheckOutput()
 
 // Streamed compression of test output.  The compressed data
 // is appended to this->CompressedOutput
-void cmCTestRunTest::CompressOutput()
+void cmCTestRunTest::CompressOutput(const char* output, size_t length)
 {
   int ret;
   z_stream strm;
 
-  unsigned char* in = reinterpret_cast<unsigned char*>(
-    const_cast<char*>(this->ProcessOutput.c_str()));
+  unsigned char* in =
+    reinterpret_cast<unsigned char*>(const_cast<char*>(output));
   // zlib makes the guarantee that this is the maximum output size
-  int outSize = static_cast<int>(
-    static_cast<double>(this->ProcessOutput.size()) * 1.001 + 13.0);
+  int outSize = static_cast<int>(static_cast<double>(length) * 1.001 + 13.0);
   unsigned char* out = new unsigned char[outSize];
 
   strm.zalloc = Z_NULL;
@@ -113,7 +116,7 @@ void cmCTestRunTest::CompressOutput()
     return;
   }
 
-  strm.avail_in = static_cast<uInt>(this->ProcessOutput.size());
+  strm.avail_in = static_cast<uInt>(length);
   strm.next_in = in;
   strm.avail_out = outSize;
   strm.next_out = out;
@@ -150,11 +153,13 @@ void cmCTestRunTest::CompressOutput()
 
 bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
 {
+  // The complete output, mapped back into memory if it was spooled.
+  const char* output = this->Output.GetText();
   if ((!this->TestHandler->MemCheck &&
        this->CTest->ShouldCompressTestOutput()) ||
       (this->TestHandler->MemCheck &&
        this->CTest->ShouldCompressMemCheckOutput())) {
-    this->CompressOutput();
+    this->CompressOutput(output, this->Output.GetSize());
   }
 
   this->WriteLogOutputTop(completed, total);
@@ -172,7 +177,7 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
     for (passIt = this->TestProperties->RequiredRegularExpressions.begin();
          passIt != this->TestProperties->RequiredRegularExpressions.end();
          ++passIt) {
-      if (passIt->first.find(this->ProcessOutput.c_str())) {
+      if (passIt->first.find(output)) {
         found = true;
         reason = "Required regular expression found.";
         break;
@@ -195,7 +200,7 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
     for (passIt = this->TestProperties->ErrorRegularExpressions.begin();
          passIt != this->TestProperties->ErrorRegularExpressions.end();
          ++passIt) {
-      if (passIt->first.find(this->ProcessOutput.c_str())) {
+      if (passIt->first.find(output)) {
         reason = "Error regular expression found in output.";
         reason += " Regex=[";
         reason += passIt->second;
@@ -261,18 +266,26 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
   cmCTestLog(this->CTest, HANDLER_OUTPUT, buf << "\n");
 
   if (outputTestErrorsToConsole) {
-    cmCTestLog(this->CTest, HANDLER_OUTPUT, this->ProcessOutput << std::endl);
+    cmCTestLog(this->CTest, HANDLER_OUTPUT, output << std::endl);
   }
 
   if (this->TestHandler->LogFile) {
     *this->TestHandler->LogFile << "Test time = " << buf << std::endl;
   }
 
+  // Keep all of the output to report only if it was not too large to
+  // keep in memory in the first place, or if the test asks for it.
+  if (!this->Output.IsSpooled() || strstr(output, "CTEST_FULL_OUTPUT")) {
+    this->ProcessOutput = output;
+  } else {
+    this->ProcessOutput = this->Output.GetHead();
+  }
+
   // Set the working directory to the tests directory
   std::string oldpath = cmSystemTools::GetCurrentWorkingDirectory();
   cmSystemTools::ChangeDirectory(this->TestProperties->Directory);
 
-  this->DartProcessing();
+  this->DartProcessing(output);
 
   // restore working directory
   cmSystemTools::ChangeDirectory(oldpath);
@@ -338,10 +351,11 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
     this->MemCheckPostProcess();
     this->ComputeWeightedCost();
   }
+  this->Output.Release();
   // If the test does not need to rerun push the current TestResult onto the
   // TestHandler vector
   if (!this->NeedsToRerun()) {
-    this->TestHandler->TestResults.push_back(this->TestResult);
+    this->TestHandler->RecordTestResult(this->TestResult);
   }
   delete this->TestProcess;
   return passed;
@@ -387,6 +401,10 @@ void cmCTestRunTest::ComputeWeightedCost()
   if (this->TestResult.Status == cmCTestTestHandler::COMPLETED) {
     this->TestProperties->Cost =
       static_cast<float>(((prev * avgcost) + current) / (prev + 1.0));
+    // Follow changes in the run time more closely than the average does.
+    double recent = static_cast<double>(this->TestProperties->RecentCost);
+    this->TestProperties->RecentCost = static_cast<float>(
+      prev == 0 ? current : 0.3 * current + 0.7 * recent);
     this->TestProperties->PreviousRuns++;
   }
 }
@@ -427,6 +445,19 @@ bool cmCTestRunTest::StartTest(size_t total)
   this->TestResult.Name = this->TestProperties->Name;
   this->TestResult.Path = this->TestProperties->Directory;
 
+  // Keep as much output in memory as may be reported for the test and
+  // spool the rest to disk.  Memory checkers parse all of the output.
+  int passedSize = this->TestHandler->CustomMaximumPassedTestOutputSize;
+  int failedSize = this->TestHandler->CustomMaximumFailedTestOutputSize;
+  size_t limit = 0;
+  if (!this->TestHandler->MemCheck && passedSize > 0 && failedSize > 0) {
+    limit = static_cast<size_t>(std::max(passedSize, failedSize)) + 1;
+  }
+  std::ostringstream spool;
+  spool << this->CTest->GetBinaryDir() << "/Testing/Temporary/TestOutput-"
+        << this->Index << ".log";
+  this->Output.Reset(spool.str(), limit);
+
   if (args.size() >= 2 && args[1] == "NOT_AVAILABLE") {
     this->TestProcess = new cmProcess;
     std::string msg;
@@ -551,12 +582,10 @@ void cmCTestRunTest::ComputeArguments()
   }
 }
 
-void cmCTestRunTest::DartProcessing()
+void cmCTestRunTest::DartProcessing(const char* output)
 {
-  if (!this->ProcessOutput.empty() &&
-      this->ProcessOutput.find("<DartMeasurement") !=
-        this->ProcessOutput.npos) {
-    if (this->TestHandler->DartStuff.find(this->ProcessOutput.c_str())) {
+  if (strstr(output, "<DartMeasurement")) {
+    if (this->TestHandler->DartStuff.find(output)) {
       this->TestResult.DartString = this->TestHandler->DartStuff.match(1);
       // keep searching and replacing until none are left
       while (this->TestHandler->DartStuff1.find(this->ProcessOutput.c_str())) {
@@ -735,7 +764,7 @@ void cmCTestRunTest::WriteLogOutputTop(size_t completed, size_t total)
     << "Output:" << std::endl
     << "----------------------------------------------------------"
     << std::endl;
-  *this->TestHandler->LogFile << this->ProcessOutput << "<end of output>"
+  *this->TestHandler->LogFile << this->Output.GetText() << "<end of output>"
                               << std::endl;
 
   cmCTestLog(this->CTest, HANDLER_OUTPUT, outname.c_str());
@@ -12,6 +12,7 @@
 #ifndef cmCTestRunTest_h
 #define cmCTestRunTest_h
 
+#include <cmCTestOutputSpool.h>
 #include <cmCTestTestHandler.h>
 
 #include <cmProcess.h>
@@ -56,7 +57,7 @@ public:
   bool CheckOutput();
 
   // Compresses the output, writing to CompressedOutput
-  void CompressOutput();
+  void CompressOutput(const char* output, size_t length);
 
   // launch the test process, return whether it started correctly
   bool StartTest(size_t total);
@@ -71,7 +72,7 @@ public:
 
 private:
   bool NeedsToRerun();
-  void DartProcessing();
+  void DartProcessing(const char* output);
   void ExeNotFound(std::string exe);
   // Figures out a final timeout which is min(STOP_TIME, NOW+TIMEOUT)
   double ResolveTimeout();
@@ -94,6 +95,8 @@ private:
   bool UsePrefixCommand;
   std::string PrefixCommand;
 
+  // The output as it is being read, and then as it is reported
+  cmCTestOutputSpool Output;
   std::string ProcessOutput;
   std::string CompressedOutput;
   double CompressionRatio;
@@ -17,6 +17,7 @@
 #include "cmCTestMultiProcessHandler.h"
 #include "cmCTestRunTest.h"
 #include "cmCommand.h"
+#include "cmFileTimeComparison.h"
 #include "cmGeneratedFileStream.h"
 #include "cmGlobalGenerator.h"
 #include "cmMakefile.h"
@@ -24,10 +25,13 @@
 #include "cmXMLWriter.h"
 #include "cm_utf8.h"
 #include "cmake.h"
+#include <cm_jsoncpp_reader.h>
+#include <cm_jsoncpp_value.h>
 #include <cmsys/Base64.h>
 #include <cmsys/Directory.hxx>
 #include <cmsys/FStream.hxx>
 #include <cmsys/Process.h>
+#include <cmsys/auto_ptr.hxx>
 #include <cmsys/RegularExpression.hxx>
 
 #include <float.h>
@@ -324,6 +328,9 @@ inline int GetNextRealNumber(std::string const& in, double& val,
 cmCTestTestHandler::cmCTestTestHandler()
 {
   this->UseUnion = false;
+  this->ShardIndex = 0;
+  this->ShardCount = 0;
+  this->PrintShardPlan = false;
 
   this->UseIncludeLabelRegExpFlag = false;
   this->UseExcludeLabelRegExpFlag = false;
@@ -337,6 +344,7 @@ cmCTestTestHandler::cmCTestTestHandler()
   this->MemCheck = false;
 
   this->LogFile = 0;
+  this->ResultsXML = 0;
 
   // regex to detect <DartMeasurement>...</DartMeasurement>
   this->DartStuff.compile("(<DartMeasurement.*/DartMeasurement[a-zA-Z]*>)");
@@ -376,6 +384,9 @@ void cmCTestTestHandler::Initialize()
 
   TestsToRunString = "";
   this->UseUnion = false;
+  this->ShardIndex = 0;
+  this->ShardCount = 0;
+  this->PrintShardPlan = false;
   this->TestList.clear();
 }
 
@@ -451,6 +462,19 @@ int cmCTestTestHandler::ProcessHandler()
     this->SetExcludeRegExp(val);
   }
   this->SetRerunFailed(cmSystemTools::IsOn(this->GetOption("RerunFailed")));
+  val = this->GetOption("Shard");
+  if (val && sscanf(val, "%d/%d", &this->ShardIndex, &this->ShardCount) != 2) {
+    this->ShardIndex = 0;
+    this->ShardCount = 0;
+  }
+  this->PrintShardPlan =
+    cmSystemTools::IsOn(this->GetOption("PrintShardPlan"));
+  if (this->PrintShardPlan && this->ShardCount < 1) {
+    cmCTestLog(this->CTest, ERROR_MESSAGE,
+               "Printing a shard plan requires a number of shards."
+                 << std::endl);
+    return -1;
+  }
 
   this->TestResults.clear();
 
@@ -459,6 +483,10 @@ int cmCTestTestHandler::ProcessHandler()
       << " project " << cmSystemTools::GetCurrentWorkingDirectory()
       << std::endl,
     this->Quiet);
+  if (this->PrintShardPlan) {
+    this->ComputeTestList();
+    return 0;
+  }
   if (!this->PreProcessHandler()) {
     return -1;
   }
@@ -467,6 +495,22 @@ int cmCTestTestHandler::ProcessHandler()
   this->StartLogFile((this->MemCheck ? "DynamicAnalysis" : "Test"), mLogFile);
   this->LogFile = &mLogFile;
 
+  // Write the results of tests to the XML file as they finish instead of
+  // keeping all of their output until the end.  Memory checks need all
+  // results to summarize the defects found.
+  cmGeneratedFileStream xmlfile;
+  cmsys::auto_ptr<cmXMLWriter> xml;
+  if (this->CTest->GetProduceXML() && !this->MemCheck) {
+    if (!this->StartResultingXML(cmCTest::PartTest, "Test", xmlfile)) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE, "Cannot create testing XML file"
+                   << std::endl);
+      this->LogFile = 0;
+      return 1;
+    }
+    xml.reset(new cmXMLWriter(xmlfile));
+    this->ResultsXML = xml.get();
+  }
+
   std::vector<std::string> passed;
   std::vector<std::string> failed;
   int total;
@@ -477,6 +521,11 @@ int cmCTestTestHandler::ProcessHandler()
 
   this->ProcessDirectory(passed, failed);
 
+  if (this->ResultsXML) {
+    this->EndDartOutput(*this->ResultsXML);
+    this->ResultsXML = 0;
+  }
+
   clock_finish = cmSystemTools::GetTime();
 
   total = int(passed.size()) + int(failed.size());
@@ -542,19 +591,17 @@ int cmCTestTestHandler::ProcessHandler()
     }
   }
 
-  if (this->CTest->GetProduceXML()) {
-    cmGeneratedFileStream xmlfile;
-    if (!this->StartResultingXML(
-          (this->MemCheck ? cmCTest::PartMemCheck : cmCTest::PartTest),
-          (this->MemCheck ? "DynamicAnalysis" : "Test"), xmlfile)) {
-      cmCTestLog(this->CTest, ERROR_MESSAGE, "Cannot create "
-                   << (this->MemCheck ? "memory check" : "testing")
-                   << " XML file" << std::endl);
+  if (this->CTest->GetProduceXML() && this->MemCheck) {
+    cmGeneratedFileStream mxmlfile;
+    if (!this->StartResultingXML(cmCTest::PartMemCheck, "DynamicAnalysis",
+                                 mxmlfile)) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "Cannot create memory check XML file" << std::endl);
       this->LogFile = 0;
       return 1;
     }
-    cmXMLWriter xml(xmlfile);
-    this->GenerateDartOutput(xml);
+    cmXMLWriter mxml(mxmlfile);
+    this->GenerateDartOutput(mxml);
   }
 
   if (!this->PostProcessHandler()) {
@@ -763,6 +810,7 @@ void cmCTestTestHandler::ComputeTestList()
   // Set the TestList to the final list of all test
   this->TestList = finalList;
 
+  this->SelectShard();
   this->UpdateMaxTestNameWidth();
 }
 
@@ -793,9 +841,160 @@ void cmCTestTestHandler::ComputeTestListForRerunFailed()
   // Set the TestList to the list of failed tests to rerun
   this->TestList = finalList;
 
+  this->SelectShard();
   this->UpdateMaxTestNameWidth();
 }
 
+static size_t cmCTestShardGroup(std::vector<size_t>& groups, size_t i)
+{
+  while (groups[i] != i) {
+    groups[i] = groups[groups[i]];
+    i = groups[i];
+  }
+  return i;
+}
+
+namespace {
+struct ShardGroupLess
+{
+  std::vector<double> const& Times;
+  ShardGroupLess(std::vector<double> const& times)
+    : Times(times)
+  {
+  }
+  // Sorts groups in descending order of time, then in test order
+  bool operator()(size_t l, size_t r) const
+  {
+    if (this->Times[l] != this->Times[r]) {
+      return this->Times[l] > this->Times[r];
+    }
+    return l < r;
+  }
+};
+}
+
+void cmCTestTestHandler::SelectShard()
+{
+  if (this->ShardCount < 1) {
+    return;
+  }
+
+  // Expect each test to take about as long as its recent runs, or its
+  // COST if it has not run yet.
+  std::map<std::string, double> recentTimes;
+  std::string fname = this->CTest->GetCostDataFile();
+  cmsys::ifstream fin(fname.c_str());
+  std::string line;
+  while (std::getline(fin, line) && line != "---") {
+    std::vector<cmsys::String> parts = cmSystemTools::SplitString(line, ' ');
+    if (parts.size() < 3) {
+      break;
+    }
+    recentTimes[parts[0]] = atof(parts[parts.size() > 3 ? 3 : 2].c_str());
+  }
+  std::vector<double> times;
+  double knownTime = 0;
+  size_t known = 0;
+  for (ListOfTests::iterator it = this->TestList.begin();
+       it != this->TestList.end(); ++it) {
+    std::map<std::string, double>::const_iterator t =
+      recentTimes.find(it->Name);
+    double time = t != recentTimes.end() ? t->second : it->Cost;
+    if (time > 0) {
+      knownTime += time;
+      ++known;
+    }
+    times.push_back(time);
+  }
+  // Tests without a time are expected to take the average time.
+  double defaultTime = known ? knownTime / double(known) : 1;
+  for (std::vector<double>::iterator t = times.begin(); t != times.end();
+       ++t) {
+    if (*t <= 0) {
+      *t = defaultTime;
+    }
+  }
+
+  // Put each test in the group of the tests it depends on, named by the
+  // first of them in the list.
+  std::map<std::string, size_t> positions;
+  std::vector<size_t> groups;
+  for (size_t i = 0; i < this->TestList.size(); ++i) {
+    positions.insert(std::make_pair(this->TestList[i].Name, i));
+    groups.push_back(i);
+  }
+  for (size_t i = 0; i < this->TestList.size(); ++i) {
+    std::vector<std::string> const& depends = this->TestList[i].Depends;
+    for (std::vector<std::string>::const_iterator d = depends.begin();
+         d != depends.end(); ++d) {
+      std::map<std::string, size_t>::const_iterator p = positions.find(*d);
+      if (p == positions.end()) {
+        continue;
+      }
+      size_t g1 = cmCTestShardGroup(groups, i);
+      size_t g2 = cmCTestShardGroup(groups, p->second);
+      groups[std::max(g1, g2)] = std::min(g1, g2);
+    }
+  }
+  std::vector<double> groupTimes(this->TestList.size(), 0);
+  std::vector<size_t> groupOrder;
+  for (size_t i = 0; i < this->TestList.size(); ++i) {
+    size_t g = cmCTestShardGroup(groups, i);
+    if (g == i) {
+      groupOrder.push_back(i);
+    }
+    groupTimes[g] += times[i];
+  }
+
+  // Put the longest groups first into the shard with the least time so
+  // far.  This only depends on the list of tests and their times, so all
+  // machines that share the cost data agree on the shards.
+  std::sort(groupOrder.begin(), groupOrder.end(), ShardGroupLess(groupTimes));
+  size_t count = static_cast<size_t>(this->ShardCount);
+  std::vector<double> shardTimes(count, 0);
+  std::vector<size_t> groupShards(this->TestList.size(), 0);
+  for (std::vector<size_t>::const_iterator g = groupOrder.begin();
+       g != groupOrder.end(); ++g) {
+    size_t shard = std::min_element(shardTimes.begin(), shardTimes.end()) -
+      shardTimes.begin();
+    shardTimes[shard] += groupTimes[*g];
+    groupShards[*g] = shard;
+  }
+
+  ListOfTests shardList;
+  std::vector<ListOfTests> shardTests(this->PrintShardPlan ? count : 0);
+  for (size_t i = 0; i < this->TestList.size(); ++i) {
+    size_t shard = groupShards[cmCTestShardGroup(groups, i)];
+    if (this->PrintShardPlan) {
+      shardTests[shard].push_back(this->TestList[i]);
+    }
+    if (shard == static_cast<size_t>(this->ShardIndex - 1)) {
+      shardList.push_back(this->TestList[i]);
+    }
+  }
+
+  if (this->PrintShardPlan) {
+    cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT, "Shard plan for "
+                         << this->TestList.size() << " tests in " << count
+                         << " shards:" << std::endl,
+                       this->Quiet);
+    for (size_t shard = 0; shard < count; ++shard) {
+      char buf[1024];
+      sprintf(buf, "  Shard %d/%d: %6d tests, predicted time %8.2f sec",
+              int(shard + 1), int(count), int(shardTests[shard].size()),
+              shardTimes[shard]);
+      cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT, buf << std::endl,
+                         this->Quiet);
+      for (ListOfTests::iterator it = shardTests[shard].begin();
+           it != shardTests[shard].end(); ++it) {
+        cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                           "    " << it->Name << std::endl, this->Quiet);
+      }
+    }
+  }
+  this->TestList = shardList;
+}
+
 void cmCTestTestHandler::UpdateMaxTestNameWidth()
 {
   std::string::size_type max = this->CTest->GetMaxTestNameWidth();
@@ -913,6 +1112,18 @@ void cmCTestTestHandler::ProcessDirectory(std::vector<std::string>& passed,
   this->StartTestTime = static_cast<unsigned int>(cmSystemTools::GetTime());
   double elapsed_time_start = cmSystemTools::GetTime();
 
+  if (this->ResultsXML) {
+    cmXMLWriter& xml = *this->ResultsXML;
+    this->StartDartOutput(xml);
+    xml.StartElement("TestList");
+    for (ListOfTests::iterator it = this->TestList.begin();
+         it != this->TestList.end(); ++it) {
+      std::string testPath = it->Directory + "/" + it->Name;
+      xml.Element("Test", this->CTest->GetShortPathToFile(testPath.c_str()));
+    }
+    xml.EndElement(); // TestList
+  }
+
   cmCTestMultiProcessHandler* parallel = this->CTest->GetBatchJobs()
     ? new cmCTestBatchTestHandler
     : new cmCTestMultiProcessHandler;
@@ -925,6 +1136,7 @@ void cmCTestTestHandler::ProcessDirectory(std::vector<std::string>& passed,
   } else {
     parallel->SetTestLoad(this->CTest->GetTestLoad());
   }
+  parallel->SetResourceCapacities(this->CTest->GetResourceCapacities());
 
   *this->LogFile
     << "Start testing: " << this->CTest->CurrentTime() << std::endl
@@ -939,6 +1151,13 @@ void cmCTestTestHandler::ProcessDirectory(std::vector<std::string>& passed,
     srand((unsigned)time(0));
   }
 
+  // Map test names to the first test with that name for DEPENDS.
+  std::map<std::string, int> testIndexes;
+  for (ListOfTests::iterator it = this->TestList.begin();
+       it != this->TestList.end(); ++it) {
+    testIndexes.insert(std::make_pair(it->Name, it->Index));
+  }
+
   for (ListOfTests::iterator it = this->TestList.begin();
        it != this->TestList.end(); ++it) {
     cmCTestTestProperties& p = *it;
@@ -955,12 +1174,9 @@ void cmCTestTestHandler::ProcessDirectory(std::vector<std::string>& passed,
     if (!p.Depends.empty()) {
       for (std::vector<std::string>::iterator i = p.Depends.begin();
            i != p.Depends.end(); ++i) {
-        for (ListOfTests::iterator it2 = this->TestList.begin();
-             it2 != this->TestList.end(); ++it2) {
-          if (it2->Name == *i) {
-            depends.insert(it2->Index);
-            break; // break out of test loop as name can only match 1
-          }
+        std::map<std::string, int>::const_iterator ti = testIndexes.find(*i);
+        if (ti != testIndexes.end()) {
+          depends.insert(ti->second);
         }
       }
     }
@@ -996,10 +1212,7 @@ void cmCTestTestHandler::GenerateDartOutput(cmXMLWriter& xml)
     return;
   }
 
-  this->CTest->StartXML(xml, this->AppendXML);
-  xml.StartElement("Testing");
-  xml.Element("StartDateTime", this->StartTest);
-  xml.Element("StartTestTime", this->StartTestTime);
+  this->StartDartOutput(xml);
   xml.StartElement("TestList");
   cmCTestTestHandler::TestResultsVector::size_type cc;
   for (cc = 0; cc < this->TestResults.size(); cc++) {
@@ -1009,76 +1222,93 @@ void cmCTestTestHandler::GenerateDartOutput(cmXMLWriter& xml)
   }
   xml.EndElement(); // TestList
   for (cc = 0; cc < this->TestResults.size(); cc++) {
-    cmCTestTestResult* result = &this->TestResults[cc];
-    this->WriteTestResultHeader(xml, result);
-    xml.StartElement("Results");
-    if (result->Status != cmCTestTestHandler::NOT_RUN) {
-      if (result->Status != cmCTestTestHandler::COMPLETED ||
-          result->ReturnValue) {
-        xml.StartElement("NamedMeasurement");
-        xml.Attribute("type", "text/string");
-        xml.Attribute("name", "Exit Code");
-        xml.Element("Value", this->GetTestStatus(result->Status));
-        xml.EndElement(); // NamedMeasurement
-        xml.StartElement("NamedMeasurement");
-        xml.Attribute("type", "text/string");
-        xml.Attribute("name", "Exit Value");
-        xml.Element("Value", result->ReturnValue);
-        xml.EndElement(); // NamedMeasurement
-      }
-      this->GenerateRegressionImages(xml, result->DartString);
+    this->GenerateTestDartOutput(xml, &this->TestResults[cc]);
+  }
+  this->EndDartOutput(xml);
+}
+
+void cmCTestTestHandler::StartDartOutput(cmXMLWriter& xml)
+{
+  this->CTest->StartXML(xml, this->AppendXML);
+  xml.StartElement("Testing");
+  xml.Element("StartDateTime", this->StartTest);
+  xml.Element("StartTestTime", this->StartTestTime);
+}
+
+void cmCTestTestHandler::GenerateTestDartOutput(cmXMLWriter& xml,
+                                                cmCTestTestResult* result)
+{
+  this->WriteTestResultHeader(xml, result);
+  xml.StartElement("Results");
+  if (result->Status != cmCTestTestHandler::NOT_RUN) {
+    if (result->Status != cmCTestTestHandler::COMPLETED ||
+        result->ReturnValue) {
       xml.StartElement("NamedMeasurement");
-      xml.Attribute("type", "numeric/double");
-      xml.Attribute("name", "Execution Time");
-      xml.Element("Value", result->ExecutionTime);
+      xml.Attribute("type", "text/string");
+      xml.Attribute("name", "Exit Code");
+      xml.Element("Value", this->GetTestStatus(result->Status));
       xml.EndElement(); // NamedMeasurement
-      if (!result->Reason.empty()) {
-        const char* reasonType = "Pass Reason";
-        if (result->Status != cmCTestTestHandler::COMPLETED &&
-            result->Status != cmCTestTestHandler::NOT_RUN) {
-          reasonType = "Fail Reason";
-        }
-        xml.StartElement("NamedMeasurement");
-        xml.Attribute("type", "text/string");
-        xml.Attribute("name", reasonType);
-        xml.Element("Value", result->Reason);
-        xml.EndElement(); // NamedMeasurement
-      }
       xml.StartElement("NamedMeasurement");
       xml.Attribute("type", "text/string");
-      xml.Attribute("name", "Completion Status");
-      xml.Element("Value", result->CompletionStatus);
+      xml.Attribute("name", "Exit Value");
+      xml.Element("Value", result->ReturnValue);
       xml.EndElement(); // NamedMeasurement
     }
+    this->GenerateRegressionImages(xml, result->DartString);
     xml.StartElement("NamedMeasurement");
-    xml.Attribute("type", "text/string");
-    xml.Attribute("name", "Command Line");
-    xml.Element("Value", result->FullCommandLine);
+    xml.Attribute("type", "numeric/double");
+    xml.Attribute("name", "Execution Time");
+    xml.Element("Value", result->ExecutionTime);
     xml.EndElement(); // NamedMeasurement
-    std::map<std::string, std::string>::iterator measureIt;
-    for (measureIt = result->Properties->Measurements.begin();
-         measureIt != result->Properties->Measurements.end(); ++measureIt) {
+    if (!result->Reason.empty()) {
+      const char* reasonType = "Pass Reason";
+      if (result->Status != cmCTestTestHandler::COMPLETED &&
+          result->Status != cmCTestTestHandler::NOT_RUN) {
+        reasonType = "Fail Reason";
+      }
       xml.StartElement("NamedMeasurement");
       xml.Attribute("type", "text/string");
-      xml.Attribute("name", measureIt->first);
-      xml.Element("Value", measureIt->second);
+      xml.Attribute("name", reasonType);
+      xml.Element("Value", result->Reason);
       xml.EndElement(); // NamedMeasurement
     }
-    xml.StartElement("Measurement");
-    xml.StartElement("Value");
-    if (result->CompressOutput) {
-      xml.Attribute("encoding", "base64");
-      xml.Attribute("compression", "gzip");
-    }
-    xml.Content(result->Output);
-    xml.EndElement(); // Value
-    xml.EndElement(); // Measurement
-    xml.EndElement(); // Results
-
-    this->AttachFiles(xml, result);
-    this->WriteTestResultFooter(xml, result);
+    xml.StartElement("NamedMeasurement");
+    xml.Attribute("type", "text/string");
+    xml.Attribute("name", "Completion Status");
+    xml.Element("Value", result->CompletionStatus);
+    xml.EndElement(); // NamedMeasurement
   }
+  xml.StartElement("NamedMeasurement");
+  xml.Attribute("type", "text/string");
+  xml.Attribute("name", "Command Line");
+  xml.Element("Value", result->FullCommandLine);
+  xml.EndElement(); // NamedMeasurement
+  std::map<std::string, std::string>::iterator measureIt;
+  for (measureIt = result->Properties->Measurements.begin();
+       measureIt != result->Properties->Measurements.end(); ++measureIt) {
+    xml.StartElement("NamedMeasurement");
+    xml.Attribute("type", "text/string");
+    xml.Attribute("name", measureIt->first);
+    xml.Element("Value", measureIt->second);
+    xml.EndElement(); // NamedMeasurement
+  }
+  xml.StartElement("Measurement");
+  xml.StartElement("Value");
+  if (result->CompressOutput) {
+    xml.Attribute("encoding", "base64");
+    xml.Attribute("compression", "gzip");
+  }
+  xml.Content(result->Output);
+  xml.EndElement(); // Value
+  xml.EndElement(); // Measurement
+  xml.EndElement(); // Results
 
+  this->AttachFiles(xml, result);
+  this->WriteTestResultFooter(xml, result);
+}
+
+void cmCTestTestHandler::EndDartOutput(cmXMLWriter& xml)
+{
   xml.Element("EndDateTime", this->EndTest);
   xml.Element("EndTestTime", this->EndTestTime);
   xml.Element("ElapsedMinutes",
@@ -1087,6 +1317,18 @@ void cmCTestTestHandler::GenerateDartOutput(cmXMLWriter& xml)
   this->CTest->EndXML(xml);
 }
 
+void cmCTestTestHandler::RecordTestResult(cmCTestTestResult const& result)
+{
+  this->TestResults.push_back(result);
+  if (this->ResultsXML) {
+    cmCTestTestResult& recorded = this->TestResults.back();
+    this->GenerateTestDartOutput(*this->ResultsXML, &recorded);
+    // The output is in the XML file now and need not be kept.
+    std::string().swap(recorded.Output);
+    std::string().swap(recorded.DartString);
+  }
+}
+
 void cmCTestTestHandler::WriteTestResultHeader(cmXMLWriter& xml,
                                                cmCTestTestResult* result)
 {
@@ -1330,6 +1572,7 @@ std::string cmCTestTestHandler::FindExecutable(
 
 void cmCTestTestHandler::GetListOfTests()
 {
+  this->TestListPositions.clear();
   if (!this->IncludeLabelRegExp.empty()) {
     this->IncludeLabelRegularExpression.compile(
       this->IncludeLabelRegExp.c_str());
@@ -1346,6 +1589,13 @@ void cmCTestTestHandler::GetListOfTests()
   }
   cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                      "Constructing a list of tests" << std::endl, this->Quiet);
+  if (this->ReadTestManifests()) {
+    cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                       "Done constructing a list of tests from manifests"
+                         << std::endl,
+                       this->Quiet);
+    return;
+  }
   cmake cm;
   cm.SetHomeDirectory("");
   cm.SetHomeOutputDirectory("");
@@ -1398,6 +1648,112 @@ void cmCTestTestHandler::GetListOfTests()
                      this->Quiet);
 }
 
+bool cmCTestTestHandler::ReadTestManifests()
+{
+  cmFileTimeComparison ftc;
+  std::string cwd = cmSystemTools::GetCurrentWorkingDirectory();
+  bool result = this->ReadTestManifest(cwd, ftc);
+  cmSystemTools::ChangeDirectory(cwd);
+  if (!result) {
+    this->TestList.clear();
+    this->TestListPositions.clear();
+  }
+  return result;
+}
+
+bool cmCTestTestHandler::ReadTestManifest(std::string const& dir,
+                                          cmFileTimeComparison& ftc)
+{
+  // The manifest written next to the CTestTestfile.cmake by the
+  // generator describes the same tests, unless the script was edited
+  // after it was written.
+  std::string testFilename = dir + "/CTestTestfile.cmake";
+  std::string manifestFile = dir + "/CTestTestfile.json";
+  int newer = 0;
+  if (!ftc.FileTimeCompare(manifestFile.c_str(), testFilename.c_str(),
+                           &newer) ||
+      newer < 0) {
+    return false;
+  }
+  cmsys::ifstream fin(manifestFile.c_str());
+  Json::Value manifest;
+  Json::Reader reader;
+  if (!fin || !reader.parse(fin, manifest, false) || !manifest.isObject() ||
+      manifest["version"] != 1) {
+    return false;
+  }
+
+  cmCTestOptionalLog(this->CTest, DEBUG,
+                     "Read test manifest: " << manifestFile << std::endl,
+                     this->Quiet);
+
+  std::string config = cmSystemTools::UpperCase(this->CTest->GetConfigType());
+  Json::Value const& tests = manifest["tests"];
+  for (Json::Value::const_iterator t = tests.begin(); t != tests.end(); ++t) {
+    // Use the first rule for the configuration, like the script.
+    for (Json::Value::const_iterator r = t->begin(); r != t->end(); ++r) {
+      Json::Value const& configs = (*r)["configurations"];
+      bool matches = configs.isNull();
+      for (Json::Value::const_iterator c = configs.begin();
+           !matches && c != configs.end(); ++c) {
+        matches = cmSystemTools::UpperCase(c->asString()) == config;
+      }
+      if (!matches) {
+        continue;
+      }
+      Json::Value const& commands = (*r)["commands"];
+      for (Json::Value::const_iterator c = commands.begin();
+           c != commands.end(); ++c) {
+        std::vector<std::string> args;
+        for (Json::Value::const_iterator a = c->begin(); a != c->end(); ++a) {
+          args.push_back(a->asString());
+        }
+        if (args.size() < 2) {
+          return false;
+        }
+        std::string command = args[0];
+        args.erase(args.begin());
+        if (command == "add_test") {
+          this->AddTest(args);
+        } else if (command == "set_tests_properties") {
+          this->SetTestsProperties(args);
+        } else {
+          return false;
+        }
+      }
+      break;
+    }
+  }
+
+  // Read the subdirectories like the subdirs command does.
+  Json::Value const& subdirs = manifest["subdirs"];
+  for (Json::Value::const_iterator i = subdirs.begin(); i != subdirs.end();
+       ++i) {
+    std::string subdir = i->asString();
+    if (!cmSystemTools::FileIsFullPath(subdir.c_str())) {
+      subdir = dir + "/" + subdir;
+    }
+    if (!cmSystemTools::FileIsDirectory(subdir)) {
+      continue;
+    }
+    std::string subdirTestFile = subdir + "/CTestTestfile.cmake";
+    if (!cmSystemTools::FileExists(subdirTestFile.c_str())) {
+      if (cmSystemTools::FileExists((subdir + "/DartTestfile.txt").c_str())) {
+        return false;
+      }
+      continue;
+    }
+    cmSystemTools::ChangeDirectory(subdir);
+    bool result = this->ReadTestManifest(
+      cmSystemTools::GetCurrentWorkingDirectory(), ftc);
+    cmSystemTools::ChangeDirectory(dir);
+    if (!result) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void cmCTestTestHandler::UseIncludeRegExp()
 {
   this->UseIncludeRegExpFlag = true;
@@ -1804,114 +2160,134 @@ bool cmCTestTestHandler::SetTestsProperties(
     std::string val = *it;
     std::vector<std::string>::const_iterator tit;
     for (tit = tests.begin(); tit != tests.end(); ++tit) {
-      cmCTestTestHandler::ListOfTests::iterator rtit;
-      for (rtit = this->TestList.begin(); rtit != this->TestList.end();
-           ++rtit) {
-        if (*tit == rtit->Name) {
-          if (key == "WILL_FAIL") {
-            rtit->WillFail = cmSystemTools::IsOn(val.c_str());
-          }
-          if (key == "ATTACHED_FILES") {
-            cmSystemTools::ExpandListArgument(val, rtit->AttachedFiles);
-          }
-          if (key == "ATTACHED_FILES_ON_FAIL") {
-            cmSystemTools::ExpandListArgument(val, rtit->AttachOnFail);
-          }
-          if (key == "RESOURCE_LOCK") {
-            std::vector<std::string> lval;
-            cmSystemTools::ExpandListArgument(val, lval);
+      TestPositionMap::const_iterator positions =
+        this->TestListPositions.find(*tit);
+      if (positions == this->TestListPositions.end()) {
+        continue;
+      }
+      for (std::vector<size_t>::const_iterator pi = positions->second.begin();
+           pi != positions->second.end(); ++pi) {
+        cmCTestTestProperties* rtit = &this->TestList[*pi];
+        if (key == "WILL_FAIL") {
+          rtit->WillFail = cmSystemTools::IsOn(val.c_str());
+        }
+        if (key == "ATTACHED_FILES") {
+          cmSystemTools::ExpandListArgument(val, rtit->AttachedFiles);
+        }
+        if (key == "ATTACHED_FILES_ON_FAIL") {
+          cmSystemTools::ExpandListArgument(val, rtit->AttachOnFail);
+        }
+        if (key == "RESOURCE_LOCK") {
+          std::vector<std::string> lval;
+          cmSystemTools::ExpandListArgument(val, lval);
 
-            rtit->LockedResources.insert(lval.begin(), lval.end());
-          }
-          if (key == "TIMEOUT") {
-            rtit->Timeout = atof(val.c_str());
-            rtit->ExplicitTimeout = true;
-          }
-          if (key == "COST") {
-            rtit->Cost = static_cast<float>(atof(val.c_str()));
-          }
-          if (key == "REQUIRED_FILES") {
-            cmSystemTools::ExpandListArgument(val, rtit->RequiredFiles);
-          }
-          if (key == "RUN_SERIAL") {
-            rtit->RunSerial = cmSystemTools::IsOn(val.c_str());
-          }
-          if (key == "FAIL_REGULAR_EXPRESSION") {
-            std::vector<std::string> lval;
-            cmSystemTools::ExpandListArgument(val, lval);
-            std::vector<std::string>::iterator crit;
-            for (crit = lval.begin(); crit != lval.end(); ++crit) {
-              rtit->ErrorRegularExpressions.push_back(
-                std::pair<cmsys::RegularExpression, std::string>(
-                  cmsys::RegularExpression(crit->c_str()),
-                  std::string(*crit)));
-            }
-          }
-          if (key == "PROCESSORS") {
-            rtit->Processors = atoi(val.c_str());
-            if (rtit->Processors < 1) {
-              rtit->Processors = 1;
+          rtit->LockedResources.insert(lval.begin(), lval.end());
+        }
+        if (key == "RESOURCE_AMOUNTS") {
+          std::vector<std::string> lval;
+          cmSystemTools::ExpandListArgument(val, lval);
+          for (std::vector<std::string>::iterator a = lval.begin();
+               a != lval.end(); ++a) {
+            std::string::size_type eq = a->find('=');
+            unsigned long amount;
+            if (eq == 0 || eq == std::string::npos ||
+                !cmSystemTools::StringToULong(a->c_str() + eq + 1,
+                                              &amount)) {
+              cmCTestLog(this->CTest, WARNING,
+                         "Invalid RESOURCE_AMOUNTS value '"
+                           << *a << "' of test " << rtit->Name
+                           << std::endl);
+              continue;
             }
+            rtit->ResourceAmounts[a->substr(0, eq)] = amount;
           }
-          if (key == "SKIP_RETURN_CODE") {
-            rtit->SkipReturnCode = atoi(val.c_str());
-            if (rtit->SkipReturnCode < 0 || rtit->SkipReturnCode > 255) {
-              rtit->SkipReturnCode = -1;
-            }
+        }
+        if (key == "TIMEOUT") {
+          rtit->Timeout = atof(val.c_str());
+          rtit->ExplicitTimeout = true;
+        }
+        if (key == "COST") {
+          rtit->Cost = static_cast<float>(atof(val.c_str()));
+        }
+        if (key == "REQUIRED_FILES") {
+          cmSystemTools::ExpandListArgument(val, rtit->RequiredFiles);
+        }
+        if (key == "RUN_SERIAL") {
+          rtit->RunSerial = cmSystemTools::IsOn(val.c_str());
+        }
+        if (key == "FAIL_REGULAR_EXPRESSION") {
+          std::vector<std::string> lval;
+          cmSystemTools::ExpandListArgument(val, lval);
+          std::vector<std::string>::iterator crit;
+          for (crit = lval.begin(); crit != lval.end(); ++crit) {
+            rtit->ErrorRegularExpressions.push_back(
+              std::pair<cmsys::RegularExpression, std::string>(
+                cmsys::RegularExpression(crit->c_str()), std::string(*crit)));
           }
-          if (key == "DEPENDS") {
-            cmSystemTools::ExpandListArgument(val, rtit->Depends);
+        }
+        if (key == "PROCESSORS") {
+          rtit->Processors = atoi(val.c_str());
+          if (rtit->Processors < 1) {
+            rtit->Processors = 1;
           }
-          if (key == "ENVIRONMENT") {
-            cmSystemTools::ExpandListArgument(val, rtit->Environment);
+        }
+        if (key == "SKIP_RETURN_CODE") {
+          rtit->SkipReturnCode = atoi(val.c_str());
+          if (rtit->SkipReturnCode < 0 || rtit->SkipReturnCode > 255) {
+            rtit->SkipReturnCode = -1;
           }
-          if (key == "LABELS") {
-            cmSystemTools::ExpandListArgument(val, rtit->Labels);
+        }
+        if (key == "DEPENDS") {
+          cmSystemTools::ExpandListArgument(val, rtit->Depends);
+        }
+        if (key == "ENVIRONMENT") {
+          cmSystemTools::ExpandListArgument(val, rtit->Environment);
+        }
+        if (key == "LABELS") {
+          cmSystemTools::ExpandListArgument(val, rtit->Labels);
+        }
+        if (key == "MEASUREMENT") {
+          size_t pos = val.find_first_of('=');
+          if (pos != val.npos) {
+            std::string mKey = val.substr(0, pos);
+            const char* mVal = val.c_str() + pos + 1;
+            rtit->Measurements[mKey] = mVal;
+          } else {
+            rtit->Measurements[val] = "1";
           }
-          if (key == "MEASUREMENT") {
-            size_t pos = val.find_first_of('=');
-            if (pos != val.npos) {
-              std::string mKey = val.substr(0, pos);
-              const char* mVal = val.c_str() + pos + 1;
-              rtit->Measurements[mKey] = mVal;
-            } else {
-              rtit->Measurements[val] = "1";
-            }
+        }
+        if (key == "PASS_REGULAR_EXPRESSION") {
+          std::vector<std::string> lval;
+          cmSystemTools::ExpandListArgument(val, lval);
+          std::vector<std::string>::iterator crit;
+          for (crit = lval.begin(); crit != lval.end(); ++crit) {
+            rtit->RequiredRegularExpressions.push_back(
+              std::pair<cmsys::RegularExpression, std::string>(
+                cmsys::RegularExpression(crit->c_str()), std::string(*crit)));
           }
-          if (key == "PASS_REGULAR_EXPRESSION") {
+        }
+        if (key == "WORKING_DIRECTORY") {
+          rtit->Directory = val;
+        }
+        if (key == "TIMEOUT_AFTER_MATCH") {
+          std::vector<std::string> propArgs;
+          cmSystemTools::ExpandListArgument(val, propArgs);
+          if (propArgs.size() != 2) {
+            cmCTestLog(this->CTest, WARNING,
+                       "TIMEOUT_AFTER_MATCH expects two arguments, found "
+                         << propArgs.size() << std::endl);
+          } else {
+            rtit->AlternateTimeout = atof(propArgs[0].c_str());
             std::vector<std::string> lval;
-            cmSystemTools::ExpandListArgument(val, lval);
+            cmSystemTools::ExpandListArgument(propArgs[1], lval);
             std::vector<std::string>::iterator crit;
             for (crit = lval.begin(); crit != lval.end(); ++crit) {
-              rtit->RequiredRegularExpressions.push_back(
+              rtit->TimeoutRegularExpressions.push_back(
                 std::pair<cmsys::RegularExpression, std::string>(
                   cmsys::RegularExpression(crit->c_str()),
                   std::string(*crit)));
             }
           }
-          if (key == "WORKING_DIRECTORY") {
-            rtit->Directory = val;
-          }
-          if (key == "TIMEOUT_AFTER_MATCH") {
-            std::vector<std::string> propArgs;
-            cmSystemTools::ExpandListArgument(val, propArgs);
-            if (propArgs.size() != 2) {
-              cmCTestLog(this->CTest, WARNING,
-                         "TIMEOUT_AFTER_MATCH expects two arguments, found "
-                           << propArgs.size() << std::endl);
-            } else {
-              rtit->AlternateTimeout = atof(propArgs[0].c_str());
-              std::vector<std::string> lval;
-              cmSystemTools::ExpandListArgument(propArgs[1], lval);
-              std::vector<std::string>::iterator crit;
-              for (crit = lval.begin(); crit != lval.end(); ++crit) {
-                rtit->TimeoutRegularExpressions.push_back(
-                  std::pair<cmsys::RegularExpression, std::string>(
-                    cmsys::RegularExpression(crit->c_str()),
-                    std::string(*crit)));
-              }
-            }
-          }
         }
       }
     }
@@ -1975,6 +2351,7 @@ bool cmCTestTestHandler::AddTest(const std::vector<std::string>& args)
   test.Timeout = 0;
   test.ExplicitTimeout = false;
   test.Cost = 0;
+  test.RecentCost = 0;
   test.Processors = 1;
   test.SkipReturnCode = -1;
   test.PreviousRuns = 0;
@@ -1985,6 +2362,7 @@ bool cmCTestTestHandler::AddTest(const std::vector<std::string>& args)
              this->ExcludeTestsRegularExpression.find(testname.c_str())) {
     test.IsInBasedOnREOptions = false;
   }
+  this->TestListPositions[testname].push_back(this->TestList.size());
   this->TestList.push_back(test);
   return true;
 }
@@ -17,6 +17,7 @@
 
 #include <cmsys/RegularExpression.hxx>
 
+class cmFileTimeComparison;
 class cmMakefile;
 class cmXMLWriter;
 
@@ -115,6 +116,8 @@ public:
     bool IsInBasedOnREOptions;
     bool WillFail;
     float Cost;
+    // Exponentially weighted average of recent run times
+    float RecentCost;
     int PreviousRuns;
     bool RunSerial;
     double Timeout;
@@ -128,6 +131,8 @@ public:
     std::vector<std::string> Environment;
     std::vector<std::string> Labels;
     std::set<std::string> LockedResources;
+    // amount used from each named pool of resources while running
+    std::map<std::string, unsigned long> ResourceAmounts;
   };
 
   struct cmCTestTestResult
@@ -185,6 +190,9 @@ protected:
   //! Clean test output to specified length
   bool CleanTestOutput(std::string& output, size_t length);
 
+  //! Add the result of a finished test to TestResults
+  void RecordTestResult(cmCTestTestResult const& result);
+
   double ElapsedTestingTime;
 
   typedef std::vector<cmCTestTestResult> TestResultsVector;
@@ -220,6 +228,9 @@ private:
    * Generate the Dart compatible output
    */
   virtual void GenerateDartOutput(cmXMLWriter& xml);
+  void StartDartOutput(cmXMLWriter& xml);
+  void GenerateTestDartOutput(cmXMLWriter& xml, cmCTestTestResult* result);
+  void EndDartOutput(cmXMLWriter& xml);
 
   void PrintLabelSummary();
   /**
@@ -232,6 +243,13 @@ private:
    * Get the list of tests in directory and subdirectories.
    */
   void GetListOfTests();
+
+  /**
+   * Get the list of tests from the manifests written next to the
+   * CTestTestfile.cmake files of a build tree, if they are all up to date.
+   */
+  bool ReadTestManifests();
+  bool ReadTestManifest(std::string const& dir, cmFileTimeComparison& ftc);
   // compute the lists of tests that will actually run
   // based on union regex and -I stuff
   void ComputeTestList();
@@ -240,6 +258,10 @@ private:
   // based on LastTestFailed.log
   void ComputeTestListForRerunFailed();
 
+  // keep only the tests of the selected shard, which have about the
+  // same expected time as the other shards
+  void SelectShard();
+
   void UpdateMaxTestNameWidth();
 
   bool GetValue(const char* tag, std::string& value, std::istream& fin);
@@ -283,11 +305,19 @@ private:
 
   std::string TestsToRunString;
   bool UseUnion;
+  int ShardIndex;
+  int ShardCount;
+  bool PrintShardPlan;
   ListOfTests TestList;
+  // map from test name to the positions of the tests in TestList
+  typedef std::map<std::string, std::vector<size_t> > TestPositionMap;
+  TestPositionMap TestListPositions;
   size_t TotalNumberOfTests;
   cmsys::RegularExpression DartStuff;
 
   std::ostream* LogFile;
+  // XML file to which test results are written as the tests finish
+  cmXMLWriter* ResultsXML;
 
   bool RerunFailed;
 };
@@ -12,11 +12,19 @@
 #include "cmArchiveWrite.h"
 
 #include "cmLocale.h"
+#include "cmParallelJobs.h"
 #include "cmSystemTools.h"
 #include "cm_get_date.h"
 #include <cm_libarchive.h>
 #include <cmsys/Directory.hxx>
 #include <cmsys/FStream.hxx>
+#include <cmsys/SystemInformation.hxx>
+
+#if defined(CMake_ARCHIVE_WRITE_BLOCKS)
+#include <cm_bzlib.h>
+#include <cm_lzma.h>
+#include <cm_zlib.h>
+#endif
 
 #ifndef __LA_SSIZE_T
 #define __LA_SSIZE_T la_ssize_t
@@ -61,29 +69,248 @@ public:
   operator struct archive_entry*() { return this->Object; }
 };
 
+#if defined(CMake_ARCHIVE_WRITE_BLOCKS)
+/*
+ * Compress the uncompressed archive produced by libarchive in blocks.
+ * Blocks are collected until there is one for every thread, compressed
+ * concurrently, and written in order.  Each block becomes a complete
+ * gzip member, bzip2 stream, or xz stream.  The formats allow these to
+ * be concatenated, and decompressors produce the concatenated data.
+ */
+class cmArchiveWrite::BlockCompressor
+{
+public:
+  static bool Supports(Compress c)
+  {
+    return c == CompressGZip || c == CompressBZip2 || c == CompressXZ;
+  }
+
+  BlockCompressor(std::ostream& os, Compress c, size_t threads)
+    : Stream(os)
+    , Current(0)
+  {
+    // Larger blocks compress better and use more memory.  The xz block
+    // size is three times the dictionary size of the default preset,
+    // like "xz --threads" uses.
+    switch (c) {
+      case CompressBZip2:
+        this->BlockSize = 8 << 20;
+        break;
+      case CompressXZ:
+        this->BlockSize = 24 << 20;
+        break;
+      default:
+        this->BlockSize = 1 << 20;
+        break;
+    }
+    // Every block in flight holds its input and output in memory, so
+    // bound their number rather than taking one per thread.
+    size_t const maxBlocks = MaxBufferSize / this->BlockSize;
+    this->Blocks.resize(threads < maxBlocks ? threads : maxBlocks);
+    for (std::vector<Block>::iterator bi = this->Blocks.begin();
+         bi != this->Blocks.end(); ++bi) {
+      bi->Type = c;
+    }
+  }
+
+  bool Write(const char* data, size_t n)
+  {
+    while (n > 0) {
+      std::string& in = this->Blocks[this->Current].In;
+      size_t room = this->BlockSize - in.size();
+      size_t len = n < room ? n : room;
+      in.append(data, len);
+      data += len;
+      n -= len;
+      if (in.size() == this->BlockSize &&
+          ++this->Current == this->Blocks.size() && !this->Flush()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool Flush()
+  {
+    std::vector<void*> args;
+    for (std::vector<Block>::iterator bi = this->Blocks.begin();
+         bi != this->Blocks.end(); ++bi) {
+      if (!bi->In.empty()) {
+        args.push_back(&*bi);
+      }
+    }
+    cmParallelJobs::Run(&BlockCompressor::CompressBlock, args);
+
+    this->Current = 0;
+    bool okay = true;
+    for (std::vector<Block>::iterator bi = this->Blocks.begin();
+         okay && bi != this->Blocks.end(); ++bi) {
+      if (bi->In.empty()) {
+        break;
+      }
+      if (!bi->Error.empty()) {
+        this->Error = bi->Error;
+        okay = false;
+      } else if (!this->Stream.write(
+                   &bi->Out[0], static_cast<std::streamsize>(bi->OutSize))) {
+        this->Error = "Cannot write compressed archive block";
+        okay = false;
+      }
+      bi->In.erase();
+    }
+    return okay;
+  }
+
+  std::string const& GetError() const { return this->Error; }
+
+private:
+  // The total size of the uncompressed blocks in flight.
+  static const size_t MaxBufferSize = 256 << 20;
+
+  struct Block
+  {
+    Compress Type;
+    std::string In;
+    std::vector<char> Out;
+    size_t OutSize;
+    std::string Error;
+  };
+
+  static void CompressBlock(void* arg)
+  {
+    Block* b = static_cast<Block*>(arg);
+    b->Error.erase();
+    switch (b->Type) {
+      case CompressGZip:
+        CompressGZipBlock(*b);
+        break;
+      case CompressBZip2:
+        CompressBZip2Block(*b);
+        break;
+      case CompressXZ:
+        CompressXZBlock(*b);
+        break;
+      default:
+        b->Error = "Compression method does not support blocks";
+        break;
+    }
+  }
+
+  static void CompressGZipBlock(Block& b)
+  {
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    // A window size of 15 + 16 selects the gzip format.
+    if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+      b.Error = "deflateInit2 failed";
+      return;
+    }
+    // Older zlib versions do not count the gzip header in the bound.
+    b.Out.resize(deflateBound(&strm, static_cast<uLong>(b.In.size())) + 32);
+    strm.next_in = reinterpret_cast<Bytef*>(&b.In[0]);
+    strm.avail_in = static_cast<uInt>(b.In.size());
+    strm.next_out = reinterpret_cast<Bytef*>(&b.Out[0]);
+    strm.avail_out = static_cast<uInt>(b.Out.size());
+    if (deflate(&strm, Z_FINISH) != Z_STREAM_END) {
+      b.Error = "deflate failed";
+    }
+    b.OutSize = b.Out.size() - strm.avail_out;
+    deflateEnd(&strm);
+  }
+
+  static void CompressBZip2Block(Block& b)
+  {
+    // The bound is documented in the bzip2 manual.
+    unsigned int size =
+      static_cast<unsigned int>(b.In.size() + b.In.size() / 100 + 600);
+    b.Out.resize(size);
+    if (BZ2_bzBuffToBuffCompress(&b.Out[0], &size, &b.In[0],
+                                 static_cast<unsigned int>(b.In.size()), 9,
+                                 0, 30) != BZ_OK) {
+      b.Error = "BZ2_bzBuffToBuffCompress failed";
+    }
+    b.OutSize = size;
+  }
+
+  static void CompressXZBlock(Block& b)
+  {
+    b.Out.resize(lzma_stream_buffer_bound(b.In.size()));
+    size_t pos = 0;
+    if (lzma_easy_buffer_encode(
+          LZMA_PRESET_DEFAULT, LZMA_CHECK_CRC64, 0,
+          reinterpret_cast<const uint8_t*>(b.In.data()), b.In.size(),
+          reinterpret_cast<uint8_t*>(&b.Out[0]), &pos,
+          b.Out.size()) != LZMA_OK) {
+      b.Error = "lzma_easy_buffer_encode failed";
+    }
+    b.OutSize = pos;
+  }
+
+  std::ostream& Stream;
+  std::vector<Block> Blocks;
+  size_t Current;
+  size_t BlockSize;
+  std::string Error;
+};
+#else
+class cmArchiveWrite::BlockCompressor
+{
+public:
+  static bool Supports(Compress) { return false; }
+  BlockCompressor(std::ostream&, Compress, size_t) {}
+  bool Write(const char*, size_t) { return false; }
+  bool Flush() { return false; }
+  std::string GetError() const { return std::string(); }
+};
+#endif
+
 struct cmArchiveWrite::Callback
 {
   // archive_write_callback
-  static __LA_SSIZE_T Write(struct archive*, void* cd, const void* b, size_t n)
+  static __LA_SSIZE_T Write(struct archive* a, void* cd, const void* b,
+                            size_t n)
   {
     cmArchiveWrite* self = static_cast<cmArchiveWrite*>(cd);
+    if (self->Blocks) {
+      if (self->Blocks->Write(static_cast<const char*>(b), n)) {
+        return static_cast<__LA_SSIZE_T>(n);
+      }
+      archive_set_error(a, -1, "%s", self->Blocks->GetError().c_str());
+      return static_cast<__LA_SSIZE_T>(-1);
+    }
     if (self->Stream.write(static_cast<const char*>(b),
                            static_cast<std::streamsize>(n))) {
       return static_cast<__LA_SSIZE_T>(n);
     } else {
+      archive_set_error(a, -1, "Cannot write the archive");
       return static_cast<__LA_SSIZE_T>(-1);
     }
   }
 };
 
 cmArchiveWrite::cmArchiveWrite(std::ostream& os, Compress c,
-                               std::string const& format)
+                               std::string const& format, int threads)
   : Stream(os)
+  , Blocks(0)
   , Archive(archive_write_new())
   , Disk(archive_read_disk_new())
   , Verbose(false)
+  , Finished(false)
   , Format(format)
 {
+  if (threads == 0) {
+    cmsys::SystemInformation info;
+    info.RunCPUCheck();
+    threads = static_cast<int>(info.GetNumberOfLogicalCPU());
+  }
+  if (threads > 1 && BlockCompressor::Supports(c)) {
+    // Let libarchive write the uncompressed archive to the blocks.
+    this->Blocks =
+      new BlockCompressor(os, c, static_cast<size_t>(threads));
+    c = CompressNone;
+  }
+
   switch (c) {
     case CompressNone:
       if (archive_write_add_filter_none(this->Archive) != ARCHIVE_OK) {
@@ -163,7 +390,39 @@ cmArchiveWrite::cmArchiveWrite(std::ostream& os, Compress c,
 cmArchiveWrite::~cmArchiveWrite()
 {
   archive_read_free(this->Disk);
+  if (!this->Finished) {
+    // Discard an archive that was not finished instead of completing it.
+    archive_write_fail(this->Archive);
+  }
   archive_write_free(this->Archive);
+  delete this->Blocks;
+}
+
+bool cmArchiveWrite::Finish()
+{
+  if (this->Finished) {
+    return this->Okay();
+  }
+  this->Finished = true;
+  if (!this->Okay()) {
+    archive_write_fail(this->Archive);
+    return false;
+  }
+  if (archive_write_close(this->Archive) != ARCHIVE_OK) {
+    this->Error = "archive_write_close: ";
+    this->Error += cm_archive_error_string(this->Archive);
+    return false;
+  }
+  // Compress the remaining data.
+  if (this->Blocks && !this->Blocks->Flush()) {
+    this->Error = this->Blocks->GetError();
+    return false;
+  }
+  if (!this->Stream.flush()) {
+    this->Error = "Cannot write the archive";
+    return false;
+  }
+  return true;
 }
 
 bool cmArchiveWrite::Add(std::string path, size_t skip, const char* prefix,
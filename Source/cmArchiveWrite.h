@@ -58,9 +58,15 @@ public:
     CompressXZ
   };
 
-  /** Construct with output stream to which to write archive.  */
+  /**
+   * Construct with output stream to which to write archive.  With more
+   * than one thread, gzip, bzip2 and xz compression is done on blocks of
+   * the archive concurrently.  The output is then a sequence of
+   * independently compressed streams, which standard tools read as one.
+   * A thread count of 0 uses one thread per processor.
+   */
   cmArchiveWrite(std::ostream& os, Compress c = CompressNone,
-                 std::string const& format = "paxr");
+                 std::string const& format = "paxr", int threads = 1);
 
   ~cmArchiveWrite();
 
@@ -75,6 +81,13 @@ public:
   bool Add(std::string path, size_t skip = 0, const char* prefix = 0,
            bool recursive = true);
 
+  /**
+   * Write the end of the archive and any data still waiting to be
+   * compressed.  Returns true if there has been no error.  An archive
+   * that is not finished is discarded on destruction.
+   */
+  bool Finish();
+
   /** Returns true if there has been no error.  */
   operator safe_bool() const
   {
@@ -155,11 +168,14 @@ private:
   friend struct Callback;
 
   class Entry;
+  class BlockCompressor;
 
   std::ostream& Stream;
+  BlockCompressor* Blocks;
   struct archive* Archive;
   struct archive* Disk;
   bool Verbose;
+  bool Finished;
   std::string Format;
   std::string Error;
   std::string MTime;
@@ -360,6 +360,22 @@ void cmCTest::SetTestLoad(unsigned long load)
   this->TestLoad = load;
 }
 
+bool cmCTest::SetResourceCapacities(std::string const& capacities)
+{
+  std::vector<std::string> pools = cmSystemTools::tokenize(capacities, ",");
+  for (std::vector<std::string>::const_iterator i = pools.begin();
+       i != pools.end(); ++i) {
+    std::string::size_type eq = i->find('=');
+    unsigned long capacity;
+    if (eq == 0 || eq == std::string::npos ||
+        !cmSystemTools::StringToULong(i->c_str() + eq + 1, &capacity)) {
+      return false;
+    }
+    this->ResourceCapacities[i->substr(0, eq)] = capacity;
+  }
+  return !pools.empty();
+}
+
 bool cmCTest::ShouldCompressTestOutput()
 {
   if (!this->ComputedCompressTestOutput) {
@@ -1757,6 +1773,16 @@ bool cmCTest::HandleCommandLineArguments(size_t& i,
     }
   }
 
+  if (this->CheckArgument(arg, "--resource-capacity") &&
+      i < args.size() - 1) {
+    i++;
+    if (!this->SetResourceCapacities(args[i])) {
+      errormsg = "'--resource-capacity' given invalid value '" + args[i] +
+        "', expected <pool>=<capacity>[,<pool>=<capacity>...]";
+      return false;
+    }
+  }
+
   if (this->CheckArgument(arg, "--no-compress-output")) {
     this->CompressTestOutput = false;
     this->CompressMemCheckOutput = false;
@@ -1899,6 +1925,29 @@ bool cmCTest::HandleCommandLineArguments(size_t& i,
     this->GetHandler("memcheck")
       ->SetPersistentOption("TestsToRunInformation", args[i].c_str());
   }
+  if (this->CheckArgument(arg, "--shard") && i < args.size() - 1) {
+    i++;
+    std::string::size_type slash = args[i].find('/');
+    unsigned long index = 0;
+    unsigned long count = 0;
+    if (slash == std::string::npos ||
+        !cmSystemTools::StringToULong(args[i].substr(0, slash).c_str(),
+                                      &index) ||
+        !cmSystemTools::StringToULong(args[i].c_str() + slash + 1, &count) ||
+        index < 1 || index > count) {
+      errormsg = "'--shard' given invalid value '" + args[i] +
+        "', expected <index>/<count> with 1 <= <index> <= <count>";
+      return false;
+    }
+    this->GetHandler("test")->SetPersistentOption("Shard", args[i].c_str());
+    this->GetHandler("memcheck")->SetPersistentOption("Shard",
+                                                      args[i].c_str());
+  }
+  if (this->CheckArgument(arg, "--print-shard-plan")) {
+    this->GetHandler("test")->SetPersistentOption("PrintShardPlan", "true");
+    this->GetHandler("memcheck")
+      ->SetPersistentOption("PrintShardPlan", "true");
+  }
   if (this->CheckArgument(arg, "-U", "--union")) {
     this->GetHandler("test")->SetPersistentOption("UseUnion", "true");
     this->GetHandler("memcheck")->SetPersistentOption("UseUnion", "true");
@@ -2110,6 +2159,10 @@ int cmCTest::Run(std::vector<std::string>& args, std::string* output)
       this->ScheduleType = "Random";
     }
 
+    if (this->CheckArgument(arg, "--schedule-critical-path")) {
+      this->ScheduleType = "CriticalPath";
+    }
+
     // pass the argument to all the handlers as well, but i may no longer be
     // set to what it was originally so I'm not sure this is working as
     // intended
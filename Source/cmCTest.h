@@ -169,6 +169,13 @@ public:
   unsigned long GetTestLoad() { return this->TestLoad; }
   void SetTestLoad(unsigned long);
 
+  // capacity of each named pool of resources shared by parallel tests
+  std::map<std::string, unsigned long> const& GetResourceCapacities()
+  {
+    return this->ResourceCapacities;
+  }
+  bool SetResourceCapacities(std::string const& capacities);
+
   /**
    * Check if CTest file exists
    */
@@ -518,6 +525,8 @@ private:
 
   unsigned long TestLoad;
 
+  std::map<std::string, unsigned long> ResourceCapacities;
+
   int CompatibilityMode;
 
   // information for the --build-and-test options
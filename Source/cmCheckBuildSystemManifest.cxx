@@ -0,0 +1,176 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmCheckBuildSystemManifest.h"
+
+#include "cmFileTimeComparison.h"
+#include "cmSystemTools.h"
+
+#include <cmsys/FStream.hxx>
+
+// The file starts with a signature, a format version and a byte order
+// mark, followed by length-prefixed strings and string lists in native
+// byte order.  It is only ever read on the machine that wrote it.
+static const char cmCheckBuildSystemManifestSignature[8] = {
+  'C', 'M', 'a', 'k', 'e', 'C', 'B', 'S'
+};
+static const unsigned int cmCheckBuildSystemManifestVersion = 2;
+static const unsigned int cmCheckBuildSystemManifestByteOrder = 0x01020304;
+
+namespace {
+class ManifestWriter
+{
+public:
+  ManifestWriter(std::string& out)
+    : Out(out)
+  {
+  }
+  void Number(unsigned int n)
+  {
+    this->Out.append(reinterpret_cast<const char*>(&n), sizeof(n));
+  }
+  void String(std::string const& s)
+  {
+    this->Number(static_cast<unsigned int>(s.size()));
+    this->Out.append(s);
+  }
+  void List(std::vector<std::string> const& l)
+  {
+    this->Number(static_cast<unsigned int>(l.size()));
+    for (std::vector<std::string>::const_iterator i = l.begin(); i != l.end();
+         ++i) {
+      this->String(*i);
+    }
+  }
+
+private:
+  std::string& Out;
+};
+
+class ManifestReader
+{
+public:
+  ManifestReader(std::string const& in)
+    : In(in)
+    , Pos(0)
+  {
+  }
+  bool Number(unsigned int& n)
+  {
+    if (this->In.size() - this->Pos < sizeof(n)) {
+      return false;
+    }
+    memcpy(&n, this->In.data() + this->Pos, sizeof(n));
+    this->Pos += sizeof(n);
+    return true;
+  }
+  bool String(std::string& s)
+  {
+    unsigned int n;
+    if (!this->Number(n) || this->In.size() - this->Pos < n) {
+      return false;
+    }
+    s.assign(this->In, this->Pos, n);
+    this->Pos += n;
+    return true;
+  }
+  bool List(std::vector<std::string>& l)
+  {
+    unsigned int n;
+    if (!this->Number(n) || this->In.size() - this->Pos < n) {
+      return false;
+    }
+    l.resize(n);
+    for (std::vector<std::string>::iterator i = l.begin(); i != l.end();
+         ++i) {
+      if (!this->String(*i)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  bool AtEnd() const { return this->Pos == this->In.size(); }
+
+private:
+  std::string const& In;
+  std::string::size_type Pos;
+};
+}
+
+std::string cmCheckBuildSystemManifest::GetManifestFile(
+  std::string const& checkFile)
+{
+  return checkFile + ".bin";
+}
+
+bool cmCheckBuildSystemManifest::Write(std::string const& checkFile) const
+{
+  std::string data(cmCheckBuildSystemManifestSignature,
+                   sizeof(cmCheckBuildSystemManifestSignature));
+  ManifestWriter w(data);
+  w.Number(cmCheckBuildSystemManifestVersion);
+  w.Number(cmCheckBuildSystemManifestByteOrder);
+  w.String(this->Generator);
+  w.List(this->Products);
+  w.List(this->Depends);
+  w.List(this->Outputs);
+  w.List(this->DependInfoFiles);
+
+  std::string fname = GetManifestFile(checkFile);
+  cmsys::ofstream fout(fname.c_str(), std::ios::out | std::ios::binary);
+  if (!fout) {
+    return false;
+  }
+  fout.write(data.data(), static_cast<std::streamsize>(data.size()));
+  fout.close();
+  if (!fout) {
+    cmSystemTools::RemoveFile(fname);
+    return false;
+  }
+  return true;
+}
+
+bool cmCheckBuildSystemManifest::Read(std::string const& checkFile)
+{
+  // The manifest is stale if the check file was written after it.
+  std::string fname = GetManifestFile(checkFile);
+  cmFileTimeComparison ftc;
+  int result = 0;
+  if (!ftc.FileTimeCompare(fname.c_str(), checkFile.c_str(), &result) ||
+      result < 0) {
+    return false;
+  }
+
+  cmsys::ifstream fin(fname.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  std::string data((std::istreambuf_iterator<char>(fin)),
+                   std::istreambuf_iterator<char>());
+  if (data.size() < sizeof(cmCheckBuildSystemManifestSignature) ||
+      data.compare(0, sizeof(cmCheckBuildSystemManifestSignature),
+                   cmCheckBuildSystemManifestSignature,
+                   sizeof(cmCheckBuildSystemManifestSignature)) != 0) {
+    return false;
+  }
+  data.erase(0, sizeof(cmCheckBuildSystemManifestSignature));
+
+  ManifestReader r(data);
+  unsigned int version;
+  unsigned int byteOrder;
+  return (r.Number(version) &&
+          version == cmCheckBuildSystemManifestVersion &&
+          r.Number(byteOrder) &&
+          byteOrder == cmCheckBuildSystemManifestByteOrder &&
+          r.String(this->Generator) && r.List(this->Products) &&
+          r.List(this->Depends) && r.List(this->Outputs) &&
+          r.List(this->DependInfoFiles) && r.AtEnd());
+}
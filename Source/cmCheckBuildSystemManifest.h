@@ -0,0 +1,57 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#ifndef cmCheckBuildSystemManifest_h
+#define cmCheckBuildSystemManifest_h
+
+#include "cmStandardIncludes.h"
+
+/** \class cmCheckBuildSystemManifest
+ * \brief Binary copy of the information read by --check-build-system.
+ *
+ * The Makefile generators write CMakeFiles/Makefile.cmake for the
+ * "cmake --check-build-system" step run by every make invocation.
+ * Reading it requires interpreting the CMake language.  The same lists
+ * are also stored in a compact binary file next to it, which can be read
+ * directly.  The binary file is only trusted when it is not older than
+ * the .cmake file it accompanies.
+ */
+class cmCheckBuildSystemManifest
+{
+public:
+  /** Name of the generator that produced the build system.  */
+  std::string Generator;
+
+  /** Files generated by CMake that must exist (CMAKE_MAKEFILE_PRODUCTS).  */
+  std::vector<std::string> Products;
+
+  /** Inputs of the generate step (CMAKE_MAKEFILE_DEPENDS).  */
+  std::vector<std::string> Depends;
+
+  /** Outputs of the generate step (CMAKE_MAKEFILE_OUTPUTS).  */
+  std::vector<std::string> Outputs;
+
+  /** Dependency information files of the targets, whose dependencies
+      are cleared by "make depend" (CMAKE_DEPEND_INFO_FILES).  */
+  std::vector<std::string> DependInfoFiles;
+
+  /** Return the binary file accompanying the given check file.  */
+  static std::string GetManifestFile(std::string const& checkFile);
+
+  /** Write the manifest for the given check file.  */
+  bool Write(std::string const& checkFile) const;
+
+  /** Read the manifest for the given check file.  Returns false if it is
+      missing, malformed, or older than the check file.  */
+  bool Read(std::string const& checkFile);
+};
+
+#endif
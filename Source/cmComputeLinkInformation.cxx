@@ -19,6 +19,7 @@
 #include "cmGlobalGenerator.h"
 #include "cmLocalGenerator.h"
 #include "cmMakefile.h"
+#include "cmMakefileProfilingData.h"
 #include "cmOutputConverter.h"
 #include "cmState.h"
 #include "cmake.h"
@@ -243,6 +244,9 @@ because this need be done only for shared libraries without soname-s.
 cmComputeLinkInformation::cmComputeLinkInformation(
   const cmGeneratorTarget* target, const std::string& config)
 {
+  cmMakefileProfilingData::Count(
+    cmMakefileProfilingData::LinkInformationComputations);
+
   // Store context information.
   this->Target = target;
   this->Makefile = this->Target->Target->GetMakefile();
@@ -15,6 +15,8 @@
 #include "cmAlgorithms.h"
 #include "cmOutputConverter.h"
 
+#include <map>
+
 static std::string const keyAND = "AND";
 static std::string const keyCOMMAND = "COMMAND";
 static std::string const keyDEFINED = "DEFINED";
@@ -42,11 +44,513 @@ static std::string const keyVERSION_EQUAL = "VERSION_EQUAL";
 static std::string const keyVERSION_GREATER = "VERSION_GREATER";
 static std::string const keyVERSION_LESS = "VERSION_LESS";
 
+namespace {
+// The keywords, in the order of the layout characters after 'A'.
+enum cmConditionKeyword
+{
+  KeyNone,
+  KeyAND,
+  KeyCOMMAND,
+  KeyDEFINED,
+  KeyEQUAL,
+  KeyEXISTS,
+  KeyGREATER,
+  KeyIN_LIST,
+  KeyIS_ABSOLUTE,
+  KeyIS_DIRECTORY,
+  KeyIS_NEWER_THAN,
+  KeyIS_SYMLINK,
+  KeyLESS,
+  KeyMATCHES,
+  KeyNOT,
+  KeyOR,
+  KeyParenL,
+  KeyParenR,
+  KeyPOLICY,
+  KeySTREQUAL,
+  KeySTRGREATER,
+  KeySTRLESS,
+  KeyTARGET,
+  KeyTEST,
+  KeyVERSION_EQUAL,
+  KeyVERSION_GREATER,
+  KeyVERSION_LESS,
+  KeyCount
+};
+
+std::string const* const cmConditionKeywords[KeyCount] = {
+  0,
+  &keyAND,
+  &keyCOMMAND,
+  &keyDEFINED,
+  &keyEQUAL,
+  &keyEXISTS,
+  &keyGREATER,
+  &keyIN_LIST,
+  &keyIS_ABSOLUTE,
+  &keyIS_DIRECTORY,
+  &keyIS_NEWER_THAN,
+  &keyIS_SYMLINK,
+  &keyLESS,
+  &keyMATCHES,
+  &keyNOT,
+  &keyOR,
+  &keyParenL,
+  &keyParenR,
+  &keyPOLICY,
+  &keySTREQUAL,
+  &keySTRGREATER,
+  &keySTRLESS,
+  &keyTARGET,
+  &keyTEST,
+  &keyVERSION_EQUAL,
+  &keyVERSION_GREATER,
+  &keyVERSION_LESS
+};
+}
+
+// The operations and programs have external linkage, as the evaluator
+// refers to programs in its header.
+enum cmConditionOpType
+{
+  OpExists,
+  OpIsDirectory,
+  OpIsSymlink,
+  OpIsAbsolute,
+  OpCommand,
+  OpPolicy,
+  OpTarget,
+  OpTest,
+  OpDefined,
+  OpMatches,
+  OpFalse,
+  OpLess,
+  OpGreater,
+  OpEqual,
+  OpStrLess,
+  OpStrGreater,
+  OpStrEqual,
+  OpVersionLess,
+  OpVersionGreater,
+  OpVersionEqual,
+  OpIsNewerThan,
+  OpInList,
+  OpNot,
+  OpAnd,
+  OpOr,
+  OpGroup,
+  OpMismatchedParen
+};
+
+// An operation storing its result in a slot.  Lhs and Rhs are the
+// slots of the operands, and Group the group evaluated by OpGroup.
+struct cmConditionOp
+{
+  cmConditionOpType Type;
+  size_t Lhs;
+  size_t Rhs;
+  size_t Group;
+  size_t Result;
+};
+
+// The operations reducing the arguments of a parenthetical group, or
+// of the whole condition, and the slot holding the one argument left.
+struct cmConditionGroup
+{
+  cmConditionGroup()
+    : Empty(false)
+    , Single(false)
+    , Result(0)
+  {
+  }
+  std::vector<cmConditionOp> Ops;
+  bool Empty;
+  bool Single;
+  size_t Result;
+};
+
+// The operations to evaluate any condition with a given layout of
+// keywords and operands.  The first slots hold the arguments and the
+// rest the results of the operations.  Group 0 is the whole condition.
+struct cmConditionProgram
+{
+  cmConditionProgram()
+    : Slots(0)
+  {
+  }
+  std::vector<cmConditionGroup> Groups;
+  size_t Slots;
+};
+
+namespace {
+// Compile a condition by reducing the slots of its arguments in the
+// same way and order as cmConditionEvaluator::Reduce reduces their
+// values.  Whether an argument is a keyword is all that decides how
+// the arguments are reduced, and the results of operations, being
+// quoted "1" or "0", are never keywords.
+class cmConditionCompiler
+{
+public:
+  typedef std::list<size_t> SlotList;
+
+  cmConditionCompiler(std::string const& layout, cmConditionProgram& program)
+    : Layout(layout)
+    , Program(program)
+  {
+  }
+
+  void Compile()
+  {
+    this->Program.Slots = this->Layout.size();
+    SlotList slots;
+    for (size_t i = 0; i < this->Layout.size(); ++i) {
+      slots.push_back(i);
+    }
+    this->CompileGroup(slots);
+  }
+
+private:
+  int Key(size_t slot) const
+  {
+    return slot < this->Layout.size() ? this->Layout[slot] - 'A' : KeyNone;
+  }
+
+  size_t CompileGroup(SlotList& slots)
+  {
+    size_t group = this->Program.Groups.size();
+    this->Program.Groups.push_back(cmConditionGroup());
+    if (slots.empty()) {
+      this->Program.Groups[group].Empty = true;
+      return group;
+    }
+
+    std::vector<cmConditionOp> ops;
+    if (this->Level0(slots, ops)) {
+      this->Level1(slots, ops);
+      this->Level2(slots, ops);
+      this->Level3(slots, ops);
+      this->Level4(slots, ops);
+      this->Program.Groups[group].Single = slots.size() == 1;
+      this->Program.Groups[group].Result = slots.front();
+    }
+    this->Program.Groups[group].Ops.swap(ops);
+    return group;
+  }
+
+  size_t AddOp(std::vector<cmConditionOp>& ops, cmConditionOpType type,
+               size_t lhs, size_t rhs)
+  {
+    cmConditionOp op;
+    op.Type = type;
+    op.Lhs = lhs;
+    op.Rhs = rhs;
+    op.Group = 0;
+    op.Result = this->Program.Slots++;
+    ops.push_back(op);
+    return op.Result;
+  }
+
+  void Increment(SlotList& slots, SlotList::iterator& argP1,
+                 SlotList::iterator& argP2) const
+  {
+    if (argP1 != slots.end()) {
+      argP1++;
+      argP2 = argP1;
+      if (argP1 != slots.end()) {
+        argP2++;
+      }
+    }
+  }
+
+  void Predicate(cmConditionOpType type, std::vector<cmConditionOp>& ops,
+                 int& reducible, SlotList::iterator& arg, SlotList& slots,
+                 SlotList::iterator& argP1, SlotList::iterator& argP2)
+  {
+    *arg = this->AddOp(ops, type, *argP1, *argP1);
+    slots.erase(argP1);
+    argP1 = arg;
+    this->Increment(slots, argP1, argP2);
+    reducible = 1;
+  }
+
+  void BinaryOp(cmConditionOpType type, std::vector<cmConditionOp>& ops,
+                int& reducible, SlotList::iterator& arg, SlotList& slots,
+                SlotList::iterator& argP1, SlotList::iterator& argP2)
+  {
+    *arg = this->AddOp(ops, type, *arg, *argP2);
+    slots.erase(argP2);
+    slots.erase(argP1);
+    argP1 = arg;
+    this->Increment(slots, argP1, argP2);
+    reducible = 1;
+  }
+
+  bool Level0(SlotList& slots, std::vector<cmConditionOp>& ops)
+  {
+    for (SlotList::iterator arg = slots.begin(); arg != slots.end(); ++arg) {
+      if (this->Key(*arg) != KeyParenL) {
+        continue;
+      }
+      SlotList::iterator argClose = arg;
+      argClose++;
+      unsigned int depth = 1;
+      while (argClose != slots.end() && depth) {
+        if (this->Key(*argClose) == KeyParenL) {
+          depth++;
+        }
+        if (this->Key(*argClose) == KeyParenR) {
+          depth--;
+        }
+        argClose++;
+      }
+      if (depth) {
+        this->AddOp(ops, OpMismatchedParen, 0, 0);
+        return false;
+      }
+      SlotList::iterator argP1 = arg;
+      argP1++;
+      SlotList inner(argP1, argClose);
+      inner.pop_back();
+      cmConditionOp op;
+      op.Type = OpGroup;
+      op.Lhs = 0;
+      op.Rhs = 0;
+      op.Group = this->CompileGroup(inner);
+      op.Result = this->Program.Slots++;
+      ops.push_back(op);
+      *arg = op.Result;
+      slots.erase(argP1, argClose);
+    }
+    return true;
+  }
+
+  void Level1(SlotList& slots, std::vector<cmConditionOp>& ops)
+  {
+    int reducible;
+    do {
+      reducible = 0;
+      SlotList::iterator arg = slots.begin();
+      SlotList::iterator argP1;
+      SlotList::iterator argP2;
+      while (arg != slots.end()) {
+        argP1 = arg;
+        this->Increment(slots, argP1, argP2);
+        if (argP1 != slots.end()) {
+          switch (this->Key(*arg)) {
+            case KeyEXISTS:
+              this->Predicate(OpExists, ops, reducible, arg, slots, argP1,
+                              argP2);
+              break;
+            case KeyIS_DIRECTORY:
+              this->Predicate(OpIsDirectory, ops, reducible, arg, slots,
+                              argP1, argP2);
+              break;
+            case KeyIS_SYMLINK:
+              this->Predicate(OpIsSymlink, ops, reducible, arg, slots, argP1,
+                              argP2);
+              break;
+            case KeyIS_ABSOLUTE:
+              this->Predicate(OpIsAbsolute, ops, reducible, arg, slots,
+                              argP1, argP2);
+              break;
+            case KeyCOMMAND:
+              this->Predicate(OpCommand, ops, reducible, arg, slots, argP1,
+                              argP2);
+              break;
+            case KeyPOLICY:
+              this->Predicate(OpPolicy, ops, reducible, arg, slots, argP1,
+                              argP2);
+              break;
+            case KeyTARGET:
+              this->Predicate(OpTarget, ops, reducible, arg, slots, argP1,
+                              argP2);
+              break;
+            case KeyTEST:
+              this->Predicate(OpTest, ops, reducible, arg, slots, argP1,
+                              argP2);
+              break;
+            case KeyDEFINED:
+              this->Predicate(OpDefined, ops, reducible, arg, slots, argP1,
+                              argP2);
+              break;
+          }
+        }
+        ++arg;
+      }
+    } while (reducible);
+  }
+
+  void Level2(SlotList& slots, std::vector<cmConditionOp>& ops)
+  {
+    int reducible;
+    do {
+      reducible = 0;
+      SlotList::iterator arg = slots.begin();
+      SlotList::iterator argP1;
+      SlotList::iterator argP2;
+      while (arg != slots.end()) {
+        argP1 = arg;
+        this->Increment(slots, argP1, argP2);
+        if (argP1 != slots.end() && argP2 != slots.end() &&
+            this->Key(*argP1) == KeyMATCHES) {
+          this->BinaryOp(OpMatches, ops, reducible, arg, slots, argP1, argP2);
+        }
+        if (argP1 != slots.end() && this->Key(*arg) == KeyMATCHES) {
+          *arg = this->AddOp(ops, OpFalse, 0, 0);
+          slots.erase(argP1);
+          argP1 = arg;
+          this->Increment(slots, argP1, argP2);
+          reducible = 1;
+        }
+        if (argP1 != slots.end() && argP2 != slots.end()) {
+          switch (this->Key(*argP1)) {
+            case KeyLESS:
+              this->BinaryOp(OpLess, ops, reducible, arg, slots, argP1,
+                             argP2);
+              break;
+            case KeyGREATER:
+              this->BinaryOp(OpGreater, ops, reducible, arg, slots, argP1,
+                             argP2);
+              break;
+            case KeyEQUAL:
+              this->BinaryOp(OpEqual, ops, reducible, arg, slots, argP1,
+                             argP2);
+              break;
+          }
+        }
+        if (argP1 != slots.end() && argP2 != slots.end()) {
+          switch (this->Key(*argP1)) {
+            case KeySTRLESS:
+              this->BinaryOp(OpStrLess, ops, reducible, arg, slots, argP1,
+                             argP2);
+              break;
+            case KeySTREQUAL:
+              this->BinaryOp(OpStrEqual, ops, reducible, arg, slots, argP1,
+                             argP2);
+              break;
+            case KeySTRGREATER:
+              this->BinaryOp(OpStrGreater, ops, reducible, arg, slots, argP1,
+                             argP2);
+              break;
+          }
+        }
+        if (argP1 != slots.end() && argP2 != slots.end()) {
+          switch (this->Key(*argP1)) {
+            case KeyVERSION_LESS:
+              this->BinaryOp(OpVersionLess, ops, reducible, arg, slots,
+                             argP1, argP2);
+              break;
+            case KeyVERSION_GREATER:
+              this->BinaryOp(OpVersionGreater, ops, reducible, arg, slots,
+                             argP1, argP2);
+              break;
+            case KeyVERSION_EQUAL:
+              this->BinaryOp(OpVersionEqual, ops, reducible, arg, slots,
+                             argP1, argP2);
+              break;
+          }
+        }
+        if (argP1 != slots.end() && argP2 != slots.end() &&
+            this->Key(*argP1) == KeyIS_NEWER_THAN) {
+          this->BinaryOp(OpIsNewerThan, ops, reducible, arg, slots, argP1,
+                         argP2);
+        }
+        if (argP1 != slots.end() && argP2 != slots.end() &&
+            this->Key(*argP1) == KeyIN_LIST) {
+          this->BinaryOp(OpInList, ops, reducible, arg, slots, argP1, argP2);
+        }
+        ++arg;
+      }
+    } while (reducible);
+  }
+
+  void Level3(SlotList& slots, std::vector<cmConditionOp>& ops)
+  {
+    int reducible;
+    do {
+      reducible = 0;
+      SlotList::iterator arg = slots.begin();
+      SlotList::iterator argP1;
+      SlotList::iterator argP2;
+      while (arg != slots.end()) {
+        argP1 = arg;
+        this->Increment(slots, argP1, argP2);
+        if (argP1 != slots.end() && this->Key(*arg) == KeyNOT) {
+          this->Predicate(OpNot, ops, reducible, arg, slots, argP1, argP2);
+        }
+        ++arg;
+      }
+    } while (reducible);
+  }
+
+  void Level4(SlotList& slots, std::vector<cmConditionOp>& ops)
+  {
+    int reducible;
+    do {
+      reducible = 0;
+      SlotList::iterator arg = slots.begin();
+      SlotList::iterator argP1;
+      SlotList::iterator argP2;
+      while (arg != slots.end()) {
+        argP1 = arg;
+        this->Increment(slots, argP1, argP2);
+        if (argP1 != slots.end() && this->Key(*argP1) == KeyAND &&
+            argP2 != slots.end()) {
+          this->BinaryOp(OpAnd, ops, reducible, arg, slots, argP1, argP2);
+        }
+        if (argP1 != slots.end() && this->Key(*argP1) == KeyOR &&
+            argP2 != slots.end()) {
+          this->BinaryOp(OpOr, ops, reducible, arg, slots, argP1, argP2);
+        }
+        ++arg;
+      }
+    } while (reducible);
+  }
+
+  std::string const& Layout;
+  cmConditionProgram& Program;
+};
+}
+
+static cmConditionProgram const& cmConditionGetProgram(
+  std::string const& layout)
+{
+  // The program depends on nothing but the layout, so share it between
+  // all conditions with the same layout.
+  typedef std::map<std::string, cmConditionProgram> ProgramMap;
+  static ProgramMap programs;
+  ProgramMap::iterator i = programs.find(layout);
+  if (i == programs.end()) {
+    i = programs.insert(ProgramMap::value_type(layout, cmConditionProgram()))
+          .first;
+    cmConditionCompiler(layout, i->second).Compile();
+  }
+  return i->second;
+}
+
+static int cmConditionFindKeyword(std::string const& value)
+{
+  // All keywords are short and start with an upper case letter or a
+  // parenthesis.
+  if (value.empty() || value.size() > 15 ||
+      !((value[0] >= 'A' && value[0] <= 'Z') || value[0] == '(' ||
+        value[0] == ')')) {
+    return KeyNone;
+  }
+  for (int key = KeyNone + 1; key < KeyCount; ++key) {
+    if (value == *cmConditionKeywords[key]) {
+      return key;
+    }
+  }
+  return KeyNone;
+}
+
+static cmExpandedCommandArgument const conditionTrue("1", true);
+static cmExpandedCommandArgument const conditionFalse("0", true);
+
 cmConditionEvaluator::cmConditionEvaluator(cmMakefile& makefile,
-                                           const cmListFileContext& context,
                                            const cmListFileBacktrace& bt)
   : Makefile(makefile)
-  , ExecutionContext(context)
   , Backtrace(bt)
   , Policy12Status(makefile.GetPolicyStatus(cmPolicies::CMP0012))
   , Policy54Status(makefile.GetPolicyStatus(cmPolicies::CMP0054))
@@ -74,6 +578,237 @@ cmConditionEvaluator::cmConditionEvaluator(cmMakefile& makefile,
 bool cmConditionEvaluator::IsTrue(
   const std::vector<cmExpandedCommandArgument>& args, std::string& errorString,
   cmake::MessageType& status)
+{
+  // Evaluate the program compiled for the layout of the arguments,
+  // unless reducing them may warn about a policy.
+  std::string layout;
+  if (args.empty() || !this->GetLayout(args, layout)) {
+    return this->Reduce(args, errorString, status);
+  }
+  cmConditionProgram const& program = cmConditionGetProgram(layout);
+  std::vector<cmExpandedCommandArgument const*> slots(program.Slots);
+  for (size_t i = 0; i < args.size(); ++i) {
+    slots[i] = &args[i];
+  }
+  return this->Run(program, 0, slots, errorString, status);
+}
+
+//=========================================================================
+bool cmConditionEvaluator::GetLayout(
+  const std::vector<cmExpandedCommandArgument>& args,
+  std::string& layout) const
+{
+  bool const quotedKeywords = this->Policy54Status == cmPolicies::WARN ||
+    this->Policy54Status == cmPolicies::OLD;
+  layout.reserve(args.size());
+  for (std::vector<cmExpandedCommandArgument>::const_iterator arg =
+         args.begin();
+       arg != args.end(); ++arg) {
+    int key = KeyNone;
+    if (!arg->WasQuoted() || quotedKeywords) {
+      key = cmConditionFindKeyword(arg->GetValue());
+    }
+    if (key != KeyNone && arg->WasQuoted() &&
+        this->Policy54Status == cmPolicies::WARN) {
+      return false;
+    }
+    if (key == KeyTEST && (this->Policy64Status == cmPolicies::OLD ||
+                           this->Policy64Status == cmPolicies::WARN)) {
+      if (this->Policy64Status == cmPolicies::WARN) {
+        return false;
+      }
+      key = KeyNone;
+    }
+    if (key == KeyIN_LIST && (this->Policy57Status == cmPolicies::OLD ||
+                              this->Policy57Status == cmPolicies::WARN)) {
+      if (this->Policy57Status == cmPolicies::WARN) {
+        return false;
+      }
+      key = KeyNone;
+    }
+    layout += static_cast<char>('A' + key);
+  }
+  return true;
+}
+
+//=========================================================================
+bool cmConditionEvaluator::Run(
+  cmConditionProgram const& program, size_t group,
+  std::vector<cmExpandedCommandArgument const*>& slots,
+  std::string& errorString, cmake::MessageType& status)
+{
+  errorString = "";
+
+  cmConditionGroup const& g = program.Groups[group];
+  if (g.Empty) {
+    return false;
+  }
+
+  std::string def_buf;
+  for (std::vector<cmConditionOp>::const_iterator op = g.Ops.begin();
+       op != g.Ops.end(); ++op) {
+    cmExpandedCommandArgument const& lhs = *slots[op->Lhs];
+    cmExpandedCommandArgument const& rhs = *slots[op->Rhs];
+    bool result = false;
+    switch (op->Type) {
+      case OpExists:
+        result = cmSystemTools::FileExists(rhs.c_str());
+        break;
+      case OpIsDirectory:
+        result = cmSystemTools::FileIsDirectory(rhs.c_str());
+        break;
+      case OpIsSymlink:
+        result = cmSystemTools::FileIsSymlink(rhs.c_str());
+        break;
+      case OpIsAbsolute:
+        result = cmSystemTools::FileIsFullPath(rhs.c_str());
+        break;
+      case OpCommand:
+        result = this->Makefile.GetState()->GetCommand(rhs.c_str()) != 0;
+        break;
+      case OpPolicy: {
+        cmPolicies::PolicyID pid;
+        result = cmPolicies::GetPolicyID(rhs.c_str(), pid);
+      } break;
+      case OpTarget:
+        result = this->Makefile.FindTargetToUse(rhs.GetValue()) != 0;
+        break;
+      case OpTest:
+        result = this->Makefile.GetTest(rhs.c_str()) != 0;
+        break;
+      case OpDefined: {
+        size_t rhslen = rhs.GetValue().size();
+        if (rhslen > 4 && rhs.GetValue().substr(0, 4) == "ENV{" &&
+            rhs.GetValue()[rhslen - 1] == '}') {
+          std::string env = rhs.GetValue().substr(4, rhslen - 5);
+          result = cmSystemTools::GetEnv(env.c_str()) ? true : false;
+        } else {
+          result = this->Makefile.IsDefinitionSet(rhs.GetValue());
+        }
+      } break;
+      case OpMatches: {
+        const char* def = this->GetVariableOrString(lhs);
+        if (def != lhs.c_str() // yes, we compare the pointer value
+            && cmHasLiteralPrefix(lhs.GetValue(), "CMAKE_MATCH_")) {
+          // The string to match is owned by our match result variables.
+          // Move it to our own buffer before clearing them.
+          def_buf = def;
+          def = def_buf.c_str();
+        }
+        const char* rex = rhs.c_str();
+        this->Makefile.ClearMatches();
+        cmsys::RegularExpression regEntry;
+        if (!regEntry.compile(rex)) {
+          std::ostringstream error;
+          error << "Regular expression \"" << rex << "\" cannot compile";
+          errorString = error.str();
+          status = cmake::FATAL_ERROR;
+          return false;
+        }
+        if (regEntry.find(def)) {
+          this->Makefile.StoreMatches(regEntry);
+          result = true;
+        }
+      } break;
+      case OpFalse:
+        break;
+      case OpLess:
+      case OpGreater:
+      case OpEqual: {
+        const char* def = this->GetVariableOrString(lhs);
+        const char* def2 = this->GetVariableOrString(rhs);
+        double l;
+        double r;
+        if (sscanf(def, "%lg", &l) != 1 || sscanf(def2, "%lg", &r) != 1) {
+          result = false;
+        } else if (op->Type == OpLess) {
+          result = (l < r);
+        } else if (op->Type == OpGreater) {
+          result = (l > r);
+        } else {
+          result = (l == r);
+        }
+      } break;
+      case OpStrLess:
+      case OpStrGreater:
+      case OpStrEqual: {
+        const char* def = this->GetVariableOrString(lhs);
+        const char* def2 = this->GetVariableOrString(rhs);
+        int val = strcmp(def, def2);
+        if (op->Type == OpStrLess) {
+          result = (val < 0);
+        } else if (op->Type == OpStrGreater) {
+          result = (val > 0);
+        } else {
+          result = (val == 0);
+        }
+      } break;
+      case OpVersionLess:
+      case OpVersionGreater:
+      case OpVersionEqual: {
+        const char* def = this->GetVariableOrString(lhs);
+        const char* def2 = this->GetVariableOrString(rhs);
+        cmSystemTools::CompareOp cop = cmSystemTools::OP_EQUAL;
+        if (op->Type == OpVersionLess) {
+          cop = cmSystemTools::OP_LESS;
+        } else if (op->Type == OpVersionGreater) {
+          cop = cmSystemTools::OP_GREATER;
+        }
+        result = cmSystemTools::VersionCompare(cop, def, def2);
+      } break;
+      case OpIsNewerThan: {
+        int fileIsNewer = 0;
+        bool success = cmSystemTools::FileTimeCompare(
+          lhs.GetValue(), rhs.GetValue(), &fileIsNewer);
+        result = (success == false || fileIsNewer == 1 || fileIsNewer == 0);
+      } break;
+      case OpInList: {
+        const char* def = this->GetVariableOrString(lhs);
+        const char* def2 = this->Makefile.GetDefinition(rhs.GetValue());
+        if (def2) {
+          std::vector<std::string> list;
+          cmSystemTools::ExpandListArgument(def2, list, true);
+          result = std::find(list.begin(), list.end(), def) != list.end();
+        }
+      } break;
+      case OpNot:
+        result =
+          !this->GetBooleanValueWithAutoDereference(rhs, errorString, status);
+        break;
+      case OpAnd:
+      case OpOr: {
+        bool l =
+          this->GetBooleanValueWithAutoDereference(lhs, errorString, status);
+        bool r =
+          this->GetBooleanValueWithAutoDereference(rhs, errorString, status);
+        result = op->Type == OpAnd ? (l && r) : (l || r);
+      } break;
+      case OpGroup:
+        result = this->Run(program, op->Group, slots, errorString, status);
+        break;
+      case OpMismatchedParen:
+        errorString = "mismatched parenthesis in condition";
+        status = cmake::FATAL_ERROR;
+        return false;
+    }
+    slots[op->Result] = result ? &conditionTrue : &conditionFalse;
+  }
+
+  // now at the end there should only be one argument left
+  if (!g.Single) {
+    errorString = "Unknown arguments specified";
+    status = cmake::FATAL_ERROR;
+    return false;
+  }
+
+  return this->GetBooleanValueWithAutoDereference(*slots[g.Result],
+                                                  errorString, status, true);
+}
+
+//=========================================================================
+bool cmConditionEvaluator::Reduce(
+  const std::vector<cmExpandedCommandArgument>& args, std::string& errorString,
+  cmake::MessageType& status)
 {
   errorString = "";
 
@@ -138,7 +873,7 @@ const char* cmConditionEvaluator::GetDefinitionIfUnquoted(
   if (def && argument.WasQuoted() &&
       this->Policy54Status == cmPolicies::WARN) {
     if (!this->Makefile.HasCMP0054AlreadyBeenReported(
-          this->ExecutionContext)) {
+          this->Backtrace.Top())) {
       std::ostringstream e;
       e << (cmPolicies::GetPolicyWarning(cmPolicies::CMP0054)) << "\n";
       e << "Quoted variables like \"" << argument.GetValue()
@@ -168,8 +903,8 @@ const char* cmConditionEvaluator::GetVariableOrString(
 }
 
 //=========================================================================
-bool cmConditionEvaluator::IsKeyword(std::string const& keyword,
-                                     cmExpandedCommandArgument& argument) const
+bool cmConditionEvaluator::IsKeyword(
+  std::string const& keyword, cmExpandedCommandArgument const& argument) const
 {
   if ((this->Policy54Status != cmPolicies::WARN &&
        this->Policy54Status != cmPolicies::OLD) &&
@@ -182,7 +917,7 @@ bool cmConditionEvaluator::IsKeyword(std::string const& keyword,
   if (isKeyword && argument.WasQuoted() &&
       this->Policy54Status == cmPolicies::WARN) {
     if (!this->Makefile.HasCMP0054AlreadyBeenReported(
-          this->ExecutionContext)) {
+          this->Backtrace.Top())) {
       std::ostringstream e;
       e << cmPolicies::GetPolicyWarning(cmPolicies::CMP0054) << "\n";
       e << "Quoted keywords like \"" << argument.GetValue()
@@ -200,7 +935,7 @@ bool cmConditionEvaluator::IsKeyword(std::string const& keyword,
 
 //=========================================================================
 bool cmConditionEvaluator::GetBooleanValue(
-  cmExpandedCommandArgument& arg) const
+  cmExpandedCommandArgument const& arg) const
 {
   // Check basic constants.
   if (arg == "0") {
@@ -261,7 +996,7 @@ bool cmConditionEvaluator::GetBooleanValueOld(
 //=========================================================================
 // returns the resulting boolean value
 bool cmConditionEvaluator::GetBooleanValueWithAutoDereference(
-  cmExpandedCommandArgument& newArg, std::string& errorString,
+  cmExpandedCommandArgument const& newArg, std::string& errorString,
   cmake::MessageType& status, bool oneArg) const
 {
   // Use the policy if it is set.
@@ -391,7 +1126,7 @@ bool cmConditionEvaluator::HandleLevel0(cmArgumentList& newArgs,
         newArgs2.pop_back();
         // now recursively invoke IsTrue to handle the values inside the
         // parenthetical expression
-        bool value = this->IsTrue(newArgs2, errorString, status);
+        bool value = this->Reduce(newArgs2, errorString, status);
         if (value) {
           *arg = cmExpandedCommandArgument("1", true);
         } else {
@@ -17,13 +17,14 @@
 
 #include <list>
 
+struct cmConditionProgram;
+
 class cmConditionEvaluator
 {
 public:
   typedef std::list<cmExpandedCommandArgument> cmArgumentList;
 
-  cmConditionEvaluator(cmMakefile& makefile, cmListFileContext const& context,
-                       cmListFileBacktrace const& bt);
+  cmConditionEvaluator(cmMakefile& makefile, cmListFileBacktrace const& bt);
 
   // this is a shared function for both If and Else to determine if the
   // arguments were valid, and if so, was the response true. If there is
@@ -32,6 +33,22 @@ public:
               std::string& errorString, cmake::MessageType& status);
 
 private:
+  // Find the layout of keywords and operands in the arguments, which
+  // determines how they are reduced.  Returns false if the reduction
+  // may warn about a policy, in which case it must be done directly.
+  bool GetLayout(const std::vector<cmExpandedCommandArgument>& args,
+                 std::string& layout) const;
+
+  // Evaluate a group of a program compiled for the layout of the
+  // arguments, with the arguments and results of operations in slots.
+  bool Run(cmConditionProgram const& program, size_t group,
+           std::vector<cmExpandedCommandArgument const*>& slots,
+           std::string& errorString, cmake::MessageType& status);
+
+  // Evaluate the arguments by reducing them directly.
+  bool Reduce(const std::vector<cmExpandedCommandArgument>& args,
+              std::string& errorString, cmake::MessageType& status);
+
   // Filter the given variable definition based on policy CMP0054.
   const char* GetDefinitionIfUnquoted(
     const cmExpandedCommandArgument& argument) const;
@@ -40,17 +57,16 @@ private:
     const cmExpandedCommandArgument& argument) const;
 
   bool IsKeyword(std::string const& keyword,
-                 cmExpandedCommandArgument& argument) const;
+                 cmExpandedCommandArgument const& argument) const;
 
-  bool GetBooleanValue(cmExpandedCommandArgument& arg) const;
+  bool GetBooleanValue(cmExpandedCommandArgument const& arg) const;
 
   bool GetBooleanValueOld(cmExpandedCommandArgument const& arg,
                           bool one) const;
 
-  bool GetBooleanValueWithAutoDereference(cmExpandedCommandArgument& newArg,
-                                          std::string& errorString,
-                                          cmake::MessageType& status,
-                                          bool oneArg = false) const;
+  bool GetBooleanValueWithAutoDereference(
+    cmExpandedCommandArgument const& newArg, std::string& errorString,
+    cmake::MessageType& status, bool oneArg = false) const;
 
   void IncrementArguments(cmArgumentList& newArgs,
                           cmArgumentList::iterator& argP1,
@@ -82,7 +98,6 @@ private:
                     cmake::MessageType& status);
 
   cmMakefile& Makefile;
-  cmListFileContext ExecutionContext;
   cmListFileBacktrace Backtrace;
   cmPolicies::PolicyStatus Policy12Status;
   cmPolicies::PolicyStatus Policy54Status;
@@ -15,8 +15,14 @@
 #include "cmExportTryCompileFileGenerator.h"
 #include "cmGlobalGenerator.h"
 #include "cmOutputConverter.h"
+#include "cmVersion.h"
 #include "cmake.h"
 #include <cmsys/Directory.hxx>
+#include <cmsys/FStream.hxx>
+
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+#include "cmCryptoHash.h"
+#endif
 
 #include <assert.h>
 
@@ -49,6 +55,7 @@ int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
 {
   this->BinaryDirectory = argv[1].c_str();
   this->OutputFile = "";
+  this->Queued = false;
   // which signature were we called with ?
   this->SrcFileSignature = true;
 
@@ -91,6 +98,7 @@ int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
   bool didOutputVariable = false;
   bool didCopyFile = false;
   bool didCopyFileError = false;
+  bool useBatch = false;
   bool useSources = argv[2] == "SOURCES";
   std::vector<std::string> sources;
 
@@ -123,6 +131,9 @@ int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
     } else if (argv[i] == "COPY_FILE_ERROR") {
       doing = DoingCopyFileError;
       didCopyFileError = true;
+    } else if (argv[i] == "BATCH" && !isTryRun) {
+      doing = DoingNone;
+      useBatch = true;
     } else if (doing == DoingCMakeFlags) {
       cmakeFlags.push_back(argv[i]);
     } else if (doing == DoingCompileDefinitions) {
@@ -212,9 +223,23 @@ int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
 
   // compute the binary dir when TRY_COMPILE is called with a src file
   // signature
+  cmTryCompileBatch* batch = 0;
   if (this->SrcFileSignature) {
     this->BinaryDirectory += cmake::GetCMakeFilesDirectory();
     this->BinaryDirectory += "/CMakeTmp";
+
+    /* Use a random file name to avoid rapid creation and deletion
+       of the same executable name (some filesystems fail on that).  */
+    sprintf(targetNameBuf, "cmTC_%05x", cmSystemTools::RandomSeed() & 0xFFFFF);
+    targetName = targetNameBuf;
+
+    // A queued build needs a directory of its own.
+    if (useBatch) {
+      batch = this->Makefile->GetTryCompileBatch();
+    }
+    if (batch) {
+      this->BinaryDirectory += "/" + targetName;
+    }
   } else {
     // only valid for srcfile signatures
     if (!compileDefs.empty()) {
@@ -229,6 +254,11 @@ int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
         "COPY_FILE specified on a srcdir type TRY_COMPILE");
       return -1;
     }
+    if (useBatch) {
+      this->Makefile->IssueMessage(
+        cmake::FATAL_ERROR, "BATCH specified on a srcdir type TRY_COMPILE");
+      return -1;
+    }
   }
   // make sure the binary directory exists
   cmSystemTools::MakeDirectory(this->BinaryDirectory.c_str());
@@ -243,6 +273,8 @@ int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
   }
 
   std::string outFileName = this->BinaryDirectory + "/CMakeLists.txt";
+  std::string cacheEntry;
+  std::string directLang;
   // which signature are we using? If we are using var srcfile bindir
   if (this->SrcFileSignature) {
     // remove any CMakeCache.txt files so we will have a clean test
@@ -254,6 +286,23 @@ int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
       sources.push_back(argv[2]);
     }
 
+    // A queued build runs after later checks have written their own
+    // sources to the shared temporary directory, so it uses copies.
+    if (batch) {
+      std::string const tmpDir =
+        cmSystemTools::GetFilenamePath(this->BinaryDirectory);
+      for (std::vector<std::string>::iterator si = sources.begin();
+           si != sources.end(); ++si) {
+        std::string const src = cmSystemTools::CollapseFullPath(*si);
+        if (cmSystemTools::GetFilenamePath(src) == tmpDir) {
+          std::string const copy = this->BinaryDirectory + "/" +
+            cmSystemTools::GetFilenameName(src);
+          cmSystemTools::CopyFileAlways(src, copy);
+          *si = copy;
+        }
+      }
+    }
+
     // Detect languages to enable.
     cmGlobalGenerator* gg = this->Makefile->GetGlobalGenerator();
     std::set<std::string> testLangs;
@@ -386,11 +435,6 @@ int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
       fprintf(fout, "add_definitions(%s)\n", cmJoin(compileDefs, " ").c_str());
     }
 
-    /* Use a random file name to avoid rapid creation and deletion
-       of the same executable name (some filesystems fail on that).  */
-    sprintf(targetNameBuf, "cmTC_%05x", cmSystemTools::RandomSeed() & 0xFFFFF);
-    targetName = targetNameBuf;
-
     if (!targets.empty()) {
       std::string fname = "/" + std::string(targetName) + "Targets.cmake";
       cmExportTryCompileFileGenerator tcfg(gg, targets, this->Makefile);
@@ -494,46 +538,129 @@ int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
     }
     fclose(fout);
     projectName = "CMAKE_TRY_COMPILE";
+
+    // Imported targets may refer to files that change without changing
+    // the project, so their results are not cached.
+    if (targets.empty()) {
+      cacheEntry =
+        this->GetCacheEntry(targetName, sources, cmakeFlags, testLangs);
+    }
+
+    // A single source that links to nothing may be compiled directly.
+    if (sources.size() == 1 && targets.empty() && libsToLink == " ") {
+      directLang = *testLangs.begin();
+    }
   }
 
+  cmTryCompileBatch::Entry entry;
+  entry.ResultVariable = argv[0];
+  entry.OutputVariable = outputVariable;
+  entry.CopyFile = copyFile;
+  entry.CopyFileError = copyFileError;
+  entry.BinaryDirectory = this->BinaryDirectory;
+  entry.TargetName = targetName;
+  entry.TargetType = targetType;
+  entry.CacheEntry = cacheEntry;
+
   bool erroroc = cmSystemTools::GetErrorOccuredFlag();
   cmSystemTools::ResetErrorOccuredFlag();
-  std::string output;
-  // actually do the try compile now that everything is setup
-  int res = this->Makefile->TryCompile(
-    sourceDirectory, this->BinaryDirectory, projectName, targetName,
-    this->SrcFileSignature, &cmakeFlags, output);
+  entry.Cached = !entry.CacheEntry.empty() &&
+    this->LoadCachedResult(entry.CacheEntry, entry.Result, entry.Output);
+  if (!entry.CacheEntry.empty()) {
+    this->Makefile->GetGlobalGenerator()->CountTryCompileCacheLookup(
+      entry.Cached);
+  }
+  if (entry.Cached) {
+    entry.OutputFile = this->OutputFile;
+  } else {
+    std::vector<std::string> directCommands;
+    bool direct = !directLang.empty() &&
+      this->GetDirectCompileCommands(sources[0], directLang, targetName,
+                                     targetType, cmakeFlags, compileDefs,
+                                     directCommands);
+    if (batch) {
+      // Set up the build now and leave running it to the batch.
+      if (direct) {
+        this->QueueDirectCompile(directCommands, entry);
+      } else {
+        std::vector<std::string> buildCommand;
+        entry.Result = this->Makefile->ConfigureTryCompile(
+          sourceDirectory, this->BinaryDirectory, projectName, targetName,
+          this->SrcFileSignature, &cmakeFlags, buildCommand);
+        if (entry.Result == 0) {
+          entry.Commands.push_back(buildCommand);
+          entry.Labels.push_back("Change Dir: " + this->BinaryDirectory +
+                                 "\n\nRun Build Command:" +
+                                 cmSystemTools::PrintSingleCommand(
+                                   buildCommand) +
+                                 "\n");
+          entry.CheckErrorDirective = true;
+        }
+      }
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+      entry.Environment = cmSystemTools::GetEnvironmentVariables();
+#endif
+    } else if (direct) {
+      entry.Result = this->TryCompileDirect(directCommands, entry.Output);
+    } else {
+      // actually do the try compile now that everything is setup
+      entry.Result = this->Makefile->TryCompile(
+        sourceDirectory, this->BinaryDirectory, projectName, targetName,
+        this->SrcFileSignature, &cmakeFlags, entry.Output);
+    }
+    // Do not keep results of a try_compile that could not be set up.
+    if (cmSystemTools::GetErrorOccuredFlag()) {
+      entry.CacheEntry = "";
+    }
+  }
   if (erroroc) {
     cmSystemTools::SetErrorOccured();
   }
 
+  if (batch) {
+    batch->Entries.push_back(entry);
+    this->Queued = true;
+    return 0;
+  }
+  return this->FinishTryCompile(entry);
+}
+
+int cmCoreTryCompile::FinishTryCompile(cmTryCompileBatch::Entry const& entry)
+{
   // set the result var to the return value to indicate success or failure
-  this->Makefile->AddCacheDefinition(argv[0], (res == 0 ? "TRUE" : "FALSE"),
-                                     "Result of TRY_COMPILE",
-                                     cmState::INTERNAL);
+  this->Makefile->AddCacheDefinition(
+    entry.ResultVariable, (entry.Result == 0 ? "TRUE" : "FALSE"),
+    "Result of TRY_COMPILE", cmState::INTERNAL);
 
-  if (!outputVariable.empty()) {
-    this->Makefile->AddDefinition(outputVariable, output.c_str());
+  if (!entry.OutputVariable.empty()) {
+    this->Makefile->AddDefinition(entry.OutputVariable, entry.Output.c_str());
   }
 
   if (this->SrcFileSignature) {
     std::string copyFileErrorMessage;
-    this->FindOutputFile(targetName, targetType);
+    if (entry.Cached) {
+      this->OutputFile = entry.OutputFile;
+    } else {
+      this->FindOutputFile(entry.TargetName, entry.TargetType);
+      if (!entry.CacheEntry.empty()) {
+        this->StoreCachedResult(entry.CacheEntry, entry.Result, entry.Output);
+      }
+    }
 
-    if ((res == 0) && !copyFile.empty()) {
+    if ((entry.Result == 0) && !entry.CopyFile.empty()) {
       if (this->OutputFile.empty() ||
-          !cmSystemTools::CopyFileAlways(this->OutputFile, copyFile)) {
+          !cmSystemTools::CopyFileAlways(this->OutputFile, entry.CopyFile)) {
         std::ostringstream emsg;
         /* clang-format off */
         emsg << "Cannot copy output executable\n"
              << "  '" << this->OutputFile << "'\n"
              << "to destination specified by COPY_FILE:\n"
-             << "  '" << copyFile << "'\n";
+             << "  '" << entry.CopyFile << "'\n";
         /* clang-format on */
         if (!this->FindErrorMessage.empty()) {
           emsg << this->FindErrorMessage.c_str();
         }
-        if (copyFileError.empty()) {
+        if (entry.CopyFileError.empty()) {
           this->Makefile->IssueMessage(cmake::FATAL_ERROR, emsg.str());
           return -1;
         } else {
@@ -542,12 +669,12 @@ int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
       }
     }
 
-    if (!copyFileError.empty()) {
-      this->Makefile->AddDefinition(copyFileError,
+    if (!entry.CopyFileError.empty()) {
+      this->Makefile->AddDefinition(entry.CopyFileError,
                                     copyFileErrorMessage.c_str());
     }
   }
-  return res;
+  return entry.Result;
 }
 
 void cmCoreTryCompile::CleanupFiles(const char* binDir)
@@ -664,3 +791,397 @@ void cmCoreTryCompile::FindOutputFile(const std::string& targetName,
   this->FindErrorMessage = emsg.str();
   return;
 }
+
+// Quote a path for a rule command line if needed.
+static std::string cmCoreTryCompileQuote(std::string const& path)
+{
+  if (path.find_first_of(" \t\"'()&;") == std::string::npos) {
+    return path;
+  }
+  return "\"" + path + "\"";
+}
+
+// Replace <NAME> placeholders in a rule.  Fails on unknown names.
+static bool cmCoreTryCompileExpandRule(
+  std::string& rule, std::map<std::string, std::string> const& vars)
+{
+  std::string expanded;
+  std::string::size_type pos = 0;
+  std::string::size_type start;
+  while ((start = rule.find('<', pos)) != std::string::npos) {
+    std::string::size_type end = rule.find('>', start);
+    if (end == std::string::npos) {
+      break;
+    }
+    std::string const name = rule.substr(start + 1, end - start - 1);
+    std::map<std::string, std::string>::const_iterator v = vars.find(name);
+    if (v == vars.end()) {
+      if (!name.empty() &&
+          name.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                 "abcdefghijklmnopqrstuvwxyz"
+                                 "0123456789_") == std::string::npos) {
+        return false;
+      }
+      expanded += rule.substr(pos, start + 1 - pos);
+      pos = start + 1;
+      continue;
+    }
+    expanded += rule.substr(pos, start - pos);
+    expanded += v->second;
+    pos = end + 1;
+  }
+  expanded += rule.substr(pos);
+  rule = expanded;
+  return true;
+}
+
+bool cmCoreTryCompile::GetDirectCompileCommands(
+  std::string const& source, std::string const& lang,
+  std::string const& targetName, cmState::TargetType targetType,
+  std::vector<std::string> const& cmakeFlags,
+  std::vector<std::string> const& compileDefs,
+  std::vector<std::string>& commands)
+{
+  cmMakefile* mf = this->Makefile;
+  cmGlobalGenerator* gg = mf->GetGlobalGenerator();
+  if (!mf->IsOn("CMAKE_TRY_COMPILE_DIRECT") || gg->IsMultiConfig() ||
+      (lang != "C" && lang != "CXX")) {
+    return false;
+  }
+
+  // Only the variables used by the generated project may be given.
+  std::map<std::string, std::string> projectVars;
+  for (std::vector<std::string>::const_iterator fi = cmakeFlags.begin() + 1;
+       fi != cmakeFlags.end(); ++fi) {
+    if (fi->empty()) {
+      continue;
+    }
+    std::string::size_type eq = fi->find('=');
+    if (fi->compare(0, 2, "-D") != 0 || eq == std::string::npos) {
+      return false;
+    }
+    std::string name = fi->substr(2, eq - 2);
+    name = name.substr(0, name.find(':'));
+    std::string const value = fi->substr(eq + 1);
+    // Without libraries to link there is no runtime path to skip.
+    if (name != "COMPILE_DEFINITIONS" && name != "INCLUDE_DIRECTORIES" &&
+        name != "EXE_LINKER_FLAGS" && name != "CMAKE_SKIP_RPATH" &&
+        ((name != "LINK_LIBRARIES" && name != "LINK_DIRECTORIES") ||
+         !value.empty())) {
+      return false;
+    }
+    projectVars[name] = value;
+  }
+
+  std::string const cfg = cmSystemTools::UpperCase(
+    mf->GetSafeDefinition("CMAKE_TRY_COMPILE_CONFIGURATION"));
+  std::string const langPrefix = "CMAKE_" + lang;
+
+  // Flags of the generated project, which uses the configuration only if
+  // one is given.
+  std::string flags = mf->GetSafeDefinition(langPrefix + "_FLAGS");
+  flags += " " + projectVars["COMPILE_DEFINITIONS"];
+  if (!cfg.empty()) {
+    flags += " ";
+    flags += mf->GetSafeDefinition(langPrefix + "_FLAGS_" + cfg);
+  }
+
+  std::string includes;
+  std::vector<std::string> includeDirs;
+  cmSystemTools::ExpandListArgument(projectVars["INCLUDE_DIRECTORIES"],
+                                    includeDirs);
+  std::vector<std::string> implicitDirs;
+  cmSystemTools::ExpandListArgument(
+    mf->GetSafeDefinition(langPrefix + "_IMPLICIT_INCLUDE_DIRECTORIES"),
+    implicitDirs);
+  std::string const includeFlag =
+    mf->GetSafeDefinition("CMAKE_INCLUDE_FLAG_" + lang);
+  for (std::vector<std::string>::const_iterator di = includeDirs.begin();
+       di != includeDirs.end(); ++di) {
+    std::string const dir =
+      cmSystemTools::CollapseFullPath(*di, this->BinaryDirectory);
+    if (std::find(implicitDirs.begin(), implicitDirs.end(), dir) ==
+        implicitDirs.end()) {
+      includes += " " + includeFlag + cmCoreTryCompileQuote(dir);
+    }
+  }
+
+  std::string linkFlags;
+  std::string const exeLinkerFlags =
+    mf->GetPolicyStatus(cmPolicies::CMP0056) == cmPolicies::NEW
+    ? "CMAKE_EXE_LINKER_FLAGS"
+    : "CMAKE_EXE_LINKER_FLAGS_INIT";
+  linkFlags = mf->GetSafeDefinition(exeLinkerFlags);
+  linkFlags += " " + projectVars["EXE_LINKER_FLAGS"];
+  if (!cfg.empty()) {
+    linkFlags += " ";
+    linkFlags +=
+      mf->GetSafeDefinition("CMAKE_EXE_LINKER_FLAGS_" + cfg + "_INIT");
+  }
+  if (mf->GetPolicyStatus(cmPolicies::CMP0065) != cmPolicies::NEW) {
+    linkFlags += " ";
+    linkFlags +=
+      mf->GetSafeDefinition("CMAKE_SHARED_LIBRARY_LINK_" + lang + "_FLAGS");
+  }
+
+  std::string object = this->BinaryDirectory + "/" + targetName +
+    mf->GetSafeDefinition(langPrefix + "_OUTPUT_EXTENSION");
+  std::string target = this->BinaryDirectory + "/";
+  std::vector<std::string> rules;
+  if (targetType == cmState::EXECUTABLE) {
+    target += targetName + mf->GetSafeDefinition("CMAKE_EXECUTABLE_SUFFIX");
+    rules.push_back(langPrefix + "_COMPILE_OBJECT");
+    rules.push_back(langPrefix + "_LINK_EXECUTABLE");
+  } else {
+    if (mf->GetDefinition(langPrefix + "_CREATE_STATIC_LIBRARY")) {
+      return false;
+    }
+    target += mf->GetSafeDefinition("CMAKE_STATIC_LIBRARY_PREFIX") +
+      targetName + mf->GetSafeDefinition("CMAKE_STATIC_LIBRARY_SUFFIX");
+    linkFlags = mf->GetSafeDefinition("CMAKE_STATIC_LINKER_FLAGS_INIT");
+    rules.push_back(langPrefix + "_COMPILE_OBJECT");
+    rules.push_back(langPrefix + "_ARCHIVE_CREATE");
+    rules.push_back(langPrefix + "_ARCHIVE_FINISH");
+  }
+
+  std::map<std::string, std::string> vars;
+  std::string compiler =
+    cmCoreTryCompileQuote(mf->GetSafeDefinition(langPrefix + "_COMPILER"));
+  if (const char* arg1 = mf->GetDefinition(langPrefix + "_COMPILER_ARG1")) {
+    compiler += " ";
+    compiler += arg1;
+  }
+  vars[langPrefix + "_COMPILER"] = compiler;
+  vars[langPrefix + "_LINK_FLAGS"] =
+    mf->GetSafeDefinition(langPrefix + "_LINK_FLAGS");
+  vars["CMAKE_AR"] = cmCoreTryCompileQuote(mf->GetSafeDefinition("CMAKE_AR"));
+  vars["CMAKE_RANLIB"] =
+    cmCoreTryCompileQuote(mf->GetSafeDefinition("CMAKE_RANLIB"));
+  vars["DEFINES"] = cmJoin(compileDefs, " ");
+  vars["INCLUDES"] = includes;
+  vars["FLAGS"] = flags;
+  vars["SOURCE"] = cmCoreTryCompileQuote(source);
+  vars["OBJECT"] = cmCoreTryCompileQuote(object);
+  vars["OBJECTS"] = cmCoreTryCompileQuote(object);
+  vars["TARGET"] = cmCoreTryCompileQuote(target);
+  vars["LINK_FLAGS"] = linkFlags;
+  vars["LINK_LIBRARIES"] =
+    mf->GetSafeDefinition(langPrefix + "_STANDARD_LIBRARIES");
+
+  // Expand all commands before running any of them.
+  for (std::vector<std::string>::const_iterator ri = rules.begin();
+       ri != rules.end(); ++ri) {
+    std::vector<std::string> ruleCommands;
+    cmSystemTools::ExpandListArgument(mf->GetSafeDefinition(*ri),
+                                      ruleCommands);
+    if (ruleCommands.empty() && *ri != langPrefix + "_ARCHIVE_FINISH") {
+      return false;
+    }
+    for (std::vector<std::string>::iterator ci = ruleCommands.begin();
+         ci != ruleCommands.end(); ++ci) {
+      if (!cmCoreTryCompileExpandRule(*ci, vars)) {
+        return false;
+      }
+      commands.push_back(*ci);
+    }
+  }
+
+  // A target left from an earlier test must not be taken as the result.
+  cmSystemTools::RemoveFile(target);
+  return true;
+}
+
+// Split a rule command into arguments.
+static void cmCoreTryCompileParseCommand(std::string const& command,
+                                         std::vector<std::string>& argv)
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  cmSystemTools::ParseWindowsCommandLine(command.c_str(), argv);
+#else
+  cmSystemTools::ParseUnixCommandLine(command.c_str(), argv);
+#endif
+}
+
+int cmCoreTryCompile::TryCompileDirect(
+  std::vector<std::string> const& commands, std::string& output)
+{
+  cmGlobalGenerator* gg = this->Makefile->GetGlobalGenerator();
+  output = "Compiling directly in " + this->BinaryDirectory + "\n";
+  for (std::vector<std::string>::const_iterator ci = commands.begin();
+       ci != commands.end(); ++ci) {
+    std::vector<std::string> argv;
+    cmCoreTryCompileParseCommand(*ci, argv);
+    output += *ci + "\n";
+    std::string commandOutput;
+    int retVal = 0;
+    bool ran = cmSystemTools::RunSingleCommand(
+      argv, &commandOutput, &commandOutput, &retVal,
+      this->BinaryDirectory.c_str(), cmSystemTools::OUTPUT_NONE,
+      gg->TryCompileTimeout);
+    output += commandOutput;
+    if (!ran || retVal != 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+void cmCoreTryCompile::QueueDirectCompile(
+  std::vector<std::string> const& commands, cmTryCompileBatch::Entry& entry)
+{
+  std::string label = "Compiling directly in " + this->BinaryDirectory + "\n";
+  for (std::vector<std::string>::const_iterator ci = commands.begin();
+       ci != commands.end(); ++ci) {
+    std::vector<std::string> argv;
+    cmCoreTryCompileParseCommand(*ci, argv);
+    entry.Commands.push_back(argv);
+    entry.Labels.push_back(label + *ci + "\n");
+    label = "";
+  }
+}
+
+std::string cmCoreTryCompile::GetCacheEntry(
+  std::string const& targetName, std::vector<std::string> const& sources,
+  std::vector<std::string> const& cmakeFlags,
+  std::set<std::string> const& langs)
+{
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+  std::string cacheDir =
+    this->Makefile->GetSafeDefinition("CMAKE_TRY_COMPILE_CACHE_DIR");
+  if (cacheDir.empty()) {
+    return std::string();
+  }
+  cacheDir = cmSystemTools::CollapseFullPath(
+    cacheDir, this->Makefile->GetHomeOutputDirectory());
+
+  // Describe everything that may affect the result, leaving out the
+  // build tree and the random target name so that the result can be
+  // shared between build trees.
+  std::string const homeDir = this->Makefile->GetHomeOutputDirectory();
+  std::ostringstream key;
+  cmGlobalGenerator* gg = this->Makefile->GetGlobalGenerator();
+  key << "cmake " << cmVersion::GetCMakeVersion() << "\n"
+      << "generator " << gg->GetName() << "\n"
+      << "toolset "
+      << this->Makefile->GetSafeDefinition("CMAKE_GENERATOR_TOOLSET") << "\n"
+      << "platform "
+      << this->Makefile->GetSafeDefinition("CMAKE_GENERATOR_PLATFORM")
+      << "\n";
+  for (std::set<std::string>::const_iterator li = langs.begin();
+       li != langs.end(); ++li) {
+    // A compiler replaced in place keeps its path, so also use its size
+    // and modification time.
+    std::string const compiler =
+      this->Makefile->GetSafeDefinition("CMAKE_" + *li + "_COMPILER");
+    key << "compiler " << *li << " " << compiler << " "
+        << this->Makefile->GetSafeDefinition("CMAKE_" + *li + "_COMPILER_ID")
+        << " " << this->Makefile->GetSafeDefinition("CMAKE_" + *li +
+                                                    "_COMPILER_VERSION")
+        << " " << cmSystemTools::FileLength(compiler) << " "
+        << cmSystemTools::ModifiedTime(compiler) << "\n";
+  }
+  for (std::vector<std::string>::const_iterator fi = cmakeFlags.begin() + 1;
+       fi != cmakeFlags.end(); ++fi) {
+    key << "flag " << *fi << "\n";
+  }
+  cmsys::auto_ptr<cmCryptoHash> md5(cmCryptoHash::New("MD5"));
+  for (std::vector<std::string>::const_iterator si = sources.begin();
+       si != sources.end(); ++si) {
+    std::string const content = md5->HashFile(*si);
+    if (content.empty()) {
+      return std::string();
+    }
+    std::string source = *si;
+    cmSystemTools::ReplaceString(source, this->BinaryDirectory, "<BINDIR>");
+    cmSystemTools::ReplaceString(source, homeDir, "<HOMEDIR>");
+    key << "source " << source << " " << content << "\n";
+  }
+  std::string project;
+  {
+    cmsys::ifstream fin((this->BinaryDirectory + "/CMakeLists.txt").c_str());
+    std::string line;
+    while (cmSystemTools::GetLineFromStream(fin, line)) {
+      project += line;
+      project += "\n";
+    }
+  }
+  cmSystemTools::ReplaceString(project, this->BinaryDirectory, "<BINDIR>");
+  cmSystemTools::ReplaceString(project, homeDir, "<HOMEDIR>");
+  cmSystemTools::ReplaceString(project, targetName, "<TARGET>");
+  key << project;
+
+  cmsys::auto_ptr<cmCryptoHash> sha(cmCryptoHash::New("SHA256"));
+  return cacheDir + "/" + sha->HashString(key.str());
+#else
+  (void)targetName;
+  (void)sources;
+  (void)cmakeFlags;
+  (void)langs;
+  return std::string();
+#endif
+}
+
+bool cmCoreTryCompile::LoadCachedResult(std::string const& entry,
+                                        int& result, std::string& output)
+{
+  cmsys::ifstream fin((entry + "/result.txt").c_str());
+  std::string resultLine;
+  std::string outputFile;
+  if (!cmSystemTools::GetLineFromStream(fin, resultLine)) {
+    return false;
+  }
+  cmSystemTools::GetLineFromStream(fin, outputFile);
+  if (!outputFile.empty()) {
+    std::string copy = this->BinaryDirectory + "/" + outputFile;
+    if (!cmSystemTools::CopyFileAlways(entry + "/" + outputFile, copy)) {
+      return false;
+    }
+    this->OutputFile = copy;
+  }
+
+  cmsys::ifstream oin((entry + "/output.txt").c_str(),
+                      std::ios::in | std::ios::binary);
+  output.assign(std::istreambuf_iterator<char>(oin),
+                std::istreambuf_iterator<char>());
+  result = atoi(resultLine.c_str());
+  return true;
+}
+
+void cmCoreTryCompile::StoreCachedResult(std::string const& entry,
+                                         int result,
+                                         std::string const& output)
+{
+  // Fill a private directory and move it into place so that concurrent
+  // configurations never see partial entries.
+  char tmpName[64];
+  sprintf(tmpName, ".tmp-%05x", cmSystemTools::RandomSeed() & 0xFFFFF);
+  std::string tmp = entry + tmpName;
+  if (!cmSystemTools::MakeDirectory(tmp.c_str())) {
+    return;
+  }
+  std::string outputFile;
+  if (!this->OutputFile.empty()) {
+    outputFile = cmSystemTools::GetFilenameName(this->OutputFile);
+    if (!cmSystemTools::CopyFileAlways(this->OutputFile,
+                                       tmp + "/" + outputFile)) {
+      cmSystemTools::RemoveADirectory(tmp);
+      return;
+    }
+  }
+  {
+    cmsys::ofstream fout((tmp + "/output.txt").c_str(),
+                         std::ios::out | std::ios::binary);
+    fout << output;
+  }
+  {
+    cmsys::ofstream fout((tmp + "/result.txt").c_str());
+    fout << result << "\n" << outputFile << "\n";
+    if (!fout) {
+      cmSystemTools::RemoveADirectory(tmp);
+      return;
+    }
+  }
+  if (!cmSystemTools::RenameFile(tmp.c_str(), entry.c_str())) {
+    cmSystemTools::RemoveADirectory(tmp);
+  }
+}
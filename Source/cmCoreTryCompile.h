@@ -14,6 +14,8 @@
 
 #include "cmCommand.h"
 
+#include "cmTryCompileBatch.h"
+
 /** \class cmCoreTryCompile
  * \brief Base class for cmTryCompileCommand and cmTryRunCommand
  *
@@ -46,12 +48,68 @@ protected:
   void FindOutputFile(const std::string& targetName,
                       cmState::TargetType targetType);
 
+  /**
+   * Store the result of a try_compile in the variables named by its
+   * arguments and copy its output file.  This is done right after the
+   * build, or when the batch that queued the build ends.
+   */
+  int FinishTryCompile(cmTryCompileBatch::Entry const& entry);
+
+  /**
+   * Compute the commands that compile a single source and link or
+   * archive it using the rule variables of the calling project instead
+   * of generating and building a test project.  This is done only if
+   * CMAKE_TRY_COMPILE_DIRECT is enabled and the rules and flags are
+   * simple enough to be expanded here.  Returns false if the test
+   * project is needed.
+   */
+  bool GetDirectCompileCommands(std::string const& source,
+                                std::string const& lang,
+                                std::string const& targetName,
+                                cmState::TargetType targetType,
+                                std::vector<std::string> const& cmakeFlags,
+                                std::vector<std::string> const& compileDefs,
+                                std::vector<std::string>& commands);
+
+  /** Run the commands computed by GetDirectCompileCommands.  */
+  int TryCompileDirect(std::vector<std::string> const& commands,
+                       std::string& output);
+
+  /** Queue the commands computed by GetDirectCompileCommands.  */
+  void QueueDirectCompile(std::vector<std::string> const& commands,
+                          cmTryCompileBatch::Entry& entry);
+
+  /**
+   * Compute the directory in CMAKE_TRY_COMPILE_CACHE_DIR holding the
+   * result of a source file signature.  The key covers the generated
+   * project, the flags passed to it, the sources and the compilers
+   * but not the binary directory or the random target name.  Returns
+   * an empty string if results may not be cached.
+   */
+  std::string GetCacheEntry(std::string const& targetName,
+                            std::vector<std::string> const& sources,
+                            std::vector<std::string> const& cmakeFlags,
+                            std::set<std::string> const& langs);
+
+  /**
+   * Load a result from a cache entry.  The output file, if any, is
+   * copied to the binary directory and stored in OutputFile.
+   */
+  bool LoadCachedResult(std::string const& entry, int& result,
+                        std::string& output);
+
+  /** Store a result and the output file, if any, in a cache entry.  */
+  void StoreCachedResult(std::string const& entry, int result,
+                         std::string const& output);
+
   cmTypeMacro(cmCoreTryCompile, cmCommand);
 
   std::string BinaryDirectory;
   std::string OutputFile;
   std::string FindErrorMessage;
   bool SrcFileSignature;
+  // Whether TryCompileCode queued the build in a batch.
+  bool Queued;
 };
 
 #endif
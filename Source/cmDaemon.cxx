@@ -0,0 +1,682 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmDaemon.h"
+
+#include "cmAlgorithms.h"
+#include "cmCommonTargetGenerator.h"
+#include "cmExternalMakefileProjectGenerator.h"
+#include "cmGeneratorTarget.h"
+#include "cmGlobalGenerator.h"
+#include "cmLocalCommonGenerator.h"
+#include "cmMakefile.h"
+#include "cmSourceFile.h"
+#include "cmSystemTools.h"
+#include "cmake.h"
+
+#include "cm_jsoncpp_reader.h"
+#include "cm_jsoncpp_writer.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+// How long to wait for further changes before regenerating, in seconds.
+// Editors and version control tools often write several files, or the
+// same file several times, in a row.
+#define CM_DAEMON_SETTLE_TIME 0.1
+
+namespace {
+// Computes the compile flags of the sources of a target the way the
+// Makefile and Ninja generators do, with include directories given as
+// full paths.
+class cmDaemonTargetFlags : public cmCommonTargetGenerator
+{
+public:
+  cmDaemonTargetFlags(cmGeneratorTarget* gt)
+    : cmCommonTargetGenerator(cmOutputConverter::START_OUTPUT, gt)
+  {
+  }
+
+  std::string GetSourceFlags(cmSourceFile const& source,
+                             std::string const& lang)
+  {
+    std::string flags = this->GetFlags(lang);
+    if (lang == "Fortran") {
+      this->AppendFortranFormatFlags(flags, source);
+    }
+    if (const char* sourceFlags = source.GetProperty("COMPILE_FLAGS")) {
+      this->LocalGenerator->AppendFlags(flags, sourceFlags);
+    }
+    return flags;
+  }
+
+  std::string GetSourceDefines(cmSourceFile const& source,
+                               std::string const& lang)
+  {
+    std::string defines = this->GetDefines(lang);
+    std::set<std::string> sourceDefines;
+    if (const char* defs = source.GetProperty("COMPILE_DEFINITIONS")) {
+      this->LocalGenerator->AppendDefines(sourceDefines, defs);
+    }
+    std::string defPropName = "COMPILE_DEFINITIONS_";
+    defPropName += cmSystemTools::UpperCase(this->ConfigName);
+    if (const char* defs = source.GetProperty(defPropName)) {
+      this->LocalGenerator->AppendDefines(sourceDefines, defs);
+    }
+    std::string sourceDefinesString;
+    this->LocalGenerator->JoinDefines(sourceDefines, sourceDefinesString,
+                                      lang);
+    this->LocalGenerator->AppendFlags(defines, sourceDefinesString);
+    return defines;
+  }
+
+  std::string GetSourceIncludes(std::string const& lang)
+  {
+    return this->GetIncludes(lang);
+  }
+
+protected:
+  void AddIncludeFlags(std::string& flags, std::string const& lang)
+  {
+    std::vector<std::string> includes;
+    this->LocalGenerator->GetIncludeDirectories(
+      includes, this->GeneratorTarget, lang, this->ConfigName);
+    std::string includeFlags = this->LocalGenerator->GetIncludeFlags(
+      includes, this->GeneratorTarget, lang, true, false, this->ConfigName);
+    this->LocalGenerator->AppendFlags(flags, includeFlags);
+  }
+};
+}
+
+cmDaemon::cmDaemon(cmake* cm)
+  : CMakeInstance(cm)
+  , Listener(-1)
+  , Notify(-1)
+  , Generated(false)
+  , RegenerateTime(0)
+  , RunStart(0)
+  , Shutdown(false)
+  , Collecting(false)
+{
+}
+
+cmDaemon::~cmDaemon()
+{
+  if (this->Listener >= 0) {
+    close(this->Listener);
+    unlink(this->SocketPath.c_str());
+  }
+  if (this->Notify >= 0) {
+    close(this->Notify);
+  }
+  cmSystemTools::SetMessageCallback(0, 0);
+}
+
+std::string cmDaemon::GetSocketPath(std::string const& buildDir)
+{
+  std::string path = buildDir;
+  path += cmake::GetCMakeFilesDirectory();
+  path += "/daemon.sock";
+  return path;
+}
+
+static bool cmDaemonSocketAddress(std::string const& path,
+                                  struct sockaddr_un& addr)
+{
+  if (path.size() >= sizeof(addr.sun_path)) {
+    cmSystemTools::Error("The path of the daemon socket is too long: ",
+                         path.c_str());
+    return false;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path.c_str());
+  return true;
+}
+
+static bool cmDaemonWrite(int fd, std::string const& data)
+{
+  std::string::size_type done = 0;
+  while (done < data.size()) {
+    ssize_t n = send(fd, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    done += static_cast<std::string::size_type>(n);
+  }
+  return true;
+}
+
+// Identify the content of a file by its inode, size and modification
+// time.  Empty if the file does not exist.
+static std::string cmDaemonFileStamp(std::string const& file,
+                                     double* mtime = 0)
+{
+  struct stat st;
+  if (stat(file.c_str(), &st) != 0) {
+    return std::string();
+  }
+  if (mtime) {
+    *mtime = static_cast<double>(st.st_mtim.tv_sec) +
+      static_cast<double>(st.st_mtim.tv_nsec) * 1e-9;
+  }
+  std::ostringstream stamp;
+  stamp << st.st_ino << " " << st.st_size << " " << st.st_mtim.tv_sec << "."
+        << st.st_mtim.tv_nsec;
+  return stamp.str();
+}
+
+// The time as the file system records it in modification times, which
+// may lag behind the precise clock.
+static double cmDaemonFileSystemTime()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME_COARSE, &now);
+  return static_cast<double>(now.tv_sec) +
+    static_cast<double>(now.tv_nsec) * 1e-9;
+}
+
+void cmDaemon::MessageCallback(const char* m, const char*, bool&,
+                               void* clientData)
+{
+  std::cerr << m << std::endl << std::flush;
+  cmDaemon* self = static_cast<cmDaemon*>(clientData);
+  if (self->Collecting) {
+    self->Messages.push_back(m);
+  }
+}
+
+int cmDaemon::Serve(std::string const& buildDir)
+{
+  std::string cacheFile = buildDir;
+  cacheFile += "/CMakeCache.txt";
+  if (!cmSystemTools::FileExists(cacheFile.c_str(), true)) {
+    cmSystemTools::Error("The daemon needs an existing build tree, but "
+                         "there is no CMakeCache.txt in ",
+                         buildDir.c_str());
+    return 1;
+  }
+  this->SocketPath = GetSocketPath(buildDir);
+  if (!this->Listen()) {
+    return 1;
+  }
+  // Watch the inputs from the start, and with the same descriptor all
+  // along, so that no change is missed while configuring.
+  this->Notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (this->Notify < 0) {
+    cmSystemTools::Error("Could not watch the inputs of the build tree: ",
+                         strerror(errno));
+    return 1;
+  }
+  cmSystemTools::SetMessageCallback(MessageCallback, this);
+
+  // The first run is that of "cmake <dir>", later ones go over the
+  // steps again with the state loaded.  A build tree that fails to
+  // configure is watched all the same, for the fix to be picked up.
+  std::vector<std::string> args;
+  args.push_back(cmSystemTools::GetCMakeCommand());
+  args.push_back(buildDir);
+  this->BeginRun();
+  this->Generated = this->CMakeInstance->Run(args, false) == 0 &&
+    !cmSystemTools::GetErrorOccuredFlag();
+  this->EndRun();
+
+  while (!this->Shutdown) {
+    struct pollfd fds[2];
+    fds[0].fd = this->Listener;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = this->Notify;
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+    int timeout = -1;
+    if (this->RegenerateTime > 0) {
+      double wait = this->RegenerateTime - cmSystemTools::GetTime();
+      timeout = wait > 0 ? static_cast<int>(wait * 1000) + 1 : 0;
+    }
+    if (poll(fds, 2, timeout) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      cmSystemTools::Error("The daemon could not wait for requests: ",
+                           strerror(errno));
+      return 1;
+    }
+    if ((fds[1].revents & POLLIN) && this->ReadEvents()) {
+      this->RegenerateTime = cmSystemTools::GetTime() + CM_DAEMON_SETTLE_TIME;
+    }
+    if (this->RegenerateTime > 0 &&
+        cmSystemTools::GetTime() >= this->RegenerateTime) {
+      this->Regenerate();
+    }
+    if (fds[0].revents & POLLIN) {
+      int fd = accept4(this->Listener, 0, 0, SOCK_CLOEXEC);
+      if (fd >= 0) {
+        this->HandleConnection(fd);
+        close(fd);
+      }
+    }
+  }
+  return 0;
+}
+
+bool cmDaemon::Listen()
+{
+  struct sockaddr_un addr;
+  if (!cmDaemonSocketAddress(this->SocketPath, addr)) {
+    return false;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    cmSystemTools::Error("Could not create the daemon socket: ",
+                         strerror(errno));
+    return false;
+  }
+
+  // A socket left behind by a daemon that did not shut down cleanly
+  // is removed, one that a daemon still accepts connections on is not.
+  if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) ==
+      0) {
+    close(fd);
+    cmSystemTools::Error("A daemon is already serving the build tree: ",
+                         this->SocketPath.c_str());
+    return false;
+  }
+  unlink(this->SocketPath.c_str());
+
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 ||
+      listen(fd, 16) < 0) {
+    std::string e = strerror(errno);
+    close(fd);
+    cmSystemTools::Error("Could not listen on the daemon socket ",
+                         this->SocketPath.c_str(), ": ", e.c_str());
+    return false;
+  }
+  this->Listener = fd;
+  return true;
+}
+
+bool cmDaemon::Regenerate()
+{
+  cmake* cm = this->CMakeInstance;
+  this->RegenerateTime = 0;
+  this->Messages.clear();
+  this->Collecting = true;
+  this->BeginRun();
+  cmSystemTools::ResetErrorOccuredFlag();
+  int ret = cm->LoadCache();
+  // The generator is replaced by a new one each time, as cmake-gui does,
+  // together with its extra generator.
+  if (cmGlobalGenerator* gg = cm->GetGlobalGenerator()) {
+    cm->SetGlobalGenerator(cm->CreateGlobalGenerator(
+      cmExternalMakefileProjectGenerator::CreateFullGeneratorName(
+        gg->GetName(), gg->GetExtraGeneratorName())));
+  }
+  if (ret >= 0) {
+    cm->PreLoadCMakeFiles();
+    ret = cm->Configure();
+  }
+  if (ret == 0) {
+    ret = cm->Generate();
+  }
+  this->Generated = ret == 0 && !cmSystemTools::GetErrorOccuredFlag();
+  this->Collecting = false;
+  if (this->Generated) {
+    std::string message = "Build files have been written to: ";
+    message += cm->GetHomeOutputDirectory();
+    cm->UpdateProgress(message.c_str(), -1);
+  }
+
+  this->EndRun();
+  return this->Generated;
+}
+
+void cmDaemon::BeginRun()
+{
+  // Note the state of the inputs as they are read.
+  this->RunStart = cmDaemonFileSystemTime();
+  for (std::map<std::string, std::string>::iterator f =
+         this->WatchedFiles.begin();
+       f != this->WatchedFiles.end(); ++f) {
+    f->second = cmDaemonFileStamp(f->first);
+  }
+}
+
+void cmDaemon::EndRun()
+{
+  std::map<std::string, std::string> const before = this->WatchedFiles;
+  this->WatchedFiles.clear();
+
+  // Watch the inputs of this run, and note the outputs, which are
+  // written by the daemon itself.
+  cmake* cm = this->CMakeInstance;
+  std::string const srcDir = cm->GetHomeDirectory();
+  std::string const binDir = cm->GetHomeOutputDirectory();
+  std::set<std::string> outputs;
+  this->WatchFile(srcDir + "/CMakeLists.txt");
+  this->WatchFile(binDir + "/CMakeCache.txt");
+  outputs.insert(binDir + "/CMakeCache.txt");
+  if (cmGlobalGenerator* gg = cm->GetGlobalGenerator()) {
+    std::vector<cmMakefile*> const& makefiles = gg->GetMakefiles();
+    for (std::vector<cmMakefile*>::const_iterator mf = makefiles.begin();
+         mf != makefiles.end(); ++mf) {
+      std::vector<std::string> const& listFiles = (*mf)->GetListFiles();
+      for (std::vector<std::string>::const_iterator f = listFiles.begin();
+           f != listFiles.end(); ++f) {
+        this->WatchFile(*f);
+      }
+      std::vector<std::string> const& outputFiles = (*mf)->GetOutputFiles();
+      outputs.insert(outputFiles.begin(), outputFiles.end());
+    }
+  }
+
+  // Inputs changed since the run started were edited while it read
+  // them, so it must be repeated.  This excludes the outputs of the
+  // run, and files of the build tree that it wrote and then read, like
+  // those of CMakeFiles or written with file(WRITE).  Their changes
+  // after the run are seen as events.
+  std::string const filesDir = binDir + cmake::GetCMakeFilesDirectory();
+  bool changed = false;
+  for (std::map<std::string, std::string>::const_iterator f =
+         this->WatchedFiles.begin();
+       !changed && f != this->WatchedFiles.end(); ++f) {
+    if (outputs.count(f->first) ||
+        cmSystemTools::IsSubDirectory(f->first, filesDir) ||
+        (cmSystemTools::IsSubDirectory(f->first, binDir) &&
+         !cmSystemTools::IsSubDirectory(f->first, srcDir))) {
+      continue;
+    }
+    std::map<std::string, std::string>::const_iterator b =
+      before.find(f->first);
+    if (b != before.end()) {
+      changed = b->second != f->second;
+    } else {
+      double mtime = 0;
+      cmDaemonFileStamp(f->first, &mtime);
+      changed = mtime >= this->RunStart;
+    }
+  }
+  if (changed) {
+    this->RegenerateTime = cmSystemTools::GetTime() + CM_DAEMON_SETTLE_TIME;
+  }
+}
+
+void cmDaemon::WatchFile(std::string const& file)
+{
+  if (!this->WatchedFiles
+         .insert(std::make_pair(file, cmDaemonFileStamp(file)))
+         .second) {
+    return;
+  }
+
+  // Directories are watched rather than the files themselves, to see
+  // files that are replaced by renaming another one over them.  Adding
+  // a directory again keeps its watch.
+  std::string dir = cmSystemTools::GetFilenamePath(file);
+  int wd = inotify_add_watch(this->Notify, dir.c_str(),
+                             IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+                               IN_CREATE | IN_DELETE);
+  if (wd >= 0) {
+    this->WatchedDirectories[wd] = dir;
+  }
+}
+
+bool cmDaemon::ReadEvents()
+{
+  union
+  {
+    struct inotify_event Event;
+    char Buffer[4096];
+  } events;
+  bool changed = false;
+  for (;;) {
+    ssize_t n = read(this->Notify, events.Buffer, sizeof(events.Buffer));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+    for (char const* p = events.Buffer; p < events.Buffer + n;) {
+      struct inotify_event const* e =
+        reinterpret_cast<struct inotify_event const*>(p);
+      if (e->mask & IN_Q_OVERFLOW) {
+        changed = true;
+      } else if (e->len > 0) {
+        // Writes made by the daemon itself, which left the file as it
+        // was noted at the end of the run, are not changes.
+        std::map<int, std::string>::const_iterator dir =
+          this->WatchedDirectories.find(e->wd);
+        std::map<std::string, std::string>::const_iterator f =
+          this->WatchedFiles.end();
+        if (dir != this->WatchedDirectories.end()) {
+          f = this->WatchedFiles.find(dir->second + "/" + e->name);
+        }
+        if (f != this->WatchedFiles.end() &&
+            cmDaemonFileStamp(f->first) != f->second) {
+          changed = true;
+        }
+      }
+      p += sizeof(struct inotify_event) + e->len;
+    }
+  }
+  return changed;
+}
+
+void cmDaemon::HandleConnection(int fd)
+{
+  // Do not let a client that never finishes its request hang the daemon.
+  struct timeval timeout;
+  timeout.tv_sec = 5;
+  timeout.tv_usec = 0;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  std::string line;
+  char buffer[1024];
+  while (line.find('\n') == line.npos) {
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+    line.append(buffer, static_cast<std::string::size_type>(n));
+  }
+  line = line.substr(0, line.find('\n'));
+
+  std::vector<std::string> request = cmSystemTools::tokenize(line, "\t");
+  Json::FastWriter writer;
+  cmDaemonWrite(fd, writer.write(this->HandleRequest(request)));
+}
+
+Json::Value cmDaemon::HandleRequest(std::vector<std::string> const& request)
+{
+  Json::Value reply(Json::objectValue);
+  std::string const name = request.empty() ? std::string() : request[0];
+  if (name == "regenerate" && request.size() == 1) {
+    reply["generated"] = this->Regenerate();
+    Json::Value& messages = reply["messages"] = Json::arrayValue;
+    for (std::vector<std::string>::const_iterator m = this->Messages.begin();
+         m != this->Messages.end(); ++m) {
+      messages.append(*m);
+    }
+    return reply;
+  }
+  if (name == "shutdown" && request.size() == 1) {
+    this->Shutdown = true;
+    reply["shutdown"] = true;
+    return reply;
+  }
+  if ((name == "list-targets" && request.size() == 1) ||
+      (name == "get-compile-flags" && request.size() == 2)) {
+    if (!this->Generated) {
+      reply["error"] = "The build tree could not be generated.  "
+                       "Fix the errors and regenerate.";
+      return reply;
+    }
+    return name == "list-targets" ? this->ListTargets()
+                                  : this->GetCompileFlags(request[1]);
+  }
+  reply["error"] = "Unknown request \"" + cmJoin(request, " ") + "\".";
+  return reply;
+}
+
+Json::Value cmDaemon::ListTargets() const
+{
+  Json::Value reply(Json::objectValue);
+  Json::Value& targets = reply["targets"] = Json::arrayValue;
+  std::vector<cmLocalGenerator*> const& lgs =
+    this->CMakeInstance->GetGlobalGenerator()->GetLocalGenerators();
+  for (std::vector<cmLocalGenerator*>::const_iterator lg = lgs.begin();
+       lg != lgs.end(); ++lg) {
+    std::vector<cmGeneratorTarget*> const& gts =
+      (*lg)->GetGeneratorTargets();
+    for (std::vector<cmGeneratorTarget*>::const_iterator gt = gts.begin();
+         gt != gts.end(); ++gt) {
+      if ((*gt)->GetType() == cmState::GLOBAL_TARGET) {
+        continue;
+      }
+      Json::Value& target = targets.append(Json::objectValue);
+      target["name"] = (*gt)->GetName();
+      target["type"] = cmState::GetTargetTypeName((*gt)->GetType());
+      target["directory"] = (*lg)->GetCurrentSourceDirectory();
+    }
+  }
+  return reply;
+}
+
+Json::Value cmDaemon::GetCompileFlags(std::string const& file) const
+{
+  Json::Value reply(Json::objectValue);
+  cmGlobalGenerator* gg = this->CMakeInstance->GetGlobalGenerator();
+  std::string const name = gg->GetName();
+  if (!cmHasLiteralSuffix(name, "Makefiles") &&
+      !cmHasLiteralSuffix(name, "Ninja")) {
+    reply["error"] = "Compile flags are only known for the Makefile and "
+                     "Ninja generators.";
+    return reply;
+  }
+
+  std::string const path = cmSystemTools::CollapseFullPath(file);
+  reply["file"] = path;
+  Json::Value& targets = reply["targets"] = Json::arrayValue;
+  std::vector<cmLocalGenerator*> const& lgs = gg->GetLocalGenerators();
+  for (std::vector<cmLocalGenerator*>::const_iterator lg = lgs.begin();
+       lg != lgs.end(); ++lg) {
+    std::string const config =
+      (*lg)->GetMakefile()->GetSafeDefinition("CMAKE_BUILD_TYPE");
+    std::vector<cmGeneratorTarget*> const& gts =
+      (*lg)->GetGeneratorTargets();
+    for (std::vector<cmGeneratorTarget*>::const_iterator gt = gts.begin();
+         gt != gts.end(); ++gt) {
+      switch ((*gt)->GetType()) {
+        case cmState::EXECUTABLE:
+        case cmState::STATIC_LIBRARY:
+        case cmState::SHARED_LIBRARY:
+        case cmState::MODULE_LIBRARY:
+        case cmState::OBJECT_LIBRARY:
+          break;
+        default:
+          continue;
+      }
+      std::vector<cmSourceFile*> sources;
+      (*gt)->GetSourceFiles(sources, config);
+      for (std::vector<cmSourceFile*>::const_iterator sf = sources.begin();
+           sf != sources.end(); ++sf) {
+        std::string const lang = (*sf)->GetLanguage();
+        if (lang.empty() || (*sf)->GetFullPath() != path) {
+          continue;
+        }
+        cmDaemonTargetFlags flags(*gt);
+        Json::Value& target = targets.append(Json::objectValue);
+        target["name"] = (*gt)->GetName();
+        target["language"] = lang;
+        target["flags"] =
+          cmSystemTools::TrimWhitespace(flags.GetSourceFlags(**sf, lang));
+        target["defines"] =
+          cmSystemTools::TrimWhitespace(flags.GetSourceDefines(**sf, lang));
+        target["includes"] =
+          cmSystemTools::TrimWhitespace(flags.GetSourceIncludes(lang));
+      }
+    }
+  }
+  if (targets.empty()) {
+    reply = Json::objectValue;
+    reply["error"] = "No target compiles " + path + ".";
+  }
+  return reply;
+}
+
+int cmDaemon::Request(std::string const& buildDir,
+                      std::vector<std::string> const& request,
+                      std::ostream& reply)
+{
+  std::string const path = GetSocketPath(buildDir);
+  struct sockaddr_un addr;
+  if (!cmDaemonSocketAddress(path, addr)) {
+    return 1;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0 ||
+      connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) <
+        0) {
+    if (fd >= 0) {
+      close(fd);
+    }
+    cmSystemTools::Error("No daemon is serving the build tree ",
+                         buildDir.c_str());
+    return 1;
+  }
+
+  // Files are named relative to the working directory of the client.
+  std::vector<std::string> args = request;
+  if (args.size() == 2 && args[0] == "get-compile-flags") {
+    args[1] = cmSystemTools::CollapseFullPath(args[1]);
+  }
+  std::string data;
+  if (cmDaemonWrite(fd, cmJoin(args, "\t") + "\n")) {
+    char buffer[4096];
+    for (;;) {
+      ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        break;
+      }
+      data.append(buffer, static_cast<std::string::size_type>(n));
+    }
+  }
+  close(fd);
+
+  Json::Value value;
+  Json::Reader reader;
+  if (!reader.parse(data, value, false) || !value.isObject()) {
+    cmSystemTools::Error("The daemon did not reply to the request.");
+    return 1;
+  }
+  reply << data;
+  if (value.isMember("error") ||
+      (value.isMember("generated") && !value["generated"].asBool())) {
+    return 1;
+  }
+  return 0;
+}
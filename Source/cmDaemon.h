@@ -0,0 +1,85 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#ifndef cmDaemon_h
+#define cmDaemon_h
+
+#include "cmStandardIncludes.h"
+
+#include "cm_jsoncpp_value.h"
+
+class cmake;
+
+/** \class cmDaemon
+ * \brief Keeps a build tree generated from a long-running cmake.
+ *
+ * The daemon configures and generates the build tree once and then
+ * keeps the cmake instance, and everything it has loaded, around.  The
+ * list files and other inputs of the configure step are watched with
+ * inotify, and the build tree is configured and generated again in the
+ * same process as soon as one of them changes.  Requests are served
+ * over the Unix socket CMakeFiles/daemon.sock of the build tree, one
+ * request per connection: the client writes a line holding the request
+ * and its arguments separated by tabs, and the daemon replies with a
+ * line holding a JSON object.
+ */
+class cmDaemon
+{
+public:
+  cmDaemon(cmake* cm);
+  ~cmDaemon();
+
+  /** Configure and generate the given build tree and serve requests
+      until asked to shut down.  Returns the exit code of cmake.  */
+  int Serve(std::string const& buildDir);
+
+  /** Send a request to the daemon of the given build tree and write
+      its reply to the stream.  Returns the exit code of cmake.  */
+  static int Request(std::string const& buildDir,
+                     std::vector<std::string> const& request,
+                     std::ostream& reply);
+
+private:
+  cmDaemon(cmDaemon const&);      // Not implemented.
+  void operator=(cmDaemon const&); // Not implemented.
+
+  static std::string GetSocketPath(std::string const& buildDir);
+  static void MessageCallback(const char* m, const char* title, bool& nomore,
+                              void* clientData);
+
+  bool Listen();
+  bool Regenerate();
+  void BeginRun();
+  void EndRun();
+  void WatchFile(std::string const& file);
+  bool ReadEvents();
+  void HandleConnection(int fd);
+  Json::Value HandleRequest(std::vector<std::string> const& request);
+  Json::Value ListTargets() const;
+  Json::Value GetCompileFlags(std::string const& file) const;
+
+  cmake* CMakeInstance;
+  std::string SocketPath;
+  int Listener;
+  int Notify;
+  std::map<int, std::string> WatchedDirectories;
+  // The inputs of the last run, with their state when it read them or,
+  // once it is done, as it left them.
+  std::map<std::string, std::string> WatchedFiles;
+  bool Generated;
+  double RegenerateTime;
+  double RunStart;
+  bool Shutdown;
+  bool Collecting;
+  std::vector<std::string> Messages;
+};
+
+#endif
@@ -62,6 +62,12 @@ cmDependsC::cmDependsC(
     }
   }
 
+  // These run on every line of every scanned file and the scan and complain
+  // expressions are user-provided, so use the engine that cannot backtrack
+  // exponentially.
+  this->IncludeRegexLine.set_engine(cmsys::RegularExpression::NFA);
+  this->IncludeRegexScan.set_engine(cmsys::RegularExpression::NFA);
+  this->IncludeRegexComplain.set_engine(cmsys::RegularExpression::NFA);
   this->IncludeRegexLine.compile(INCLUDE_REGEX_LINE);
   this->IncludeRegexScan.compile(scanRegex.c_str());
   this->IncludeRegexComplain.compile(complainRegex.c_str());
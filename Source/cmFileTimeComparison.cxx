@@ -32,6 +32,11 @@
 #include <windows.h>
 #endif
 
+// Use threads to query many files concurrently.
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+#include "cmParallelJobs.h"
+#endif
+
 class cmFileTimeComparisonInternal
 {
 public:
@@ -40,6 +45,9 @@ public:
 
   bool FileTimesDiffer(const char* f1, const char* f2);
 
+  bool FindNewestAndOldest(std::vector<std::string> const& files,
+                           size_t* newest, size_t* oldest, size_t* missing);
+
 private:
 #if defined(CMAKE_BUILD_WITH_CMAKE)
   // Use a hash table to efficiently map from file name to modification time.
@@ -65,6 +73,8 @@ private:
 
   // Internal methods to lookup and compare modification times.
   inline bool Stat(const char* fname, cmFileTimeComparison_Type* st);
+  static bool StatDisk(const char* fname, cmFileTimeComparison_Type* st);
+  void StatMany(std::vector<std::string> const& files);
   inline int Compare(cmFileTimeComparison_Type* st1,
                      cmFileTimeComparison_Type* st2);
   inline bool TimesDiffer(cmFileTimeComparison_Type* st1,
@@ -84,6 +94,21 @@ bool cmFileTimeComparisonInternal::Stat(const char* fname,
   }
 #endif
 
+  if (!StatDisk(fname, st)) {
+    return false;
+  }
+
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+  // Store the time for future use.
+  this->Files[fname] = *st;
+#endif
+
+  return true;
+}
+
+bool cmFileTimeComparisonInternal::StatDisk(const char* fname,
+                                            cmFileTimeComparison_Type* st)
+{
 #if !defined(_WIN32) || defined(__CYGWIN__)
   // POSIX version.  Use the stat function.
   int res = ::stat(fname, st);
@@ -103,12 +128,84 @@ bool cmFileTimeComparisonInternal::Stat(const char* fname,
   *st = fdata.ftLastWriteTime;
 #endif
 
+  return true;
+}
+
 #if defined(CMAKE_BUILD_WITH_CMAKE)
-  // Store the time for future use.
-  this->Files[fname] = *st;
+// Work of one thread in StatMany.  Thread i queries the files i,
+// i + Stride, i + 2*Stride, ... so no synchronization is needed.
+struct cmFileTimeComparisonStatJob
+{
+  std::vector<const char*> const* Names;
+  std::vector<cmFileTimeComparison_Type>* Stats;
+  std::vector<char>* Found;
+  size_t First;
+  size_t Stride;
+  bool (*StatDisk)(const char*, cmFileTimeComparison_Type*);
+};
+
+static void cmFileTimeComparisonStatThread(void* arg)
+{
+  cmFileTimeComparisonStatJob* job =
+    static_cast<cmFileTimeComparisonStatJob*>(arg);
+  for (size_t i = job->First; i < job->Names->size(); i += job->Stride) {
+    (*job->Found)[i] = job->StatDisk((*job->Names)[i], &(*job->Stats)[i]);
+  }
+}
+
+// Querying files is bound by the file system latency, not by the CPU.
+// Use only a few threads, and only when each gets enough files.
+static const size_t cmFileTimeComparisonMaxThreads = 8;
+static const size_t cmFileTimeComparisonFilesPerThread = 16;
 #endif
 
-  return true;
+void cmFileTimeComparisonInternal::StatMany(
+  std::vector<std::string> const& files)
+{
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+  // Collect the files whose times are not known yet.
+  std::vector<const char*> names;
+  for (std::vector<std::string>::const_iterator fi = files.begin();
+       fi != files.end(); ++fi) {
+    if (this->Files.find(*fi) == this->Files.end()) {
+      names.push_back(fi->c_str());
+    }
+  }
+  size_t nthreads = names.size() / cmFileTimeComparisonFilesPerThread;
+  if (nthreads < 2) {
+    // Not worth the thread startup.  The caller stats serially.
+    return;
+  }
+  if (nthreads > cmFileTimeComparisonMaxThreads) {
+    nthreads = cmFileTimeComparisonMaxThreads;
+  }
+
+  std::vector<cmFileTimeComparison_Type> stats(names.size());
+  std::vector<char> found(names.size(), 0);
+  std::vector<cmFileTimeComparisonStatJob> jobs(nthreads);
+  std::vector<void*> args;
+  for (size_t t = 0; t < nthreads; ++t) {
+    cmFileTimeComparisonStatJob& job = jobs[t];
+    job.Names = &names;
+    job.Stats = &stats;
+    job.Found = &found;
+    job.First = t;
+    job.Stride = nthreads;
+    job.StatDisk = &cmFileTimeComparisonInternal::StatDisk;
+    args.push_back(&job);
+  }
+  cmParallelJobs::Run(cmFileTimeComparisonStatThread, args);
+
+  // Store the times for future use.  Missing files are left out so that
+  // the caller reports them in order.
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (found[i]) {
+      this->Files[names[i]] = stats[i];
+    }
+  }
+#else
+  (void)files;
+#endif
 }
 
 cmFileTimeComparison::cmFileTimeComparison()
@@ -132,6 +229,13 @@ bool cmFileTimeComparison::FileTimesDiffer(const char* f1, const char* f2)
   return this->Internals->FileTimesDiffer(f1, f2);
 }
 
+bool cmFileTimeComparison::FindNewestAndOldest(
+  std::vector<std::string> const& files, size_t* newest, size_t* oldest,
+  size_t* missing)
+{
+  return this->Internals->FindNewestAndOldest(files, newest, oldest, missing);
+}
+
 int cmFileTimeComparisonInternal::Compare(cmFileTimeComparison_Type* s1,
                                           cmFileTimeComparison_Type* s2)
 {
@@ -261,3 +365,30 @@ bool cmFileTimeComparisonInternal::FileTimesDiffer(const char* f1,
     return true;
   }
 }
+
+bool cmFileTimeComparisonInternal::FindNewestAndOldest(
+  std::vector<std::string> const& files, size_t* newest, size_t* oldest,
+  size_t* missing)
+{
+  // Fill the time cache for all files at once.
+  this->StatMany(files);
+
+  cmFileTimeComparison_Type sNewest;
+  cmFileTimeComparison_Type sOldest;
+  for (size_t i = 0; i < files.size(); ++i) {
+    cmFileTimeComparison_Type st;
+    if (!this->Stat(files[i].c_str(), &st)) {
+      *missing = i;
+      return false;
+    }
+    if (i == 0 || this->Compare(&st, &sNewest) > 0) {
+      sNewest = st;
+      *newest = i;
+    }
+    if (i == 0 || this->Compare(&st, &sOldest) < 0) {
+      sOldest = st;
+      *oldest = i;
+    }
+  }
+  return true;
+}
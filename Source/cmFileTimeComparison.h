@@ -41,6 +41,17 @@ public:
    */
   bool FileTimesDiffer(const char* f1, const char* f2);
 
+  /**
+   *  Find the newest and the oldest of a list of files.  Files whose
+   *  times are not yet known are examined concurrently, which helps on
+   *  file systems with a high latency per query.  Return true on success
+   *  with the indices of the (first) newest and oldest files stored in
+   *  newest and oldest.  Return false if any file cannot be examined, with
+   *  the index of the first such file stored in missing.
+   */
+  bool FindNewestAndOldest(std::vector<std::string> const& files,
+                           size_t* newest, size_t* oldest, size_t* missing);
+
 protected:
   cmFileTimeComparisonInternal* Internals;
 };
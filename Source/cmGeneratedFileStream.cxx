@@ -11,6 +11,7 @@
 ============================================================================*/
 #include "cmGeneratedFileStream.h"
 
+#include "cmMakefileProfilingData.h"
 #include "cmSystemTools.h"
 
 #if defined(CMAKE_BUILD_WITH_CMAKE)
@@ -168,6 +169,9 @@ bool cmGeneratedFileStreamBase::Close()
     }
 
     replaced = true;
+    cmMakefileProfilingData::Count(cmMakefileProfilingData::FilesWritten);
+  } else if (!this->Name.empty() && this->Okay) {
+    cmMakefileProfilingData::Count(cmMakefileProfilingData::FilesUnchanged);
   }
 
   // Else, the destination was not replaced.
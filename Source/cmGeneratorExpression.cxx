@@ -13,6 +13,7 @@
 
 #include "assert.h"
 #include "cmAlgorithms.h"
+#include "cmMakefileProfilingData.h"
 #include "cmSystemTools.h"
 
 #include "cmGeneratorExpressionDAGChecker.h"
@@ -73,6 +74,8 @@ const char* cmCompiledGeneratorExpression::EvaluateWithContext(
   if (!this->NeedsEvaluation) {
     return this->Input.c_str();
   }
+  cmMakefileProfilingData::Count(
+    cmMakefileProfilingData::GeneratorExpressionEvaluations);
 
   this->Output = "";
 
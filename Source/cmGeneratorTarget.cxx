@@ -19,8 +19,10 @@
 #include "cmGlobalGenerator.h"
 #include "cmLocalGenerator.h"
 #include "cmMakefile.h"
+#include "cmMakefileProfilingData.h"
 #include "cmSourceFile.h"
 #include "cmTarget.h"
+#include "cmake.h"
 
 #include <queue>
 
@@ -3785,6 +3787,10 @@ cmComputeLinkInformation* cmGeneratorTarget::GetLinkInformation(
   std::string key(cmSystemTools::UpperCase(config));
   cmTargetLinkInformationMap::iterator i = this->LinkInformation.find(key);
   if (i == this->LinkInformation.end()) {
+    cmMakefileProfilingData::StepScope profilingScope(
+      this->LocalGenerator->GetCMakeInstance()->GetProfilingData(), "target",
+      this->GetName(), "link information");
+
     // Compute information for this configuration.
     cmComputeLinkInformation* info =
       new cmComputeLinkInformation(this, config);
@@ -29,6 +29,7 @@
 #include "cmInstallGenerator.h"
 #include "cmLocalGenerator.h"
 #include "cmMakefile.h"
+#include "cmMakefileProfilingData.h"
 #include "cmQtAutoGeneratorInitializer.h"
 #include "cmSourceFile.h"
 #include "cmState.h"
@@ -40,6 +41,7 @@
 #include <cmsys/FStream.hxx>
 
 #if defined(CMAKE_BUILD_WITH_CMAKE)
+#include "cmCryptoHash.h"
 #include "cm_jsoncpp_value.h"
 #include "cm_jsoncpp_writer.h"
 #include <cmsys/MD5.h>
@@ -80,6 +82,8 @@ cmGlobalGenerator::cmGlobalGenerator(cmake* cm)
 
   // how long to let try compiles run
   this->TryCompileTimeout = 0;
+  this->TryCompileCacheHits = 0;
+  this->TryCompileCacheMisses = 0;
 
   this->ExtraGenerator = 0;
   this->CurrentMakefile = 0;
@@ -542,21 +546,36 @@ void cmGlobalGenerator::EnableLanguage(
                              "using a broken CMakeLists.txt file or a "
                              "problematic release of CMake");
       }
-      // if the CMake(LANG)Compiler.cmake file was not found then
-      // load CMakeDetermine(LANG)Compiler.cmake
-      std::string determineCompiler = "CMakeDetermine";
-      determineCompiler += lang;
-      determineCompiler += "Compiler.cmake";
-      std::string determineFile =
-        mf->GetModulesFile(determineCompiler.c_str());
-      if (!mf->ReadListFile(determineFile.c_str())) {
-        cmSystemTools::Error("Could not find cmake module file: ",
-                             determineCompiler.c_str());
-      }
-      if (cmSystemTools::GetFatalErrorOccured()) {
-        return;
+      // Use the information another build tree stored for the same
+      // compiler, if any, as if this tree had been configured before.
+      std::string const cacheEntry = this->GetCompilerIdCacheEntry(lang, mf);
+      bool const cached = !cacheEntry.empty() &&
+        this->LoadCompilerIdCacheEntry(cacheEntry, lang, rootBin, mf);
+      if (!cached) {
+        std::vector<std::string> cacheKeys;
+        if (!cacheEntry.empty()) {
+          cacheKeys = this->CMakeInstance->GetState()->GetCacheEntryKeys();
+        }
+
+        // if the CMake(LANG)Compiler.cmake file was not found then
+        // load CMakeDetermine(LANG)Compiler.cmake
+        std::string determineCompiler = "CMakeDetermine";
+        determineCompiler += lang;
+        determineCompiler += "Compiler.cmake";
+        std::string determineFile =
+          mf->GetModulesFile(determineCompiler.c_str());
+        if (!mf->ReadListFile(determineFile.c_str())) {
+          cmSystemTools::Error("Could not find cmake module file: ",
+                               determineCompiler.c_str());
+        }
+        if (cmSystemTools::GetFatalErrorOccured()) {
+          return;
+        }
+        if (!cacheEntry.empty()) {
+          this->RecordCompilerIdCacheEntry(lang, cacheEntry, cacheKeys);
+        }
+        needTestLanguage[lang] = true;
       }
-      needTestLanguage[lang] = true;
       // Some generators like visual studio should not use the env variables
       // So the global generator can specify that in this variable
       if (!mf->GetDefinition("CMAKE_GENERATOR_NO_COMPILER_ENV")) {
@@ -576,6 +595,12 @@ void cmGlobalGenerator::EnableLanguage(
         env += envVarValue;
         cmSystemTools::PutEnv(env);
       }
+      if (cached) {
+        needTestLanguage[lang] = false;
+        this->SetLanguageEnabledFlag(lang, mf);
+        needSetLanguageEnabledMaps[lang] = true;
+        continue;
+      }
 
       // if determineLanguage was called then load the file it
       // configures CMake(LANG)Compiler.cmake
@@ -718,6 +743,8 @@ void cmGlobalGenerator::EnableLanguage(
           compilerLangFile += lang;
           compilerLangFile += "Compiler.cmake";
           cmSystemTools::RemoveFile(compilerLangFile);
+        } else {
+          this->StoreCompilerIdCacheEntry(lang, rootBin, mf);
         }
       } // end if in try compile
     }   // end need test language
@@ -847,6 +874,224 @@ void cmGlobalGenerator::CheckCompilerIdCompatibility(
   }
 }
 
+std::string cmGlobalGenerator::GetCompilerIdCacheEntry(
+  std::string const& lang, cmMakefile* mf) const
+{
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+  std::string cacheDir = mf->GetSafeDefinition("CMAKE_COMPILER_ID_CACHE_DIR");
+  if (cacheDir.empty()) {
+    cmSystemTools::GetEnv("CMAKE_COMPILER_ID_CACHE_DIR", cacheDir);
+  }
+  if (cacheDir.empty() || this->CMakeInstance->GetIsInTryCompile()) {
+    return std::string();
+  }
+  cacheDir = cmSystemTools::CollapseFullPath(
+    cacheDir, this->CMakeInstance->GetHomeOutputDirectory());
+
+  // Describe everything that may select the compiler or change what is
+  // learned about it.  The compiler found is checked when loading.
+  std::ostringstream key;
+  key << "cmake " << cmVersion::GetCMakeVersion() << "\n"
+      << "generator " << this->GetName() << "\n"
+      << "language " << lang << "\n";
+  const char* vars[] = { "CMAKE_GENERATOR_TOOLSET",
+                         "CMAKE_GENERATOR_PLATFORM",
+                         "CMAKE_SYSTEM",
+                         "CMAKE_SYSTEM_PROCESSOR",
+                         "CMAKE_CROSSCOMPILING",
+                         "CMAKE_SYSROOT",
+                         "CMAKE_OSX_ARCHITECTURES",
+                         "CMAKE_OSX_SYSROOT",
+                         "CMAKE_OSX_DEPLOYMENT_TARGET",
+                         "CMAKE_TOOLCHAIN_FILE" };
+  for (size_t i = 0; i < sizeof(vars) / sizeof(vars[0]); ++i) {
+    key << "var " << vars[i] << "=" << mf->GetSafeDefinition(vars[i])
+        << "\n";
+  }
+  const char* langVars[] = { "COMPILER", "COMPILER_ARG1", "FLAGS",
+                             "COMPILER_TARGET",
+                             "COMPILER_EXTERNAL_TOOLCHAIN" };
+  for (size_t i = 0; i < sizeof(langVars) / sizeof(langVars[0]); ++i) {
+    std::string const var = "CMAKE_" + lang + "_" + langVars[i];
+    key << "var " << var << "=" << mf->GetSafeDefinition(var) << "\n";
+  }
+  // Use only the environment variables of this language.  Enabling a
+  // language exports its compiler, e.g. in CC, which must not change the
+  // key of the languages enabled after it.
+  std::vector<std::string> envVars;
+  envVars.push_back("PATH");
+  if (lang == "C") {
+    envVars.push_back("CC");
+    envVars.push_back("CFLAGS");
+  } else if (lang == "Fortran") {
+    envVars.push_back("FC");
+    envVars.push_back("FFLAGS");
+  } else {
+    envVars.push_back(lang);
+    envVars.push_back(lang + "FLAGS");
+  }
+  envVars.push_back("LDFLAGS");
+  for (std::vector<std::string>::const_iterator ei = envVars.begin();
+       ei != envVars.end(); ++ei) {
+    std::string value;
+    cmSystemTools::GetEnv(*ei, value);
+    key << "env " << *ei << "=" << value << "\n";
+  }
+  cmsys::auto_ptr<cmCryptoHash> sha(cmCryptoHash::New("SHA256"));
+  std::string toolchain = mf->GetSafeDefinition("CMAKE_TOOLCHAIN_FILE");
+  if (!toolchain.empty()) {
+    toolchain = cmSystemTools::CollapseFullPath(
+      toolchain, this->CMakeInstance->GetHomeOutputDirectory());
+    key << "toolchain " << sha->HashFile(toolchain) << "\n";
+  }
+  return cacheDir + "/" + sha->HashString(key.str());
+#else
+  (void)lang;
+  (void)mf;
+  return std::string();
+#endif
+}
+
+bool cmGlobalGenerator::LoadCompilerIdCacheEntry(std::string const& entry,
+                                                 std::string const& lang,
+                                                 std::string const& rootBin,
+                                                 cmMakefile* mf)
+{
+  // The entry is only valid while the compiler found when it was stored
+  // is unchanged.
+  cmsys::ifstream fin((entry + "/compiler.txt").c_str());
+  std::string compiler;
+  std::string length;
+  std::string mtime;
+  if (!cmSystemTools::GetLineFromStream(fin, compiler) ||
+      !cmSystemTools::GetLineFromStream(fin, length) ||
+      !cmSystemTools::GetLineFromStream(fin, mtime)) {
+    return false;
+  }
+  std::ostringstream current;
+  current << cmSystemTools::FileLength(compiler) << "\n"
+          << cmSystemTools::ModifiedTime(compiler);
+  if (!cmSystemTools::FileExists(compiler.c_str()) ||
+      current.str() != length + "\n" + mtime) {
+    return false;
+  }
+
+  std::string const compilerFile = "CMake" + lang + "Compiler.cmake";
+  if (!cmSystemTools::CopyFileAlways(entry + "/" + compilerFile,
+                                     rootBin + "/" + compilerFile)) {
+    return false;
+  }
+  mf->ReadListFile((entry + "/cache.cmake").c_str());
+  mf->ReadListFile((rootBin + "/" + compilerFile).c_str());
+
+  std::string msg = "The " + lang + " compiler identification is ";
+  std::string const id =
+    mf->GetSafeDefinition("CMAKE_" + lang + "_COMPILER_ID");
+  msg += id.empty() ? "unknown" : id;
+  std::string const version =
+    mf->GetSafeDefinition("CMAKE_" + lang + "_COMPILER_VERSION");
+  if (!version.empty()) {
+    msg += " " + version;
+  }
+  msg += " (cached)";
+  this->CMakeInstance->UpdateProgress(msg.c_str(), -1);
+  return true;
+}
+
+void cmGlobalGenerator::RecordCompilerIdCacheEntry(
+  std::string const& lang, std::string const& entry,
+  std::vector<std::string> const& oldCacheKeys)
+{
+  std::set<std::string> const oldKeys(oldCacheKeys.begin(),
+                                      oldCacheKeys.end());
+  CompilerIdCacheEntry& ce = this->CompilerIdCacheEntries[lang];
+  ce.Directory = entry;
+  ce.CacheKeys.clear();
+  // The tools found by CMakeFindBinUtils are created as cache entries
+  // only by the first language enabled, but every entry needs them.
+  const char* binUtils[] = { "CMAKE_AR",      "CMAKE_RANLIB",
+                             "CMAKE_STRIP",   "CMAKE_LINKER",
+                             "CMAKE_NM",      "CMAKE_OBJDUMP",
+                             "CMAKE_OBJCOPY", "CMAKE_INSTALL_NAME_TOOL" };
+  std::set<std::string> const binUtilKeys(
+    binUtils, binUtils + sizeof(binUtils) / sizeof(binUtils[0]));
+  std::vector<std::string> const keys =
+    this->CMakeInstance->GetState()->GetCacheEntryKeys();
+  for (std::vector<std::string>::const_iterator ki = keys.begin();
+       ki != keys.end(); ++ki) {
+    if (oldKeys.find(*ki) == oldKeys.end() ||
+        binUtilKeys.find(*ki) != binUtilKeys.end()) {
+      ce.CacheKeys.push_back(*ki);
+    }
+  }
+}
+
+void cmGlobalGenerator::StoreCompilerIdCacheEntry(std::string const& lang,
+                                                  std::string const& rootBin,
+                                                  cmMakefile* mf)
+{
+  std::map<std::string, CompilerIdCacheEntry>::iterator it =
+    this->CompilerIdCacheEntries.find(lang);
+  if (it == this->CompilerIdCacheEntries.end()) {
+    return;
+  }
+  std::string const entry = it->second.Directory;
+  std::string const compiler =
+    mf->GetSafeDefinition("CMAKE_" + lang + "_COMPILER");
+  if (!cmSystemTools::FileIsFullPath(compiler) ||
+      !cmSystemTools::FileExists(compiler.c_str())) {
+    return;
+  }
+
+  // Fill a private directory and move it into place so that concurrent
+  // configurations never see partial entries.
+  char tmpName[64];
+  sprintf(tmpName, ".tmp-%05x", cmSystemTools::RandomSeed() & 0xFFFFF);
+  std::string const tmp = entry + tmpName;
+  if (!cmSystemTools::MakeDirectory(tmp.c_str())) {
+    return;
+  }
+  std::string const compilerFile = "CMake" + lang + "Compiler.cmake";
+  bool ok = cmSystemTools::CopyFileAlways(rootBin + "/" + compilerFile,
+                                          tmp + "/" + compilerFile);
+  if (ok) {
+    // Restore the cache entries, e.g. of the tools found next to the
+    // compiler, that a build tree gets while determining the compiler.
+    cmState* state = this->CMakeInstance->GetState();
+    cmsys::ofstream fout((tmp + "/cache.cmake").c_str());
+    std::vector<std::string> const& keys = it->second.CacheKeys;
+    for (std::vector<std::string>::const_iterator ki = keys.begin();
+         ki != keys.end(); ++ki) {
+      const char* value = state->GetCacheEntryValue(*ki);
+      if (!value) {
+        continue;
+      }
+      const char* help = state->GetCacheEntryProperty(*ki, "HELPSTRING");
+      fout << "set(" << *ki << " "
+           << cmOutputConverter::EscapeForCMake(value) << " CACHE "
+           << cmState::CacheEntryTypeToString(
+                state->GetCacheEntryType(*ki))
+           << " " << cmOutputConverter::EscapeForCMake(help ? help : "")
+           << ")\n";
+      if (state->GetCacheEntryPropertyAsBool(*ki, "ADVANCED")) {
+        fout << "mark_as_advanced(" << *ki << ")\n";
+      }
+    }
+    ok = !!fout;
+  }
+  if (ok) {
+    cmsys::ofstream fout((tmp + "/compiler.txt").c_str());
+    fout << compiler << "\n"
+         << cmSystemTools::FileLength(compiler) << "\n"
+         << cmSystemTools::ModifiedTime(compiler) << "\n";
+    ok = !!fout;
+  }
+  if (!ok || !cmSystemTools::RenameFile(tmp.c_str(), entry.c_str())) {
+    cmSystemTools::RemoveADirectory(tmp);
+  }
+  this->CompilerIdCacheEntries.erase(it);
+}
+
 std::string cmGlobalGenerator::GetLanguageOutputExtension(
   cmSourceFile const& source) const
 {
@@ -1030,6 +1275,8 @@ void cmGlobalGenerator::Configure()
 {
   this->FirstTimeProgress = 0.0f;
   this->ClearGeneratorMembers();
+  this->TryCompileCacheHits = 0;
+  this->TryCompileCacheMisses = 0;
 
   cmState::Snapshot snapshot = this->CMakeInstance->GetCurrentSnapshot();
 
@@ -1094,6 +1341,12 @@ void cmGlobalGenerator::Configure()
     } else {
       msg << "Configuring done";
     }
+    if (this->TryCompileCacheHits || this->TryCompileCacheMisses) {
+      std::ostringstream cacheMsg;
+      cacheMsg << "try_compile cache: " << this->TryCompileCacheHits
+               << " hits, " << this->TryCompileCacheMisses << " misses";
+      this->CMakeInstance->UpdateProgress(cacheMsg.str().c_str(), -1);
+    }
     this->CMakeInstance->UpdateProgress(msg.str().c_str(), -1);
   }
 }
@@ -1171,6 +1424,11 @@ void cmGlobalGenerator::ComputeBuildFileGenerators()
 
 bool cmGlobalGenerator::Compute()
 {
+  cmMakefileProfilingData* profilingData =
+    this->CMakeInstance->GetProfilingData();
+  cmMakefileProfilingData::StepScope profilingScope(profilingData, "compute",
+                                                    "Compute");
+
   // Some generators track files replaced during the Generate.
   // Start with an empty vector:
   this->FilesReplacedDuringGenerate.clear();
@@ -1184,7 +1442,11 @@ bool cmGlobalGenerator::Compute()
   }
   this->FinalizeTargetCompileInfo();
 
-  this->CreateGenerationObjects();
+  {
+    cmMakefileProfilingData::StepScope stepScope(profilingData, "compute",
+                                                 "CreateGenerationObjects");
+    this->CreateGenerationObjects();
+  }
 
   // at this point this->LocalGenerators has been filled,
   // so create the map from project name to vector of local generators
@@ -1225,20 +1487,32 @@ bool cmGlobalGenerator::Compute()
 
   // Trace the dependencies, after that no custom commands should be added
   // because their dependencies might not be handled correctly
-  for (i = 0; i < this->LocalGenerators.size(); ++i) {
-    this->LocalGenerators[i]->TraceDependencies();
+  {
+    cmMakefileProfilingData::StepScope stepScope(profilingData, "compute",
+                                                 "TraceDependencies");
+    for (i = 0; i < this->LocalGenerators.size(); ++i) {
+      this->LocalGenerators[i]->TraceDependencies();
+    }
   }
 
   this->ForceLinkerLanguages();
 
   // Compute the manifest of main targets generated.
-  for (i = 0; i < this->LocalGenerators.size(); ++i) {
-    this->LocalGenerators[i]->ComputeTargetManifest();
+  {
+    cmMakefileProfilingData::StepScope stepScope(profilingData, "compute",
+                                                 "ComputeTargetManifest");
+    for (i = 0; i < this->LocalGenerators.size(); ++i) {
+      this->LocalGenerators[i]->ComputeTargetManifest();
+    }
   }
 
   // Compute the inter-target dependencies.
-  if (!this->ComputeTargetDepends()) {
-    return false;
+  {
+    cmMakefileProfilingData::StepScope stepScope(profilingData, "compute",
+                                                 "ComputeTargetDepends");
+    if (!this->ComputeTargetDepends()) {
+      return false;
+    }
   }
 
   for (i = 0; i < this->LocalGenerators.size(); ++i) {
@@ -1250,14 +1524,27 @@ bool cmGlobalGenerator::Compute()
 
 void cmGlobalGenerator::Generate()
 {
+  cmMakefileProfilingData* profilingData =
+    this->CMakeInstance->GetProfilingData();
+  cmMakefileProfilingData::StepScope profilingScope(profilingData, "generate",
+                                                    "Generate");
+
   // Create a map from local generator to the complete set of targets
   // it builds by default.
   this->InitializeProgressMarks();
 
-  this->ProcessEvaluationFiles();
+  {
+    cmMakefileProfilingData::StepScope stepScope(profilingData, "generate",
+                                                 "ProcessEvaluationFiles");
+    this->ProcessEvaluationFiles();
+  }
 
   // Generate project files
   for (unsigned int i = 0; i < this->LocalGenerators.size(); ++i) {
+    cmMakefileProfilingData::StepScope stepScope(
+      profilingData, "generate",
+      this->LocalGenerators[i]->GetCurrentSourceDirectory(),
+      "local generator");
     this->SetCurrentMakefile(this->LocalGenerators[i]->GetMakefile());
     this->LocalGenerators[i]->Generate();
     if (!this->LocalGenerators[i]->GetMakefile()->IsOn(
@@ -1643,6 +1930,26 @@ int cmGlobalGenerator::TryCompile(const std::string& srcdir,
                      config, false, fast, false, this->TryCompileTimeout);
 }
 
+void cmGlobalGenerator::GenerateTryCompileBuildCommand(
+  std::vector<std::string>& makeCommand, const std::string& bindir,
+  const std::string& projectName, const std::string& target, bool fast,
+  cmMakefile* mf)
+{
+  std::string config =
+    mf->GetSafeDefinition("CMAKE_TRY_COMPILE_CONFIGURATION");
+  this->GenerateBuildCommand(makeCommand, "", projectName, bindir, target,
+                             config, fast, false);
+}
+
+void cmGlobalGenerator::CountTryCompileCacheLookup(bool hit)
+{
+  if (hit) {
+    ++this->TryCompileCacheHits;
+  } else {
+    ++this->TryCompileCacheMisses;
+  }
+}
+
 void cmGlobalGenerator::GenerateBuildCommand(
   std::vector<std::string>& makeCommand, const std::string&,
   const std::string&, const std::string&, const std::string&,
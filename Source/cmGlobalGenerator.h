@@ -138,6 +138,18 @@ public:
                  const std::string& projectName, const std::string& targetName,
                  bool fast, std::string& output, cmMakefile* mf);
 
+  /** Compute the command that TryCompile runs to build a project.  */
+  void GenerateTryCompileBuildCommand(std::vector<std::string>& makeCommand,
+                                      const std::string& bindir,
+                                      const std::string& projectName,
+                                      const std::string& target, bool fast,
+                                      cmMakefile* mf);
+
+  /** Count a lookup of a try_compile result in the directory named by
+      CMAKE_TRY_COMPILE_CACHE_DIR.  The counts are reported at the end
+      of the configure step.  */
+  void CountTryCompileCacheLookup(bool hit);
+
   /**
    * Build a file given the following information. This is a more direct call
    * that is used by both CTest and TryCompile. If target name is NULL or
@@ -452,6 +464,8 @@ private:
   GeneratorTargetMap GeneratorTargetSearchIndex;
 
   cmMakefile* TryCompileOuterMakefile;
+  unsigned int TryCompileCacheHits;
+  unsigned int TryCompileCacheMisses;
   // If you add a new map here, make sure it is copied
   // in EnableLanguagesFromGenerator
   std::map<std::string, bool> IgnoreExtensions;
@@ -484,6 +498,26 @@ private:
   void CheckCompilerIdCompatibility(cmMakefile* mf,
                                     std::string const& lang) const;
 
+  // Compiler information of enabled languages kept in the directory
+  // named by CMAKE_COMPILER_ID_CACHE_DIR for use by other build trees.
+  struct CompilerIdCacheEntry
+  {
+    std::string Directory;
+    // Cache entries created while determining the compiler.
+    std::vector<std::string> CacheKeys;
+  };
+  std::map<std::string, CompilerIdCacheEntry> CompilerIdCacheEntries;
+  std::string GetCompilerIdCacheEntry(std::string const& lang,
+                                      cmMakefile* mf) const;
+  bool LoadCompilerIdCacheEntry(std::string const& entry,
+                                std::string const& lang,
+                                std::string const& rootBin, cmMakefile* mf);
+  void RecordCompilerIdCacheEntry(std::string const& lang,
+                                  std::string const& entry,
+                                  std::vector<std::string> const& oldKeys);
+  void StoreCompilerIdCacheEntry(std::string const& lang,
+                                 std::string const& rootBin, cmMakefile* mf);
+
   void ComputeBuildFileGenerators();
 
   cmExternalMakefileProjectGenerator* ExtraGenerator;
@@ -45,6 +45,8 @@ public:
   virtual void EnableLanguage(std::vector<std::string> const& languages,
                               cmMakefile*, bool optional);
 
+  virtual bool AllowOptionalInclude() const { return false; }
+
 private:
   void PrintCompilerAdvice(std::ostream& os, std::string const& lang,
                            const char* envVar) const;
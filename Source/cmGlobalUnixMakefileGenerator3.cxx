@@ -12,6 +12,7 @@
 #include "cmGlobalUnixMakefileGenerator3.h"
 
 #include "cmAlgorithms.h"
+#include "cmCheckBuildSystemManifest.h"
 #include "cmGeneratedFileStream.h"
 #include "cmGeneratorTarget.h"
 #include "cmLocalUnixMakefileGenerator3.h"
@@ -278,10 +279,15 @@ void cmGlobalUnixMakefileGenerator3::WriteMainCMakefile()
   // Write the do not edit header.
   lg->WriteDisclaimer(cmakefileStream);
 
+  // The check-build-system step reads the same information from a
+  // binary manifest when it is up to date.
+  cmCheckBuildSystemManifest manifest;
+
   // Save the generator name
   cmakefileStream << "# The generator used is:\n"
                   << "set(CMAKE_DEPENDS_GENERATOR \"" << this->GetName()
                   << "\")\n\n";
+  manifest.Generator = this->GetName();
 
   // for each cmMakefile get its list of dependencies
   std::vector<std::string> lfiles;
@@ -308,15 +314,17 @@ void cmGlobalUnixMakefileGenerator3::WriteMainCMakefile()
   cache += "/CMakeCache.txt";
 
   // Save the list to the cmake file.
+  cache = lg->Convert(cache, cmOutputConverter::START_OUTPUT);
   cmakefileStream
     << "# The top level Makefile was generated from the following files:\n"
     << "set(CMAKE_MAKEFILE_DEPENDS\n"
-    << "  \"" << lg->Convert(cache, cmOutputConverter::START_OUTPUT) << "\"\n";
+    << "  \"" << cache << "\"\n";
+  manifest.Depends.push_back(cache);
   for (std::vector<std::string>::const_iterator i = lfiles.begin();
        i != lfiles.end(); ++i) {
-    cmakefileStream << "  \""
-                    << lg->Convert(*i, cmOutputConverter::START_OUTPUT)
-                    << "\"\n";
+    std::string dep = lg->Convert(*i, cmOutputConverter::START_OUTPUT);
+    cmakefileStream << "  \"" << dep << "\"\n";
+    manifest.Depends.push_back(dep);
   }
   cmakefileStream << "  )\n\n";
 
@@ -335,6 +343,10 @@ void cmGlobalUnixMakefileGenerator3::WriteMainCMakefile()
                   << lg->Convert(check, cmOutputConverter::START_OUTPUT)
                   << "\"\n";
   cmakefileStream << "  )\n\n";
+  manifest.Outputs.push_back(
+    lg->Convert(makefileName, cmOutputConverter::START_OUTPUT));
+  manifest.Outputs.push_back(
+    lg->Convert(check, cmOutputConverter::START_OUTPUT));
 
   // CMake must rerun if a byproduct is missing.
   {
@@ -344,9 +356,9 @@ void cmGlobalUnixMakefileGenerator3::WriteMainCMakefile()
       lg->GetMakefile()->GetOutputFiles();
     for (std::vector<std::string>::const_iterator k = outfiles.begin();
          k != outfiles.end(); ++k) {
-      cmakefileStream << "  \""
-                      << lg->Convert(*k, cmOutputConverter::HOME_OUTPUT)
-                      << "\"\n";
+      std::string product = lg->Convert(*k, cmOutputConverter::HOME_OUTPUT);
+      cmakefileStream << "  \"" << product << "\"\n";
+      manifest.Products.push_back(product);
     }
 
     // add in all the directory information files
@@ -357,20 +369,27 @@ void cmGlobalUnixMakefileGenerator3::WriteMainCMakefile()
       tmpStr = lg->GetCurrentBinaryDirectory();
       tmpStr += cmake::GetCMakeFilesDirectory();
       tmpStr += "/CMakeDirectoryInformation.cmake";
-      cmakefileStream << "  \""
-                      << lg->Convert(tmpStr, cmOutputConverter::HOME_OUTPUT)
-                      << "\"\n";
+      tmpStr = lg->Convert(tmpStr, cmOutputConverter::HOME_OUTPUT);
+      cmakefileStream << "  \"" << tmpStr << "\"\n";
+      manifest.Products.push_back(tmpStr);
     }
     cmakefileStream << "  )\n\n";
   }
 
-  this->WriteMainCMakefileLanguageRules(cmakefileStream,
-                                        this->LocalGenerators);
+  this->WriteMainCMakefileLanguageRules(
+    cmakefileStream, this->LocalGenerators, manifest.DependInfoFiles);
+
+  // Write the manifest only after the check file is in place so that it
+  // is not older than the check file.
+  if (cmakefileStream.Close()) {
+    manifest.Write(cmakefileName);
+  }
 }
 
 void cmGlobalUnixMakefileGenerator3::WriteMainCMakefileLanguageRules(
   cmGeneratedFileStream& cmakefileStream,
-  std::vector<cmLocalGenerator*>& lGenerators)
+  std::vector<cmLocalGenerator*>& lGenerators,
+  std::vector<std::string>& dependInfoFiles)
 {
   cmLocalUnixMakefileGenerator3* lg;
 
@@ -394,6 +413,7 @@ void cmGlobalUnixMakefileGenerator3::WriteMainCMakefileLanguageRules(
         tname += "/DependInfo.cmake";
         cmSystemTools::ConvertToUnixSlashes(tname);
         cmakefileStream << "  \"" << tname << "\"\n";
+        dependInfoFiles.push_back(tname);
       }
     }
   }
@@ -96,8 +96,9 @@ public:
    */
   virtual void Generate();
 
-  void WriteMainCMakefileLanguageRules(cmGeneratedFileStream& cmakefileStream,
-                                       std::vector<cmLocalGenerator*>&);
+  void WriteMainCMakefileLanguageRules(
+    cmGeneratedFileStream& cmakefileStream, std::vector<cmLocalGenerator*>&,
+    std::vector<std::string>& dependInfoFiles);
 
   // write out the help rule listing the valid targets
   void WriteHelpRule(std::ostream& ruleFileStream,
@@ -136,6 +137,9 @@ public:
   /** Does the make tool tolerate .DELETE_ON_ERROR? */
   virtual bool AllowDeleteOnError() const { return true; }
 
+  /** Does the make tool support -include of files that may not exist?  */
+  virtual bool AllowOptionalInclude() const { return true; }
+
   virtual void ComputeTargetObjectDirectory(cmGeneratorTarget* gt) const;
 
   std::string IncludeDirective;
@@ -46,6 +46,7 @@ public:
 
   virtual bool AllowNotParallel() const { return false; }
   virtual bool AllowDeleteOnError() const { return false; }
+  virtual bool AllowOptionalInclude() const { return false; }
 };
 
 #endif
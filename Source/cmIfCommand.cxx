@@ -94,12 +94,8 @@ bool cmIfFunctionBlocker::IsFunctionBlocked(const cmListFileFunction& lff,
 
             cmake::MessageType messType;
 
-            cmListFileContext conditionContext =
-              cmListFileContext::FromCommandContext(
-                this->Functions[c], this->GetStartingContext().FilePath);
-
             cmConditionEvaluator conditionEvaluator(
-              mf, conditionContext, mf.GetBacktrace(this->Functions[c]));
+              mf, mf.GetBacktrace(this->Functions[c]));
 
             bool isTrue = conditionEvaluator.IsTrue(expandedArguments,
                                                     errorString, messType);
@@ -177,9 +173,8 @@ bool cmIfCommand::InvokeInitialPass(
 
   cmake::MessageType status;
 
-  cmConditionEvaluator conditionEvaluator(
-    *(this->Makefile), this->Makefile->GetExecutionContext(),
-    this->Makefile->GetBacktrace());
+  cmConditionEvaluator conditionEvaluator(*(this->Makefile),
+                                          this->Makefile->GetBacktrace());
 
   bool isTrue =
     conditionEvaluator.IsTrue(expandedArguments, errorString, status);
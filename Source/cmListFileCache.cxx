@@ -332,10 +332,19 @@ bool cmListFileParser::AddArgument(cmListFileLexer_Token* token,
   }
 }
 
-struct cmListFileBacktrace::Entry : public cmListFileContext
+std::string const& cmListFileIntern(std::string const& s)
 {
-  Entry(cmListFileContext const& lfc, Entry* up)
-    : cmListFileContext(lfc)
+  static std::set<std::string> strings;
+  return *strings.insert(s).first;
+}
+
+struct cmListFileBacktrace::Entry
+{
+  Entry(std::string const& name, std::string const& file, long line,
+        Entry* up)
+    : Name(&name)
+    , FilePath(&file)
+    , Line(line)
     , Up(up)
     , RefCount(0)
   {
@@ -356,14 +365,51 @@ struct cmListFileBacktrace::Entry : public cmListFileContext
       delete this;
     }
   }
+  cmListFileContext GetContext() const
+  {
+    cmListFileContext lfc;
+    lfc.Name = *this->Name;
+    lfc.FilePath = *this->FilePath;
+    lfc.Line = this->Line;
+    return lfc;
+  }
+
+  // Keep the storage of deleted entries for new ones.
+  static void* operator new(size_t size);
+  static void operator delete(void* p);
+  static void* FreeList;
+
+  // Interned strings.  The name is empty for whole-file scopes.
+  std::string const* Name;
+  std::string const* FilePath;
+  long Line;
   Entry* Up;
   unsigned int RefCount;
 };
 
+void* cmListFileBacktrace::Entry::FreeList = 0;
+
+void* cmListFileBacktrace::Entry::operator new(size_t size)
+{
+  assert(size == sizeof(Entry));
+  if (void* p = FreeList) {
+    FreeList = *static_cast<void**>(p);
+    return p;
+  }
+  return ::operator new(size);
+}
+
+void cmListFileBacktrace::Entry::operator delete(void* p)
+{
+  *static_cast<void**>(p) = FreeList;
+  FreeList = p;
+}
+
 cmListFileBacktrace::cmListFileBacktrace(cmState::Snapshot bottom, Entry* up,
-                                         cmListFileContext const& lfc)
+                                         std::string const& name,
+                                         std::string const& file, long line)
   : Bottom(bottom)
-  , Cur(new Entry(lfc, up))
+  , Cur(new Entry(name, file, line, up))
 {
   assert(this->Bottom.IsValid());
   this->Cur->Ref();
@@ -423,15 +469,25 @@ cmListFileBacktrace cmListFileBacktrace::Push(std::string const& file) const
   // any specific line or command invocation within it.  This context
   // is useful to print when it is at the top but otherwise can be
   // skipped during call stack printing.
-  cmListFileContext lfc;
-  lfc.FilePath = file;
-  return cmListFileBacktrace(this->Bottom, this->Cur, lfc);
+  static std::string const& noName = cmListFileIntern(std::string());
+  return cmListFileBacktrace(this->Bottom, this->Cur, noName,
+                             cmListFileIntern(file), 0);
 }
 
 cmListFileBacktrace cmListFileBacktrace::Push(
   cmListFileContext const& lfc) const
 {
-  return cmListFileBacktrace(this->Bottom, this->Cur, lfc);
+  return cmListFileBacktrace(this->Bottom, this->Cur,
+                             cmListFileIntern(lfc.Name),
+                             cmListFileIntern(lfc.FilePath), lfc.Line);
+}
+
+cmListFileBacktrace cmListFileBacktrace::Push(
+  cmCommandContext const& cc, cmState::Snapshot const& snapshot) const
+{
+  return cmListFileBacktrace(this->Bottom, this->Cur,
+                             cmListFileIntern(cc.Name),
+                             snapshot.GetExecutionListFile(), cc.Line);
 }
 
 cmListFileBacktrace cmListFileBacktrace::Pop() const
@@ -440,14 +496,12 @@ cmListFileBacktrace cmListFileBacktrace::Pop() const
   return cmListFileBacktrace(this->Bottom, this->Cur->Up);
 }
 
-cmListFileContext const& cmListFileBacktrace::Top() const
+cmListFileContext cmListFileBacktrace::Top() const
 {
   if (this->Cur) {
-    return *this->Cur;
-  } else {
-    static cmListFileContext const empty;
-    return empty;
+    return this->Cur->GetContext();
   }
+  return cmListFileContext();
 }
 
 void cmListFileBacktrace::PrintTitle(std::ostream& out) const
@@ -456,7 +510,7 @@ void cmListFileBacktrace::PrintTitle(std::ostream& out) const
     return;
   }
   cmOutputConverter converter(this->Bottom);
-  cmListFileContext lfc = *this->Cur;
+  cmListFileContext lfc = this->Cur->GetContext();
   if (!this->Bottom.GetState()->GetIsInTryCompile()) {
     lfc.FilePath = converter.Convert(lfc.FilePath, cmOutputConverter::HOME);
   }
@@ -472,7 +526,7 @@ void cmListFileBacktrace::PrintCallStack(std::ostream& out) const
   bool first = true;
   cmOutputConverter converter(this->Bottom);
   for (Entry* i = this->Cur->Up; i; i = i->Up) {
-    if (i->Name.empty()) {
+    if (i->Name->empty()) {
       // Skip this whole-file scope.  When we get here we already will
       // have printed a more-specific context within the file.
       continue;
@@ -481,7 +535,7 @@ void cmListFileBacktrace::PrintCallStack(std::ostream& out) const
       first = false;
       out << "Call Stack (most recent call first):\n";
     }
-    cmListFileContext lfc = *i;
+    cmListFileContext lfc = i->GetContext();
     if (!this->Bottom.GetState()->GetIsInTryCompile()) {
       lfc.FilePath = converter.Convert(lfc.FilePath, cmOutputConverter::HOME);
     }
@@ -106,8 +106,16 @@ struct cmListFileFunction : public cmCommandContext
   std::vector<cmListFileArgument> Arguments;
 };
 
+// Get the copy of the given string shared by all equal strings given.
+// It lives as long as the process, so that backtraces can refer to
+// file paths and command names without copying them.
+std::string const& cmListFileIntern(std::string const& s);
+
 // Represent a backtrace (call stack).  Provide value semantics
 // but use efficient reference-counting underneath to avoid copies.
+// The frames refer to interned names and file paths, and are recycled
+// when no longer referenced, so pushing a command call does not
+// allocate once the deepest call stack has been seen.
 class cmListFileBacktrace
 {
 public:
@@ -133,13 +141,19 @@ public:
   // May not be called until after construction with a valid snapshot.
   cmListFileBacktrace Push(cmListFileContext const& lfc) const;
 
+  // Get a backtrace with a call of the given command, in the list file
+  // being executed in the given snapshot, added to the top.
+  // May not be called until after construction with a valid snapshot.
+  cmListFileBacktrace Push(cmCommandContext const& cc,
+                           cmState::Snapshot const& snapshot) const;
+
   // Get a backtrace with the top level removed.
   // May not be called until after a matching Push.
   cmListFileBacktrace Pop() const;
 
   // Get the context at the top of the backtrace.
   // Returns an empty context if the backtrace is empty.
-  cmListFileContext const& Top() const;
+  cmListFileContext Top() const;
 
   // Print the top of the backtrace.
   void PrintTitle(std::ostream& out) const;
@@ -152,7 +166,8 @@ private:
   cmState::Snapshot Bottom;
   Entry* Cur;
   cmListFileBacktrace(cmState::Snapshot bottom, Entry* up,
-                      cmListFileContext const& lfc);
+                      std::string const& name, std::string const& file,
+                      long line);
   cmListFileBacktrace(cmState::Snapshot bottom, Entry* cur);
 };
 
@@ -30,6 +30,8 @@
 
 #if defined(CMAKE_BUILD_WITH_CMAKE)
 #define CM_LG_ENCODE_OBJECT_NAMES
+#include "cm_jsoncpp_value.h"
+#include "cm_jsoncpp_writer.h"
 #include <cmsys/MD5.h>
 #endif
 
@@ -161,6 +163,16 @@ void cmLocalGenerator::GenerateTestFiles()
     fout << "include(\"" << testIncludeFile << "\")" << std::endl;
   }
 
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+  // Describe the same tests in a manifest that ctest reads instead of
+  // running this script, unless the script runs arbitrary code.
+  Json::Value manifest(Json::objectValue);
+  manifest["version"] = 1;
+  Json::Value& manifestTests = manifest["tests"] = Json::arrayValue;
+  Json::Value& manifestSubdirs = manifest["subdirs"] = Json::arrayValue;
+  bool manifestComplete = !testIncludeFile;
+#endif
+
   // Ask each test generator to write its code.
   std::vector<cmTestGenerator*> const& testers =
     this->Makefile->GetTestGenerators();
@@ -168,6 +180,12 @@ void cmLocalGenerator::GenerateTestFiles()
        gi != testers.end(); ++gi) {
     (*gi)->Compute(this);
     (*gi)->Generate(fout, config, configurationTypes);
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+    if (manifestComplete) {
+      manifestComplete = (*gi)->GenerateManifest(
+        manifestTests.append(Json::arrayValue), config, configurationTypes);
+    }
+#endif
   }
   size_t i;
   std::vector<cmState::Snapshot> children =
@@ -176,9 +194,32 @@ void cmLocalGenerator::GenerateTestFiles()
     // TODO: Use add_subdirectory instead?
     fout << "subdirs(";
     std::string outP = children[i].GetDirectory().GetCurrentBinary();
-    fout << this->Convert(outP, START_OUTPUT);
+    std::string subdir = this->Convert(outP, START_OUTPUT);
+    fout << subdir;
     fout << ")" << std::endl;
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+    if (subdir.empty() ||
+        subdir.find_first_of(" \t\r\n()#\"\\$;") != std::string::npos) {
+      manifestComplete = false;
+    }
+    manifestSubdirs.append(subdir);
+#endif
   }
+
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+  // Write the manifest after the script so that it is not older.
+  std::string manifestFile =
+    this->StateSnapshot.GetDirectory().GetCurrentBinary();
+  manifestFile += "/CTestTestfile.json";
+  if (manifestComplete) {
+    fout.Close();
+    cmGeneratedFileStream mout(manifestFile.c_str());
+    Json::FastWriter writer;
+    mout << writer.write(manifest);
+  } else {
+    cmSystemTools::RemoveFile(manifestFile);
+  }
+#endif
 }
 
 void cmLocalGenerator::CreateEvaluationFileOutputs(std::string const& config)
@@ -16,6 +16,7 @@
 #include "cmGeneratedFileStream.h"
 #include "cmGlobalNinjaGenerator.h"
 #include "cmMakefile.h"
+#include "cmMakefileProfilingData.h"
 #include "cmNinjaTargetGenerator.h"
 #include "cmSourceFile.h"
 #include "cmState.h"
@@ -76,6 +77,9 @@ void cmLocalNinjaGenerator::Generate()
     if ((*t)->GetType() == cmState::INTERFACE_LIBRARY) {
       continue;
     }
+    cmMakefileProfilingData::StepScope profilingScope(
+      this->GetCMakeInstance()->GetProfilingData(), "target",
+      (*t)->GetName(), "generate");
     cmNinjaTargetGenerator* tg = cmNinjaTargetGenerator::New(*t);
     if (tg) {
       tg->Generate();
@@ -17,6 +17,7 @@
 #include "cmGeneratedFileStream.h"
 #include "cmGlobalUnixMakefileGenerator3.h"
 #include "cmMakefile.h"
+#include "cmMakefileProfilingData.h"
 #include "cmMakefileTargetGenerator.h"
 #include "cmSourceFile.h"
 #include "cmVersion.h"
@@ -121,6 +122,9 @@ void cmLocalUnixMakefileGenerator3::Generate()
     if ((*t)->GetType() == cmState::INTERFACE_LIBRARY) {
       continue;
     }
+    cmMakefileProfilingData::StepScope profilingScope(
+      this->GetCMakeInstance()->GetProfilingData(), "target",
+      (*t)->GetName(), "generate");
     cmsys::auto_ptr<cmMakefileTargetGenerator> tg(
       cmMakefileTargetGenerator::New(*t));
     if (tg.get()) {
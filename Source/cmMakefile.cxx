@@ -19,12 +19,14 @@
 #include "cmGeneratorExpressionEvaluationFile.h"
 #include "cmGlobalGenerator.h"
 #include "cmListFileCache.h"
+#include "cmMakefileProfilingData.h"
 #include "cmOutputConverter.h"
 #include "cmSourceFile.h"
 #include "cmSourceFileLocation.h"
 #include "cmState.h"
 #include "cmSystemTools.h"
 #include "cmTest.h"
+#include "cmTryCompileBatch.h"
 #include "cmVersion.h"
 #ifdef CMAKE_BUILD_WITH_CMAKE
 #include "cmVariableWatch.h"
@@ -56,6 +58,7 @@ cmMakefile::cmMakefile(cmGlobalGenerator* globalGenerator,
   this->CheckSystemVars = this->GetCMakeInstance()->GetCheckSystemVars();
 
   this->SuppressWatches = false;
+  this->TryCompileBatch = 0;
 
   // Setup the default include complaint regular expression (match nothing).
   this->ComplainFileRegularExpression = "^$";
@@ -103,6 +106,7 @@ cmMakefile::~cmMakefile()
   cmDeleteAll(this->FinalPassCommands);
   cmDeleteAll(this->FunctionBlockers);
   cmDeleteAll(this->EvaluationFiles);
+  delete this->TryCompileBatch;
 }
 
 void cmMakefile::IssueMessage(cmake::MessageType t,
@@ -156,19 +160,12 @@ cmListFileBacktrace cmMakefile::GetBacktrace() const
 
 cmListFileBacktrace cmMakefile::GetBacktrace(cmCommandContext const& cc) const
 {
-  cmListFileContext lfc;
-  lfc.Name = cc.Name;
-  lfc.Line = cc.Line;
-  lfc.FilePath = this->StateSnapshot.GetExecutionListFile();
-  return this->Backtrace.Push(lfc);
+  return this->Backtrace.Push(cc, this->StateSnapshot);
 }
 
 cmListFileContext cmMakefile::GetExecutionContext() const
 {
-  cmListFileContext const& cur = this->Backtrace.Top();
-  cmListFileContext lfc;
-  lfc.Name = cur.Name;
-  lfc.Line = cur.Line;
+  cmListFileContext lfc = this->Backtrace.Top();
   lfc.FilePath = this->StateSnapshot.GetExecutionListFile();
   return lfc;
 }
@@ -204,9 +201,8 @@ public:
                  cmExecutionStatus& status)
     : Makefile(mf)
   {
-    cmListFileContext const& lfc = cmListFileContext::FromCommandContext(
-      cc, this->Makefile->StateSnapshot.GetExecutionListFile());
-    this->Makefile->Backtrace = this->Makefile->Backtrace.Push(lfc);
+    this->Makefile->Backtrace =
+      this->Makefile->Backtrace.Push(cc, this->Makefile->StateSnapshot);
     this->Makefile->ExecutionStatusStack.push_back(&status);
   }
 
@@ -254,8 +250,16 @@ bool cmMakefile::ExecuteCommand(const cmListFileFunction& lff,
         this->PrintCommandTrace(lff);
       }
       // Try invoking the command.
-      if (!pcmd->InvokeInitialPass(lff.Arguments, status) ||
-          status.GetNestedError()) {
+      bool invokeSucceeded;
+      if (cmMakefileProfilingData* profilingData =
+            this->GetCMakeInstance()->GetProfilingData()) {
+        cmMakefileProfilingData::CommandScope profilingScope(
+          *profilingData, this, lff, pcmd.get());
+        invokeSucceeded = pcmd->InvokeInitialPass(lff.Arguments, status);
+      } else {
+        invokeSucceeded = pcmd->InvokeInitialPass(lff.Arguments, status);
+      }
+      if (!invokeSucceeded || status.GetNestedError()) {
         if (!status.GetNestedError()) {
           // The command invocation requested that we report an error.
           this->IssueMessage(cmake::FATAL_ERROR, pcmd->GetError());
@@ -488,6 +492,19 @@ bool cmMakefile::ReadListFile(const char* filename)
 
 void cmMakefile::ReadListFile(cmListFile const& listFile,
                               std::string const& filenametoread)
+{
+  if (cmMakefileProfilingData* profilingData =
+        this->GetCMakeInstance()->GetProfilingData()) {
+    cmMakefileProfilingData::ListFileScope profilingScope(*profilingData,
+                                                          filenametoread);
+    this->RunListFile(listFile, filenametoread);
+  } else {
+    this->RunListFile(listFile, filenametoread);
+  }
+}
+
+void cmMakefile::RunListFile(cmListFile const& listFile,
+                             std::string const& filenametoread)
 {
   // add this list file to the list of dependencies
   this->ListFiles.push_back(filenametoread);
@@ -872,19 +889,34 @@ void cmMakefile::UpdateOutputToSourceMap(
 void cmMakefile::UpdateOutputToSourceMap(std::string const& output,
                                          cmSourceFile* source)
 {
+  // Multiple custom commands may produce the same output but may
+  // be attached to a different source file (MAIN_DEPENDENCY).
+  // The look up of relative outputs would return the first one,
+  // so keep the mapping for the first one.
+  //
+  // TODO: Warn the user about this case.  However, the VS 8 generator
+  // triggers it for separate generate.stamp rules in ZERO_CHECK and
+  // individual targets.
   OutputToSourceMap::iterator i = this->OutputToSource.find(output);
-  if (i != this->OutputToSource.end()) {
-    // Multiple custom commands produce the same output but may
-    // be attached to a different source file (MAIN_DEPENDENCY).
-    // LinearGetSourceFileWithOutput would return the first one,
-    // so keep the mapping for the first one.
-    //
-    // TODO: Warn the user about this case.  However, the VS 8 generator
-    // triggers it for separate generate.stamp rules in ZERO_CHECK and
-    // individual targets.
-    return;
+  if (i == this->OutputToSource.end()) {
+    this->OutputToSource[output] = source;
+  }
+
+  // Index the output under every relative path it may be looked up with.
+  // All sources producing it are kept since the first one is wanted.
+  std::string::size_type pos = 0;
+  for (;;) {
+    std::vector<cmSourceFile*>& sources =
+      this->OutputSuffixToSources[output.substr(pos)];
+    if (sources.empty() || sources.back() != source) {
+      sources.push_back(source);
+    }
+    pos = output.find('/', pos);
+    if (pos == std::string::npos) {
+      break;
+    }
+    ++pos;
   }
-  this->OutputToSource[output] = source;
 }
 
 cmSourceFile* cmMakefile::AddCustomCommandToOutput(
@@ -1428,6 +1460,12 @@ void cmMakefile::Configure()
     return;
   }
   this->ReadListFile(listFile, currentStart);
+  if (this->TryCompileBatch) {
+    this->IssueMessage(cmake::FATAL_ERROR,
+                       "try_compile_batch(BEGIN) is not followed by "
+                       "try_compile_batch(END) in this directory.");
+    this->SetTryCompileBatch(0);
+  }
   if (cmSystemTools::GetFatalErrorOccured()) {
     scope.Quiet();
   }
@@ -1828,45 +1866,67 @@ cmTarget* cmMakefile::AddNewTarget(cmState::TargetType type,
   return &it->second;
 }
 
-cmSourceFile* cmMakefile::LinearGetSourceFileWithOutput(
+// Check whether the custom command of a source file has an output that
+// is the given name or ends in it after a '/'.
+static bool cmMakefileHasOutputWithSuffix(cmSourceFile* sf,
+                                          std::string const& name)
+{
+  cmCustomCommand const* cc = sf->GetCustomCommand();
+  if (!cc) {
+    return false;
+  }
+  const std::vector<std::string>& outputs = cc->GetOutputs();
+  for (std::vector<std::string>::const_iterator o = outputs.begin();
+       o != outputs.end(); ++o) {
+    std::string::size_type pos = o->rfind(name);
+    if (pos != o->npos && pos == o->size() - name.size() &&
+        (pos == 0 || (*o)[pos - 1] == '/')) {
+      return true;
+    }
+  }
+  return false;
+}
+
+cmSourceFile* cmMakefile::GetSourceFileWithOutputSuffix(
   const std::string& name) const
 {
-  std::string out;
+  OutputSuffixMap::const_iterator i = this->OutputSuffixToSources.find(name);
+  if (i == this->OutputSuffixToSources.end()) {
+    return 0;
+  }
 
-  // look through all the source files that have custom commands
-  // and see if the custom command has the passed source file as an output
-  for (std::vector<cmSourceFile*>::const_iterator i =
-         this->SourceFiles.begin();
-       i != this->SourceFiles.end(); ++i) {
-    // does this source file have a custom command?
-    if ((*i)->GetCustomCommand()) {
-      // Does the output of the custom command match the source file name?
-      const std::vector<std::string>& outputs =
-        (*i)->GetCustomCommand()->GetOutputs();
-      for (std::vector<std::string>::const_iterator o = outputs.begin();
-           o != outputs.end(); ++o) {
-        out = *o;
-        std::string::size_type pos = out.rfind(name);
-        // If the output matches exactly
-        if (pos != out.npos && pos == out.size() - name.size() &&
-            (pos == 0 || out[pos - 1] == '/')) {
-          return *i;
-        }
-      }
+  // The custom command of a source may have been replaced since its
+  // outputs were indexed, so check the current outputs.
+  std::set<cmSourceFile*> found;
+  for (std::vector<cmSourceFile*>::const_iterator s = i->second.begin();
+       s != i->second.end(); ++s) {
+    if (cmMakefileHasOutputWithSuffix(*s, name)) {
+      found.insert(*s);
     }
   }
+  if (found.size() <= 1) {
+    return found.empty() ? 0 : *found.begin();
+  }
 
-  // otherwise return NULL
+  // Several sources match.  Return the one listed first, as a search
+  // through all source files would.
+  for (std::vector<cmSourceFile*>::const_iterator s =
+         this->SourceFiles.begin();
+       s != this->SourceFiles.end(); ++s) {
+    if (found.count(*s)) {
+      return *s;
+    }
+  }
   return 0;
 }
 
 cmSourceFile* cmMakefile::GetSourceFileWithOutput(
   const std::string& name) const
 {
-  // If the queried path is not absolute we use the backward compatible
-  // linear-time search for an output with a matching suffix.
+  // If the queried path is not absolute we look for an output with a
+  // matching suffix.
   if (!cmSystemTools::FileIsFullPath(name.c_str())) {
-    return this->LinearGetSourceFileWithOutput(name);
+    return this->GetSourceFileWithOutputSuffix(name);
   }
   // Otherwise we use an efficient lookup map.
   OutputToSourceMap::const_iterator o = this->OutputToSource.find(name);
@@ -3002,14 +3062,79 @@ void cmMakefile::SetArgcArgv(const std::vector<std::string>& args)
   }
 }
 
+// Compute the names under which a source file location is indexed.  Two
+// locations can only match if they share one of these names: either the
+// name itself, or, for a name ending in one of the extensions that are
+// tried for an ambiguous name, the name without that extension.
+static void cmMakefileSourceFileKeys(cmSourceFileLocation const& sfl,
+                                     std::vector<std::string>& keys)
+{
+  keys.clear();
+  std::string name = sfl.GetName();
+#if defined(_WIN32) || defined(__APPLE__)
+  name = cmSystemTools::LowerCase(name);
+#endif
+  keys.push_back(name);
+  std::string const& sfName = sfl.GetName();
+  std::string::size_type dot = sfName.rfind('.');
+  if (dot == std::string::npos || dot == 0) {
+    return;
+  }
+  std::string const ext = sfName.substr(dot + 1);
+  cmake* cm = sfl.GetMakefile()->GetCMakeInstance();
+  std::vector<std::string> const& srcExts = cm->GetSourceExtensions();
+  std::vector<std::string> const& hdrExts = cm->GetHeaderExtensions();
+  if (std::find(srcExts.begin(), srcExts.end(), ext) != srcExts.end() ||
+      std::find(hdrExts.begin(), hdrExts.end(), ext) != hdrExts.end()) {
+    keys.push_back(name.substr(0, dot));
+  }
+}
+
+void cmMakefile::IndexSource(size_t index) const
+{
+  std::vector<std::string> keys;
+  cmMakefileSourceFileKeys(this->SourceFiles[index]->GetLocation(), keys);
+  for (std::vector<std::string>::const_iterator ki = keys.begin();
+       ki != keys.end(); ++ki) {
+    std::vector<size_t>& bucket = this->SourceFileIndex[*ki];
+    if (std::find(bucket.begin(), bucket.end(), index) == bucket.end()) {
+      bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), index),
+                    index);
+    }
+  }
+}
+
 cmSourceFile* cmMakefile::GetSource(const std::string& sourceName) const
 {
   cmSourceFileLocation sfl(this, sourceName);
-  for (std::vector<cmSourceFile*>::const_iterator sfi =
-         this->SourceFiles.begin();
-       sfi != this->SourceFiles.end(); ++sfi) {
-    cmSourceFile* sf = *sfi;
+
+  // Collect the files that may match and try them in the order in which
+  // they were created, as a search over all files would.
+  std::vector<std::string> keys;
+  cmMakefileSourceFileKeys(sfl, keys);
+  std::vector<size_t> candidates;
+  for (std::vector<std::string>::const_iterator ki = keys.begin();
+       ki != keys.end(); ++ki) {
+    SourceFileIndexMap::const_iterator i = this->SourceFileIndex.find(*ki);
+    if (i != this->SourceFileIndex.end()) {
+      candidates.insert(candidates.end(), i->second.begin(), i->second.end());
+    }
+  }
+  if (keys.size() > 1) {
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                     candidates.end());
+  }
+
+  for (std::vector<size_t>::const_iterator ci = candidates.begin();
+       ci != candidates.end(); ++ci) {
+    cmSourceFile* sf = this->SourceFiles[*ci];
+    std::string const name = sf->GetLocation().GetName();
     if (sf->Matches(sfl)) {
+      // A match may have resolved an ambiguous extension.
+      if (sf->GetLocation().GetName() != name) {
+        this->IndexSource(*ci);
+      }
       return sf;
     }
   }
@@ -3024,6 +3149,7 @@ cmSourceFile* cmMakefile::CreateSource(const std::string& sourceName,
     sf->SetProperty("GENERATED", "1");
   }
   this->SourceFiles.push_back(sf);
+  this->IndexSource(this->SourceFiles.size() - 1);
   return sf;
 }
 
@@ -3053,6 +3179,42 @@ int cmMakefile::TryCompile(const std::string& srcdir,
                            std::string& output)
 {
   this->IsSourceFileTryCompile = fast;
+  std::string cwd = cmSystemTools::GetCurrentWorkingDirectory();
+  int ret = this->ConfigureTryCompileProject(srcdir, bindir, cmakeArgs);
+  if (ret == 0) {
+    // finally call the generator to actually build the resulting project
+    ret = this->GetGlobalGenerator()->TryCompile(
+      srcdir, bindir, projectName, targetName, fast, output, this);
+  }
+
+  // return to the original directory
+  cmSystemTools::ChangeDirectory(cwd);
+  this->IsSourceFileTryCompile = false;
+  return ret;
+}
+
+int cmMakefile::ConfigureTryCompile(
+  const std::string& srcdir, const std::string& bindir,
+  const std::string& projectName, const std::string& targetName, bool fast,
+  const std::vector<std::string>* cmakeArgs,
+  std::vector<std::string>& buildCommand)
+{
+  this->IsSourceFileTryCompile = fast;
+  std::string cwd = cmSystemTools::GetCurrentWorkingDirectory();
+  int ret = this->ConfigureTryCompileProject(srcdir, bindir, cmakeArgs);
+  if (ret == 0) {
+    this->GetGlobalGenerator()->GenerateTryCompileBuildCommand(
+      buildCommand, bindir, projectName, targetName, fast, this);
+  }
+  cmSystemTools::ChangeDirectory(cwd);
+  this->IsSourceFileTryCompile = false;
+  return ret;
+}
+
+int cmMakefile::ConfigureTryCompileProject(
+  const std::string& srcdir, const std::string& bindir,
+  const std::vector<std::string>* cmakeArgs)
+{
   // does the binary directory exist ? If not create it...
   if (!cmSystemTools::FileIsDirectory(bindir)) {
     cmSystemTools::MakeDirectory(bindir.c_str());
@@ -3060,7 +3222,6 @@ int cmMakefile::TryCompile(const std::string& srcdir,
 
   // change to the tests directory and run cmake
   // use the cmake object instead of calling cmake
-  std::string cwd = cmSystemTools::GetCurrentWorkingDirectory();
   cmSystemTools::ChangeDirectory(bindir);
 
   // make sure the same generator is used
@@ -3073,9 +3234,6 @@ int cmMakefile::TryCompile(const std::string& srcdir,
   if (!gg) {
     cmSystemTools::Error(
       "Internal CMake error, TryCompile bad GlobalGenerator");
-    // return to the original directory
-    cmSystemTools::ChangeDirectory(cwd);
-    this->IsSourceFileTryCompile = false;
     return 1;
   }
   cm.SetGlobalGenerator(gg);
@@ -3137,28 +3295,16 @@ int cmMakefile::TryCompile(const std::string& srcdir,
   if (cm.Configure() != 0) {
     cmSystemTools::Error(
       "Internal CMake error, TryCompile configure of cmake failed");
-    // return to the original directory
-    cmSystemTools::ChangeDirectory(cwd);
-    this->IsSourceFileTryCompile = false;
     return 1;
   }
 
   if (cm.Generate() != 0) {
     cmSystemTools::Error(
       "Internal CMake error, TryCompile generation of cmake failed");
-    // return to the original directory
-    cmSystemTools::ChangeDirectory(cwd);
-    this->IsSourceFileTryCompile = false;
     return 1;
   }
 
-  // finally call the generator to actually build the resulting project
-  int ret = this->GetGlobalGenerator()->TryCompile(
-    srcdir, bindir, projectName, targetName, fast, output, this);
-
-  cmSystemTools::ChangeDirectory(cwd);
-  this->IsSourceFileTryCompile = false;
-  return ret;
+  return 0;
 }
 
 bool cmMakefile::GetIsSourceFileTryCompile() const
@@ -3166,6 +3312,14 @@ bool cmMakefile::GetIsSourceFileTryCompile() const
   return this->IsSourceFileTryCompile;
 }
 
+void cmMakefile::SetTryCompileBatch(cmTryCompileBatch* batch)
+{
+  if (batch != this->TryCompileBatch) {
+    delete this->TryCompileBatch;
+    this->TryCompileBatch = batch;
+  }
+}
+
 cmake* cmMakefile::GetCMakeInstance() const
 {
   return this->GlobalGenerator->GetCMakeInstance();
@@ -46,6 +46,7 @@ class cmInstallGenerator;
 class cmSourceFile;
 class cmTest;
 class cmTestGenerator;
+class cmTryCompileBatch;
 class cmVariableWatch;
 class cmake;
 class cmMakefileCall;
@@ -109,8 +110,28 @@ public:
                  bool fast, const std::vector<std::string>* cmakeArgs,
                  std::string& output);
 
+  /**
+   * Configure and generate a try compile project like TryCompile but
+   * only compute the command that builds it instead of running it.
+   */
+  int ConfigureTryCompile(const std::string& srcdir, const std::string& bindir,
+                          const std::string& projectName,
+                          const std::string& targetName, bool fast,
+                          const std::vector<std::string>* cmakeArgs,
+                          std::vector<std::string>& buildCommand);
+
   bool GetIsSourceFileTryCompile() const;
 
+  /**
+   * Get the try_compile batch open in this directory, if any.  The
+   * makefile owns the batch set here until it is set again.
+   */
+  cmTryCompileBatch* GetTryCompileBatch() const
+  {
+    return this->TryCompileBatch;
+  }
+  void SetTryCompileBatch(cmTryCompileBatch* batch);
+
   /**
    * Help enforce global target name uniqueness.
    */
@@ -807,6 +828,21 @@ protected:
   std::map<std::string, std::string> AliasTargets;
   std::vector<cmSourceFile*> SourceFiles;
 
+// Positions in SourceFiles of the files with a given name, for GetSource.
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+#ifdef CMake_HAVE_CXX11_UNORDERED_MAP
+  typedef std::unordered_map<std::string, std::vector<size_t> >
+    SourceFileIndexMap;
+#else
+  typedef cmsys::hash_map<std::string, std::vector<size_t> >
+    SourceFileIndexMap;
+#endif
+#else
+  typedef std::map<std::string, std::vector<size_t> > SourceFileIndexMap;
+#endif
+  mutable SourceFileIndexMap SourceFileIndex;
+  void IndexSource(size_t index) const;
+
   // Tests
   std::map<std::string, cmTest*> Tests;
 
@@ -851,6 +887,8 @@ private:
 
   void ReadListFile(cmListFile const& listFile,
                     const std::string& filenametoread);
+  void RunListFile(cmListFile const& listFile,
+                   const std::string& filenametoread);
 
   bool ParseDefineFlag(std::string const& definition, bool remove);
 
@@ -906,12 +944,11 @@ private:
     bool noEscapes, bool atOnly, const char* filename, long line,
     bool removeEmpty, bool replaceAt) const;
   /**
-   * Old version of GetSourceFileWithOutput(const std::string&) kept for
-   * backward-compatibility. It implements a linear search and support
-   * relative file paths. It is used as a fall back by
-   * GetSourceFileWithOutput(const std::string&).
+   * Version of GetSourceFileWithOutput(const std::string&) for relative
+   * file paths.  It finds the first source file with an output that ends
+   * in the given path, matching whole path components.
    */
-  cmSourceFile* LinearGetSourceFileWithOutput(const std::string& cname) const;
+  cmSourceFile* GetSourceFileWithOutputSuffix(const std::string& name) const;
 
 // A map for fast output to input look up.
 #if defined(CMAKE_BUILD_WITH_CMAKE)
@@ -925,6 +962,21 @@ private:
 #endif
   OutputToSourceMap OutputToSource;
 
+// A map from each output and each of its suffixes that follow a '/' to
+// the source files producing it, for relative output look up.
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+#ifdef CMake_HAVE_CXX11_UNORDERED_MAP
+  typedef std::unordered_map<std::string, std::vector<cmSourceFile*> >
+    OutputSuffixMap;
+#else
+  typedef cmsys::hash_map<std::string, std::vector<cmSourceFile*> >
+    OutputSuffixMap;
+#endif
+#else
+  typedef std::map<std::string, std::vector<cmSourceFile*> > OutputSuffixMap;
+#endif
+  OutputSuffixMap OutputSuffixToSources;
+
   void UpdateOutputToSourceMap(std::vector<std::string> const& outputs,
                                cmSourceFile* source);
   void UpdateOutputToSourceMap(std::string const& output,
@@ -957,6 +1009,11 @@ private:
   bool CheckCMP0000;
   bool IsSourceFileTryCompile;
   mutable bool SuppressWatches;
+  cmTryCompileBatch* TryCompileBatch;
+
+  int ConfigureTryCompileProject(const std::string& srcdir,
+                                 const std::string& bindir,
+                                 const std::vector<std::string>* cmakeArgs);
 };
 
 #endif
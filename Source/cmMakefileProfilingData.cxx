@@ -0,0 +1,331 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmMakefileProfilingData.h"
+
+#include "cmCommand.h"
+#include "cmListFileCache.h"
+#include "cmMakefile.h"
+#include "cmSystemTools.h"
+
+#include <assert.h>
+
+unsigned long cmMakefileProfilingData::Counters[CounterCount];
+
+const char* const cmMakefileProfilingData::CounterNames[CounterCount] = {
+  "generator expression evaluations", "link information computations",
+  "files written", "files unchanged"
+};
+
+// The number of targets listed in the summary.
+#define CM_PROFILING_TOP_TARGETS 20
+
+cmMakefileProfilingData::Totals::Totals()
+  : Count(0)
+  , Total(0)
+  , Self(0)
+  , Max(0)
+{
+}
+
+cmMakefileProfilingData::cmMakefileProfilingData(std::string const& traceFile)
+  : TraceFile(traceFile)
+  , Trace(traceFile.c_str())
+  , FirstEvent(true)
+{
+  this->Origin = cmSystemTools::GetTime();
+  if (this->Trace) {
+    this->Trace << "{\"traceEvents\":[\n"
+                << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,"
+                << "\"tid\":0,\"args\":{\"name\":\"cmake\"}}";
+    this->FirstEvent = false;
+  }
+}
+
+cmMakefileProfilingData::~cmMakefileProfilingData()
+{
+  if (!this->Trace) {
+    return;
+  }
+  this->Trace << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  this->Trace.close();
+  this->WriteSummary(this->TraceFile + ".summary.txt");
+}
+
+bool cmMakefileProfilingData::IsValid() const
+{
+  return this->Trace ? true : false;
+}
+
+void cmMakefileProfilingData::StartEntry()
+{
+  Entry e;
+  e.Start = cmSystemTools::GetTime();
+  e.Children = 0;
+  this->Stack.push_back(e);
+}
+
+static void cmMakefileProfilingDataEscape(std::ostream& os,
+                                          std::string const& s)
+{
+  os << '"';
+  for (std::string::const_iterator c = s.begin(); c != s.end(); ++c) {
+    switch (*c) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      case '\r':
+        os << "\\r";
+        break;
+      case '\t':
+        os << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(*c) < 0x20) {
+          char buf[8];
+          sprintf(buf, "\\u%04x", static_cast<unsigned char>(*c));
+          os << buf;
+        } else {
+          os << *c;
+        }
+        break;
+    }
+  }
+  os << '"';
+}
+
+void cmMakefileProfilingData::StopEntry(const char* category,
+                                        std::string const& name,
+                                        std::string const& file, long line,
+                                        std::string const& detail)
+{
+  assert(!this->Stack.empty());
+  double const stop = cmSystemTools::GetTime();
+  Entry const e = this->Stack.back();
+  this->Stack.pop_back();
+  double const duration = stop - e.Start;
+  double const self = duration - e.Children;
+  if (!this->Stack.empty()) {
+    this->Stack.back().Children += duration;
+  }
+
+  // Times are given in microseconds since the run started.
+  long const ts = static_cast<long>((e.Start - this->Origin) * 1e6);
+  long const dur = static_cast<long>(duration * 1e6);
+  this->Trace << (this->FirstEvent ? "" : ",\n") << "{\"name\":";
+  cmMakefileProfilingDataEscape(this->Trace, name);
+  this->Trace << ",\"cat\":\"" << category << "\",\"ph\":\"X\""
+              << ",\"ts\":" << ts << ",\"dur\":" << dur
+              << ",\"pid\":0,\"tid\":0,\"args\":{";
+  if (!file.empty()) {
+    this->Trace << "\"file\":";
+    cmMakefileProfilingDataEscape(this->Trace, file);
+    if (line > 0) {
+      this->Trace << ",\"line\":" << line;
+    }
+    if (!detail.empty()) {
+      this->Trace << ',';
+    }
+  }
+  if (!detail.empty()) {
+    this->Trace << "\"args\":";
+    cmMakefileProfilingDataEscape(this->Trace, detail);
+  }
+  this->Trace << "}}";
+  this->FirstEvent = false;
+
+  // List files are summed up by file, the time they take themselves
+  // being that of the commands they call.  Everything else is summed
+  // up by name.
+  if (strcmp(category, "listfile") == 0) {
+    Totals& t = this->FileTotals[name];
+    t.Count++;
+    t.Total += duration;
+    t.Max = std::max(t.Max, duration);
+    return;
+  }
+  TotalsMap* totals = &this->CommandTotals;
+  if (strcmp(category, "target") == 0) {
+    totals = &this->TargetTotals;
+  } else if (strcmp(category, "compute") == 0 ||
+             strcmp(category, "generate") == 0) {
+    totals = &this->StepTotals;
+    this->WriteCounters(stop);
+  } else if (!file.empty()) {
+    this->FileTotals[file].Self += self;
+  }
+  Totals& t = (*totals)[name];
+  t.Count++;
+  t.Total += duration;
+  t.Self += self;
+  t.Max = std::max(t.Max, duration);
+}
+
+void cmMakefileProfilingData::WriteCounters(double now)
+{
+  long const ts = static_cast<long>((now - this->Origin) * 1e6);
+  this->Trace << ",\n{\"name\":\"counters\",\"ph\":\"C\",\"ts\":" << ts
+              << ",\"pid\":0,\"tid\":0,\"args\":{";
+  for (int c = 0; c < CounterCount; ++c) {
+    this->Trace << (c ? "," : "") << '"' << CounterNames[c]
+                << "\":" << Counters[c];
+  }
+  this->Trace << "}}";
+}
+
+namespace {
+struct cmMakefileProfilingDataBySelf
+{
+  template <typename T>
+  bool operator()(T const* l, T const* r) const
+  {
+    return l->second.Self > r->second.Self;
+  }
+};
+}
+
+void cmMakefileProfilingData::WriteTotals(std::ostream& os,
+                                          std::string const& title,
+                                          const char* countHeader,
+                                          const char* nameHeader,
+                                          TotalsMap const& totals,
+                                          size_t limit)
+{
+  std::vector<TotalsMap::value_type const*> sorted;
+  for (TotalsMap::const_iterator i = totals.begin(); i != totals.end(); ++i) {
+    sorted.push_back(&*i);
+  }
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   cmMakefileProfilingDataBySelf());
+  if (limit && sorted.size() > limit) {
+    sorted.resize(limit);
+  }
+
+  os << title << " (times in milliseconds, by self time)\n\n";
+  os << std::setw(8) << countHeader << std::setw(12) << "Total"
+     << std::setw(12) << "Self" << std::setw(12) << "Max"
+     << "  " << nameHeader << "\n";
+  os << std::fixed << std::setprecision(3);
+  for (std::vector<TotalsMap::value_type const*>::const_iterator i =
+         sorted.begin();
+       i != sorted.end(); ++i) {
+    Totals const& t = (*i)->second;
+    os << std::setw(8) << t.Count << std::setw(12) << t.Total * 1000
+       << std::setw(12) << t.Self * 1000 << std::setw(12) << t.Max * 1000
+       << "  " << (*i)->first << "\n";
+  }
+  os << "\n";
+}
+
+void cmMakefileProfilingData::WriteSummary(
+  std::string const& summaryFile) const
+{
+  cmsys::ofstream fout(summaryFile.c_str());
+  if (!fout) {
+    cmSystemTools::Error("Could not write profiling summary ",
+                         summaryFile.c_str());
+    return;
+  }
+  WriteTotals(fout, "Commands", "Calls", "Command", this->CommandTotals);
+  WriteTotals(fout, "Files", "Reads", "File", this->FileTotals);
+  if (!this->StepTotals.empty()) {
+    WriteTotals(fout, "Generate steps", "Calls", "Step", this->StepTotals);
+  }
+  if (!this->TargetTotals.empty()) {
+    std::ostringstream title;
+    title << "Targets, top " << CM_PROFILING_TOP_TARGETS;
+    WriteTotals(fout, title.str(), "Steps", "Target", this->TargetTotals,
+                CM_PROFILING_TOP_TARGETS);
+  }
+  fout << "Counters\n\n";
+  for (int c = 0; c < CounterCount; ++c) {
+    fout << std::setw(8) << Counters[c] << "  " << CounterNames[c] << "\n";
+  }
+}
+
+cmMakefileProfilingData::CommandScope::CommandScope(
+  cmMakefileProfilingData& data, cmMakefile const* mf,
+  cmListFileFunction const& lff, cmCommand* cmd)
+  : Data(data)
+  , Name(cmd->GetName())
+  , File(mf->GetExecutionFilePath())
+  , Line(lff.Line)
+{
+  if (cmd->IsA("cmFunctionHelperCommand")) {
+    this->Category = "function";
+  } else if (cmd->IsA("cmMacroHelperCommand")) {
+    this->Category = "macro";
+  } else if (this->Name == "try_compile" || this->Name == "try_run" ||
+             this->Name == "try_compile_batch") {
+    this->Category = "try_compile";
+  } else if (cmHasLiteralPrefix(this->Name, "find_")) {
+    this->Category = "find";
+  } else {
+    this->Category = "command";
+  }
+  for (std::vector<cmListFileArgument>::const_iterator i =
+         lff.Arguments.begin();
+       i != lff.Arguments.end(); ++i) {
+    if (i != lff.Arguments.begin()) {
+      this->Arguments += " ";
+    }
+    this->Arguments += i->Value;
+  }
+  this->Data.StartEntry();
+}
+
+cmMakefileProfilingData::CommandScope::~CommandScope()
+{
+  this->Data.StopEntry(this->Category, this->Name, this->File, this->Line,
+                       this->Arguments);
+}
+
+cmMakefileProfilingData::ListFileScope::ListFileScope(
+  cmMakefileProfilingData& data, std::string const& file)
+  : Data(data)
+  , File(file)
+{
+  this->Data.StartEntry();
+}
+
+cmMakefileProfilingData::ListFileScope::~ListFileScope()
+{
+  this->Data.StopEntry("listfile", this->File, std::string(), 0,
+                       std::string());
+}
+
+cmMakefileProfilingData::StepScope::StepScope(cmMakefileProfilingData* data,
+                                              const char* category,
+                                              std::string const& name,
+                                              std::string const& detail)
+  : Data(data)
+  , Category(category)
+{
+  if (this->Data) {
+    this->Name = name;
+    this->Detail = detail;
+    this->Data->StartEntry();
+  }
+}
+
+cmMakefileProfilingData::StepScope::~StepScope()
+{
+  if (this->Data) {
+    this->Data->StopEntry(this->Category, this->Name, std::string(), 0,
+                          this->Detail);
+  }
+}
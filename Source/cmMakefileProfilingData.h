@@ -0,0 +1,161 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#ifndef cmMakefileProfilingData_h
+#define cmMakefileProfilingData_h
+
+#include "cmStandardIncludes.h"
+
+#include <cmsys/FStream.hxx>
+
+class cmCommand;
+class cmMakefile;
+struct cmListFileFunction;
+
+/** \class cmMakefileProfilingData
+ * \brief Records how long the steps of a cmake run take.
+ *
+ * The cmake instance owns one of these when --profiling-output is
+ * given.  Each command executed, each list file read and each other
+ * step timed is written to the output file as a complete event of the
+ * Chrome trace event format as soon as it finishes, so that the file
+ * can be loaded into chrome://tracing or Perfetto.  The time spent is
+ * also summed up per command, per file, per step of the generate step
+ * and per target, and the totals are written as tables to
+ * <file>.summary.txt when the run ends, along with the counters.
+ */
+class cmMakefileProfilingData
+{
+public:
+  /** Start recording to the given file.  Check IsValid() afterwards.  */
+  cmMakefileProfilingData(std::string const& traceFile);
+
+  /** Finish the trace and write the summary.  */
+  ~cmMakefileProfilingData();
+
+  /** Whether the trace file could be opened.  */
+  bool IsValid() const;
+
+  /** Start timing a step.  Steps nest, and each StartEntry must be
+      matched by a StopEntry before the enclosing step stops.  */
+  void StartEntry();
+
+  /** Stop timing the innermost step and record it under the given
+      category and name, with the file and line it comes from and any
+      further detail such as the arguments of a command.  The step is
+      also added to the summary: "listfile" steps by file, "compute" and
+      "generate" steps by name, "target" steps by target name and other
+      steps by command name.  */
+  void StopEntry(const char* category, std::string const& name,
+                 std::string const& file, long line,
+                 std::string const& detail);
+
+  /** Things counted whether profiling is enabled or not.  */
+  enum Counter
+  {
+    GeneratorExpressionEvaluations,
+    LinkInformationComputations,
+    FilesWritten,
+    FilesUnchanged,
+    CounterCount
+  };
+
+  /** Count one more of the given thing.  */
+  static void Count(Counter c) { ++Counters[c]; }
+
+  /** Time a command from construction to destruction.  */
+  class CommandScope
+  {
+  public:
+    CommandScope(cmMakefileProfilingData& data, cmMakefile const* mf,
+                 cmListFileFunction const& lff, cmCommand* cmd);
+    ~CommandScope();
+
+  private:
+    cmMakefileProfilingData& Data;
+    const char* Category;
+    std::string Name;
+    std::string File;
+    long Line;
+    std::string Arguments;
+  };
+
+  /** Time the reading of a list file from construction to
+      destruction.  */
+  class ListFileScope
+  {
+  public:
+    ListFileScope(cmMakefileProfilingData& data, std::string const& file);
+    ~ListFileScope();
+
+  private:
+    cmMakefileProfilingData& Data;
+    std::string File;
+  };
+
+  /** Time a step of the generate step, or a step for a target, from
+      construction to destruction.  Does nothing if data is null.  */
+  class StepScope
+  {
+  public:
+    StepScope(cmMakefileProfilingData* data, const char* category,
+              std::string const& name,
+              std::string const& detail = std::string());
+    ~StepScope();
+
+  private:
+    cmMakefileProfilingData* Data;
+    const char* Category;
+    std::string Name;
+    std::string Detail;
+  };
+
+private:
+  cmMakefileProfilingData(cmMakefileProfilingData const&); // Not implemented.
+  void operator=(cmMakefileProfilingData const&);          // Not implemented.
+
+  struct Entry
+  {
+    double Start;
+    double Children;
+  };
+
+  struct Totals
+  {
+    Totals();
+    unsigned long Count;
+    double Total;
+    double Self;
+    double Max;
+  };
+  typedef std::map<std::string, Totals> TotalsMap;
+
+  void WriteCounters(double now);
+  void WriteSummary(std::string const& summaryFile) const;
+  static void WriteTotals(std::ostream& os, std::string const& title,
+                          const char* countHeader, const char* nameHeader,
+                          TotalsMap const& totals, size_t limit = 0);
+
+  static unsigned long Counters[CounterCount];
+  static const char* const CounterNames[CounterCount];
+
+  std::string TraceFile;
+  cmsys::ofstream Trace;
+  double Origin;
+  bool FirstEvent;
+  std::vector<Entry> Stack;
+  TotalsMap CommandTotals;
+  TotalsMap FileTotals;
+  TotalsMap StepTotals;
+  TotalsMap TargetTotals;
+};
+
+#endif
@@ -50,6 +50,8 @@ cmMakefileTargetGenerator::cmMakefileTargetGenerator(cmGeneratorTarget* target)
         cm->GetState()->GetGlobalProperty("RULE_MESSAGES")) {
     this->NoRuleMessages = cmSystemTools::IsOff(ruleStatus);
   }
+  this->CompilerDepends = this->GlobalGenerator->AllowOptionalInclude() &&
+    this->Makefile->IsOn("CMAKE_DEPENDS_USE_COMPILER");
   MacOSXContentGenerator = new MacOSXContentGeneratorType(this);
 }
 
@@ -207,6 +209,18 @@ void cmMakefileTargetGenerator::WriteCommonCodeRules()
                      cmOutputConverter::MAKERULE)
     << "\n\n";
 
+  if (this->CompilerDepends) {
+    // Include the dependencies written by the compiler.
+    std::string compilerDependFile = this->TargetBuildDirectoryFull;
+    compilerDependFile += "/compiler_depend.make";
+    *this->BuildFileStream
+      << "# Include the dependencies generated by the compiler.\n"
+      << this->GlobalGenerator->IncludeDirective << " " << root
+      << this->Convert(compilerDependFile, cmOutputConverter::HOME_OUTPUT,
+                       cmOutputConverter::MAKERULE)
+      << "\n\n";
+  }
+
   if (!this->NoRuleMessages) {
     // Include the progress variables for the target.
     *this->BuildFileStream
@@ -377,6 +391,11 @@ void cmMakefileTargetGenerator::WriteObjectRuleFiles(
   // generate the build rule file
   this->WriteObjectBuildFile(obj, lang, source, depends);
 
+  // The compiler checks the dependencies of this object itself.
+  if (this->UseCompilerDepends(lang)) {
+    return;
+  }
+
   // The object file should be checked for dependency integrity.
   std::string objFullPath = this->LocalGenerator->GetCurrentBinaryDirectory();
   objFullPath += "/";
@@ -587,6 +606,30 @@ void cmMakefileTargetGenerator::WriteObjectBuildFile(
         source.GetFullPath(), workingDirectory, compileCommand);
     }
 
+    // Have the compiler write the dependencies of the object to a depfile
+    // next to it.  This is not part of the exported compile command, nor
+    // of the preprocess and assembly rules.
+    std::string compileFlags = flags;
+    if (this->UseCompilerDepends(lang)) {
+      std::string depfile = obj + ".d";
+      std::string depfileFlags = this->Makefile->GetSafeDefinition(
+        "CMAKE_MAKE_DEPFILE_FLAGS_" + lang);
+      cmSystemTools::ReplaceString(
+        depfileFlags, "<DEPFILE>",
+        this->Convert(depfile, cmOutputConverter::NONE,
+                      cmOutputConverter::SHELL)
+          .c_str());
+      cmSystemTools::ReplaceString(
+        depfileFlags, "<OBJECT>",
+        this->Convert(relativeObj, cmOutputConverter::NONE,
+                      cmOutputConverter::SHELL)
+          .c_str());
+      this->LocalGenerator->AppendFlags(compileFlags, depfileFlags);
+      vars.Flags = compileFlags.c_str();
+      this->CleanFiles.push_back(depfile);
+      this->CompilerDependFiles.push_back(relativeObj + ".d");
+    }
+
     // Maybe insert an include-what-you-use runner.
     if (!compileCommands.empty() && (lang == "C" || lang == "CXX")) {
       std::string const iwyu_prop = lang + "_INCLUDE_WHAT_YOU_USE";
@@ -633,6 +676,7 @@ void cmMakefileTargetGenerator::WriteObjectBuildFile(
          i != compileCommands.end(); ++i) {
       this->LocalGenerator->ExpandRuleVariables(*i, vars);
     }
+    vars.Flags = flags.c_str();
 
     // Change the command working directory to the local build tree.
     this->LocalGenerator->CreateCDCommand(
@@ -905,6 +949,36 @@ bool cmMakefileTargetGenerator::WriteMakeRule(
   return symbolic;
 }
 
+bool cmMakefileTargetGenerator::UseCompilerDepends(
+  const std::string& lang) const
+{
+  // Fortran module dependencies need the CMake dependency scanner.
+  if (!this->CompilerDepends || lang == "Fortran") {
+    return false;
+  }
+  const char* flags =
+    this->Makefile->GetDefinition("CMAKE_MAKE_DEPFILE_FLAGS_" + lang);
+  return flags && *flags;
+}
+
+void cmMakefileTargetGenerator::WriteCompilerDependFile()
+{
+  std::string compilerDependFile = this->TargetBuildDirectoryFull;
+  compilerDependFile += "/compiler_depend.make";
+  cmGeneratedFileStream depFileStream(compilerDependFile.c_str());
+  depFileStream.SetCopyIfDifferent(true);
+  depFileStream << "# Dependencies generated by the compiler for target "
+                << this->GeneratorTarget->GetName() << ".\n";
+  for (std::vector<std::string>::const_iterator i =
+         this->CompilerDependFiles.begin();
+       i != this->CompilerDependFiles.end(); ++i) {
+    depFileStream << "-include "
+                  << this->Convert(*i, cmOutputConverter::NONE,
+                                   cmOutputConverter::MAKERULE)
+                  << "\n";
+  }
+}
+
 void cmMakefileTargetGenerator::WriteTargetDependRules()
 {
   // must write the targets depend info file
@@ -969,55 +1043,80 @@ void cmMakefileTargetGenerator::WriteTargetDependRules()
   std::vector<std::string> depends;
   std::vector<std::string> commands;
 
+  // When the compiler writes the dependencies of the objects, CMake
+  // scans only for those of custom commands and multiple outputs.
+  bool scanDepends = true;
+  if (this->CompilerDepends &&
+      this->GeneratorTarget->GetType() != cmState::UTILITY) {
+    this->WriteCompilerDependFile();
+    scanDepends =
+      !this->LocalGenerator->GetImplicitDepends(this->GeneratorTarget)
+         .empty() ||
+      !this->MultipleOutputPairs.empty();
+  }
+
   // Construct the name of the dependency generation target.
   std::string depTarget =
     this->LocalGenerator->GetRelativeTargetDirectory(this->GeneratorTarget);
   depTarget += "/depend";
 
-  // Add a command to call CMake to scan dependencies.  CMake will
-  // touch the corresponding depends file after scanning dependencies.
-  std::ostringstream depCmd;
+  if (scanDepends) {
+    // Add a command to call CMake to scan dependencies.  CMake will
+    // touch the corresponding depends file after scanning dependencies.
+    std::ostringstream depCmd;
 // TODO: Account for source file properties and directory-level
 // definitions when scanning for dependencies.
 #if !defined(_WIN32) || defined(__CYGWIN__)
-  // This platform supports symlinks, so cmSystemTools will translate
-  // paths.  Make sure PWD is set to the original name of the home
-  // output directory to help cmSystemTools to create the same
-  // translation table for the dependency scanning process.
-  depCmd << "cd " << (this->LocalGenerator->Convert(
-                       this->LocalGenerator->GetBinaryDirectory(),
-                       cmOutputConverter::FULL, cmOutputConverter::SHELL))
-         << " && ";
+    // This platform supports symlinks, so cmSystemTools will translate
+    // paths.  Make sure PWD is set to the original name of the home
+    // output directory to help cmSystemTools to create the same
+    // translation table for the dependency scanning process.
+    depCmd << "cd " << (this->LocalGenerator->Convert(
+                         this->LocalGenerator->GetBinaryDirectory(),
+                         cmOutputConverter::FULL, cmOutputConverter::SHELL))
+           << " && ";
 #endif
-  // Generate a call this signature:
-  //
-  //   cmake -E cmake_depends <generator>
-  //                          <home-src-dir> <start-src-dir>
-  //                          <home-out-dir> <start-out-dir>
-  //                          <dep-info> --color=$(COLOR)
-  //
-  // This gives the dependency scanner enough information to recreate
-  // the state of our local generator sufficiently for its needs.
-  depCmd << "$(CMAKE_COMMAND) -E cmake_depends \""
-         << this->GlobalGenerator->GetName() << "\" "
-         << this->Convert(this->LocalGenerator->GetSourceDirectory(),
-                          cmOutputConverter::FULL, cmOutputConverter::SHELL)
-         << " "
-         << this->Convert(this->LocalGenerator->GetCurrentSourceDirectory(),
-                          cmOutputConverter::FULL, cmOutputConverter::SHELL)
-         << " "
-         << this->Convert(this->LocalGenerator->GetBinaryDirectory(),
-                          cmOutputConverter::FULL, cmOutputConverter::SHELL)
-         << " "
-         << this->Convert(this->LocalGenerator->GetCurrentBinaryDirectory(),
-                          cmOutputConverter::FULL, cmOutputConverter::SHELL)
-         << " "
-         << this->Convert(this->InfoFileNameFull, cmOutputConverter::FULL,
-                          cmOutputConverter::SHELL);
-  if (this->LocalGenerator->GetColorMakefile()) {
-    depCmd << " --color=$(COLOR)";
-  }
-  commands.push_back(depCmd.str());
+    // Generate a call this signature:
+    //
+    //   cmake -E cmake_depends <generator>
+    //                          <home-src-dir> <start-src-dir>
+    //                          <home-out-dir> <start-out-dir>
+    //                          <dep-info> --color=$(COLOR)
+    //
+    // This gives the dependency scanner enough information to recreate
+    // the state of our local generator sufficiently for its needs.
+    depCmd << "$(CMAKE_COMMAND) -E cmake_depends \""
+           << this->GlobalGenerator->GetName() << "\" "
+           << this->Convert(this->LocalGenerator->GetSourceDirectory(),
+                            cmOutputConverter::FULL, cmOutputConverter::SHELL)
+           << " "
+           << this->Convert(this->LocalGenerator->GetCurrentSourceDirectory(),
+                            cmOutputConverter::FULL, cmOutputConverter::SHELL)
+           << " "
+           << this->Convert(this->LocalGenerator->GetBinaryDirectory(),
+                            cmOutputConverter::FULL, cmOutputConverter::SHELL)
+           << " "
+           << this->Convert(this->LocalGenerator->GetCurrentBinaryDirectory(),
+                            cmOutputConverter::FULL, cmOutputConverter::SHELL)
+           << " "
+           << this->Convert(this->InfoFileNameFull, cmOutputConverter::FULL,
+                            cmOutputConverter::SHELL);
+    if (this->LocalGenerator->GetColorMakefile()) {
+      depCmd << " --color=$(COLOR)";
+    }
+    commands.push_back(depCmd.str());
+  } else {
+    // Discard dependencies found by an earlier scan so that they cannot
+    // refer to files that no longer exist.
+    std::string dependFile = this->TargetBuildDirectoryFull;
+    dependFile += "/depend.make";
+    cmGeneratedFileStream depFileStream(dependFile.c_str());
+    depFileStream.SetCopyIfDifferent(true);
+    depFileStream << "# Empty dependencies file for "
+                  << this->GeneratorTarget->GetName() << ".\n"
+                  << "# The compiler generates the dependencies of this "
+                  << "target.\n";
+  }
 
   // Make sure all custom command outputs in this target are built.
   if (this->CustomCommandDriver == OnDepends) {
@@ -74,6 +74,12 @@ protected:
   // write the depend rules for this target
   void WriteTargetDependRules();
 
+  // write the file including the depfiles written by the compiler
+  void WriteCompilerDependFile();
+
+  // whether the compiler writes the dependencies of objects in a language
+  bool UseCompilerDepends(const std::string& lang) const;
+
   // write rules for Mac OS X Application Bundle content.
   struct MacOSXContentGeneratorType
     : cmOSXBundleGenerator::MacOSXContentGeneratorType
@@ -186,6 +192,9 @@ protected:
   unsigned long NumberOfProgressActions;
   bool NoRuleMessages;
 
+  // whether CMAKE_DEPENDS_USE_COMPILER is enabled for this target
+  bool CompilerDepends;
+
   // the path to the directory the build file is in
   std::string TargetBuildDirectory;
   std::string TargetBuildDirectoryFull;
@@ -212,6 +221,9 @@ protected:
   std::vector<std::string> Objects;
   std::vector<std::string> ExternalObjects;
 
+  // depfiles written by the compiler for the objects of this target
+  std::vector<std::string> CompilerDependFiles;
+
   // Set of object file names that will be built in this directory.
   std::set<std::string> ObjectFiles;
 
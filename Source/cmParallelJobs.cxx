@@ -0,0 +1,94 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmParallelJobs.h"
+
+#if defined(CMake_USE_PTHREADS)
+#include <pthread.h>
+#elif defined(_WIN32) && !defined(__CYGWIN__)
+#include <windows.h>
+#define cmParallelJobs_USE_WIN32_THREADS
+#endif
+
+namespace {
+struct cmParallelJob
+{
+  cmParallelJobs::Function Job;
+  void* Arg;
+};
+}
+
+#if defined(CMake_USE_PTHREADS)
+extern "C" {
+static void* cmParallelJobsThread(void* arg)
+{
+  cmParallelJob* job = static_cast<cmParallelJob*>(arg);
+  job->Job(job->Arg);
+  return 0;
+}
+}
+#elif defined(cmParallelJobs_USE_WIN32_THREADS)
+static DWORD WINAPI cmParallelJobsThread(LPVOID arg)
+{
+  cmParallelJob* job = static_cast<cmParallelJob*>(arg);
+  job->Job(job->Arg);
+  return 0;
+}
+#endif
+
+void cmParallelJobs::Run(Function job, std::vector<void*> const& args)
+{
+  size_t const n = args.size();
+  std::vector<cmParallelJob> jobs(n);
+  for (size_t i = 0; i < n; ++i) {
+    jobs[i].Job = job;
+    jobs[i].Arg = args[i];
+  }
+
+#if defined(CMake_USE_PTHREADS)
+  std::vector<pthread_t> threads(n);
+  std::vector<char> started(n, 0);
+  for (size_t i = 1; i < n; ++i) {
+    started[i] =
+      pthread_create(&threads[i], 0, cmParallelJobsThread, &jobs[i]) == 0;
+  }
+#elif defined(cmParallelJobs_USE_WIN32_THREADS)
+  std::vector<HANDLE> threads(n, static_cast<HANDLE>(0));
+  std::vector<char> started(n, 0);
+  for (size_t i = 1; i < n; ++i) {
+    threads[i] = CreateThread(0, 0, cmParallelJobsThread, &jobs[i], 0, 0);
+    started[i] = threads[i] != 0;
+  }
+#else
+  std::vector<char> started(n, 0);
+#endif
+
+  for (size_t i = 0; i < n; ++i) {
+    if (!started[i]) {
+      job(args[i]);
+    }
+  }
+
+#if defined(CMake_USE_PTHREADS)
+  for (size_t i = 1; i < n; ++i) {
+    if (started[i]) {
+      pthread_join(threads[i], 0);
+    }
+  }
+#elif defined(cmParallelJobs_USE_WIN32_THREADS)
+  for (size_t i = 1; i < n; ++i) {
+    if (started[i]) {
+      WaitForSingleObject(threads[i], INFINITE);
+      CloseHandle(threads[i]);
+    }
+  }
+#endif
+}
@@ -0,0 +1,35 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#ifndef cmParallelJobs_h
+#define cmParallelJobs_h
+
+#include "cmStandardIncludes.h"
+
+/** \class cmParallelJobs
+ * \brief Run a few independent jobs concurrently.
+ *
+ * Each job runs on its own thread, except the first one, which runs on
+ * the calling thread.  Jobs whose thread cannot be started, or all jobs
+ * on platforms without thread support, run on the calling thread.  The
+ * jobs must not share mutable state.
+ */
+class cmParallelJobs
+{
+public:
+  typedef void (*Function)(void* arg);
+
+  /** Call job(arg) for every element of args and wait for all calls
+      to return.  */
+  static void Run(Function job, std::vector<void*> const& args);
+};
+
+#endif
@@ -347,3 +347,27 @@ bool cmPolicies::PolicyMap::IsEmpty() const
 {
   return this->Status.none();
 }
+
+typedef std::bitset<cmPolicies::CMPCOUNT * POLICY_STATUS_COUNT>
+  cmPolicyStatusBits;
+
+static cmPolicyStatusBits cmPolicyFirstStatusBits()
+{
+  cmPolicyStatusBits bits;
+  for (size_t i = 0; i < bits.size(); i += POLICY_STATUS_COUNT) {
+    bits.set(i);
+  }
+  return bits;
+}
+
+void cmPolicies::PolicyMap::Inherit(cmPolicies::PolicyMap const& parent)
+{
+  // At most one status bit is set for each policy.  Spread the bits of
+  // the defined policies over all their status bits and take the bits
+  // of the others from the parent, without looking at each policy.
+  static cmPolicyStatusBits const first = cmPolicyFirstStatusBits();
+  cmPolicyStatusBits defined =
+    (this->Status | (this->Status >> 1) | (this->Status >> 2)) & first;
+  defined |= (defined << 1) | (defined << 2);
+  this->Status |= parent.Status & ~defined;
+}
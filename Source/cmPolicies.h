@@ -289,6 +289,10 @@ public:
     bool IsDefined(PolicyID id) const;
     bool IsEmpty() const;
 
+    /** Give the policies not defined in this map the status they
+        have in the given one.  */
+    void Inherit(PolicyMap const& parent);
+
   private:
 #define POLICY_STATUS_COUNT 3
     std::bitset<cmPolicies::CMPCOUNT * POLICY_STATUS_COUNT> Status;
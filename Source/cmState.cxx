@@ -15,6 +15,7 @@
 #include "cmCacheManager.h"
 #include "cmCommand.h"
 #include "cmDefinitions.h"
+#include "cmListFileCache.h"
 #include "cmVersion.h"
 #include "cmake.h"
 
@@ -29,7 +30,7 @@ struct cmState::SnapshotDataType
   cmLinkedTree<cmState::PolicyStackEntry>::iterator PolicyScope;
   cmState::SnapshotType SnapshotType;
   bool Keep;
-  cmLinkedTree<std::string>::iterator ExecutionListFile;
+  cmLinkedTree<std::string const*>::iterator ExecutionListFile;
   cmLinkedTree<cmState::BuildsystemDirectoryStateType>::iterator
     BuildSystemDirectory;
   cmLinkedTree<cmDefinitions>::iterator Vars;
@@ -46,19 +47,30 @@ struct cmState::PolicyStackEntry : public cmPolicies::PolicyMap
   PolicyStackEntry(bool w = false)
     : derived()
     , Weak(w)
+    , ResolvedGeneration(0)
   {
   }
   PolicyStackEntry(derived const& d, bool w)
     : derived(d)
     , Weak(w)
+    , ResolvedGeneration(0)
   {
   }
   PolicyStackEntry(PolicyStackEntry const& r)
     : derived(r)
     , Weak(r.Weak)
+    , Resolved(r.Resolved)
+    , ResolvedGeneration(r.ResolvedGeneration)
   {
   }
   bool Weak;
+
+  // The policies in effect when this entry is the top of the stack of
+  // its directory, taken from the entries below it and from the parent
+  // directories.  Valid while ResolvedGeneration is the PolicyGeneration
+  // of the state.
+  derived Resolved;
+  unsigned long ResolvedGeneration;
 };
 
 struct cmState::BuildsystemDirectoryStateType
@@ -95,7 +107,8 @@ struct cmState::BuildsystemDirectoryStateType
 };
 
 cmState::cmState()
-  : IsInTryCompile(false)
+  : PolicyGeneration(1)
+  , IsInTryCompile(false)
   , WindowsShell(false)
   , WindowsVSIDE(false)
   , WatcomWMake(false)
@@ -322,6 +335,7 @@ cmState::Snapshot cmState::Reset()
   }
 
   this->PolicyStack.Clear();
+  ++this->PolicyGeneration;
   pos->Policies = this->PolicyStack.Root();
   pos->PolicyRoot = this->PolicyStack.Root();
   pos->PolicyScope = this->PolicyStack.Root();
@@ -763,8 +777,8 @@ cmState::Snapshot cmState::CreateBaseSnapshot()
   pos->Keep = true;
   pos->BuildSystemDirectory =
     this->BuildsystemDirectory.Push(this->BuildsystemDirectory.Root());
-  pos->ExecutionListFile =
-    this->ExecutionListFiles.Push(this->ExecutionListFiles.Root());
+  pos->ExecutionListFile = this->ExecutionListFiles.Push(
+    this->ExecutionListFiles.Root(), &cmListFileIntern(std::string()));
   pos->IncludeDirectoryPosition = 0;
   pos->CompileDefinitionsPosition = 0;
   pos->CompileOptionsPosition = 0;
@@ -793,7 +807,8 @@ cmState::Snapshot cmState::CreateBuildsystemDirectorySnapshot(
   pos->BuildSystemDirectory = this->BuildsystemDirectory.Push(
     originSnapshot.Position->BuildSystemDirectory);
   pos->ExecutionListFile =
-    this->ExecutionListFiles.Push(originSnapshot.Position->ExecutionListFile);
+    this->ExecutionListFiles.Push(originSnapshot.Position->ExecutionListFile,
+                                  &cmListFileIntern(std::string()));
   pos->BuildSystemDirectory->DirectoryEnd = pos;
   pos->Policies = originSnapshot.Position->Policies;
   pos->PolicyRoot = originSnapshot.Position->Policies;
@@ -823,7 +838,7 @@ cmState::Snapshot cmState::CreateFunctionCallSnapshot(
   pos->SnapshotType = FunctionCallType;
   pos->Keep = false;
   pos->ExecutionListFile = this->ExecutionListFiles.Push(
-    originSnapshot.Position->ExecutionListFile, fileName);
+    originSnapshot.Position->ExecutionListFile, &cmListFileIntern(fileName));
   pos->BuildSystemDirectory->DirectoryEnd = pos;
   pos->PolicyScope = originSnapshot.Position->Policies;
   assert(originSnapshot.Position->Vars.IsValid());
@@ -841,7 +856,7 @@ cmState::Snapshot cmState::CreateMacroCallSnapshot(
   pos->SnapshotType = MacroCallType;
   pos->Keep = false;
   pos->ExecutionListFile = this->ExecutionListFiles.Push(
-    originSnapshot.Position->ExecutionListFile, fileName);
+    originSnapshot.Position->ExecutionListFile, &cmListFileIntern(fileName));
   assert(originSnapshot.Position->Vars.IsValid());
   pos->BuildSystemDirectory->DirectoryEnd = pos;
   pos->PolicyScope = originSnapshot.Position->Policies;
@@ -856,7 +871,7 @@ cmState::Snapshot cmState::CreateIncludeFileSnapshot(
   pos->SnapshotType = IncludeFileType;
   pos->Keep = true;
   pos->ExecutionListFile = this->ExecutionListFiles.Push(
-    originSnapshot.Position->ExecutionListFile, fileName);
+    originSnapshot.Position->ExecutionListFile, &cmListFileIntern(fileName));
   assert(originSnapshot.Position->Vars.IsValid());
   pos->BuildSystemDirectory->DirectoryEnd = pos;
   pos->PolicyScope = originSnapshot.Position->Policies;
@@ -889,7 +904,7 @@ cmState::Snapshot cmState::CreateInlineListFileSnapshot(
   pos->SnapshotType = InlineListFileType;
   pos->Keep = true;
   pos->ExecutionListFile = this->ExecutionListFiles.Push(
-    originSnapshot.Position->ExecutionListFile, fileName);
+    originSnapshot.Position->ExecutionListFile, &cmListFileIntern(fileName));
   pos->BuildSystemDirectory->DirectoryEnd = pos;
   pos->PolicyScope = originSnapshot.Position->Policies;
   return cmState::Snapshot(this, pos);
@@ -919,6 +934,10 @@ cmState::Snapshot cmState::Pop(cmState::Snapshot originSnapshot)
   prevPos->CompileOptionsPosition =
     prevPos->BuildSystemDirectory->CompileOptions.size();
   prevPos->BuildSystemDirectory->DirectoryEnd = prevPos;
+  if (prevPos->Policies != pos->Policies) {
+    // Lookups in the directory now start from another entry.
+    ++this->PolicyGeneration;
+  }
 
   if (!pos->Keep && this->SnapshotData.IsLast(pos)) {
     if (pos->Vars != prevPos->Vars) {
@@ -997,7 +1016,7 @@ void cmState::Directory::SetCurrentBinary(std::string const& dir)
 
 void cmState::Snapshot::SetListFile(const std::string& listfile)
 {
-  *this->Position->ExecutionListFile = listfile;
+  *this->Position->ExecutionListFile = &cmListFileIntern(listfile);
 }
 
 std::vector<std::string> const&
@@ -1032,9 +1051,9 @@ void cmState::Directory::SetRelativePathTopBinary(const char* dir)
   this->DirectoryState->RelativePathTopBinary = dir;
 }
 
-std::string cmState::Snapshot::GetExecutionListFile() const
+std::string const& cmState::Snapshot::GetExecutionListFile() const
 {
-  return *this->Position->ExecutionListFile;
+  return **this->Position->ExecutionListFile;
 }
 
 bool cmState::Snapshot::IsValid() const
@@ -1108,6 +1127,10 @@ void cmState::Snapshot::PushPolicy(cmPolicies::PolicyMap entry, bool weak)
   PositionType pos = this->Position;
   pos->Policies = this->State->PolicyStack.Push(pos->Policies,
                                                 PolicyStackEntry(entry, weak));
+  if (!pos->BuildSystemDirectory->Children.empty()) {
+    // Lookups in the child directories continue at the new entry.
+    ++this->State->PolicyGeneration;
+  }
 }
 
 bool cmState::Snapshot::PopPolicy()
@@ -1116,6 +1139,10 @@ bool cmState::Snapshot::PopPolicy()
   if (pos->Policies == pos->PolicyScope) {
     return false;
   }
+  if (!pos->BuildSystemDirectory->Children.empty()) {
+    // Lookups in the child directories continue below the entry.
+    ++this->State->PolicyGeneration;
+  }
   pos->Policies = this->State->PolicyStack.Pop(pos->Policies);
   return true;
 }
@@ -1135,6 +1162,7 @@ void cmState::Snapshot::SetPolicy(cmPolicies::PolicyID id,
     psi->Set(id, status);
     previous_was_weak = psi->Weak;
   }
+  ++this->State->PolicyGeneration;
 }
 
 cmPolicies::PolicyStatus cmState::Snapshot::GetPolicy(
@@ -1147,29 +1175,51 @@ cmPolicies::PolicyStatus cmState::Snapshot::GetPolicy(
     return status;
   }
 
-  cmLinkedTree<BuildsystemDirectoryStateType>::iterator dir =
-    this->Position->BuildSystemDirectory;
+  cmPolicies::PolicyMap const& resolved = this->State->ResolvePolicies(
+    this->Position->BuildSystemDirectory->DirectoryEnd);
+  if (resolved.IsDefined(id)) {
+    status = resolved.Get(id);
+  }
+  return status;
+}
 
-  while (true) {
-    assert(dir.IsValid());
-    cmLinkedTree<PolicyStackEntry>::iterator leaf =
-      dir->DirectoryEnd->Policies;
-    cmLinkedTree<PolicyStackEntry>::iterator root =
-      dir->DirectoryEnd->PolicyRoot;
-    for (; leaf != root; ++leaf) {
-      if (leaf->IsDefined(id)) {
-        status = leaf->Get(id);
-        return status;
-      }
+cmPolicies::PolicyMap const& cmState::ResolvePolicies(PositionType end)
+{
+  // The policies of a directory are those of the entries on its own
+  // stack, from the top down, and then those of the parent directory
+  // where it currently is.  The result is kept in the top entry.
+  static cmPolicies::PolicyMap const none;
+  cmLinkedTree<PolicyStackEntry>::iterator top = end->Policies;
+  cmLinkedTree<PolicyStackEntry>::iterator root = end->PolicyRoot;
+  PositionType parent = end->DirectoryParent;
+  if (top == root) {
+    if (parent == this->SnapshotData.Root()) {
+      return none;
     }
-    cmState::PositionType e = dir->DirectoryEnd;
-    cmState::PositionType p = e->DirectoryParent;
-    if (p == this->State->SnapshotData.Root()) {
+    return this->ResolvePolicies(parent->BuildSystemDirectory->DirectoryEnd);
+  }
+  if (top->ResolvedGeneration == this->PolicyGeneration) {
+    return top->Resolved;
+  }
+
+  cmPolicies::PolicyMap resolved;
+  cmLinkedTree<PolicyStackEntry>::iterator leaf = top;
+  for (; leaf != root; ++leaf) {
+    // An entry further down was the top once, and the entries below it
+    // have not changed since it was resolved.
+    if (leaf->ResolvedGeneration == this->PolicyGeneration) {
+      resolved.Inherit(leaf->Resolved);
       break;
     }
-    dir = p->BuildSystemDirectory;
+    resolved.Inherit(*leaf);
   }
-  return status;
+  if (leaf == root && parent != this->SnapshotData.Root()) {
+    resolved.Inherit(
+      this->ResolvePolicies(parent->BuildSystemDirectory->DirectoryEnd));
+  }
+  top->Resolved = resolved;
+  top->ResolvedGeneration = this->PolicyGeneration;
+  return top->Resolved;
 }
 
 bool cmState::Snapshot::HasDefinedPolicyCMP0011()
@@ -68,7 +68,8 @@ public:
 
     void SetListFile(std::string const& listfile);
 
-    std::string GetExecutionListFile() const;
+    // The path is interned by cmListFileIntern.
+    std::string const& GetExecutionListFile() const;
 
     std::vector<Snapshot> GetChildren();
 
@@ -330,6 +331,10 @@ private:
   void AddCacheEntry(const std::string& key, const char* value,
                      const char* helpString, CacheEntryType type);
 
+  /** The policies in effect in the directory of the given
+      snapshot, which must be the current end of that directory.  */
+  cmPolicies::PolicyMap const& ResolvePolicies(PositionType end);
+
   std::map<cmProperty::ScopeType, cmPropertyDefinitionMap> PropertyDefinitions;
   std::vector<std::string> EnabledLanguages;
   std::map<std::string, cmCommand*> Commands;
@@ -338,9 +343,11 @@ private:
 
   cmLinkedTree<BuildsystemDirectoryStateType> BuildsystemDirectory;
 
-  cmLinkedTree<std::string> ExecutionListFiles;
+  cmLinkedTree<std::string const*> ExecutionListFiles;
 
   cmLinkedTree<PolicyStackEntry> PolicyStack;
+  // Changed whenever a resolved policy entry may have become stale.
+  unsigned long PolicyGeneration;
   cmLinkedTree<SnapshotDataType> SnapshotData;
   cmLinkedTree<cmDefinitions> VarTree;
 
@@ -1345,7 +1345,7 @@ bool cmSystemTools::CreateTar(const char* outFileName,
                               const std::vector<std::string>& files,
                               cmTarCompression compressType, bool verbose,
                               std::string const& mtime,
-                              std::string const& format)
+                              std::string const& format, int threads)
 {
 #if defined(CMAKE_BUILD_WITH_CMAKE)
   std::string cwd = cmSystemTools::GetCurrentWorkingDirectory();
@@ -1374,7 +1374,8 @@ bool cmSystemTools::CreateTar(const char* outFileName,
       break;
   }
 
-  cmArchiveWrite a(fout, compress, format.empty() ? "paxr" : format);
+  cmArchiveWrite a(fout, compress, format.empty() ? "paxr" : format,
+                   threads);
 
   a.SetMTime(mtime);
   a.SetVerbose(verbose);
@@ -1389,7 +1390,7 @@ bool cmSystemTools::CreateTar(const char* outFileName,
       break;
     }
   }
-  if (!a) {
+  if (!a.Finish()) {
     cmSystemTools::Error(a.GetError().c_str());
     return false;
   }
@@ -1398,6 +1399,7 @@ bool cmSystemTools::CreateTar(const char* outFileName,
   (void)outFileName;
   (void)files;
   (void)verbose;
+  (void)threads;
   return false;
 #endif
 }
@@ -17,6 +17,12 @@
 #include "cmSystemTools.h"
 #include "cmTest.h"
 
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+#include "cm_jsoncpp_value.h"
+#endif
+
+#include <ctype.h>
+
 cmTestGenerator::cmTestGenerator(
   cmTest* test, std::vector<std::string> const& configurations)
   : cmScriptGenerator("CTEST_CONFIGURATION_TYPE", configurations)
@@ -34,6 +40,7 @@ cmTestGenerator::~cmTestGenerator()
 void cmTestGenerator::Compute(cmLocalGenerator* lg)
 {
   this->LG = lg;
+  this->ComputedCommands.clear();
 }
 
 void cmTestGenerator::GenerateScriptConfigs(std::ostream& os,
@@ -58,24 +65,19 @@ void cmTestGenerator::GenerateScriptActions(std::ostream& os,
   }
 }
 
-void cmTestGenerator::GenerateScriptForConfig(std::ostream& os,
-                                              const std::string& config,
-                                              Indent const& indent)
+void cmTestGenerator::ComputeCommand(const std::string& config,
+                                     std::vector<std::string>& command,
+                                     std::vector<std::string>& properties)
 {
-  this->TestGenerated = true;
-
   // Set up generator expression evaluation context.
   cmGeneratorExpression ge(this->Test->GetBacktrace());
 
-  // Start the test command.
-  os << indent << "add_test(" << this->Test->GetName() << " ";
-
   // Get the test command line to be executed.
-  std::vector<std::string> const& command = this->Test->GetCommand();
+  std::vector<std::string> const& testCommand = this->Test->GetCommand();
 
   // Check whether the command executable is a target whose name is to
   // be translated.
-  std::string exe = command[0];
+  std::string exe = testCommand[0];
   cmGeneratorTarget* target = this->LG->FindGeneratorTargetToUse(exe);
   if (target && target->GetType() == cmState::EXECUTABLE) {
     // Use the target file on disk.
@@ -88,39 +90,70 @@ void cmTestGenerator::GenerateScriptForConfig(std::ostream& os,
       cmSystemTools::ExpandListArgument(emulator, emulatorWithArgs);
       std::string emulatorExe(emulatorWithArgs[0]);
       cmSystemTools::ConvertToUnixSlashes(emulatorExe);
-      os << cmOutputConverter::EscapeForCMake(emulatorExe) << " ";
-      for (std::vector<std::string>::const_iterator ei =
-             emulatorWithArgs.begin() + 1;
-           ei != emulatorWithArgs.end(); ++ei) {
-        os << cmOutputConverter::EscapeForCMake(*ei) << " ";
-      }
+      command.push_back(emulatorExe);
+      command.insert(command.end(), emulatorWithArgs.begin() + 1,
+                     emulatorWithArgs.end());
     }
   } else {
     // Use the command name given.
     exe = ge.Parse(exe.c_str())->Evaluate(this->LG, config);
     cmSystemTools::ConvertToUnixSlashes(exe);
   }
+  command.push_back(exe);
+  for (std::vector<std::string>::const_iterator ci = testCommand.begin() + 1;
+       ci != testCommand.end(); ++ci) {
+    command.push_back(ge.Parse(*ci)->Evaluate(this->LG, config));
+  }
+
+  cmPropertyMap& pm = this->Test->GetProperties();
+  for (cmPropertyMap::const_iterator i = pm.begin(); i != pm.end(); ++i) {
+    properties.push_back(i->first);
+    properties.push_back(
+      ge.Parse(i->second.GetValue())->Evaluate(this->LG, config));
+  }
+}
+
+cmTestGenerator::ComputedCommand const& cmTestGenerator::GetComputedCommand(
+  const std::string& config)
+{
+  std::map<std::string, ComputedCommand>::iterator i =
+    this->ComputedCommands.find(config);
+  if (i == this->ComputedCommands.end()) {
+    i = this->ComputedCommands
+          .insert(std::make_pair(config, ComputedCommand()))
+          .first;
+    this->ComputeCommand(config, i->second.Command, i->second.Properties);
+  }
+  return i->second;
+}
+
+void cmTestGenerator::GenerateScriptForConfig(std::ostream& os,
+                                              const std::string& config,
+                                              Indent const& indent)
+{
+  this->TestGenerated = true;
+
+  ComputedCommand const& computed = this->GetComputedCommand(config);
+  std::vector<std::string> const& command = computed.Command;
+  std::vector<std::string> const& properties = computed.Properties;
 
   // Generate the command line with full escapes.
-  os << cmOutputConverter::EscapeForCMake(exe);
-  for (std::vector<std::string>::const_iterator ci = command.begin() + 1;
+  os << indent << "add_test(" << this->Test->GetName() << " ";
+  const char* sep = "";
+  for (std::vector<std::string>::const_iterator ci = command.begin();
        ci != command.end(); ++ci) {
-    os << " " << cmOutputConverter::EscapeForCMake(
-                   ge.Parse(*ci)->Evaluate(this->LG, config));
+    os << sep << cmOutputConverter::EscapeForCMake(*ci);
+    sep = " ";
   }
-
-  // Finish the test command.
   os << ")\n";
 
   // Output properties for the test.
-  cmPropertyMap& pm = this->Test->GetProperties();
-  if (!pm.empty()) {
+  if (!properties.empty()) {
     os << indent << "set_tests_properties(" << this->Test->GetName()
        << " PROPERTIES ";
-    for (cmPropertyMap::const_iterator i = pm.begin(); i != pm.end(); ++i) {
-      os << " " << i->first << " "
-         << cmOutputConverter::EscapeForCMake(
-              ge.Parse(i->second.GetValue())->Evaluate(this->LG, config));
+    for (std::vector<std::string>::const_iterator i = properties.begin();
+         i != properties.end(); i += 2) {
+      os << " " << *i << " " << cmOutputConverter::EscapeForCMake(*(i + 1));
     }
     os << ")" << std::endl;
   }
@@ -140,19 +173,31 @@ bool cmTestGenerator::NeedsScriptNoConfig() const
           !this->ConfigurationTypes->empty()); // config-dependent command
 }
 
+void cmTestGenerator::ComputeOldStyleCommand(
+  std::vector<std::string>& command, std::vector<std::string>& properties)
+{
+  command = this->Test->GetCommand();
+  cmSystemTools::ConvertToUnixSlashes(command[0]);
+
+  cmPropertyMap& pm = this->Test->GetProperties();
+  for (cmPropertyMap::const_iterator i = pm.begin(); i != pm.end(); ++i) {
+    properties.push_back(i->first);
+    properties.push_back(i->second.GetValue());
+  }
+}
+
 void cmTestGenerator::GenerateOldStyle(std::ostream& fout,
                                        Indent const& indent)
 {
   this->TestGenerated = true;
 
-  // Get the test command line to be executed.
-  std::vector<std::string> const& command = this->Test->GetCommand();
+  std::vector<std::string> command;
+  std::vector<std::string> properties;
+  this->ComputeOldStyleCommand(command, properties);
 
-  std::string exe = command[0];
-  cmSystemTools::ConvertToUnixSlashes(exe);
   fout << indent;
   fout << "add_test(";
-  fout << this->Test->GetName() << " \"" << exe << "\"";
+  fout << this->Test->GetName() << " \"" << command[0] << "\"";
 
   for (std::vector<std::string>::const_iterator argit = command.begin() + 1;
        argit != command.end(); ++argit) {
@@ -174,14 +219,135 @@ void cmTestGenerator::GenerateOldStyle(std::ostream& fout,
   fout << ")" << std::endl;
 
   // Output properties for the test.
-  cmPropertyMap& pm = this->Test->GetProperties();
-  if (!pm.empty()) {
+  if (!properties.empty()) {
     fout << indent << "set_tests_properties(" << this->Test->GetName()
          << " PROPERTIES ";
-    for (cmPropertyMap::const_iterator i = pm.begin(); i != pm.end(); ++i) {
-      fout << " " << i->first << " "
-           << cmOutputConverter::EscapeForCMake(i->second.GetValue());
+    for (std::vector<std::string>::const_iterator i = properties.begin();
+         i != properties.end(); i += 2) {
+      fout << " " << *i << " " << cmOutputConverter::EscapeForCMake(*(i + 1));
     }
     fout << ")" << std::endl;
   }
 }
+
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+// Return true if the script reads a string written without quotes as
+// the string itself.
+static bool cmTestGeneratorIsUnquotedArgument(std::string const& s)
+{
+  return !s.empty() && s[0] != '[' &&
+    s.find_first_of(" \t\r\n()#\"\\$;") == std::string::npos;
+}
+
+// Return true if the script matches the configuration name itself and
+// not a regular expression.
+static bool cmTestGeneratorIsPlainConfig(std::string const& config)
+{
+  for (std::string::const_iterator c = config.begin(); c != config.end();
+       ++c) {
+    if (!isalnum(static_cast<unsigned char>(*c)) && *c != '_' && *c != '-') {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool cmTestGenerator::GenerateManifest(
+  Json::Value& test, const std::string& config,
+  std::vector<std::string> const& configurationTypes)
+{
+  this->ConfigurationName = config;
+  this->ConfigurationTypes = &configurationTypes;
+  if (!cmTestGeneratorIsUnquotedArgument(this->Test->GetName())) {
+    return false;
+  }
+
+  // Like the script, the test has a list of rules for the configurations
+  // they apply to.  ctest uses the first rule that matches.
+  test = Json::arrayValue;
+  if (!this->ActionsPerConfig || this->ConfigurationTypes->empty()) {
+    return this->GenerateManifestForConfig(test.append(Json::objectValue),
+                                           this->Configurations,
+                                           this->ConfigurationName);
+  }
+  bool first = true;
+  for (std::vector<std::string>::const_iterator i =
+         this->ConfigurationTypes->begin();
+       i != this->ConfigurationTypes->end(); ++i) {
+    if (this->GeneratesForConfig(*i)) {
+      if (!this->GenerateManifestForConfig(test.append(Json::objectValue),
+                                           std::vector<std::string>(1, *i),
+                                           *i)) {
+        return false;
+      }
+      first = false;
+    }
+  }
+  if (!first && this->NeedsScriptNoConfig()) {
+    Json::Value& addTest = test.append(Json::objectValue)["commands"]
+                             .append(Json::arrayValue);
+    addTest.append("add_test");
+    addTest.append(this->Test->GetName());
+    addTest.append("NOT_AVAILABLE");
+  }
+  return true;
+}
+
+bool cmTestGenerator::GenerateManifestForConfig(
+  Json::Value& rule, std::vector<std::string> const& configs,
+  const std::string& config)
+{
+  if (!configs.empty()) {
+    Json::Value& ruleConfigs = rule["configurations"] = Json::arrayValue;
+    for (std::vector<std::string>::const_iterator i = configs.begin();
+         i != configs.end(); ++i) {
+      if (!cmTestGeneratorIsPlainConfig(*i)) {
+        return false;
+      }
+      ruleConfigs.append(*i);
+    }
+  }
+
+  std::vector<std::string> command;
+  std::vector<std::string> properties;
+  if (this->ActionsPerConfig) {
+    ComputedCommand const& computed = this->GetComputedCommand(config);
+    command = computed.Command;
+    properties = computed.Properties;
+  } else {
+    // Old-style arguments are quoted without escapes.
+    this->ComputeOldStyleCommand(command, properties);
+    for (std::vector<std::string>::const_iterator i = command.begin();
+         i != command.end(); ++i) {
+      if (i->find_first_of("\\$") != std::string::npos ||
+          (i == command.begin() && i->find('"') != std::string::npos)) {
+        return false;
+      }
+    }
+  }
+
+  Json::Value& commands = rule["commands"] = Json::arrayValue;
+  Json::Value& addTest = commands.append(Json::arrayValue);
+  addTest.append("add_test");
+  addTest.append(this->Test->GetName());
+  for (std::vector<std::string>::const_iterator i = command.begin();
+       i != command.end(); ++i) {
+    addTest.append(*i);
+  }
+  if (!properties.empty()) {
+    Json::Value& setProperties = commands.append(Json::arrayValue);
+    setProperties.append("set_tests_properties");
+    setProperties.append(this->Test->GetName());
+    setProperties.append("PROPERTIES");
+    for (std::vector<std::string>::const_iterator i = properties.begin();
+         i != properties.end(); ++i) {
+      if (setProperties.size() % 2 == 1 &&
+          !cmTestGeneratorIsUnquotedArgument(*i)) {
+        return false;
+      }
+      setProperties.append(*i);
+    }
+  }
+  return true;
+}
+#endif
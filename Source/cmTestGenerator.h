@@ -17,6 +17,12 @@
 class cmTest;
 class cmLocalGenerator;
 
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+namespace Json {
+class Value;
+}
+#endif
+
 /** \class cmTestGenerator
  * \brief Support class for generating install scripts.
  *
@@ -31,6 +37,17 @@ public:
 
   void Compute(cmLocalGenerator* lg);
 
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+  /**
+   * Describe the commands that the generated script runs for each
+   * configuration in the test manifest read by ctest.  Return false if
+   * the test cannot be described exactly, e.g. because its name would
+   * need to be quoted.
+   */
+  bool GenerateManifest(Json::Value& test, const std::string& config,
+                        std::vector<std::string> const& configurationTypes);
+#endif
+
 protected:
   virtual void GenerateScriptConfigs(std::ostream& os, Indent const& indent);
   virtual void GenerateScriptActions(std::ostream& os, Indent const& indent);
@@ -41,9 +58,33 @@ protected:
   virtual bool NeedsScriptNoConfig() const;
   void GenerateOldStyle(std::ostream& os, Indent const& indent);
 
+  // Compute the command line and the property names and values of the
+  // test for a configuration.
+  void ComputeCommand(const std::string& config,
+                      std::vector<std::string>& command,
+                      std::vector<std::string>& properties);
+
+  // The command line and properties are computed once per configuration
+  // for both the script and the manifest, so that errors in generator
+  // expressions are reported once.
+  struct ComputedCommand
+  {
+    std::vector<std::string> Command;
+    std::vector<std::string> Properties;
+  };
+  ComputedCommand const& GetComputedCommand(const std::string& config);
+  void ComputeOldStyleCommand(std::vector<std::string>& command,
+                              std::vector<std::string>& properties);
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+  bool GenerateManifestForConfig(Json::Value& rule,
+                                 std::vector<std::string> const& configs,
+                                 const std::string& config);
+#endif
+
   cmLocalGenerator* LG;
   cmTest* Test;
   bool TestGenerated;
+  std::map<std::string, ComputedCommand> ComputedCommands;
 };
 
 #endif
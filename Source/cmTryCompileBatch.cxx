@@ -0,0 +1,166 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmTryCompileBatch.h"
+
+#include "cmSystemTools.h"
+
+#include <cmsys/Process.h>
+
+cmTryCompileBatch::Entry::Entry()
+{
+  this->TargetType = cmState::EXECUTABLE;
+  this->Cached = false;
+  this->CheckErrorDirective = false;
+  this->Result = 0;
+}
+
+namespace {
+// An entry whose commands are running.
+struct cmTryCompileBatchJob
+{
+  cmTryCompileBatch::Entry* Entry;
+  size_t Command;
+  cmsysProcess* Process;
+};
+}
+
+// Start the next command of a job.  Returns false if it could not be
+// started, in which case the entry has failed.
+static bool cmTryCompileBatchStart(cmTryCompileBatchJob& job, double timeout)
+{
+  cmTryCompileBatch::Entry& e = *job.Entry;
+  std::vector<std::string> const& command = e.Commands[job.Command];
+  e.Output += e.Labels[job.Command];
+
+  std::vector<const char*> argv;
+  for (std::vector<std::string>::const_iterator a = command.begin();
+       a != command.end(); ++a) {
+    argv.push_back(a->c_str());
+  }
+  argv.push_back(0);
+
+  job.Process = cmsysProcess_New();
+  cmsysProcess_SetCommand(job.Process, &*argv.begin());
+  cmsysProcess_SetWorkingDirectory(job.Process, e.BinaryDirectory.c_str());
+  cmsysProcess_SetOption(job.Process, cmsysProcess_Option_HideWindow, 1);
+  cmsysProcess_SetOption(job.Process, cmsysProcess_Option_MergeOutput, 1);
+  if (timeout > 0) {
+    cmsysProcess_SetTimeout(job.Process, timeout);
+  }
+  {
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+    // Run the command in the environment in which it was queued, e.g.
+    // with the locale chosen by the check that queued it.
+    cmSystemTools::SaveRestoreEnvironment restoreEnv;
+    cmSystemTools::AppendEnv(e.Environment);
+#endif
+    cmsysProcess_Execute(job.Process);
+  }
+  if (cmsysProcess_GetState(job.Process) != cmsysProcess_State_Executing) {
+    e.Output += cmsysProcess_GetErrorString(job.Process);
+    e.Output += "\n";
+    e.Result = 1;
+    cmsysProcess_Delete(job.Process);
+    job.Process = 0;
+    return false;
+  }
+  return true;
+}
+
+// Read the output of a running job.  Returns true if anything happened,
+// and clears the process once the job has no more commands to run.
+static bool cmTryCompileBatchPoll(cmTryCompileBatchJob& job, double timeout)
+{
+  cmTryCompileBatch::Entry& e = *job.Entry;
+  char* data;
+  int length;
+  double wait = 0;
+  int pipe = cmsysProcess_WaitForData(job.Process, &data, &length, &wait);
+  if (pipe == cmsysProcess_Pipe_Timeout) {
+    return false;
+  }
+  if (pipe != cmsysProcess_Pipe_None) {
+    e.Output.append(data, length);
+    return true;
+  }
+
+  // The command has finished.
+  cmsysProcess_WaitForExit(job.Process, 0);
+  int state = cmsysProcess_GetState(job.Process);
+  if (state == cmsysProcess_State_Exited) {
+    e.Result = cmsysProcess_GetExitValue(job.Process);
+  } else {
+    if (state == cmsysProcess_State_Expired) {
+      e.Output += "\nProcess timed out.\n";
+    } else if (state == cmsysProcess_State_Exception) {
+      e.Output += "\nProcess exception: ";
+      e.Output += cmsysProcess_GetExceptionString(job.Process);
+      e.Output += "\n";
+    } else {
+      e.Output += "\nProcess error: ";
+      e.Output += cmsysProcess_GetErrorString(job.Process);
+      e.Output += "\n";
+    }
+    e.Result = 1;
+  }
+  cmsysProcess_Delete(job.Process);
+  job.Process = 0;
+
+  if (e.Result == 0 && ++job.Command < e.Commands.size()) {
+    cmTryCompileBatchStart(job, timeout);
+  }
+  return true;
+}
+
+void cmTryCompileBatch::Run(size_t parallel, double timeout)
+{
+  if (parallel < 1) {
+    parallel = 1;
+  }
+  std::vector<Entry*> pending;
+  for (std::vector<Entry>::iterator ei = this->Entries.begin();
+       ei != this->Entries.end(); ++ei) {
+    if (!ei->Commands.empty()) {
+      pending.push_back(&*ei);
+    }
+  }
+
+  std::vector<cmTryCompileBatchJob> running;
+  std::vector<Entry*>::const_iterator next = pending.begin();
+  while (next != pending.end() || !running.empty()) {
+    while (running.size() < parallel && next != pending.end()) {
+      cmTryCompileBatchJob job;
+      job.Entry = *next++;
+      job.Command = 0;
+      job.Process = 0;
+      if (cmTryCompileBatchStart(job, timeout)) {
+        running.push_back(job);
+      }
+    }
+
+    bool busy = false;
+    for (std::vector<cmTryCompileBatchJob>::iterator ji = running.begin();
+         ji != running.end();) {
+      if (cmTryCompileBatchPoll(*ji, timeout)) {
+        busy = true;
+      }
+      if (ji->Process) {
+        ++ji;
+      } else {
+        ji = running.erase(ji);
+      }
+    }
+    if (!busy && !running.empty()) {
+      cmSystemTools::Delay(1);
+    }
+  }
+}
@@ -0,0 +1,75 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#ifndef cmTryCompileBatch_h
+#define cmTryCompileBatch_h
+
+#include "cmStandardIncludes.h"
+
+#include "cmListFileCache.h"
+#include "cmState.h"
+
+/** \class cmTryCompileBatch
+ * \brief try_compile builds queued to run concurrently.
+ *
+ * Between try_compile_batch(BEGIN) and try_compile_batch(END) a
+ * try_compile call with the BATCH option sets up its test project and
+ * queues the commands that build it instead of running them.  Commands
+ * given to try_compile_batch(CALL) are queued after it.  When the batch
+ * ends, all queued builds run at once, up to a given number at a time,
+ * and then the results are stored and the calls made in queue order.
+ */
+class cmTryCompileBatch
+{
+public:
+  /** A queued try_compile of the source file signature, or a call.  */
+  struct Entry
+  {
+    Entry();
+
+    // The command to call if this is not a try_compile.
+    cmListFileFunction Call;
+
+    // The arguments given to try_compile.
+    std::string ResultVariable;
+    std::string OutputVariable;
+    std::string CopyFile;
+    std::string CopyFileError;
+
+    // The test project.
+    std::string BinaryDirectory;
+    std::string TargetName;
+    cmState::TargetType TargetType;
+    std::string CacheEntry;
+    bool Cached;
+    std::string OutputFile;
+
+    // The commands building the test project, each preceded in the
+    // output by its label, and the environment to run them in.
+    std::vector<std::vector<std::string> > Commands;
+    std::vector<std::string> Labels;
+    std::vector<std::string> Environment;
+    // Whether the build tool reports an #error in the output as success.
+    bool CheckErrorDirective;
+
+    int Result;
+    std::string Output;
+  };
+
+  std::vector<Entry> Entries;
+
+  /** Run the commands of all entries, at most parallel entries at a
+      time.  Each command is killed after timeout seconds, if positive.
+      The commands of an entry stop at the first that fails.  */
+  void Run(size_t parallel, double timeout);
+};
+
+#endif
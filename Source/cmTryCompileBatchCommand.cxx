@@ -0,0 +1,151 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmTryCompileBatchCommand.h"
+
+#include "cmTryCompileBatch.h"
+
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+#include <cmsys/SystemInformation.hxx>
+#endif
+
+#include <stdlib.h>
+
+// cmTryCompileBatchCommand
+bool cmTryCompileBatchCommand::InitialPass(
+  std::vector<std::string> const& args, cmExecutionStatus&)
+{
+  if (args.empty()) {
+    this->SetError("called with incorrect number of arguments");
+    return false;
+  }
+
+  if (args[0] == "BEGIN") {
+    if (args.size() != 1) {
+      this->SetError("BEGIN given unknown arguments.");
+      return false;
+    }
+    if (this->Makefile->GetTryCompileBatch()) {
+      this->SetError("BEGIN given while a batch is already open in this "
+                     "directory.");
+      return false;
+    }
+    this->Makefile->SetTryCompileBatch(new cmTryCompileBatch);
+    return true;
+  }
+  if (args[0] == "CALL") {
+    return this->HandleCall(args);
+  }
+  if (args[0] == "END") {
+    return this->HandleEnd(args);
+  }
+
+  std::string e = "given unknown mode \"" + args[0] + "\".";
+  this->SetError(e);
+  return false;
+}
+
+bool cmTryCompileBatchCommand::HandleCall(std::vector<std::string> const& args)
+{
+  if (args.size() < 2) {
+    this->SetError("CALL must be followed by a command name.");
+    return false;
+  }
+
+  // The arguments have been evaluated already, so pass them on as they
+  // are when the command is called.
+  long const line = this->Makefile->GetExecutionContext().Line;
+  cmListFileFunction call;
+  call.Name = args[1];
+  call.Line = line;
+  for (std::vector<std::string>::const_iterator ai = args.begin() + 2;
+       ai != args.end(); ++ai) {
+    call.Arguments.push_back(
+      cmListFileArgument(*ai, cmListFileArgument::Bracket, line));
+  }
+
+  if (cmTryCompileBatch* batch = this->Makefile->GetTryCompileBatch()) {
+    cmTryCompileBatch::Entry entry;
+    entry.Call = call;
+    batch->Entries.push_back(entry);
+    return true;
+  }
+  cmExecutionStatus status;
+  this->Makefile->ExecuteCommand(call, status);
+  return true;
+}
+
+bool cmTryCompileBatchCommand::HandleEnd(std::vector<std::string> const& args)
+{
+  cmTryCompileBatch* batch = this->Makefile->GetTryCompileBatch();
+  if (!batch) {
+    this->SetError("END given without BEGIN in this directory.");
+    return false;
+  }
+
+  size_t parallel = 0;
+  if (args.size() == 3 && args[1] == "PARALLEL") {
+    parallel = static_cast<size_t>(atoi(args[2].c_str()));
+  } else if (args.size() != 1) {
+    this->SetError("END given unknown arguments.");
+    return false;
+  }
+  if (parallel == 0) {
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+    cmsys::SystemInformation info;
+    info.RunCPUCheck();
+    parallel = info.GetNumberOfLogicalCPU();
+#else
+    parallel = 1;
+#endif
+  }
+
+  // Calls made while the results are stored may queue more builds.
+  // Run them in further rounds until the batch is empty.
+  double const timeout =
+    this->Makefile->GetGlobalGenerator()->TryCompileTimeout;
+  long const line = this->Makefile->GetExecutionContext().Line;
+  while (!batch->Entries.empty()) {
+    cmTryCompileBatch round;
+    round.Entries.swap(batch->Entries);
+    round.Run(parallel, timeout);
+
+    for (std::vector<cmTryCompileBatch::Entry>::iterator ei =
+           round.Entries.begin();
+         ei != round.Entries.end(); ++ei) {
+      if (!ei->Call.Name.empty()) {
+        // Errors in the called command point here.
+        ei->Call.Line = line;
+        cmExecutionStatus status;
+        this->Makefile->ExecuteCommand(ei->Call, status);
+        continue;
+      }
+
+      // The SGI MipsPro 7.3 compiler does not return an error code when
+      // the source has a #error in it!  This is a work-around for such
+      // compilers.
+      if (ei->CheckErrorDirective && ei->Result == 0 &&
+          ei->Output.find("#error") != std::string::npos) {
+        ei->Result = 1;
+      }
+      this->BinaryDirectory = ei->BinaryDirectory;
+      this->SrcFileSignature = true;
+      this->FinishTryCompile(*ei);
+      if (!this->Makefile->GetCMakeInstance()->GetDebugTryCompile()) {
+        this->CleanupFiles(this->BinaryDirectory.c_str());
+        cmSystemTools::RemoveADirectory(this->BinaryDirectory);
+      }
+    }
+  }
+
+  this->Makefile->SetTryCompileBatch(0);
+  return true;
+}
@@ -0,0 +1,51 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#ifndef cmTryCompileBatchCommand_h
+#define cmTryCompileBatchCommand_h
+
+#include "cmCoreTryCompile.h"
+
+/** \class cmTryCompileBatchCommand
+ * \brief Build try_compile test projects concurrently
+ *
+ * cmTryCompileBatchCommand opens and ends a batch of try_compile calls
+ * whose builds run at the same time, and queues calls to be made once
+ * their results are known.
+ */
+class cmTryCompileBatchCommand : public cmCoreTryCompile
+{
+public:
+  /**
+   * This is a virtual constructor for the command.
+   */
+  virtual cmCommand* Clone() { return new cmTryCompileBatchCommand; }
+
+  /**
+   * This is called when the command is first encountered in
+   * the CMakeLists.txt file.
+   */
+  virtual bool InitialPass(std::vector<std::string> const& args,
+                           cmExecutionStatus& status);
+
+  /**
+   * The name of the command as specified in CMakeList.txt.
+   */
+  virtual std::string GetName() const { return "try_compile_batch"; }
+
+  cmTypeMacro(cmTryCompileBatchCommand, cmCoreTryCompile);
+
+private:
+  bool HandleCall(std::vector<std::string> const& args);
+  bool HandleEnd(std::vector<std::string> const& args);
+};
+
+#endif
@@ -30,7 +30,7 @@ bool cmTryCompileCommand::InitialPass(std::vector<std::string> const& argv,
   this->TryCompileCode(argv, false);
 
   // if They specified clean then we clean up what we can
-  if (this->SrcFileSignature) {
+  if (this->SrcFileSignature && !this->Queued) {
     if (!this->Makefile->GetCMakeInstance()->GetDebugTryCompile()) {
       this->CleanupFiles(this->BinaryDirectory.c_str());
     }
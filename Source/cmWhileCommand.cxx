@@ -55,7 +55,7 @@ bool cmWhileFunctionBlocker::IsFunctionBlocked(const cmListFileFunction& lff,
       commandContext.Line = execContext.Line;
       commandContext.Name = execContext.Name;
 
-      cmConditionEvaluator conditionEvaluator(mf, this->GetStartingContext(),
+      cmConditionEvaluator conditionEvaluator(mf,
                                               mf.GetBacktrace(commandContext));
 
       bool isTrue =
@@ -12,6 +12,7 @@
 #include "cmake.h"
 
 #include "cmAlgorithms.h"
+#include "cmCheckBuildSystemManifest.h"
 #include "cmCommand.h"
 #include "cmCommands.h"
 #include "cmDocumentationFormatter.h"
@@ -19,6 +20,7 @@
 #include "cmFileTimeComparison.h"
 #include "cmLocalGenerator.h"
 #include "cmMakefile.h"
+#include "cmMakefileProfilingData.h"
 #include "cmSourceFile.h"
 #include "cmState.h"
 #include "cmTest.h"
@@ -131,6 +133,7 @@ cmake::cmake()
   this->DebugTryCompile = false;
   this->ClearBuildSystem = false;
   this->FileComparison = new cmFileTimeComparison;
+  this->ProfilingData = 0;
 
   this->State = new cmState;
   this->CurrentSnapshot = this->State->CreateBaseSnapshot();
@@ -198,6 +201,7 @@ cmake::~cmake()
   delete this->VariableWatch;
 #endif
   delete this->FileComparison;
+  delete this->ProfilingData;
 }
 
 void cmake::CleanupCommandsAndMacros()
@@ -579,6 +583,22 @@ void cmake::SetArgs(const std::vector<std::string>& args,
       if (this->GraphVizFile.empty()) {
         cmSystemTools::Error("No file specified for --graphviz");
       }
+    } else if (arg.find("--profiling-output=", 0) == 0) {
+      std::string path = arg.substr(strlen("--profiling-output="));
+      if (path.empty()) {
+        cmSystemTools::Error("No file specified for --profiling-output");
+        return;
+      }
+      path = cmSystemTools::CollapseFullPath(path);
+      delete this->ProfilingData;
+      this->ProfilingData = new cmMakefileProfilingData(path);
+      if (!this->ProfilingData->IsValid()) {
+        cmSystemTools::Error("Could not open profiling output file ",
+                             path.c_str());
+        delete this->ProfilingData;
+        this->ProfilingData = 0;
+        return;
+      }
     } else if (arg.find("--debug-trycompile", 0) == 0) {
       std::cout << "debug trycompile on\n";
       this->DebugTryCompileOn();
@@ -1731,39 +1751,67 @@ int cmake::CheckBuildSystem()
   }
 
   // Read the rerun check file and use it to decide whether to do the
-  // global generate.
-  cmake cm;
-  cm.SetHomeDirectory("");
-  cm.SetHomeOutputDirectory("");
-  cm.GetCurrentSnapshot().SetDefaultDefinitions();
-  cmGlobalGenerator gg(&cm);
-  cmsys::auto_ptr<cmMakefile> mf(new cmMakefile(&gg, cm.GetCurrentSnapshot()));
-  if (!mf->ReadListFile(this->CheckBuildSystemArgument.c_str()) ||
-      cmSystemTools::GetErrorOccuredFlag()) {
-    if (verbose) {
-      std::ostringstream msg;
-      msg << "Re-run cmake error reading : " << this->CheckBuildSystemArgument
-          << "\n";
-      cmSystemTools::Stdout(msg.str().c_str());
+  // global generate.  The generator stores the same information in a
+  // binary manifest that can be loaded without running the CMake language
+  // interpreter.  Fall back to the check file if it is unusable.
+  cmCheckBuildSystemManifest manifest;
+  if (!manifest.Read(this->CheckBuildSystemArgument)) {
+    cmake cm;
+    cm.SetHomeDirectory("");
+    cm.SetHomeOutputDirectory("");
+    cm.GetCurrentSnapshot().SetDefaultDefinitions();
+    cmGlobalGenerator gg(&cm);
+    cmsys::auto_ptr<cmMakefile> mf(
+      new cmMakefile(&gg, cm.GetCurrentSnapshot()));
+    if (!mf->ReadListFile(this->CheckBuildSystemArgument.c_str()) ||
+        cmSystemTools::GetErrorOccuredFlag()) {
+      if (verbose) {
+        std::ostringstream msg;
+        msg << "Re-run cmake error reading : "
+            << this->CheckBuildSystemArgument << "\n";
+        cmSystemTools::Stdout(msg.str().c_str());
+      }
+      // There was an error reading the file.  Just rerun.
+      return 1;
+    }
+
+    if (const char* genName = mf->GetDefinition("CMAKE_DEPENDS_GENERATOR")) {
+      manifest.Generator = genName;
+    }
+    if (const char* productStr =
+          mf->GetDefinition("CMAKE_MAKEFILE_PRODUCTS")) {
+      cmSystemTools::ExpandListArgument(productStr, manifest.Products);
+    }
+    const char* dependsStr = mf->GetDefinition("CMAKE_MAKEFILE_DEPENDS");
+    const char* outputsStr = mf->GetDefinition("CMAKE_MAKEFILE_OUTPUTS");
+    if (dependsStr && outputsStr) {
+      cmSystemTools::ExpandListArgument(dependsStr, manifest.Depends);
+      cmSystemTools::ExpandListArgument(outputsStr, manifest.Outputs);
+    }
+    if (const char* infoStr = mf->GetDefinition("CMAKE_DEPEND_INFO_FILES")) {
+      cmSystemTools::ExpandListArgument(infoStr, manifest.DependInfoFiles);
     }
-    // There was an error reading the file.  Just rerun.
-    return 1;
   }
 
   if (this->ClearBuildSystem) {
     // Get the generator used for this build system.
-    const char* genName = mf->GetDefinition("CMAKE_DEPENDS_GENERATOR");
-    if (!genName || genName[0] == '\0') {
+    std::string genName = manifest.Generator;
+    if (genName.empty()) {
       genName = "Unix Makefiles";
     }
 
     // Create the generator and use it to clear the dependencies.
+    cmake cm;
+    cm.SetHomeDirectory("");
+    cm.SetHomeOutputDirectory("");
     cmsys::auto_ptr<cmGlobalGenerator> ggd(
       this->CreateGlobalGenerator(genName));
     if (ggd.get()) {
       cm.GetCurrentSnapshot().SetDefaultDefinitions();
       cmsys::auto_ptr<cmMakefile> mfd(
         new cmMakefile(ggd.get(), cm.GetCurrentSnapshot()));
+      mfd->AddDefinition("CMAKE_DEPEND_INFO_FILES",
+                         cmJoin(manifest.DependInfoFiles, ";").c_str());
       cmsys::auto_ptr<cmLocalGenerator> lgd(
         ggd->CreateLocalGenerator(mfd.get()));
       lgd->ClearDependencies(mfd.get(), verbose);
@@ -1771,10 +1819,7 @@ int cmake::CheckBuildSystem()
   }
 
   // If any byproduct of makefile generation is missing we must re-run.
-  std::vector<std::string> products;
-  if (const char* productStr = mf->GetDefinition("CMAKE_MAKEFILE_PRODUCTS")) {
-    cmSystemTools::ExpandListArgument(productStr, products);
-  }
+  std::vector<std::string> const& products = manifest.Products;
   for (std::vector<std::string>::const_iterator pi = products.begin();
        pi != products.end(); ++pi) {
     if (!(cmSystemTools::FileExists(pi->c_str()) ||
@@ -1789,14 +1834,8 @@ int cmake::CheckBuildSystem()
   }
 
   // Get the set of dependencies and outputs.
-  std::vector<std::string> depends;
-  std::vector<std::string> outputs;
-  const char* dependsStr = mf->GetDefinition("CMAKE_MAKEFILE_DEPENDS");
-  const char* outputsStr = mf->GetDefinition("CMAKE_MAKEFILE_OUTPUTS");
-  if (dependsStr && outputsStr) {
-    cmSystemTools::ExpandListArgument(dependsStr, depends);
-    cmSystemTools::ExpandListArgument(outputsStr, outputs);
-  }
+  std::vector<std::string> const& depends = manifest.Depends;
+  std::vector<std::string> const& outputs = manifest.Outputs;
   if (depends.empty() || outputs.empty()) {
     // Not enough information was provided to do the test.  Just rerun.
     if (verbose) {
@@ -1808,44 +1847,38 @@ int cmake::CheckBuildSystem()
     return 1;
   }
 
-  // Find the newest dependency.
-  std::vector<std::string>::iterator dep = depends.begin();
-  std::string dep_newest = *dep++;
-  for (; dep != depends.end(); ++dep) {
-    int result = 0;
-    if (this->FileComparison->FileTimeCompare(dep_newest.c_str(), dep->c_str(),
-                                              &result)) {
-      if (result < 0) {
-        dep_newest = *dep;
-      }
-    } else {
-      if (verbose) {
-        std::ostringstream msg;
-        msg << "Re-run cmake: build system dependency is missing\n";
-        cmSystemTools::Stdout(msg.str().c_str());
-      }
-      return 1;
+  // Find the newest dependency and the oldest output.  The times of all
+  // files are queried in one batch.
+  double checkStart = verbose ? cmSystemTools::GetTime() : 0;
+  size_t newest = 0;
+  size_t oldest = 0;
+  size_t missing = 0;
+  if (!this->FileComparison->FindNewestAndOldest(depends, &newest, &oldest,
+                                                 &missing)) {
+    if (verbose) {
+      std::ostringstream msg;
+      msg << "Re-run cmake: build system dependency is missing\n";
+      cmSystemTools::Stdout(msg.str().c_str());
     }
+    return 1;
   }
-
-  // Find the oldest output.
-  std::vector<std::string>::iterator out = outputs.begin();
-  std::string out_oldest = *out++;
-  for (; out != outputs.end(); ++out) {
-    int result = 0;
-    if (this->FileComparison->FileTimeCompare(out_oldest.c_str(), out->c_str(),
-                                              &result)) {
-      if (result > 0) {
-        out_oldest = *out;
-      }
-    } else {
-      if (verbose) {
-        std::ostringstream msg;
-        msg << "Re-run cmake: build system output is missing\n";
-        cmSystemTools::Stdout(msg.str().c_str());
-      }
-      return 1;
+  std::string dep_newest = depends[newest];
+  if (!this->FileComparison->FindNewestAndOldest(outputs, &newest, &oldest,
+                                                 &missing)) {
+    if (verbose) {
+      std::ostringstream msg;
+      msg << "Re-run cmake: build system output is missing\n";
+      cmSystemTools::Stdout(msg.str().c_str());
     }
+    return 1;
+  }
+  std::string out_oldest = outputs[oldest];
+  if (verbose) {
+    std::ostringstream msg;
+    msg << "Checked times of " << depends.size() + outputs.size()
+        << " build system files in " << std::fixed << std::setprecision(3)
+        << (cmSystemTools::GetTime() - checkStart) * 1000 << " ms\n";
+    cmSystemTools::Stdout(msg.str().c_str());
   }
 
   // If any output is older than any dependency then rerun.
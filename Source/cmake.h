@@ -27,6 +27,7 @@ class cmLocalGenerator;
 class cmMakefile;
 class cmVariableWatch;
 class cmFileTimeComparison;
+class cmMakefileProfilingData;
 class cmExternalMakefileProjectGenerator;
 class cmDocumentationSection;
 class cmTarget;
@@ -307,6 +308,9 @@ public:
   void SetTrace(bool b) { this->Trace = b; }
   bool GetTraceExpand() { return this->TraceExpand; }
   void SetTraceExpand(bool b) { this->TraceExpand = b; }
+
+  // Where to record how long the steps of the cmake run take, or null.
+  cmMakefileProfilingData* GetProfilingData() { return this->ProfilingData; }
   bool GetWarnUninitialized() { return this->WarnUninitialized; }
   void SetWarnUninitialized(bool b) { this->WarnUninitialized = b; }
   bool GetWarnUnused() { return this->WarnUnused; }
@@ -476,6 +480,7 @@ private:
   bool DebugTryCompile;
   cmFileTimeComparison* FileComparison;
   std::string GraphVizFile;
+  cmMakefileProfilingData* ProfilingData;
   InstalledFilesMap InstalledFiles;
 
   cmState* State;
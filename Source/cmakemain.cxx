@@ -27,6 +27,10 @@
 #include "cmcmd.h"
 #include <cmsys/Encoding.hxx>
 
+#ifdef CMAKE_USE_DAEMON
+#include "cmDaemon.h"
+#endif
+
 #ifdef CMAKE_BUILD_WITH_CMAKE
 static const char* cmDocumentationName[][2] = {
   { 0, "  cmake - Cross-Platform Makefile Generator." },
@@ -57,11 +61,21 @@ static const char* cmDocumentationUsageNote[][2] = {
   "  --use-stderr   = Ignored.  Behavior is default in CMake >= 3.0.\n"       \
   "  --             = Pass remaining options to the native tool.\n"
 
+#define CMAKE_DAEMON_REQUESTS                                                 \
+  "  regenerate              = Configure and generate the build tree.\n"     \
+  "  list-targets            = List the targets of the build tree.\n"        \
+  "  get-compile-flags <src> = Show the flags <src> is compiled with.\n"     \
+  "  shutdown                = Stop the daemon.\n"
+
 static const char* cmDocumentationOptions[][2] = {
   CMAKE_STANDARD_OPTIONS_TABLE,
   { "-E", "CMake command mode." },
   { "-L[A][H]", "List non-advanced cached variables." },
   { "--build <dir>", "Build a CMake-generated project binary tree." },
+#ifdef CMAKE_USE_DAEMON
+  { "--daemon <dir> [<request>]", "Keep a project binary tree generated, "
+                                  "or send a request to the daemon." },
+#endif
   { "-N", "View mode only." },
   { "-P <file>", "Process script mode." },
   { "--find-package", "Run in pkg-config like mode." },
@@ -73,6 +87,8 @@ static const char* cmDocumentationOptions[][2] = {
   { "--debug-output", "Put cmake in a debug mode." },
   { "--trace", "Put cmake in trace mode." },
   { "--trace-expand", "Put cmake in trace mode with variable expansion." },
+  { "--profiling-output=<file>", "Write a trace of the time taken by the "
+                                 "cmake run to <file>." },
   { "--warn-uninitialized", "Warn about uninitialized values." },
   { "--warn-unused-vars", "Warn about unused variables." },
   { "--no-warn-unused-cli", "Don't warn about command line options." },
@@ -94,6 +110,7 @@ static int do_command(int ac, char const* const* av)
 
 int do_cmake(int ac, char const* const* av);
 static int do_build(int ac, char const* const* av);
+static int do_daemon(int ac, char const* const* av);
 
 static cmMakefile* cmakemainGetMakefile(void* clientdata)
 {
@@ -160,6 +177,8 @@ int main(int ac, char const* const* av)
   if (ac > 1) {
     if (strcmp(av[1], "--build") == 0) {
       return do_build(ac, av);
+    } else if (strcmp(av[1], "--daemon") == 0) {
+      return do_daemon(ac, av);
     } else if (strcmp(av[1], "-E") == 0) {
       return do_command(ac, av);
     }
@@ -394,3 +413,35 @@ static int do_build(int ac, char const* const* av)
   return cm.Build(dir, target, config, nativeOptions, clean);
 #endif
 }
+
+static int do_daemon(int ac, char const* const* av)
+{
+#ifndef CMAKE_USE_DAEMON
+  std::cerr << "This cmake does not support --daemon\n";
+  return -1;
+#else
+  if (ac < 3) {
+    /* clang-format off */
+    std::cerr <<
+      "Usage: cmake --daemon <dir> [<request> [<argument>]]\n"
+      "Requests:\n"
+      CMAKE_DAEMON_REQUESTS
+      ;
+    /* clang-format on */
+    return 1;
+  }
+
+  std::string dir = cmSystemTools::CollapseFullPath(av[2]);
+  if (ac > 3) {
+    cmSystemTools::SetMessageCallback(cmakemainMessageCallback, 0);
+    std::vector<std::string> request(av + 3, av + ac);
+    return cmDaemon::Request(dir, request, std::cout);
+  }
+
+  cmake cm;
+  cmSystemTools::SetMessageCallback(cmakemainMessageCallback, &cm);
+  cm.SetProgressCallback(cmakemainProgressCallback, &cm);
+  cmDaemon daemon(&cm);
+  return daemon.Serve(dir);
+#endif
+}
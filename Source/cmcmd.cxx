@@ -22,7 +22,6 @@
 #include "cmDependsFortran.h" // For -E cmake_copy_f90_mod callback.
 #endif
 
-#include <cmsys/Directory.hxx>
 #include <cmsys/FStream.hxx>
 #include <cmsys/Process.h>
 #include <cmsys/Terminal.h>
@@ -39,6 +38,12 @@
 #include "bindexplib.h"
 #endif
 
+// The progress file of Makefile builds has a text header with the total
+// count of marks and then a byte for each mark.  Marks are numbered from
+// 1 to at most 100.
+static const int cmcmdProgressHeaderSize = 16;
+static const int cmcmdProgressMarks = 101;
+
 void CMakeCommandUsage(const char* program)
 {
   std::ostringstream errorStream;
@@ -589,12 +594,15 @@ int cmcmd::ExecuteCMakeCommand(std::vector<std::string>& args)
       }
       if (count) {
         cmSystemTools::MakeDirectory(dirName.c_str());
-        // write the count into the directory
+        // write the count and room for all marks into the directory
         std::string fName = dirName;
-        fName += "/count.txt";
-        FILE* progFile = cmsys::SystemTools::Fopen(fName, "w");
+        fName += "/marks.bin";
+        FILE* progFile = cmsys::SystemTools::Fopen(fName, "wb");
         if (progFile) {
-          fprintf(progFile, "%i\n", count);
+          char marks[cmcmdProgressHeaderSize + cmcmdProgressMarks];
+          memset(marks, 0, sizeof(marks));
+          sprintf(marks, "%-*i\n", cmcmdProgressHeaderSize - 2, count);
+          fwrite(marks, 1, sizeof(marks), progFile);
           fclose(progFile);
         }
       }
@@ -783,6 +791,7 @@ int cmcmd::ExecuteCMakeCommand(std::vector<std::string>& args)
       std::vector<std::string> files;
       std::string mtime;
       std::string format;
+      int threads = 1;
       bool doing_options = true;
       for (std::string::size_type cc = 4; cc < args.size(); cc++) {
         std::string const& arg = args[cc];
@@ -796,6 +805,15 @@ int cmcmd::ExecuteCMakeCommand(std::vector<std::string>& args)
             if (!cmTarFilesFrom(files_from, files)) {
               return 1;
             }
+          } else if (cmHasLiteralPrefix(arg, "--threads=")) {
+            std::string const& value = arg.substr(10);
+            long n;
+            if (!cmSystemTools::StringToLong(value.c_str(), &n) || n < 0) {
+              cmSystemTools::Error("Invalid -E tar --threads= argument: ",
+                                   value.c_str());
+              return 1;
+            }
+            threads = static_cast<int>(n);
           } else if (cmHasLiteralPrefix(arg, "--format=")) {
             format = arg.substr(9);
             bool isKnown =
@@ -851,7 +869,7 @@ int cmcmd::ExecuteCMakeCommand(std::vector<std::string>& args)
         }
       } else if (flags.find_first_of('c') != flags.npos) {
         if (!cmSystemTools::CreateTar(outFile.c_str(), files, compress,
-                                      verbose, mtime, format)) {
+                                      verbose, mtime, format, threads)) {
           cmSystemTools::Error("Problem creating tar: ", outFile.c_str());
           return 1;
         }
@@ -967,48 +985,50 @@ bool cmcmd::SymlinkInternal(std::string const& file, std::string const& link)
 
 static void cmcmdProgressReport(std::string const& dir, std::string const& num)
 {
-  std::string dirName = dir;
-  dirName += "/Progress";
-  std::string fName;
-  FILE* progFile;
-
-  // read the count
-  fName = dirName;
-  fName += "/count.txt";
-  progFile = cmsys::SystemTools::Fopen(fName, "r");
-  int count = 0;
+  // Progress is kept in a single small file with the total count of
+  // marks followed by one byte for each mark that has been reached, so a
+  // report opens one file instead of creating a file for each mark and
+  // reading the whole directory.
+  std::string fName = dir;
+  fName += "/Progress/marks.bin";
+  FILE* progFile = cmsys::SystemTools::Fopen(fName, "r+b");
   if (!progFile) {
     return;
-  } else {
-    if (1 != fscanf(progFile, "%i", &count)) {
-      cmSystemTools::Message("Could not read from progress file.");
+  }
+
+  // Set the bytes of the given marks.  Concurrent reports write
+  // distinct bytes, and a mark reached twice is counted once.
+  for (const char* c = num.c_str(); *c;) {
+    char* end;
+    long mark = strtol(c, &end, 10);
+    if (mark > 0 && mark < cmcmdProgressMarks &&
+        fseek(progFile, cmcmdProgressHeaderSize + mark, SEEK_SET) == 0) {
+      fputc(1, progFile);
     }
-    fclose(progFile);
+    c = *end == ',' ? end + 1 : end + strlen(end);
   }
-  const char* last = num.c_str();
-  for (const char* c = last;; ++c) {
-    if (*c == ',' || *c == '\0') {
-      if (c != last) {
-        fName = dirName;
-        fName += "/";
-        fName.append(last, c - last);
-        progFile = cmsys::SystemTools::Fopen(fName, "w");
-        if (progFile) {
-          fprintf(progFile, "empty");
-          fclose(progFile);
-        }
-      }
-      if (*c == '\0') {
-        break;
-      }
-      last = c + 1;
+
+  char marks[cmcmdProgressHeaderSize + cmcmdProgressMarks];
+  size_t length = 0;
+  if (fseek(progFile, 0, SEEK_SET) == 0) {
+    length = fread(marks, 1, sizeof(marks), progFile);
+  }
+  fclose(progFile);
+  if (length < static_cast<size_t>(cmcmdProgressHeaderSize)) {
+    cmSystemTools::Message("Could not read from progress file.");
+    return;
+  }
+  marks[cmcmdProgressHeaderSize - 1] = 0;
+  int count = atoi(marks);
+  int reached = 0;
+  for (size_t i = cmcmdProgressHeaderSize; i < length; ++i) {
+    if (marks[i]) {
+      ++reached;
     }
   }
-  int fileNum =
-    static_cast<int>(cmsys::Directory::GetNumberOfFilesInDirectory(dirName));
   if (count > 0) {
     // print the progress
-    fprintf(stdout, "[%3i%%] ", ((fileNum - 3) * 100) / count);
+    fprintf(stdout, "[%3i%%] ", (reached * 100) / count);
   }
 }
 
@@ -68,6 +68,9 @@ static const char* cmDocumentationOptions[][2] = {
     "Run a specific number of tests by number." },
   { "-U, --union", "Take the Union of -I and -R" },
   { "--rerun-failed", "Run only the tests that failed previously" },
+  { "--shard <index>/<count>",
+    "Run only the tests of one of several balanced shards" },
+  { "--print-shard-plan", "Print the expected time of each shard." },
   { "--repeat-until-fail <n>", "Require each test to run <n> "
                                "times without failing in order to pass" },
   { "--max-width <width>", "Set the max width for a test name to output" },
@@ -92,6 +95,8 @@ static const char* cmDocumentationOptions[][2] = {
   { "--test-command", "The test to run with the --build-and-test option." },
   { "--test-timeout", "The time limit in seconds, internal use only." },
   { "--test-load", "CPU load threshold for starting new parallel tests." },
+  { "--resource-capacity <pool>=<capacity>[,<pool>=<capacity>...]",
+    "Limit the RESOURCE_AMOUNTS of tests running in parallel." },
   { "--tomorrow-tag", "Nightly or experimental starts with next day tag." },
   { "--ctest-config", "The configuration file used to initialize CTest state "
                       "when submitting dashboards." },
@@ -100,6 +105,8 @@ static const char* cmDocumentationOptions[][2] = {
   { "--force-new-ctest-process",
     "Run child CTest instances as new processes" },
   { "--schedule-random", "Use a random order for scheduling tests" },
+  { "--schedule-critical-path",
+    "Start tests with the longest chains of dependent tests first" },
   { "--submit-index",
     "Submit individual dashboard tests with specific index" },
   { "--timeout <seconds>", "Set a global timeout on all tests." },
@@ -40,11 +40,15 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <vector>
+
 namespace KWSYS_NAMESPACE
 {
 
 // RegularExpression -- Copies the given regular expression.
 RegularExpression::RegularExpression (const RegularExpression& rxp) {
+  this->engine = rxp.engine;                    // Copy matching engine
+  this->nfaprog = 0;                            // Rebuilt on demand
   if ( !rxp.program )
     {
     this->program = 0;
@@ -79,6 +83,9 @@ RegularExpression& RegularExpression::operator= (const RegularExpression& rxp)
     {
     return *this;
     }
+  this->engine = rxp.engine;                    // Copy matching engine
+  delete [] this->nfaprog;                      // Rebuilt on demand
+  this->nfaprog = 0;
   if ( !rxp.program )
     {
     this->program = 0;
@@ -379,6 +386,8 @@ bool RegularExpression::compile (const char* exp) {
 //#ifndef _WIN32
     if (this->program != 0) delete [] this->program;
 //#endif
+    delete [] this->nfaprog;
+    this->nfaprog = 0;
     this->program = new char[regsize];
     this->progsize = static_cast<int>(regsize);
 
@@ -914,6 +923,10 @@ bool RegularExpression::find (const char* string) {
             return (0);
     }
 
+    // Simulate the program breadth-first if requested.
+    if (this->engine == NFA)
+        return this->find_nfa(string);
+
     // Mark beginning of line for ^ .
     regbol = string;
 
@@ -1241,4 +1254,390 @@ static char* regnext (char* p) {
         return (p + offset);
 }
 
+/////////////////////////////////////////////////////////////////////////
+//
+//  NFA SIMULATION
+//
+/////////////////////////////////////////////////////////////////////////
+
+/*
+ * The NFA engine translates the compiled program above into a flat list of
+ * instructions and runs all alternatives in lock step over the input, in
+ * the manner of Thompson and Pike.  Threads are kept in priority order so
+ * that the first thread to reach a match is the one the backtracking
+ * matcher would have found, which keeps the start, end and submatch
+ * positions identical between the two engines.  Each input character is
+ * examined once, so no pattern can make find() take more than time
+ * proportional to the program size times the input length.
+ *
+ * An instruction is three ints:  opcode, and two operands.
+ */
+
+#define NFA_FAIL    0   // Thread dies.
+#define NFA_MATCH   1   // Thread matched.
+#define NFA_CHAR    2   // x: character to match.
+#define NFA_ANY     3   // Match any character.
+#define NFA_ANYOF   4   // x: program offset of character set.
+#define NFA_ANYBUT  5   // x: program offset of excluded character set.
+#define NFA_BOL     6   // Match "" at beginning of input.
+#define NFA_EOL     7   // Match "" at end of input.
+#define NFA_JMP     8   // x: next instruction.
+#define NFA_SPLIT   9   // x: preferred next instruction, y: alternative.
+#define NFA_SAVE    10  // x: submatch slot to record position in.
+
+static RegularExpression::Engine regdefaultengine =
+  RegularExpression::Backtracking;
+
+void RegularExpression::set_default_engine (Engine e) {
+    regdefaultengine = e;
+}
+
+RegularExpression::Engine RegularExpression::get_default_engine () {
+    return regdefaultengine;
+}
+
+/*
+ - regnfasize - number of instructions the node at p translates into
+ */
+static int regnfasize (const char* p) {
+    switch (OP(p)) {
+        case END:
+        case NOTHING:
+        case BACK:
+        case BRANCH:
+            return 1;
+        case EXACTLY:
+            return static_cast<int>(strlen(OPERAND(p))) + 1;
+        case STAR:
+            return 3;
+        default:
+            return 2;
+    }
+}
+
+/*
+ - regnodesize - number of bytes the node at p occupies in the program
+ */
+static int regnodesize (const char* p) {
+    switch (OP(p)) {
+        case EXACTLY:
+        case ANYOF:
+        case ANYBUT:
+            return 3 + static_cast<int>(strlen(OPERAND(p))) + 1;
+        default:
+            return 3;
+    }
+}
+
+// compile_nfa -- translate the compiled program into NFA instructions.
+
+bool RegularExpression::compile_nfa () {
+    const char* end = this->program + this->progsize;
+    const char* scan;
+
+    // First pass: the instruction index at which every node starts.
+    // Instruction 0 is reserved for NFA_FAIL, the target of null pointers.
+    std::vector<int> label(static_cast<size_t>(this->progsize), 0);
+    int size = 1;
+    for (scan = this->program + 1; scan < end; scan += regnodesize(scan)) {
+        label[static_cast<size_t>(scan - this->program)] = size;
+        size += regnfasize(scan);
+    }
+
+    // Second pass: emit the instructions.
+    int* code = new int[3 * size];
+    int* pc = code;
+#define NFA_EMIT(o, x, y) { pc[0] = (o); pc[1] = (x); pc[2] = (y); pc += 3; }
+#define NFA_LABEL(p) ((p) ? label[static_cast<size_t>((p) - this->program)] : 0)
+    NFA_EMIT(NFA_FAIL, 0, 0);
+    for (scan = this->program + 1; scan < end; scan += regnodesize(scan)) {
+        const char* next = regnext(scan);
+        int here = static_cast<int>(pc - code) / 3;
+        int op = OP(scan);
+        switch (op) {
+            case END:
+                NFA_EMIT(NFA_MATCH, 0, 0);
+                break;
+            case BOL:
+                NFA_EMIT(NFA_BOL, 0, 0);
+                NFA_EMIT(NFA_JMP, NFA_LABEL(next), 0);
+                break;
+            case EOL:
+                NFA_EMIT(NFA_EOL, 0, 0);
+                NFA_EMIT(NFA_JMP, NFA_LABEL(next), 0);
+                break;
+            case ANY:
+                NFA_EMIT(NFA_ANY, 0, 0);
+                NFA_EMIT(NFA_JMP, NFA_LABEL(next), 0);
+                break;
+            case ANYOF:
+            case ANYBUT:
+                NFA_EMIT(op == ANYOF ? NFA_ANYOF : NFA_ANYBUT,
+                         static_cast<int>(OPERAND(scan) - this->program), 0);
+                NFA_EMIT(NFA_JMP, NFA_LABEL(next), 0);
+                break;
+            case EXACTLY:{
+                    const char* opnd;
+                    for (opnd = OPERAND(scan); *opnd != '\0'; ++opnd)
+                        NFA_EMIT(NFA_CHAR, UCHARAT(opnd), 0);
+                    NFA_EMIT(NFA_JMP, NFA_LABEL(next), 0);
+                }
+                break;
+            case NOTHING:
+            case BACK:
+                NFA_EMIT(NFA_JMP, NFA_LABEL(next), 0);
+                break;
+            case BRANCH:
+                if (OP(next) != BRANCH)     // No choice.
+                    NFA_EMIT(NFA_JMP, NFA_LABEL(OPERAND(scan)), 0)
+                else
+                    NFA_EMIT(NFA_SPLIT, NFA_LABEL(OPERAND(scan)),
+                             NFA_LABEL(next))
+                break;
+            case STAR:
+            case PLUS:{
+                    // The operand is a single character test.  Greedy, so
+                    // another repetition is preferred over moving on.
+                    const char* opnd = OPERAND(scan);
+                    int test = NFA_FAIL;
+                    int arg = 0;
+                    switch (OP(opnd)) {
+                        case ANY:
+                            test = NFA_ANY;
+                            break;
+                        case EXACTLY:
+                            test = NFA_CHAR;
+                            arg = UCHARAT(OPERAND(opnd));
+                            break;
+                        case ANYOF:
+                            test = NFA_ANYOF;
+                            arg = static_cast<int>(OPERAND(opnd) -
+                                                   this->program);
+                            break;
+                        case ANYBUT:
+                            test = NFA_ANYBUT;
+                            arg = static_cast<int>(OPERAND(opnd) -
+                                                   this->program);
+                            break;
+                        default:
+                            break;
+                    }
+                    if (op == STAR) {
+                        NFA_EMIT(NFA_SPLIT, here + 1, NFA_LABEL(next));
+                        NFA_EMIT(test, arg, 0);
+                        NFA_EMIT(NFA_JMP, here, 0);
+                    } else {
+                        NFA_EMIT(test, arg, 0);
+                        NFA_EMIT(NFA_SPLIT, here, NFA_LABEL(next));
+                    }
+                }
+                break;
+            default:
+                if (op > OPEN && op < OPEN + NSUBEXP) {
+                    NFA_EMIT(NFA_SAVE, 2 * (op - OPEN), 0);
+                    NFA_EMIT(NFA_JMP, NFA_LABEL(next), 0);
+                } else if (op > CLOSE && op < CLOSE + NSUBEXP) {
+                    NFA_EMIT(NFA_SAVE, 2 * (op - CLOSE) + 1, 0);
+                    NFA_EMIT(NFA_JMP, NFA_LABEL(next), 0);
+                } else {
+                    //RAISE Error, SYM(RegularExpression), SYM(Internal_Error),
+                    printf ("RegularExpression::find(): Internal error -- memory corrupted.\n");
+                    delete [] code;
+                    return false;
+                }
+                break;
+        }
+    }
+#undef NFA_LABEL
+#undef NFA_EMIT
+
+    this->nfaprog = code;
+    this->nfasize = size;
+    return true;
+}
+
+/*
+ * Global work variables for find_nfa().  A thread list is a sparse set of
+ * instruction indices in priority order, with the submatch slots of each
+ * thread stored alongside.
+ */
+#define NFA_NSLOT (2 * RegularExpression::NSUBEXP)
+
+struct RegNFAThreadList {
+    std::vector<int>         dense;
+    std::vector<int>         sparse;
+    std::vector<const char*> slots;
+    int                      count;
+};
+
+struct RegNFAStackEntry {
+    int         pc;     // Instruction to follow, or -1 to restore a slot.
+    int         slot;
+    const char* save;
+};
+
+static RegNFAThreadList              regnfalist[2];
+static std::vector<RegNFAStackEntry> regnfastack;
+static const char*                   regnfaslots[NFA_NSLOT];
+
+static void regnfareset (RegNFAThreadList& l, int size) {
+    if (static_cast<int>(l.dense.size()) < size) {
+        l.dense.resize(static_cast<size_t>(size));
+        l.sparse.resize(static_cast<size_t>(size));
+        l.slots.resize(static_cast<size_t>(size) * NFA_NSLOT);
+    }
+    l.count = 0;
+}
+
+/*
+ - regnfaadd - add the thread at instruction pc, with submatch slots taken
+   from regnfaslots, and every thread reachable from it without consuming
+   input.  Lower priority alternatives are explored after higher ones.
+ */
+static void regnfaadd (RegNFAThreadList& l, const int* prog, int pc,
+                       const char* input, const char* bol) {
+    RegNFAStackEntry e;
+    e.pc = pc;
+    e.slot = 0;
+    e.save = 0;
+    regnfastack.push_back(e);
+    while (!regnfastack.empty()) {
+        e = regnfastack.back();
+        regnfastack.pop_back();
+        if (e.pc < 0) {
+            regnfaslots[e.slot] = e.save;
+            continue;
+        }
+        pc = e.pc;
+        for (;;) {
+            int k = l.sparse[static_cast<size_t>(pc)];
+            if (k < l.count && l.dense[static_cast<size_t>(k)] == pc)
+                break;          // Already on the list at higher priority.
+            k = l.count++;
+            l.dense[static_cast<size_t>(k)] = pc;
+            l.sparse[static_cast<size_t>(pc)] = k;
+
+            const int* inst = prog + 3 * pc;
+            if (inst[0] == NFA_JMP) {
+                pc = inst[1];
+            } else if (inst[0] == NFA_SPLIT) {
+                e.pc = inst[2];
+                regnfastack.push_back(e);
+                pc = inst[1];
+            } else if (inst[0] == NFA_SAVE) {
+                e.pc = -1;
+                e.slot = inst[1];
+                e.save = regnfaslots[inst[1]];
+                regnfastack.push_back(e);
+                regnfaslots[inst[1]] = input;
+                pc++;
+            } else if (inst[0] == NFA_BOL) {
+                if (input != bol)
+                    break;
+                pc++;
+            } else if (inst[0] == NFA_EOL) {
+                if (*input != '\0')
+                    break;
+                pc++;
+            } else {
+                // Consuming instruction or match:  keep the submatches.
+                memcpy(&l.slots[static_cast<size_t>(k) * NFA_NSLOT],
+                       regnfaslots, sizeof(regnfaslots));
+                break;
+            }
+        }
+    }
+}
+
+// find_nfa -- Matches the regular expression to the given string by
+// simulating all alternatives in parallel.
+
+bool RegularExpression::find_nfa (const char* string) {
+    if (!this->nfaprog && !this->compile_nfa())
+        return false;
+
+    const int* prog = this->nfaprog;
+    const char* prog_chars = this->program;
+    const int start = 1;        // First node, right after NFA_FAIL.
+    RegNFAThreadList* clist = &regnfalist[0];
+    RegNFAThreadList* nlist = &regnfalist[1];
+    regnfareset(*clist, this->nfasize);
+    regnfareset(*nlist, this->nfasize);
+
+    bool matched = false;
+    const char* s = string;
+    for (;;) {
+        // Start a new, lowest priority, attempt at this position.
+        if (!matched && (s == string || !this->reganch)) {
+            if (clist->count == 0 && this->regstart != '\0' &&
+                *s != this->regstart) {
+                s = strchr(s, this->regstart);
+                if (s == 0)
+                    break;
+            }
+            if (this->regstart == '\0' || *s == this->regstart) {
+                int i;
+                for (i = 0; i < NFA_NSLOT; ++i)
+                    regnfaslots[i] = 0;
+                regnfaslots[0] = s;
+                regnfaadd(*clist, prog, start, s, string);
+            }
+        }
+        if (clist->count == 0 && (matched || this->reganch))
+            break;
+
+        // Advance every thread over the current character.
+        nlist->count = 0;
+        unsigned char c = UCHARAT(s);
+        int i;
+        for (i = 0; i < clist->count; ++i) {
+            int pc = clist->dense[static_cast<size_t>(i)];
+            const int* inst = prog + 3 * pc;
+            const char** slots = &clist->slots[static_cast<size_t>(i) *
+                                               NFA_NSLOT];
+            bool step = false;
+            switch (inst[0]) {
+                case NFA_MATCH:
+                    for (int n = 0; n < NSUBEXP; ++n) {
+                        this->startp[n] = slots[2 * n];
+                        this->endp[n] = slots[2 * n + 1];
+                    }
+                    this->endp[0] = s;
+                    matched = true;
+                    break;
+                case NFA_CHAR:
+                    step = (c == static_cast<unsigned char>(inst[1]));
+                    break;
+                case NFA_ANY:
+                    step = (c != '\0');
+                    break;
+                case NFA_ANYOF:
+                    step = (c != '\0' &&
+                            strchr(prog_chars + inst[1], c) != 0);
+                    break;
+                case NFA_ANYBUT:
+                    step = (c != '\0' &&
+                            strchr(prog_chars + inst[1], c) == 0);
+                    break;
+                default:
+                    break;
+            }
+            if (inst[0] == NFA_MATCH)
+                break;          // Lower priority threads cannot win.
+            if (step) {
+                memcpy(regnfaslots, slots, sizeof(regnfaslots));
+                regnfaadd(*nlist, prog, pc + 1, s + 1, string);
+            }
+        }
+
+        RegNFAThreadList* tmp = clist;
+        clist = nlist;
+        nlist = tmp;
+        if (c == '\0')
+            break;
+        ++s;
+    }
+    return matched;
+}
+
 } // namespace KWSYS_NAMESPACE
@@ -0,0 +1,321 @@
+/*============================================================================
+  KWSys - Kitware System Library
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "kwsysPrivate.h"
+#include KWSYS_HEADER(RegularExpression.hxx)
+
+// Work-around CMake dependency scanning limitation.  This must
+// duplicate the above list of headers.
+#if 0
+# include "RegularExpression.hxx.in"
+#endif
+
+#include <iostream>
+#include <string>
+#include <stdlib.h> /* atoi */
+#include <string.h> /* strcmp */
+#include <time.h> /* clock */
+
+//----------------------------------------------------------------------------
+static const char* testPatterns[][2] =
+{
+  { "abc", "xxabcxx" },
+  { "^abc", "abcabc" },
+  { "^abc", "xabc" },
+  { "abc$", "abcabc" },
+  { "a*", "bbb" },
+  { "a+b", "caaab" },
+  { "a?b", "cab" },
+  { "(a|ab)(c|bcd)(d*)", "abcd" },
+  { "(a+|b)*", "ab" },
+  { "(a+|b)+", "ab" },
+  { "((a)|b)*", "ab" },
+  { "(a|b)*c", "abababc" },
+  { "(..p)b", "rep drepa qrepb" },
+  { "d(..p)", "rep drepa qrepb" },
+  { "[1-9ab]", "hello 1" },
+  { "[^1-9ab]", "begin" },
+  { "br* ", "brrrrr " },
+  { "(x)?y", "y" },
+  { "($)", "xy" },
+  { "(^a)", "ba" },
+  { "([^ :]+):([0-9]+): ([^ \t])", "src/foo.cxx:12: error: bad" },
+  { "([^:]+): (Error:|error|undefined reference|multiply defined)",
+    "foo.o: undefined reference to `bar'" },
+  { "make\\[.*\\]: \\*\\*\\*.*Error", "make[2]: *** [all] Error 2" },
+  { "^#[ \t]*include[ \t]*[<\"]([^\">]+)([\">])", "#include <vector>" },
+  { "(a|b|c|d|e)(f|g)?(h)*$", "xxaghhh" },
+  { "(((((((((a)))))))))", "a" },
+  { 0, 0 }
+};
+
+//----------------------------------------------------------------------------
+static bool CheckSameResult(const char* pattern, const char* input)
+{
+  kwsys::RegularExpression bt;
+  kwsys::RegularExpression nfa;
+  bt.set_engine(kwsys::RegularExpression::Backtracking);
+  nfa.set_engine(kwsys::RegularExpression::NFA);
+  if(!bt.compile(pattern) || !nfa.compile(pattern))
+    {
+    std::cerr << "Could not compile \"" << pattern << "\"" << std::endl;
+    return false;
+    }
+  bool btFound = bt.find(input);
+  bool nfaFound = nfa.find(input);
+  if(btFound != nfaFound)
+    {
+    std::cerr << "Pattern \"" << pattern << "\" on \"" << input
+              << "\": backtracking found " << btFound
+              << ", NFA found " << nfaFound << std::endl;
+    return false;
+    }
+  if(!btFound)
+    {
+    return true;
+    }
+  for(int n = 0; n < kwsys::RegularExpression::NSUBEXP; ++n)
+    {
+    if(bt.start(n) != nfa.start(n) || bt.end(n) != nfa.end(n) ||
+       bt.match(n) != nfa.match(n))
+      {
+      std::cerr << "Pattern \"" << pattern << "\" on \"" << input
+                << "\": submatch " << n << " is \"" << bt.match(n)
+                << "\" with backtracking but \"" << nfa.match(n)
+                << "\" with NFA" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Deterministic pseudo-random numbers so failures are reproducible.
+static unsigned long testSeed = 12345;
+static unsigned int NextRandom(unsigned int n)
+{
+  testSeed = testSeed * 1103515245UL + 12345UL;
+  return static_cast<unsigned int>((testSeed >> 16) & 0x7fff) % n;
+}
+
+// Generate an expression that compiles:  '*' and '+' are only applied to
+// operands that cannot match the empty string.
+static std::string RandomExpression(int depth, int& parens, bool& width);
+
+static std::string RandomAtom(int depth, int& parens, bool& width)
+{
+  static const char* atoms[] = { "a", "b", "c", ".", "[ab]", "[^a]" };
+  if(depth > 0 && parens < kwsys::RegularExpression::NSUBEXP - 1 &&
+     NextRandom(4) == 0)
+    {
+    ++parens;
+    return "(" + RandomExpression(depth - 1, parens, width) + ")";
+    }
+  width = true;
+  return atoms[NextRandom(6)];
+}
+
+static std::string RandomExpression(int depth, int& parens, bool& width)
+{
+  std::string expr;
+  width = true;
+  int branches = 1 + static_cast<int>(NextRandom(3) == 0);
+  for(int b = 0; b < branches; ++b)
+    {
+    bool branchWidth = false;
+    if(b > 0)
+      {
+      expr += "|";
+      }
+    int pieces = 1 + static_cast<int>(NextRandom(3));
+    for(int p = 0; p < pieces; ++p)
+      {
+      bool atomWidth = false;
+      expr += RandomAtom(depth, parens, atomWidth);
+      unsigned int q = NextRandom(6);
+      if(q == 0 && atomWidth)
+        {
+        expr += "*";
+        }
+      else if(q == 1 && atomWidth)
+        {
+        expr += "+";
+        branchWidth = true;
+        }
+      else if(q == 2)
+        {
+        expr += "?";
+        }
+      else
+        {
+        branchWidth = branchWidth || atomWidth;
+        }
+      }
+    width = width && branchWidth;
+    }
+  return expr;
+}
+
+static bool CheckRandomExpressions()
+{
+  bool res = true;
+  for(int i = 0; i < 2000 && res; ++i)
+    {
+    int parens = 0;
+    bool width = false;
+    std::string pattern = RandomExpression(3, parens, width);
+    if(NextRandom(8) == 0)
+      {
+      pattern = "^" + pattern;
+      }
+    if(NextRandom(8) == 0)
+      {
+      pattern += "$";
+      }
+    for(int j = 0; j < 10 && res; ++j)
+      {
+      std::string input;
+      unsigned int len = NextRandom(12);
+      for(unsigned int k = 0; k < len; ++k)
+        {
+        input += "abcd"[NextRandom(4)];
+        }
+      res = CheckSameResult(pattern.c_str(), input.c_str());
+      }
+    }
+  return res;
+}
+
+//----------------------------------------------------------------------------
+static bool CheckPathological()
+{
+  // Exponential for a backtracking matcher.
+  kwsys::RegularExpression re;
+  re.set_engine(kwsys::RegularExpression::NFA);
+  re.compile("(a|a)*(a|a)*(a|a)*b");
+  std::string input(2000, 'a');
+  if(re.find(input))
+    {
+    std::cerr << "Pathological pattern matched unexpectedly" << std::endl;
+    return false;
+    }
+  input += "b";
+  if(!re.find(input) || re.start() != 0 || re.end() != input.size())
+    {
+    std::cerr << "Pathological pattern did not match whole input"
+              << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+static bool CheckEngineSelection()
+{
+  bool res = true;
+  kwsys::RegularExpression::Engine old =
+    kwsys::RegularExpression::get_default_engine();
+  kwsys::RegularExpression::set_default_engine(
+    kwsys::RegularExpression::NFA);
+  kwsys::RegularExpression re("b+");
+  kwsys::RegularExpression copy(re);
+  kwsys::RegularExpression::set_default_engine(old);
+  if(re.get_engine() != kwsys::RegularExpression::NFA ||
+     copy.get_engine() != kwsys::RegularExpression::NFA)
+    {
+    std::cerr << "Default engine not honored" << std::endl;
+    res = false;
+    }
+  if(!copy.find("abbbc") || copy.match(0) != "bbb")
+    {
+    std::cerr << "Copied NFA expression did not match" << std::endl;
+    res = false;
+    }
+  re.compile("c");
+  if(!re.find("abbbc") || re.start() != 4)
+    {
+    std::cerr << "Recompiled NFA expression did not match" << std::endl;
+    res = false;
+    }
+  return res;
+}
+
+//----------------------------------------------------------------------------
+// Report matching throughput in MB/s on a generated build log using the
+// kind of patterns ctest uses to scrape build output.
+static void Benchmark(int megabytes)
+{
+  static const char* lines[] =
+  {
+    "[ 42%] Building CXX object Source/CMakeFiles/CMakeLib.dir/cmFoo.cxx.o",
+    "/usr/bin/c++ -DFOO -I/src/Source -O2 -o cmFoo.cxx.o -c /src/cmFoo.cxx",
+    "/src/Source/cmFoo.cxx:123:45: warning: unused variable 'x'",
+    "Linking CXX static library libCMakeLib.a",
+    "make[2]: Leaving directory '/build'",
+    0
+  };
+  static const char* patterns[] =
+  {
+    "([^ :]+):([0-9]+): ([^ \t])",
+    "([^:]+): (Error:|error|undefined reference|multiply defined)",
+    "make\\[.*\\]: \\*\\*\\*.*Error",
+    "^CMake Error.*:",
+    0
+  };
+  size_t target = static_cast<size_t>(megabytes) * 1024 * 1024;
+  for(int e = 0; e < 2; ++e)
+    {
+    kwsys::RegularExpression::Engine engine = e == 0 ?
+      kwsys::RegularExpression::Backtracking :
+      kwsys::RegularExpression::NFA;
+    kwsys::RegularExpression rex[4];
+    for(int p = 0; patterns[p]; ++p)
+      {
+      rex[p].set_engine(engine);
+      rex[p].compile(patterns[p]);
+      }
+    size_t bytes = 0;
+    size_t matches = 0;
+    clock_t begin = clock();
+    for(int l = 0; bytes < target; l = lines[l + 1] ? l + 1 : 0)
+      {
+      for(int p = 0; patterns[p]; ++p)
+        {
+        matches += rex[p].find(lines[l]) ? 1 : 0;
+        }
+      bytes += strlen(lines[l]) + 1;
+      }
+    double seconds = static_cast<double>(clock() - begin) / CLOCKS_PER_SEC;
+    std::cout << (e == 0 ? "Backtracking" : "NFA") << ": "
+              << (seconds > 0 ? megabytes / seconds : 0) << " MB/s ("
+              << matches << " matches)" << std::endl;
+    }
+}
+
+//----------------------------------------------------------------------------
+int testRegularExpression(int argc, char* argv[])
+{
+  if(argc > 1 && strcmp(argv[1], "benchmark") == 0)
+    {
+    Benchmark(argc > 2 ? atoi(argv[2]) : 16);
+    return 0;
+    }
+
+  bool res = true;
+  for(int i = 0; testPatterns[i][0]; ++i)
+    {
+    res &= CheckSameResult(testPatterns[i][0], testPatterns[i][1]);
+    }
+  res &= CheckRandomExpressions();
+  res &= CheckPathological();
+  res &= CheckEngineSelection();
+  return res ? 0 : 1;
+}
@@ -0,0 +1,342 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "CTest/cmCTestMultiProcessHandler.h"
+
+#include "cmCTest.h"
+#include "cmSystemTools.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Scheduler whose tests finish as soon as they are started, or when
+// asked to if they are held.
+class NoOpTestHandler : public cmCTestMultiProcessHandler
+{
+public:
+  NoOpTestHandler()
+    : Hold(false)
+  {
+  }
+  std::vector<int> Started;
+  bool Hold;
+
+  // Start as many tests as the scheduler allows and return them.
+  std::vector<int> StartRound()
+  {
+    size_t begin = this->Started.size();
+    this->StartNextTests();
+    return std::vector<int>(this->Started.begin() + begin,
+                            this->Started.end());
+  }
+
+  void Finish(int test)
+  {
+    this->FinishTestProcess(test);
+    this->Completed++;
+    this->Passed->push_back(this->Properties[test]->Name);
+  }
+
+protected:
+  void StartTestProcess(int test)
+  {
+    this->Started.push_back(test);
+    this->TestRunningMap[test] = true;
+    this->EraseTest(test);
+    this->RunningCount += this->GetProcessorsUsed(test);
+    this->LockResources(test);
+    if (!this->Hold) {
+      this->Finish(test);
+    }
+  }
+};
+
+class Schedule
+{
+public:
+  Schedule(cmCTest* ctest, size_t parallel)
+    : CTest(ctest)
+    , Parallel(parallel)
+  {
+  }
+  ~Schedule()
+  {
+    for (std::vector<cmCTestTestHandler::cmCTestTestProperties*>::iterator i =
+           this->Properties.begin();
+         i != this->Properties.end(); ++i) {
+      delete *i;
+    }
+  }
+
+  // Add a test and return its index.
+  int Add(float cost, int dependsOn = 0, int dependsOn2 = 0)
+  {
+    cmCTestTestHandler::cmCTestTestProperties* p =
+      new cmCTestTestHandler::cmCTestTestProperties;
+    int index = static_cast<int>(this->Properties.size()) + 1;
+    char name[32];
+    sprintf(name, "test%d", index);
+    p->Name = name;
+    p->Cost = cost;
+    p->RecentCost = 0;
+    p->PreviousRuns = 0;
+    p->RunSerial = false;
+    p->Index = index;
+    p->Processors = 1;
+    this->Properties.push_back(p);
+    cmCTestMultiProcessHandler::TestSet& depends = this->Tests[index];
+    if (dependsOn) {
+      depends.insert(dependsOn);
+    }
+    if (dependsOn2) {
+      depends.insert(dependsOn2);
+    }
+    this->PropertiesMap[index] = p;
+    return index;
+  }
+
+  void SetAmount(int test, std::string const& pool, unsigned long amount)
+  {
+    this->Properties[test - 1]->ResourceAmounts[pool] = amount;
+  }
+
+  // Hand the tests to the scheduler without running them.
+  NoOpTestHandler& Prepare(
+    cmCTestMultiProcessHandler::ResourceAmountMap const& capacities =
+      cmCTestMultiProcessHandler::ResourceAmountMap())
+  {
+    this->Handler.SetCTest(this->CTest);
+    this->Handler.SetParallelLevel(this->Parallel);
+    this->Handler.SetResourceCapacities(capacities);
+    this->Handler.SetTestHandler(static_cast<cmCTestTestHandler*>(
+      this->CTest->GetHandler("test")));
+    this->Handler.SetPassFailVectors(&this->Passed, &this->Failed);
+    this->Handler.SetQuiet(true);
+    this->Handler.SetTests(this->Tests, this->PropertiesMap);
+    return this->Handler;
+  }
+
+  std::vector<int> const& Run()
+  {
+    this->Prepare().RunTests();
+    return this->Handler.Started;
+  }
+
+  // Check that every test ran once and after the tests it depends on.
+  bool CheckOrder()
+  {
+    std::vector<int> const& started = this->Handler.Started;
+    if (started.size() != this->Properties.size()) {
+      printf("%d of %d tests started\n", int(started.size()),
+             int(this->Properties.size()));
+      return false;
+    }
+    std::map<int, size_t> positions;
+    for (size_t i = 0; i < started.size(); ++i) {
+      positions[started[i]] = i;
+    }
+    for (cmCTestMultiProcessHandler::TestMap::iterator t = this->Tests.begin();
+         t != this->Tests.end(); ++t) {
+      for (cmCTestMultiProcessHandler::TestSet::iterator d =
+             t->second.begin();
+           d != t->second.end(); ++d) {
+        if (positions[*d] > positions[t->first]) {
+          printf("test %d started before its dependency %d\n", t->first, *d);
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+private:
+  cmCTest* CTest;
+  size_t Parallel;
+  NoOpTestHandler Handler;
+  std::vector<cmCTestTestHandler::cmCTestTestProperties*> Properties;
+  cmCTestMultiProcessHandler::TestMap Tests;
+  cmCTestMultiProcessHandler::PropertiesMap PropertiesMap;
+  std::vector<std::string> Passed;
+  std::vector<std::string> Failed;
+};
+
+static bool expectOrder(std::vector<int> const& actual, int const* expect,
+                        size_t count)
+{
+  if (actual.size() == count &&
+      std::equal(actual.begin(), actual.end(), expect)) {
+    return true;
+  }
+  printf("expected order:");
+  for (size_t i = 0; i < count; ++i) {
+    printf(" %d", expect[i]);
+  }
+  printf("\nactual order:");
+  for (size_t i = 0; i < actual.size(); ++i) {
+    printf(" %d", actual[i]);
+  }
+  printf("\n");
+  return false;
+}
+
+static int testParallelOrder(cmCTest* ctest)
+{
+  // Independent tests start in order of decreasing cost, after tests that
+  // others depend on.
+  Schedule s(ctest, 4);
+  int t1 = s.Add(1);
+  s.Add(5);
+  s.Add(3, t1);
+  s.Add(4);
+  s.Add(2, t1);
+  static int const expect[] = { 1, 2, 4, 3, 5 };
+  if (!expectOrder(s.Run(), expect, 5) || !s.CheckOrder()) {
+    return 1;
+  }
+  return 0;
+}
+
+static int testSerialOrder(cmCTest* ctest)
+{
+  // Each test starts right after the tests it depends on.
+  Schedule s(ctest, 1);
+  int t1 = s.Add(1);
+  int t2 = s.Add(2, t1);
+  s.Add(5, t2);
+  s.Add(4);
+  s.Add(3, t1);
+  static int const expect[] = { 1, 2, 3, 4, 5 };
+  if (!expectOrder(s.Run(), expect, 5) || !s.CheckOrder()) {
+    return 1;
+  }
+  return 0;
+}
+
+static int testDependencyGraph(cmCTest* ctest)
+{
+  // Diamonds of dependencies several levels deep.
+  Schedule s(ctest, 3);
+  std::vector<int> level(1, s.Add(1));
+  for (int depth = 0; depth < 10; ++depth) {
+    std::vector<int> next;
+    for (size_t i = 0; i < level.size() && i < 8; ++i) {
+      next.push_back(s.Add(float(depth + i), level[i],
+                           level[(i + 1) % level.size()]));
+      next.push_back(s.Add(float(i), level[i]));
+    }
+    level = next;
+  }
+  s.Run();
+  return s.CheckOrder() ? 0 : 1;
+}
+
+static int testCycle(cmCTest* ctest)
+{
+  Schedule s(ctest, 2);
+  s.Add(1);
+  s.Add(1, 3);
+  s.Add(1, 2);
+  if (!s.Run().empty()) {
+    printf("tests with cyclic dependencies were started\n");
+    return 1;
+  }
+  return 0;
+}
+
+static int testResourcePacking(cmCTest* ctest)
+{
+  // Tests start in order of decreasing cost as long as their amounts of
+  // memory fit, skipping over tests that do not fit.
+  Schedule s(ctest, 4);
+  int t1 = s.Add(5);
+  int t2 = s.Add(4);
+  int t3 = s.Add(3);
+  int t4 = s.Add(2);
+  int t5 = s.Add(1);
+  s.SetAmount(t1, "mem", 60);
+  s.SetAmount(t2, "mem", 50);
+  s.SetAmount(t3, "mem", 40);
+  s.SetAmount(t4, "mem", 30);
+  s.SetAmount(t5, "mem", 150);
+  cmCTestMultiProcessHandler::ResourceAmountMap capacities;
+  capacities["mem"] = 100;
+  NoOpTestHandler& h = s.Prepare(capacities);
+  h.Hold = true;
+
+  static int const round1[] = { 1, 3 };
+  if (!expectOrder(h.StartRound(), round1, 2)) {
+    return 1;
+  }
+  h.Finish(t1);
+  static int const round2[] = { 2 };
+  if (!expectOrder(h.StartRound(), round2, 1)) {
+    return 1;
+  }
+  h.Finish(t3);
+  static int const round3[] = { 4 };
+  if (!expectOrder(h.StartRound(), round3, 1)) {
+    return 1;
+  }
+  // A test that needs more than the whole pool runs once it is unused.
+  h.Finish(t2);
+  if (!h.StartRound().empty()) {
+    printf("test needing the whole pool started next to others\n");
+    return 1;
+  }
+  h.Finish(t4);
+  static int const round5[] = { 5 };
+  if (!expectOrder(h.StartRound(), round5, 1)) {
+    return 1;
+  }
+  h.Finish(t5);
+  return s.CheckOrder() ? 0 : 1;
+}
+
+// Report the time to schedule many tests that finish immediately, each
+// depending on an earlier one.
+static void benchmark(cmCTest* ctest, int count)
+{
+  Schedule s(ctest, 8);
+  for (int i = 1; i <= count; ++i) {
+    s.Add(float(rand() % 1000), i > 110 ? i - 100 - rand() % 10 : 0);
+  }
+  double begin = cmSystemTools::GetTime();
+  s.Run();
+  double seconds = cmSystemTools::GetTime() - begin;
+  printf("scheduled %d tests in %.2f s\n", count, seconds);
+}
+
+int testCTestMultiProcessHandler(int argc, char* argv[])
+{
+  std::string dir = cmSystemTools::GetCurrentWorkingDirectory() +
+    "/testCTestMultiProcessHandler";
+  cmSystemTools::RemoveADirectory(dir);
+  cmSystemTools::MakeDirectory(dir.c_str());
+  std::ostringstream log;
+  cmCTest ctest;
+  ctest.SetStreams(&log, &log);
+  ctest.SetCTestConfiguration("CostDataFile",
+                              (dir + "/CTestCostData.txt").c_str());
+
+  if (argc > 1 && strcmp(argv[1], "benchmark") == 0) {
+    benchmark(&ctest, argc > 2 ? atoi(argv[2]) : 100000);
+    return 0;
+  }
+  int result = 0;
+  result |= testParallelOrder(&ctest);
+  result |= testSerialOrder(&ctest);
+  result |= testDependencyGraph(&ctest);
+  result |= testCycle(&ctest);
+  result |= testResourcePacking(&ctest);
+  cmSystemTools::RemoveADirectory(dir);
+  return result;
+}
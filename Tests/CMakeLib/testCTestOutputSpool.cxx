@@ -0,0 +1,102 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmCTestOutputSpool.h"
+#include "cmSystemTools.h"
+
+#if !defined(_WIN32)
+#include <signal.h>
+#include <sys/resource.h>
+#endif
+
+#define cmFailed(m1, m2)                                                      \
+  std::cout << "FAILED: " << m1 << m2 << "\n";                                \
+  failed = 1
+
+static std::string spoolOutput(size_t size)
+{
+  std::string output;
+  for (size_t i = 0; i < size; ++i) {
+    output += static_cast<char>('a' + i % 26);
+  }
+  return output;
+}
+
+int testCTestOutputSpool(int, char* [])
+{
+  int failed = 0;
+  std::string const file = "testCTestOutputSpool.txt";
+  cmSystemTools::RemoveFile(file);
+
+  // Output beyond the limit goes to the file and is read back whole.
+  {
+    std::string const output = spoolOutput(100000);
+    cmCTestOutputSpool spool;
+    spool.Reset(file, 10);
+    for (size_t i = 0; i < output.size(); i += 1000) {
+      spool.Append(output.data() + i, 1000);
+    }
+    if (!spool.IsSpooled() || spool.IsTruncated()) {
+      cmFailed("Output was not spooled to ", file);
+    }
+    if (spool.GetHead() != output.substr(0, 10)) {
+      cmFailed("Unexpected head of spooled output: ", spool.GetHead());
+    }
+    if (spool.GetText() != output) {
+      cmFailed("Spooled output was not read back from ", file);
+    }
+    spool.Release();
+    if (cmSystemTools::FileExists(file.c_str())) {
+      cmFailed("Spool file was not removed: ", file);
+    }
+  }
+
+#if !defined(_WIN32)
+  // Output that cannot be written, as on a full disk, is dropped after
+  // the head, whether that shows while appending or when closing.
+  struct rlimit oldLimit;
+  getrlimit(RLIMIT_FSIZE, &oldLimit);
+  signal(SIGXFSZ, SIG_IGN);
+  size_t const sizes[] = { 100, 100000 };
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+    struct rlimit limit = oldLimit;
+    limit.rlim_cur = 50;
+    setrlimit(RLIMIT_FSIZE, &limit);
+
+    std::string const output = spoolOutput(sizes[s]);
+    cmCTestOutputSpool spool;
+    spool.Reset(file, 10);
+    for (size_t i = 0; i < output.size(); i += 10) {
+      spool.Append(output.data() + i, 10);
+    }
+    std::string const text = spool.GetText();
+    setrlimit(RLIMIT_FSIZE, &oldLimit);
+
+    if (!spool.IsTruncated() || spool.IsSpooled()) {
+      cmFailed("Failed writes were not noticed for output of size ",
+               sizes[s]);
+    }
+    if (text.compare(0, 10, output, 0, 10) != 0 ||
+        text.find("output was lost") == text.npos) {
+      cmFailed("Unexpected truncated output: ", text);
+    }
+    if (spool.GetSize() != text.size()) {
+      cmFailed("Unexpected size of truncated output: ", spool.GetSize());
+    }
+    if (cmSystemTools::FileExists(file.c_str())) {
+      cmFailed("Spool file was not removed: ", file);
+    }
+  }
+  signal(SIGXFSZ, SIG_DFL);
+#endif
+
+  return failed;
+}
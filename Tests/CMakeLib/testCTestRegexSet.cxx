@@ -0,0 +1,174 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "CTest/cmCTestRegexSet.h"
+
+#include "cmStandardIncludes.h"
+#include "cmSystemTools.h"
+
+struct test_pair
+{
+  const char* in;
+  const char* out;
+};
+
+static test_pair const literals[] = {
+  { "^[Bb]us [Ee]rror", "rror" },
+  { "^Fatal", "Fatal" },
+  { "([^ :]+):([0-9]+): ([^ \\t])", ": " },
+  { "make\\[.*\\]: \\*\\*\\*.*Error", "]: ***" },
+  { "^collect2: ld returned", "collect2: ld returned" },
+  { "ab*c", "a" },
+  { "ab+c", "ab" },
+  { "abc?d", "ab" },
+  { "(x|y)abc", "abc" },
+  { "x|abc", "" },
+  { "[]x]yz", "yz" },
+  { 0, 0 }
+};
+
+static const char* errorMatches[] = {
+  "^[Bb]us [Ee]rror",
+  "^[Ss]egmentation [Ff]ault",
+  ":.*[Pp]ermission [Dd]enied",
+  "([^ :]+):([0-9]+): ([^ \\t])",
+  "([^:]+): error[ \\t]*[0-9]+[ \\t]*:",
+  "^Error ([0-9]+):",
+  "^Fatal",
+  "([^ :]+) : (error|fatal error|catastrophic error)",
+  "([^:]+): (Error:|error|undefined reference|multiply defined)",
+  "^collect2: ld returned 1 exit status",
+  "^CMake Error.*:",
+  "make\\[.*\\]: \\*\\*\\*.*Error",
+  ": No such file or directory",
+  0
+};
+
+static const char* errorExceptions[] = {
+  "instantiated from ", "candidates are:", ": warning", ": note", "Note:",
+  "makefile:", "Makefile:", "([^ :]+):([0-9]+): Warning", 0
+};
+
+static const char* logLines[] = {
+  "[ 42%] Building CXX object Source/CMakeFiles/CMakeLib.dir/cmFoo.cxx.o",
+  "/usr/bin/c++ -DFOO -I/src/Source -O2 -o cmFoo.cxx.o -c /src/cmFoo.cxx",
+  "/src/Source/cmFoo.cxx:123:45: warning: unused variable 'x'",
+  "/src/Source/cmFoo.cxx:124:1: error: expected ';' before '}' token",
+  "foo.o: undefined reference to `bar'",
+  "collect2: ld returned 1 exit status",
+  "make[2]: *** [Source/cmFoo.o] Error 1",
+  "Makefile:123: recipe for target 'all' failed",
+  "Segmentation fault",
+  "cc: x.c: No such file or directory",
+  "Linking CXX static library libCMakeLib.a",
+  "",
+  0
+};
+
+static int sequentialFind(std::vector<cmsys::RegularExpression>& rexs,
+                          const char* line)
+{
+  for (size_t i = 0; i < rexs.size(); ++i) {
+    if (rexs[i].find(line)) {
+      return int(i);
+    }
+  }
+  return -1;
+}
+
+static int testLiterals()
+{
+  int result = 0;
+  for (test_pair const* p = literals; p->in; ++p) {
+    std::string out = cmCTestRegexSet::RequiredLiteral(p->in);
+    if (out != p->out) {
+      printf("literal of [%s]: expected [%s], got [%s]\n", p->in, p->out,
+             out.c_str());
+      result = 1;
+    }
+  }
+  return result;
+}
+
+static int testClassification()
+{
+  int result = 0;
+  cmCTestRegexSet set;
+  std::vector<std::vector<cmsys::RegularExpression> > sequential(2);
+  const char** lists[] = { errorMatches, errorExceptions };
+  for (size_t l = 0; l < 2; ++l) {
+    for (const char** r = lists[l]; *r; ++r) {
+      set.Add(l, *r);
+      sequential[l].push_back(cmsys::RegularExpression(*r));
+    }
+  }
+  // An expression that does not compile never matches.
+  set.Add(1, "(unbalanced");
+  sequential[1].push_back(cmsys::RegularExpression());
+
+  for (const char** line = logLines; *line; ++line) {
+    set.SetLine(*line);
+    for (size_t l = 0; l < 2; ++l) {
+      int expect = sequentialFind(sequential[l], *line);
+      int actual = set.Find(l);
+      if (expect != actual) {
+        printf("line [%s] list %d: expected %d, got %d\n", *line, int(l),
+               expect, actual);
+        result = 1;
+      }
+    }
+  }
+  return result;
+}
+
+// Report throughput on a generated build log, one pass per line through
+// the sequential expression lists and through cmCTestRegexSet.
+static void benchmark(int megabytes)
+{
+  cmCTestRegexSet set;
+  std::vector<cmsys::RegularExpression> sequential;
+  for (const char** r = errorMatches; *r; ++r) {
+    set.Add(0, *r);
+    sequential.push_back(cmsys::RegularExpression(*r));
+  }
+  size_t target = static_cast<size_t>(megabytes) * 1024 * 1024;
+  for (int pass = 0; pass < 2; ++pass) {
+    size_t bytes = 0;
+    size_t matches = 0;
+    double begin = cmSystemTools::GetTime();
+    for (const char** line = logLines; bytes < target;
+         line = *(line + 1) ? line + 1 : logLines) {
+      if (pass == 0) {
+        matches += sequentialFind(sequential, *line) >= 0 ? 1 : 0;
+      } else {
+        set.SetLine(*line);
+        matches += set.Find(0) >= 0 ? 1 : 0;
+      }
+      bytes += strlen(*line) + 1;
+    }
+    double seconds = cmSystemTools::GetTime() - begin;
+    printf("%s: %.1f MB/s (%d matching lines)\n",
+           pass == 0 ? "sequential" : "regex set",
+           seconds > 0 ? megabytes / seconds : 0.0, int(matches));
+  }
+}
+
+int testCTestRegexSet(int argc, char* argv[])
+{
+  if (argc > 1 && strcmp(argv[1], "benchmark") == 0) {
+    benchmark(argc > 2 ? atoi(argv[2]) : 64);
+    return 0;
+  }
+  int result = 0;
+  result |= testLiterals();
+  result |= testClassification();
+  return result;
+}
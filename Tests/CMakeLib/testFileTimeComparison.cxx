@@ -0,0 +1,112 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmFileTimeComparison.h"
+#include "cmSystemTools.h"
+
+#include <cmsys/FStream.hxx>
+
+#define cmFailed(m1, m2)                                                      \
+  std::cout << "FAILED: " << m1 << m2 << "\n";                                \
+  failed = 1
+
+// Pick the first newest and first oldest file with pairwise comparisons.
+static bool serialNewestAndOldest(std::vector<std::string> const& files,
+                                  size_t* newest, size_t* oldest)
+{
+  cmFileTimeComparison ftc;
+  *newest = 0;
+  *oldest = 0;
+  for (size_t i = 1; i < files.size(); ++i) {
+    int result;
+    if (!ftc.FileTimeCompare(files[i].c_str(), files[*newest].c_str(),
+                             &result)) {
+      return false;
+    }
+    if (result > 0) {
+      *newest = i;
+    }
+    if (!ftc.FileTimeCompare(files[i].c_str(), files[*oldest].c_str(),
+                             &result)) {
+      return false;
+    }
+    if (result < 0) {
+      *oldest = i;
+    }
+  }
+  return true;
+}
+
+int testFileTimeComparison(int, char* [])
+{
+  int failed = 0;
+  std::string dir = "testFileTimeComparison";
+  cmSystemTools::RemoveADirectory(dir);
+  cmSystemTools::MakeDirectory(dir.c_str());
+
+  // Enough files to query them on several threads.
+  std::vector<std::string> files;
+  for (int i = 0; i < 200; ++i) {
+    std::ostringstream name;
+    name << dir << "/file" << i;
+    cmsys::ofstream fout(name.str().c_str());
+    fout << i << "\n";
+    files.push_back(name.str());
+  }
+  // Give the files in the middle the same, older time.
+  for (size_t i = 50; i < 150; ++i) {
+    cmSystemTools::CopyFileTime(files[50].c_str(), files[i].c_str());
+  }
+
+  size_t expectNewest;
+  size_t expectOldest;
+  if (!serialNewestAndOldest(files, &expectNewest, &expectOldest)) {
+    cmFailed("Cannot compare times of generated files in ", dir);
+    return failed;
+  }
+
+  cmFileTimeComparison ftc;
+  size_t newest = 0;
+  size_t oldest = 0;
+  size_t missing = 0;
+  if (!ftc.FindNewestAndOldest(files, &newest, &oldest, &missing)) {
+    cmFailed("FindNewestAndOldest reports missing file ", files[missing]);
+  } else {
+    if (newest != expectNewest) {
+      cmFailed("FindNewestAndOldest reports wrong newest file ",
+               files[newest]);
+    }
+    if (oldest != expectOldest) {
+      cmFailed("FindNewestAndOldest reports wrong oldest file ",
+               files[oldest]);
+    }
+  }
+
+  // The first missing file is reported, with and without cached times.
+  files.insert(files.begin() + 120, dir + "/missing1");
+  files.push_back(dir + "/missing2");
+  cmFileTimeComparison ftc2;
+  if (ftc2.FindNewestAndOldest(files, &newest, &oldest, &missing)) {
+    cmFailed("FindNewestAndOldest does not report missing files in ", dir);
+  } else if (missing != 120) {
+    cmFailed("FindNewestAndOldest reports wrong missing file ",
+             files[missing]);
+  }
+  if (ftc.FindNewestAndOldest(files, &newest, &oldest, &missing)) {
+    cmFailed("FindNewestAndOldest does not report missing files in ", dir);
+  } else if (missing != 120) {
+    cmFailed("FindNewestAndOldest reports wrong missing file ",
+             files[missing]);
+  }
+
+  cmSystemTools::RemoveADirectory(dir);
+  return failed;
+}
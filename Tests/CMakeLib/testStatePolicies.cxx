@@ -0,0 +1,189 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmState.h"
+
+#include <stdio.h>
+
+// A model of the policy stacks of the directories, looked up by
+// walking the entries one by one, against which the state is checked.
+struct test_policy_entry
+{
+  cmPolicies::PolicyMap Map;
+  bool Weak;
+};
+
+struct test_policy_dir
+{
+  cmState::Snapshot Snapshot;
+  int Parent;
+  std::vector<test_policy_entry> Stack;
+};
+
+static unsigned long test_policy_seed = 1;
+
+static unsigned int test_policy_random(unsigned int n)
+{
+  test_policy_seed = test_policy_seed * 1103515245 + 12345;
+  return static_cast<unsigned int>((test_policy_seed / 65536) % n);
+}
+
+static cmPolicies::PolicyID test_policy_random_id()
+{
+  return static_cast<cmPolicies::PolicyID>(
+    test_policy_random(cmPolicies::CMPCOUNT));
+}
+
+static cmPolicies::PolicyStatus test_policy_random_status()
+{
+  static cmPolicies::PolicyStatus const statuses[] = { cmPolicies::OLD,
+                                                       cmPolicies::WARN,
+                                                       cmPolicies::NEW };
+  return statuses[test_policy_random(3)];
+}
+
+static cmPolicies::PolicyMap test_policy_random_map()
+{
+  cmPolicies::PolicyMap pm;
+  for (unsigned int n = test_policy_random(4); n > 0; --n) {
+    pm.Set(test_policy_random_id(), test_policy_random_status());
+  }
+  return pm;
+}
+
+static void test_policy_set(test_policy_dir& dir, cmPolicies::PolicyID id,
+                            cmPolicies::PolicyStatus status)
+{
+  dir.Snapshot.SetPolicy(id, status);
+  for (std::vector<test_policy_entry>::reverse_iterator e =
+         dir.Stack.rbegin();
+       e != dir.Stack.rend(); ++e) {
+    e->Map.Set(id, status);
+    if (!e->Weak) {
+      break;
+    }
+  }
+}
+
+static cmPolicies::PolicyStatus test_policy_expected(
+  std::vector<test_policy_dir> const& dirs, int d, cmPolicies::PolicyID id)
+{
+  cmPolicies::PolicyStatus status = cmPolicies::GetPolicyStatus(id);
+  if (status == cmPolicies::REQUIRED_ALWAYS ||
+      status == cmPolicies::REQUIRED_IF_USED) {
+    return status;
+  }
+  for (; d >= 0; d = dirs[d].Parent) {
+    std::vector<test_policy_entry> const& stack = dirs[d].Stack;
+    for (std::vector<test_policy_entry>::const_reverse_iterator e =
+           stack.rbegin();
+         e != stack.rend(); ++e) {
+      if (e->Map.IsDefined(id)) {
+        return e->Map.Get(id);
+      }
+    }
+  }
+  return status;
+}
+
+static bool test_policy_check(std::vector<test_policy_dir> const& dirs,
+                              int step)
+{
+  bool result = true;
+  for (int d = 0; d < static_cast<int>(dirs.size()); ++d) {
+    for (int i = 0; i < cmPolicies::CMPCOUNT; ++i) {
+      cmPolicies::PolicyID id = static_cast<cmPolicies::PolicyID>(i);
+      cmPolicies::PolicyStatus expected = test_policy_expected(dirs, d, id);
+      cmPolicies::PolicyStatus actual = dirs[d].Snapshot.GetPolicy(id);
+      if (actual != expected) {
+        printf("step %d: directory %d policy CMP%04d: expected %d, got %d\n",
+               step, d, i, static_cast<int>(expected),
+               static_cast<int>(actual));
+        result = false;
+      }
+    }
+  }
+  return result;
+}
+
+int testStatePolicies(int, char* [])
+{
+  cmState state;
+  std::vector<test_policy_dir> dirs;
+  test_policy_dir top;
+  top.Snapshot = state.CreateBaseSnapshot();
+  top.Parent = -1;
+  dirs.push_back(top);
+
+  // Directories, scopes and policy settings come and go in any order,
+  // including in directories that have finished with their children.
+  for (int step = 0; step < 4000; ++step) {
+    test_policy_dir& dir = dirs[test_policy_random(
+      static_cast<unsigned int>(dirs.size()))];
+    switch (test_policy_random(6)) {
+      case 0:
+        if (dirs.size() < 16) {
+          test_policy_dir child;
+          child.Snapshot =
+            state.CreateBuildsystemDirectorySnapshot(dir.Snapshot);
+          child.Parent = static_cast<int>(&dir - &dirs[0]);
+          test_policy_entry e = { cmPolicies::PolicyMap(), false };
+          child.Snapshot.PushPolicy(e.Map, e.Weak);
+          child.Stack.push_back(e);
+          dirs.push_back(child);
+        }
+        break;
+      case 1: {
+        test_policy_entry e = { test_policy_random_map(),
+                                test_policy_random(2) == 0 };
+        dir.Snapshot.PushPolicy(e.Map, e.Weak);
+        dir.Stack.push_back(e);
+      } break;
+      case 2:
+        if (dir.Snapshot.PopPolicy() != !dir.Stack.empty()) {
+          printf("step %d: unexpected result of PopPolicy\n", step);
+          return 1;
+        }
+        if (!dir.Stack.empty()) {
+          dir.Stack.pop_back();
+        }
+        break;
+      case 3: {
+        // A function call with its own snapshot and policy scope.
+        cmState::Snapshot outer = dir.Snapshot;
+        dir.Snapshot = state.CreateFunctionCallSnapshot(outer, "f");
+        test_policy_entry e = { test_policy_random_map(), true };
+        dir.Snapshot.PushPolicy(e.Map, e.Weak);
+        dir.Stack.push_back(e);
+        test_policy_set(dir, test_policy_random_id(),
+                        test_policy_random_status());
+        if (!test_policy_check(dirs, step)) {
+          return 1;
+        }
+        dir.Snapshot.PopPolicy();
+        dir.Stack.pop_back();
+        dir.Snapshot = state.Pop(dir.Snapshot);
+        if (!(dir.Snapshot == outer)) {
+          printf("step %d: unexpected snapshot after Pop\n", step);
+          return 1;
+        }
+      } break;
+      default:
+        test_policy_set(dir, test_policy_random_id(),
+                        test_policy_random_status());
+        break;
+    }
+    if (!test_policy_check(dirs, step)) {
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -140,3 +140,137 @@ function(run_TestOutputSize)
     )
 endfunction()
 run_TestOutputSize()
+
+function(run_TestOutputSpool)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/TestOutputSpool)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/output.cmake" "
+message(\"FirstLine\")
+foreach(i RANGE 100)
+  message(\"Line \${i} of output kept only on disk while the test runs\")
+endforeach()
+message(\"<DartMeasurement name=\\\"Spooled\\\" type=\\\"text/string\\\">Found</DartMeasurement>\")
+message(\"LastLine\")
+")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+add_test(SpoolingTest \"${CMAKE_COMMAND}\" -P output.cmake)
+set_tests_properties(SpoolingTest PROPERTIES PASS_REGULAR_EXPRESSION LastLine)
+")
+  run_cmake_command(TestOutputSpool
+    ${CMAKE_CTEST_COMMAND} -M Experimental -T Test
+                           --test-output-size-passed 100
+                           --test-output-size-failed 200
+    )
+endfunction()
+run_TestOutputSpool()
+
+function(run_CriticalPath)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/CriticalPath)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+add_test(Head \"${CMAKE_COMMAND}\" -E echo \"Head\")
+add_test(Tail \"${CMAKE_COMMAND}\" -E echo \"Tail\")
+set_tests_properties(Tail PROPERTIES DEPENDS Head)
+add_test(Long \"${CMAKE_COMMAND}\" -E echo \"Long\")
+add_test(Short \"${CMAKE_COMMAND}\" -E echo \"Short\")
+set_tests_properties(Short PROPERTIES DEPENDS Long)
+")
+  # Only the recent times count, and the chain with the cheap Head test
+  # is the longest one.
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestCostData.txt"
+"Head 10 1 1
+Tail 10 10 100
+Long 10 50 50
+Short 10 1 1
+---
+")
+  run_cmake_command(CriticalPath
+    ${CMAKE_CTEST_COMMAND} -j2 --schedule-critical-path
+    )
+endfunction()
+run_CriticalPath()
+
+run_cmake_command(resource-capacity-bad
+  ${CMAKE_CTEST_COMMAND} --resource-capacity mem
+  )
+
+function(run_ResourceAmounts)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/ResourceAmounts)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+add_test(Big1 \"${CMAKE_COMMAND}\" -E echo \"Big1\")
+set_tests_properties(Big1 PROPERTIES COST 3 RESOURCE_AMOUNTS mem=60)
+add_test(Big2 \"${CMAKE_COMMAND}\" -E echo \"Big2\")
+set_tests_properties(Big2 PROPERTIES COST 2 RESOURCE_AMOUNTS \"mem=70;cpu=1\")
+add_test(Small \"${CMAKE_COMMAND}\" -E echo \"Small\")
+set_tests_properties(Small PROPERTIES COST 1 RESOURCE_AMOUNTS mem=40)
+")
+  # Big2 fits next to neither Big1 nor Small, so Small starts before it.
+  run_cmake_command(ResourceAmounts
+    ${CMAKE_CTEST_COMMAND} -j3 --resource-capacity mem=100,cpu=4
+    )
+endfunction()
+run_ResourceAmounts()
+
+run_cmake_command(shard-bad
+  ${CMAKE_CTEST_COMMAND} --shard 3/2
+  )
+
+function(run_Shard)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/Shard)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+foreach(t A B C D E)
+  add_test(\${t} \"${CMAKE_COMMAND}\" -E echo \"\${t}\")
+endforeach()
+set_tests_properties(C PROPERTIES DEPENDS A)
+")
+  # A and C have to stay together and take longer than the other tests.
+  # Each run records new times, so start every shard from the same data
+  # as separate machines would.
+  foreach(case plan 1 2)
+    file(WRITE "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestCostData.txt"
+"A 1 50 50
+B 1 40 40
+C 1 30 30
+D 1 20 20
+E 1 10 10
+---
+")
+    if(case STREQUAL "plan")
+      run_cmake_command(Shard-plan
+        ${CMAKE_CTEST_COMMAND} -V --shard 1/2 --print-shard-plan
+        )
+    else()
+      run_cmake_command(Shard-${case}
+        ${CMAKE_CTEST_COMMAND} --shard ${case}/2
+        )
+    endif()
+  endforeach()
+endfunction()
+run_Shard()
+
+function(run_TestManifest)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/TestManifest-build)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+
+  run_cmake(TestManifest)
+  run_cmake_command(TestManifest-ctest ${CMAKE_CTEST_COMMAND} -N -V)
+  run_cmake_command(TestManifest-debug
+    ${CMAKE_CTEST_COMMAND} -N -V -C debug
+    )
+  # Without the manifest of a subdirectory the scripts list the same tests.
+  file(REMOVE "${RunCMake_TEST_BINARY_DIR}/TestManifest/CTestTestfile.json")
+  run_cmake_command(TestManifest-fallback ${CMAKE_CTEST_COMMAND} -N -V)
+endfunction()
+run_TestManifest()
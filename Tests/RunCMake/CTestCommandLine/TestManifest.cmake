@@ -0,0 +1,7 @@
+enable_testing()
+
+add_test(NAME newstyle COMMAND ${CMAKE_COMMAND} -E echo "a b;c")
+set_tests_properties(newstyle PROPERTIES LABELS "x;y")
+add_test(oldstyle ${CMAKE_COMMAND} -E echo old)
+add_test(NAME debugonly CONFIGURATIONS Debug COMMAND ${CMAKE_COMMAND} -E echo)
+add_subdirectory(TestManifest)
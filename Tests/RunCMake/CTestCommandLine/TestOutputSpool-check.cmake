@@ -0,0 +1,20 @@
+file(GLOB spool_files "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/TestOutput-*")
+file(GLOB test_xml_file "${RunCMake_TEST_BINARY_DIR}/Testing/*/Test.xml")
+file(GLOB test_log_file "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/LastTest*.log")
+file(READ "${test_log_file}" test_log)
+if(spool_files)
+  set(RunCMake_TEST_FAILED "Spooled test output not removed:\n ${spool_files}")
+elseif(NOT test_log MATCHES "FirstLine.*Line 100 of output.*LastLine")
+  set(RunCMake_TEST_FAILED "LastTest.log does not contain all output:\n ${test_log}")
+elseif(test_xml_file)
+  file(READ "${test_xml_file}" test_xml)
+  if(NOT test_xml MATCHES [[<Test Status="passed">]])
+    set(RunCMake_TEST_FAILED "Test.xml does not contain a passed test:\n ${test_xml}")
+  elseif(NOT test_xml MATCHES "name=\"Spooled\"[^>]*>[ \t\n]*<Value>Found</Value>")
+    set(RunCMake_TEST_FAILED "Test.xml does not contain the measurement:\n ${test_xml}")
+  elseif(NOT test_xml MATCHES [[<Value>FirstLine.*100 bytes]] OR test_xml MATCHES "Line 100 of")
+    set(RunCMake_TEST_FAILED "Test.xml output not truncated at 100 bytes:\n ${test_xml}")
+  endif()
+else()
+  set(RunCMake_TEST_FAILED "Test.xml not found")
+endif()
@@ -0,0 +1,16 @@
+enable_language(C)
+include(CheckTypeSize)
+set(output "unchanged")
+try_compile_batch(BEGIN)
+check_type_size(int SIZEOF_INT)
+check_type_size(long SIZEOF_LONG)
+try_compile_batch(END)
+if(NOT output STREQUAL "unchanged")
+  message(SEND_ERROR "check_type_size changed output:\n${output}")
+endif()
+if(DEFINED __CHECK_TYPE_SIZE_OUTPUT_SIZEOF_INT)
+  message(SEND_ERROR "check_type_size left its output set")
+endif()
+if(NOT SIZEOF_INT OR NOT SIZEOF_LONG)
+  message(SEND_ERROR "check_type_size found no sizes")
+endif()
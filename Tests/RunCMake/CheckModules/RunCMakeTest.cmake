@@ -12,5 +12,6 @@ run_cmake(CheckTypeSizeUnknownLanguage)
 run_cmake(CheckTypeSizeMissingLanguage)
 run_cmake(CheckTypeSizeUnknownArgument)
 run_cmake(CheckTypeSizeMixedArgs)
+run_cmake(CheckTypeSizeBatch)
 
 run_cmake(CheckTypeSizeOkNoC)
@@ -173,6 +173,18 @@ run_cmake_command(E_sleep-bad-arg1 ${CMAKE_COMMAND} -E sleep x)
 run_cmake_command(E_sleep-bad-arg2 ${CMAKE_COMMAND} -E sleep 1 -1)
 run_cmake_command(E_sleep-one-tenth ${CMAKE_COMMAND} -E sleep 0.1)
 
+set(progress_dir ${RunCMake_BINARY_DIR}/E_cmake_progress)
+file(REMOVE_RECURSE "${progress_dir}")
+run_cmake_command(E_cmake_progress_start
+  ${CMAKE_COMMAND} -E cmake_progress_start ${progress_dir} 4)
+run_cmake_command(E_cmake_progress-first ${CMAKE_COMMAND} -E cmake_echo_color
+  --progress-dir=${progress_dir} --progress-num=1,2 first)
+run_cmake_command(E_cmake_progress-none ${CMAKE_COMMAND} -E cmake_echo_color
+  --progress-dir=${progress_dir} --progress-num= none)
+run_cmake_command(E_cmake_progress-again ${CMAKE_COMMAND} -E cmake_echo_color
+  --progress-dir=${progress_dir} --progress-num=2,3 again)
+unset(progress_dir)
+
 run_cmake_command(P_directory ${CMAKE_COMMAND} -P ${RunCMake_SOURCE_DIR})
 run_cmake_command(P_working-dir ${CMAKE_COMMAND} -DEXPECTED_WORKING_DIR=${RunCMake_BINARY_DIR}/P_working-dir-build -P ${RunCMake_SOURCE_DIR}/P_working-dir.cmake)
 
@@ -264,6 +276,11 @@ set(RunCMake_TEST_OPTIONS --trace-expand)
 run_cmake(trace-expand)
 unset(RunCMake_TEST_OPTIONS)
 
+set(RunCMake_TEST_OPTIONS
+  --profiling-output=${RunCMake_BINARY_DIR}/profiling-output.json)
+run_cmake(profiling-output)
+unset(RunCMake_TEST_OPTIONS)
+
 set(RunCMake_TEST_OPTIONS --debug-trycompile)
 run_cmake(debug-trycompile)
 unset(RunCMake_TEST_OPTIONS)
@@ -0,0 +1,37 @@
+set(trace "${RunCMake_BINARY_DIR}/profiling-output.json")
+if(NOT EXISTS "${trace}")
+  set(RunCMake_TEST_FAILED "Profiling output missing:\n ${trace}")
+  return()
+endif()
+file(READ "${trace}" trace_content)
+foreach(event
+    "{\"name\":\"profiled_function\",\"cat\":\"function\",\"ph\":\"X\",[^\n]*\"args\":{\"file\":\"[^\"]*/profiling-output.cmake\",\"line\":7,\"args\":\"a b\"}}"
+    "{\"name\":\"profiled_macro\",\"cat\":\"macro\",[^\n]*\"line\":2,\"args\":\"\\\${ARGN}\"}}"
+    "{\"name\":\"find_program\",\"cat\":\"find\","
+    "{\"name\":\"[^\"]*/profiling-output.cmake\",\"cat\":\"listfile\","
+    "{\"name\":\"ComputeTargetDepends\",\"cat\":\"compute\","
+    "{\"name\":\"Generate\",\"cat\":\"generate\","
+    "{\"name\":\"profiled_target\",\"cat\":\"target\",[^\n]*\"args\":\"generate\"}}"
+    "{\"name\":\"counters\",\"ph\":\"C\",[^\n]*\"files written\":[1-9]"
+    )
+  if(NOT trace_content MATCHES "${event}")
+    set(RunCMake_TEST_FAILED "Profiling output does not match\n ${event}")
+    return()
+  endif()
+endforeach()
+if(NOT trace_content MATCHES "^{\"traceEvents\":\\[\n.*\n\\],\"displayTimeUnit\":\"ms\"}\n$")
+  set(RunCMake_TEST_FAILED "Profiling output is not complete.")
+  return()
+endif()
+
+set(summary "${trace}.summary.txt")
+if(NOT EXISTS "${summary}")
+  set(RunCMake_TEST_FAILED "Profiling summary missing:\n ${summary}")
+  return()
+endif()
+file(READ "${summary}" summary_content)
+if(NOT summary_content MATCHES "Calls +Total +Self +Max +Command\n.* 1 +[0-9.]+ +[0-9.]+ +[0-9.]+  profiled_function\n.*Reads +Total +Self +Max +File\n.* 1 +[0-9.]+ +[0-9.]+ +[0-9.]+  [^\n]*/profiling-output.cmake\n")
+  set(RunCMake_TEST_FAILED "Profiling summary does not have expected content:\n${summary_content}")
+elseif(NOT summary_content MATCHES "Step\n.*  Generate\n.*Targets, top 20 .*Target\n.*  profiled_target\n.*Counters\n\n +[0-9]+  generator expression evaluations\n")
+  set(RunCMake_TEST_FAILED "Profiling summary does not have generate step content:\n${summary_content}")
+endif()
@@ -0,0 +1,9 @@
+function(profiled_function)
+  profiled_macro(${ARGN})
+endfunction()
+macro(profiled_macro)
+  set(profiled_value "${ARGN}")
+endmacro()
+profiled_function(a b)
+find_program(profiled_program NAMES profiled-program-that-does-not-exist)
+add_custom_target(profiled_target)
@@ -6,6 +6,7 @@ endfunction()
 
 external_command_test(bad-opt1   tar cvf bad.tar --bad)
 external_command_test(bad-mtime1 tar cvf bad.tar --mtime=bad .)
+external_command_test(bad-threads1 tar cvf bad.tar --threads=bad .)
 external_command_test(bad-from1  tar cvf bad.tar --files-from=bad)
 external_command_test(bad-from2  tar cvf bad.tar --files-from=.)
 external_command_test(bad-from3  tar cvf bad.tar --files-from=${CMAKE_CURRENT_LIST_DIR}/bad-from3.txt)
@@ -17,12 +18,19 @@ external_command_test(mtime      tar cvf bad.tar "--mtime=1970-01-01 00:00:00 UT
 external_command_test(bad-format tar cvf bad.tar "--format=bad-format")
 external_command_test(zip-bz2    tar cvjf bad.tar "--format=zip")
 external_command_test(7zip-gz    tar cvzf bad.tar "--format=7zip")
+if(EXISTS /dev/full)
+  external_command_test(full         tar czf /dev/full ${CMAKE_CURRENT_LIST_DIR})
+  external_command_test(full-threads tar czf /dev/full --threads=2 ${CMAKE_CURRENT_LIST_DIR})
+endif()
 
 run_cmake(7zip)
 run_cmake(gnutar)
 run_cmake(gnutar-gz)
+run_cmake(gnutar-gz-threads)
 run_cmake(pax)
 run_cmake(pax-xz)
+run_cmake(pax-xz-threads)
 run_cmake(paxr)
 run_cmake(paxr-bz2)
+run_cmake(paxr-bz2-threads)
 run_cmake(zip)
@@ -0,0 +1,12 @@
+set(OUTPUT_NAME "test.tar.gz")
+
+set(COMPRESSION_FLAGS cvzf)
+set(COMPRESSION_OPTIONS --format=gnutar --threads=3)
+
+set(DECOMPRESSION_FLAGS xvzf)
+
+set(LARGE_FILE 1)
+
+include(${CMAKE_CURRENT_LIST_DIR}/roundtrip.cmake)
+
+check_magic("1f8b" LIMIT 2 HEX)
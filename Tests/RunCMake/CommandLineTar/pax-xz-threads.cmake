@@ -0,0 +1,12 @@
+set(OUTPUT_NAME "test.tar.xz")
+
+set(COMPRESSION_FLAGS cvJf)
+set(COMPRESSION_OPTIONS --format=pax --threads=0)
+
+set(DECOMPRESSION_FLAGS xvJf)
+
+set(LARGE_FILE 1)
+
+include(${CMAKE_CURRENT_LIST_DIR}/roundtrip.cmake)
+
+check_magic("fd377a585a00" LIMIT 6 HEX)
@@ -0,0 +1,12 @@
+set(OUTPUT_NAME "test.tar.bz2")
+
+set(COMPRESSION_FLAGS cvjf)
+set(COMPRESSION_OPTIONS --format=paxr --threads=3)
+
+set(DECOMPRESSION_FLAGS xvjf)
+
+set(LARGE_FILE 1)
+
+include(${CMAKE_CURRENT_LIST_DIR}/roundtrip.cmake)
+
+check_magic("425a68" LIMIT 3 HEX)
@@ -37,6 +37,16 @@ foreach(file ${CHECK_FILES})
   configure_file(${CMAKE_CURRENT_LIST_FILE} ${FULL_COMPRESS_DIR}/${file} COPYONLY)
 endforeach()
 
+if(LARGE_FILE)
+  # Write a file large enough to span several compression blocks.
+  set(content "0123456789abcdef")
+  foreach(i RANGE 17)
+    set(content "${content}${content}")
+  endforeach()
+  file(WRITE ${FULL_COMPRESS_DIR}/large.txt "${content}")
+  list(APPEND CHECK_FILES "large.txt")
+endif()
+
 if(UNIX)
   execute_process(COMMAND ln -sf f1.txt ${FULL_COMPRESS_DIR}/d1/f2.txt)
   list(APPEND CHECK_FILES "d1/f2.txt")
@@ -0,0 +1,4 @@
+enable_language(C)
+include_directories(inc)
+set_property(SOURCE main.c PROPERTY COMPILE_DEFINITIONS SOURCE_DEFINE)
+include(${CMAKE_CURRENT_BINARY_DIR}/targets.cmake)
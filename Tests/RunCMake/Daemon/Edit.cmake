@@ -0,0 +1,13 @@
+include(${CMAKE_CURRENT_SOURCE_DIR}/targets.cmake)
+
+# Let the test edit the inputs while the daemon is configuring.
+if(EXISTS ${CMAKE_CURRENT_SOURCE_DIR}/pause)
+  file(REMOVE ${CMAKE_CURRENT_SOURCE_DIR}/pause)
+  file(WRITE ${CMAKE_CURRENT_BINARY_DIR}/paused "")
+  foreach(i RANGE 200)
+    if(EXISTS ${CMAKE_CURRENT_SOURCE_DIR}/resume)
+      break()
+    endif()
+    execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 0.1)
+  endforeach()
+endif()
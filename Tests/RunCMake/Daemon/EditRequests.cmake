@@ -0,0 +1,21 @@
+include(${CMAKE_CURRENT_LIST_DIR}/RequestFunctions.cmake)
+start_daemon()
+
+# Regenerate in the background and add a target to an input that the
+# configure step has already read.
+file(WRITE "${src}/pause" "")
+execute_process(COMMAND sh -c
+  "('${CMAKE_COMMAND}' --daemon '${dir}' regenerate >'${dir}/regenerate.log' 2>&1; echo $? >'${dir}/regenerate.result') >/dev/null 2>&1 </dev/null &")
+wait_for("EXISTS;${dir}/paused")
+file(APPEND "${src}/targets.cmake" "add_custom_target(target2)\n")
+file(WRITE "${src}/resume" "")
+wait_for("EXISTS;${dir}/regenerate.result")
+file(READ "${dir}/regenerate.log" out)
+file(STRINGS "${dir}/regenerate.result" res)
+string(STRIP "${out}" out)
+message("regenerate ${res} ${out}")
+
+# The edit is not lost, the build tree is regenerated again.
+wait_for_target(target2)
+request(list-targets)
+stop_daemon()
@@ -0,0 +1,10 @@
+include(${CMAKE_CURRENT_LIST_DIR}/RequestFunctions.cmake)
+start_daemon()
+
+# Regenerating writes the project files of the extra generator again.
+file(REMOVE "${dir}/ExtraGenerator.cbp")
+request(regenerate)
+if(NOT EXISTS "${dir}/ExtraGenerator.cbp")
+  message("The extra generator did not write ExtraGenerator.cbp.")
+endif()
+stop_daemon()
@@ -0,0 +1,46 @@
+set(socket "${dir}/CMakeFiles/daemon.sock")
+
+function(request)
+  execute_process(COMMAND ${CMAKE_COMMAND} --daemon ${dir} ${ARGN}
+    OUTPUT_VARIABLE out ERROR_VARIABLE err RESULT_VARIABLE res
+    OUTPUT_STRIP_TRAILING_WHITESPACE TIMEOUT 60)
+  set(reply "${out}${err}" PARENT_SCOPE)
+  message("${ARGV0} ${res} ${out}${err}")
+endfunction()
+
+function(wait_for condition)
+  foreach(i RANGE 200)
+    if(${condition})
+      return()
+    endif()
+    execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 0.1)
+  endforeach()
+endfunction()
+
+# Start the daemon in the background and wait for it to listen.
+function(start_daemon)
+  execute_process(COMMAND sh -c
+    "'${CMAKE_COMMAND}' --daemon '${dir}' >'${dir}/daemon.log' 2>&1 </dev/null &")
+  wait_for("EXISTS;${socket}")
+endfunction()
+
+# Wait for the daemon to regenerate the build tree with a new target.
+function(wait_for_target name)
+  foreach(i RANGE 100)
+    execute_process(COMMAND ${CMAKE_COMMAND} --daemon ${dir} list-targets
+      OUTPUT_VARIABLE reply)
+    if(reply MATCHES "\"${name}\"")
+      return()
+    endif()
+    execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 0.1)
+  endforeach()
+endfunction()
+
+# Shut the daemon down and wait for it to remove its socket.
+function(stop_daemon)
+  request(shutdown)
+  wait_for("NOT;EXISTS;${socket}")
+  if(EXISTS "${socket}")
+    message("The daemon did not remove its socket.")
+  endif()
+endfunction()
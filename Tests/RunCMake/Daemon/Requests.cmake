@@ -0,0 +1,16 @@
+include(${CMAKE_CURRENT_LIST_DIR}/RequestFunctions.cmake)
+start_daemon()
+
+request(list-targets)
+request(get-compile-flags ${src}/main.c)
+request(get-compile-flags ${src}/missing.c)
+request(frobnicate)
+
+# Adding a target to an input of the configure step regenerates the
+# build tree without being asked to.
+file(APPEND "${dir}/targets.cmake" "add_library(lib2 STATIC main.c)\n")
+wait_for_target(lib2)
+request(list-targets)
+
+request(regenerate)
+stop_daemon()
@@ -0,0 +1,55 @@
+include(RunCMake)
+
+run_cmake_command(no-dir ${CMAKE_COMMAND} --daemon)
+run_cmake_command(no-daemon ${CMAKE_COMMAND} --daemon . list-targets)
+
+# Serve a build tree whose targets come from a file that is changed
+# while the daemon runs.
+set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/Basic-build)
+set(RunCMake_TEST_NO_CLEAN 1)
+file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/targets.cmake"
+  "add_executable(exe1 main.c)\n")
+run_cmake(Basic)
+run_cmake_command(Basic-requests ${CMAKE_COMMAND}
+  -Dsrc=${RunCMake_SOURCE_DIR} -Ddir=${RunCMake_TEST_BINARY_DIR}
+  -P ${RunCMake_SOURCE_DIR}/Requests.cmake)
+unset(RunCMake_TEST_BINARY_DIR)
+unset(RunCMake_TEST_NO_CLEAN)
+
+# Edit an input of a source tree while the daemon configures it.
+set(RunCMake_TEST_SOURCE_DIR ${RunCMake_BINARY_DIR}/Edit-src)
+set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/Edit-build)
+set(RunCMake_TEST_NO_CLEAN 1)
+file(REMOVE_RECURSE "${RunCMake_TEST_SOURCE_DIR}" "${RunCMake_TEST_BINARY_DIR}")
+file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+file(WRITE "${RunCMake_TEST_SOURCE_DIR}/CMakeLists.txt" "
+cmake_minimum_required(VERSION 3.5)
+project(Edit NONE)
+include(${RunCMake_SOURCE_DIR}/Edit.cmake)
+")
+file(WRITE "${RunCMake_TEST_SOURCE_DIR}/targets.cmake"
+  "add_custom_target(target1)\n")
+run_cmake(Edit)
+run_cmake_command(EditRequests ${CMAKE_COMMAND}
+  -Dsrc=${RunCMake_TEST_SOURCE_DIR} -Ddir=${RunCMake_TEST_BINARY_DIR}
+  -P ${RunCMake_SOURCE_DIR}/EditRequests.cmake)
+unset(RunCMake_TEST_SOURCE_DIR)
+unset(RunCMake_TEST_BINARY_DIR)
+unset(RunCMake_TEST_NO_CLEAN)
+
+# Serve a build tree that also has an extra generator.
+if(RunCMake_GENERATOR MATCHES "^(Unix Makefiles|Ninja)$")
+  set(RunCMake_GENERATOR "CodeBlocks - ${RunCMake_GENERATOR}")
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/ExtraGenerator-build)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  run_cmake(ExtraGenerator)
+  run_cmake_command(ExtraGeneratorRequests ${CMAKE_COMMAND}
+    -Ddir=${RunCMake_TEST_BINARY_DIR}
+    -P ${RunCMake_SOURCE_DIR}/ExtraGeneratorRequests.cmake)
+  unset(RunCMake_TEST_BINARY_DIR)
+  unset(RunCMake_TEST_NO_CLEAN)
+endif()
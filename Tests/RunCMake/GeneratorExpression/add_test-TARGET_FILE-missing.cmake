@@ -0,0 +1,2 @@
+enable_testing()
+add_test(NAME t COMMAND $<TARGET_FILE:missing>)
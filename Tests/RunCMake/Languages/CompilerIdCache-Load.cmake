@@ -0,0 +1,8 @@
+enable_language(C)
+if(NOT CMAKE_C_COMPILER_WORKS OR NOT CMAKE_C_SIZEOF_DATA_PTR)
+  message(FATAL_ERROR "C compiler information not loaded from the cache.")
+endif()
+get_property(type CACHE CMAKE_C_COMPILER PROPERTY TYPE)
+if(NOT type STREQUAL "FILEPATH")
+  message(FATAL_ERROR "CMAKE_C_COMPILER cache entry not restored.")
+endif()
@@ -0,0 +1,10 @@
+# The tools found with the first language enabled are restored too.
+set(tools_regex "^CMAKE_(AR|RANLIB|STRIP|LINKER|NM|OBJDUMP|OBJCOPY):")
+file(STRINGS ${RunCMake_BINARY_DIR}/CompilerIdCache-StoreBoth-build/CMakeCache.txt
+  expect REGEX "${tools_regex}")
+file(STRINGS ${RunCMake_TEST_BINARY_DIR}/CMakeCache.txt
+  actual REGEX "${tools_regex}")
+if(NOT actual STREQUAL expect)
+  set(RunCMake_TEST_FAILED
+    "Cached tools are\n  ${actual}\nbut expected\n  ${expect}")
+endif()
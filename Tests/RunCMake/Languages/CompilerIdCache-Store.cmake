@@ -0,0 +1 @@
+enable_language(C)
@@ -0,0 +1,2 @@
+enable_language(C)
+enable_language(CXX)
@@ -6,3 +6,12 @@ run_cmake(link-libraries-TARGET_FILE-genex)
 run_cmake(link-libraries-TARGET_FILE-genex-ok)
 
 run_cmake(DetermineFail)
+
+set(RunCMake_TEST_OPTIONS
+  -DCMAKE_COMPILER_ID_CACHE_DIR=${RunCMake_BINARY_DIR}/CompilerIdCache)
+file(REMOVE_RECURSE ${RunCMake_BINARY_DIR}/CompilerIdCache)
+run_cmake(CompilerIdCache-Store)
+run_cmake(CompilerIdCache-Load)
+run_cmake(CompilerIdCache-StoreBoth)
+run_cmake(CompilerIdCache-LoadCXX)
+unset(RunCMake_TEST_OPTIONS)
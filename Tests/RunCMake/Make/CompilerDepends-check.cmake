@@ -0,0 +1,18 @@
+set(build_make "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/main.dir/build.make")
+file(READ "${build_make}" rules)
+
+# Compilers that cannot write depfiles are not given the flags at all.
+if(NOT rules MATCHES "-MF")
+  return()
+endif()
+
+foreach(ext i s)
+  string(REGEX MATCH "main\\.c\\.${ext}: cmake_force\n[^\n]*\n[^\n]*\n"
+    rule "${rules}")
+  if(NOT rule)
+    set(RunCMake_TEST_FAILED "No rule for main.c.${ext} in\n  ${build_make}")
+  elseif(rule MATCHES "-MF")
+    set(RunCMake_TEST_FAILED
+      "The rule for main.c.${ext} writes the depfile of the object:\n${rule}")
+  endif()
+endforeach()
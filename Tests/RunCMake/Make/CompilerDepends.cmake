@@ -0,0 +1,2 @@
+enable_language(C)
+add_executable(main main.c)
@@ -0,0 +1,9 @@
+set(dir "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/main.dir")
+file(READ "${dir}/depend.make" depend_make)
+if(NOT depend_make MATCHES "^# Empty dependencies file")
+  set(RunCMake_TEST_FAILED
+    "The dependencies were not cleared from\n  ${dir}/depend.make")
+elseif(EXISTS "${dir}/depend.internal")
+  set(RunCMake_TEST_FAILED
+    "The dependencies were not cleared, found\n  ${dir}/depend.internal")
+endif()
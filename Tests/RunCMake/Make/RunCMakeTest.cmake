@@ -15,3 +15,18 @@ run_TargetMessages(OFF)
 
 run_TargetMessages(VAR-ON -DCMAKE_TARGET_MESSAGES=ON)
 run_TargetMessages(VAR-OFF -DCMAKE_TARGET_MESSAGES=OFF)
+
+set(RunCMake_TEST_OPTIONS -DCMAKE_DEPENDS_USE_COMPILER=ON)
+run_cmake(CompilerDepends)
+unset(RunCMake_TEST_OPTIONS)
+
+function(run_MakeDepend)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/MakeDepend-build)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  run_cmake(MakeDepend)
+  run_cmake_command(MakeDepend-build ${CMAKE_COMMAND} --build .)
+  run_cmake_command(MakeDepend-depend ${CMAKE_COMMAND} --build . --target depend)
+endfunction()
+run_MakeDepend()
@@ -5,6 +5,7 @@ run_cmake(directory_properties)
 run_cmake(global_properties)
 run_cmake(install_properties)
 run_cmake(source_properties)
+run_cmake(source_lookup)
 run_cmake(target_properties)
 run_cmake(test_properties)
 run_cmake(DebugConfigurations)
@@ -0,0 +1,34 @@
+function (check_source_lookup file)
+  get_property(val SOURCE "${file}" PROPERTY tag)
+  message("${file}: -->${val}<--")
+endfunction ()
+
+# A name without extension is resolved by a later name with one of the
+# extensions tried for source files on disk.
+set_property(SOURCE ambig PROPERTY tag ambig)
+check_source_lookup(ambig.c)
+check_source_lookup(ambig.cxx)
+check_source_lookup(ambig)
+
+# Names with known extensions are found without them.
+set_property(SOURCE header.h PROPERTY tag header.h)
+set_property(SOURCE template.in PROPERTY tag template.in)
+check_source_lookup(header)
+check_source_lookup(template)
+
+# A name with an unknown extension may still be extended.
+set_property(SOURCE data.txt PROPERTY tag data.txt)
+check_source_lookup(data.txt.c)
+check_source_lookup(data)
+
+# The first file created wins among several candidates.
+set_property(SOURCE dup.h PROPERTY tag dup.h)
+set_property(SOURCE dup.c PROPERTY tag dup.c)
+check_source_lookup(dup)
+check_source_lookup(dup.c)
+
+# Directories must still match.
+set_property(SOURCE sub/ambig PROPERTY tag sub/ambig)
+check_source_lookup(sub/ambig.c)
+check_source_lookup(other/ambig.c)
+check_source_lookup(${CMAKE_CURRENT_SOURCE_DIR}/sub/ambig)
@@ -0,0 +1,3 @@
+cmake_policy(SET CMP0054 NEW)
+if((x MATCHES "("))
+endif()
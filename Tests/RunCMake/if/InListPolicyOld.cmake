@@ -0,0 +1,4 @@
+cmake_policy(SET CMP0057 OLD)
+set(list a b)
+if(a IN_LIST list)
+endif()
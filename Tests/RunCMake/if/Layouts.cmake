@@ -0,0 +1,25 @@
+# The same condition reduces differently when its arguments expand to
+# a different layout of keywords and operands.
+set(S "abc")
+foreach(v "x" "NOT;x" "x;STREQUAL;x" "(;x;)" "NOT;(;x;STREQUAL;y;)")
+  if(${v} STREQUAL "x")
+    message("[${v}] STREQUAL x: true")
+  else()
+    message("[${v}] STREQUAL x: false")
+  endif()
+endforeach()
+
+# Binary operators run left to right within a precedence level, so the
+# STREQUAL on CMAKE_MATCH_1 runs before MATCHES and does not yet see its
+# match results.
+if(CMAKE_MATCH_1 STREQUAL "a" AND S MATCHES "^(.)")
+  message("matched before AND")
+endif()
+
+# Predicates and NOT take the next argument, even if it is a keyword.
+set(NOT 1)
+if(NOT NOT)
+  message("NOT NOT: true")
+else()
+  message("NOT NOT: false")
+endif()
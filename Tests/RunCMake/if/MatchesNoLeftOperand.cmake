@@ -0,0 +1,5 @@
+if(MATCHES "x")
+  message("MATCHES x: true")
+else()
+  message("MATCHES x: false")
+endif()
@@ -0,0 +1,3 @@
+set(open "(")
+if((a) AND ${open} b)
+endif()
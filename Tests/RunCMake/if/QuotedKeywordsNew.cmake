@@ -0,0 +1,7 @@
+cmake_policy(SET CMP0054 NEW)
+if("NOT" STREQUAL "NOT")
+  message("\"NOT\" STREQUAL \"NOT\": true")
+endif()
+if(NOT ("AND") AND ("OR" STREQUAL "OR"))
+  message("NOT (\"AND\") AND (\"OR\" STREQUAL \"OR\"): true")
+endif()
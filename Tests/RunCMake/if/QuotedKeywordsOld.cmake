@@ -0,0 +1,8 @@
+cmake_policy(SET CMP0054 OLD)
+set(x 0)
+if("NOT" x)
+  message("\"NOT\" x: true")
+endif()
+if("x" "STREQUAL" "0")
+  message("\"x\" \"STREQUAL\" \"0\": true")
+endif()
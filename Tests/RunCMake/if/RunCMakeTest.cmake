@@ -6,6 +6,14 @@ run_cmake(IsDirectoryLong)
 run_cmake(elseif-message)
 
 run_cmake(MatchesSelf)
+run_cmake(Layouts)
+run_cmake(MismatchedParenAfterGroup)
+run_cmake(BadRegexInParens)
+run_cmake(MatchesNoLeftOperand)
+run_cmake(QuotedKeywordsOld)
+run_cmake(QuotedKeywordsNew)
+run_cmake(InListPolicyOld)
+run_cmake(TestPolicyOld)
 
 run_cmake(TestNameThatExists)
 run_cmake(TestNameThatDoesNotExist)
@@ -0,0 +1,3 @@
+cmake_policy(SET CMP0064 OLD)
+if(TEST t)
+endif()
@@ -0,0 +1,54 @@
+enable_language(C)
+
+function(report_late)
+  message(STATUS "late: ${late}")
+endfunction()
+
+function(check_results)
+  if(NOT good)
+    message(FATAL_ERROR "try_compile failed:\n${good_out}")
+  elseif(NOT EXISTS ${CMAKE_CURRENT_BINARY_DIR}/copy)
+    message(FATAL_ERROR "try_compile did not copy its output file")
+  elseif(bad)
+    message(FATAL_ERROR "try_compile passed but should have failed")
+  elseif(NOT bad_out MATCHES "PP_ERROR is defined")
+    message(FATAL_ERROR "try_compile did not fail with PP_ERROR:\n${bad_out}")
+  endif()
+  try_compile(late ${CMAKE_CURRENT_BINARY_DIR}
+    SOURCES ${CMAKE_CURRENT_SOURCE_DIR}/src.c
+    BATCH
+    )
+  try_compile_batch(CALL report_late)
+  try_compile_batch(CALL set checked 1)
+endfunction()
+
+file(REMOVE ${CMAKE_CURRENT_BINARY_DIR}/copy)
+try_compile_batch(BEGIN)
+try_compile(good ${CMAKE_CURRENT_BINARY_DIR}
+  SOURCES ${CMAKE_CURRENT_SOURCE_DIR}/src.c
+  OUTPUT_VARIABLE good_out
+  COPY_FILE ${CMAKE_CURRENT_BINARY_DIR}/copy
+  BATCH
+  )
+try_compile(bad ${CMAKE_CURRENT_BINARY_DIR}
+  SOURCES ${CMAKE_CURRENT_SOURCE_DIR}/src.c
+  COMPILE_DEFINITIONS -DPP_ERROR
+  OUTPUT_VARIABLE bad_out
+  BATCH
+  )
+if(DEFINED good OR DEFINED bad)
+  message(FATAL_ERROR "try_compile results set before the batch ends")
+endif()
+try_compile_batch(CALL check_results)
+try_compile_batch(END PARALLEL 2)
+
+if(NOT checked)
+  message(FATAL_ERROR "try_compile_batch did not make the queued calls")
+elseif(NOT late)
+  message(FATAL_ERROR "try_compile queued by a call failed")
+endif()
+
+try_compile_batch(CALL set immediate 1)
+if(NOT immediate)
+  message(FATAL_ERROR "try_compile_batch(CALL) outside a batch was queued")
+endif()
@@ -0,0 +1 @@
+try_compile_batch(END)
@@ -0,0 +1,4 @@
+try_compile_batch(BEGIN)
+try_compile(RESULT ${CMAKE_CURRENT_BINARY_DIR} ${CMAKE_CURRENT_SOURCE_DIR}
+  Proj BATCH)
+try_compile_batch(END)
@@ -0,0 +1,39 @@
+enable_language(C)
+set(CMAKE_TRY_COMPILE_CACHE_DIR ${CMAKE_CURRENT_BINARY_DIR}/cache)
+
+foreach(i 1 2)
+  file(REMOVE ${CMAKE_CURRENT_BINARY_DIR}/copy${i})
+  try_compile(result ${CMAKE_CURRENT_BINARY_DIR}
+    SOURCES ${CMAKE_CURRENT_SOURCE_DIR}/src.c
+    OUTPUT_VARIABLE out${i}
+    COPY_FILE ${CMAKE_CURRENT_BINARY_DIR}/copy${i}
+    )
+  if(NOT result)
+    message(FATAL_ERROR "try_compile failed:\n${out${i}}")
+  endif()
+  if(NOT EXISTS ${CMAKE_CURRENT_BINARY_DIR}/copy${i})
+    message(FATAL_ERROR "try_compile did not copy its output file (${i})")
+  endif()
+endforeach()
+if(NOT out1 STREQUAL out2)
+  message(FATAL_ERROR "try_compile output changed:\n${out1}\n${out2}")
+endif()
+
+foreach(i 1 2)
+  try_compile(result ${CMAKE_CURRENT_BINARY_DIR}
+    SOURCES ${CMAKE_CURRENT_SOURCE_DIR}/src.c
+    COMPILE_DEFINITIONS -DPP_ERROR
+    OUTPUT_VARIABLE out
+    )
+  if(result)
+    message(FATAL_ERROR "try_compile passed but should have failed:\n${out}")
+  elseif(NOT out MATCHES "PP_ERROR is defined")
+    message(FATAL_ERROR "try_compile did not fail with PP_ERROR:\n${out}")
+  endif()
+endforeach()
+
+file(GLOB entries ${CMAKE_TRY_COMPILE_CACHE_DIR}/*)
+list(LENGTH entries count)
+if(NOT count EQUAL 2)
+  message(FATAL_ERROR "try_compile cache has ${count} entries:\n${entries}")
+endif()
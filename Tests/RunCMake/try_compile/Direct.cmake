@@ -0,0 +1,28 @@
+enable_language(C)
+set(CMAKE_TRY_COMPILE_DIRECT ON)
+
+file(REMOVE ${CMAKE_CURRENT_BINARY_DIR}/copy)
+try_compile(result ${CMAKE_CURRENT_BINARY_DIR}
+  SOURCES ${CMAKE_CURRENT_SOURCE_DIR}/src.c
+  OUTPUT_VARIABLE out
+  COPY_FILE ${CMAKE_CURRENT_BINARY_DIR}/copy
+  )
+if(NOT result)
+  message(FATAL_ERROR "try_compile failed:\n${out}")
+elseif(NOT out MATCHES "Compiling directly")
+  message(FATAL_ERROR "try_compile did not compile directly:\n${out}")
+elseif(NOT EXISTS ${CMAKE_CURRENT_BINARY_DIR}/copy)
+  message(FATAL_ERROR "try_compile did not copy its output file")
+endif()
+
+try_compile(result ${CMAKE_CURRENT_BINARY_DIR}
+  SOURCES ${CMAKE_CURRENT_SOURCE_DIR}/src.c
+  COMPILE_DEFINITIONS -DPP_ERROR
+  OUTPUT_VARIABLE out
+  )
+if(result)
+  message(FATAL_ERROR "try_compile passed but should have failed:\n${out}")
+elseif(NOT out MATCHES "PP_ERROR is defined")
+  message(FATAL_ERROR "try_compile did not fail with PP_ERROR:\n${out}")
+endif()
+
@@ -26,6 +26,14 @@ run_cmake(TargetTypeStatic)
 
 run_cmake(CMP0056)
 run_cmake(CompileFlags)
+run_cmake(CacheDir)
+run_cmake(Batch)
+run_cmake(BatchEndNoBegin)
+run_cmake(BatchNoEnd)
+run_cmake(BatchSrcDir)
+if(RunCMake_GENERATOR MATCHES "Make|Ninja")
+  run_cmake(Direct)
+endif()
 
 if(RunCMake_GENERATOR MATCHES "Make|Ninja")
   # Use a single build tree for a few tests without cleaning.
@@ -0,0 +1,52 @@
+# Time the evaluation of if() and while() conditions in a hot loop.
+#
+# Invoke in script mode, optionally defining these variables:
+# ITERATIONS - the number of loop iterations (default 50000)
+#
+# For example:
+#
+#   time cmake -DITERATIONS=100000 -P ConditionBenchmark.cmake
+#
+# Each loop repeats the same few conditions, so the time is dominated
+# by parsing and evaluating their arguments.  Compare the times of two
+# cmake builds to see the effect of a change to the condition evaluator.
+
+cmake_minimum_required(VERSION 3.3)
+cmake_policy(SET CMP0054 NEW)
+cmake_policy(SET CMP0057 NEW)
+cmake_policy(SET CMP0064 NEW)
+
+if(NOT ITERATIONS)
+  set(ITERATIONS 50000)
+endif()
+
+set(list a b c d e f)
+set(str "abcdef")
+set(count 0)
+
+# Nested if()/elseif() with deep parentheses and every operator class.
+foreach(i RANGE ${ITERATIONS})
+  if(((i LESS 10 OR i GREATER 20) AND NOT (i EQUAL 15)) AND
+     ((str MATCHES "^a(b+)c" AND CMAKE_MATCH_1 STREQUAL "b") OR
+      (DEFINED undefined_var)))
+    if((c IN_LIST list) AND (str STRGREATER "abc") AND
+       NOT ((i EQUAL 0) OR (str STREQUAL "")))
+      math(EXPR count "${count} + 1")
+    elseif(i VERSION_LESS 1.2.3 OR (COMMAND message AND POLICY CMP0054))
+      math(EXPR count "${count} + 2")
+    else()
+      math(EXPR count "${count} + 3")
+    endif()
+  elseif(NOT (i LESS 10) AND (str MATCHES "z$" OR list))
+    math(EXPR count "${count} + 4")
+  endif()
+endforeach()
+
+# while() with a compound condition re-evaluated on every iteration.
+set(i 0)
+while((i LESS ITERATIONS) AND (NOT (i EQUAL -1)) AND
+      (str STREQUAL "abcdef" OR str MATCHES "^x") AND (DEFINED str))
+  math(EXPR i "${i} + 1")
+endwhile()
+
+message(STATUS "count=${count} i=${i}")